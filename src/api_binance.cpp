@@ -29,20 +29,16 @@ ApiBinance::ApiBinance(const std::vector<TradingPair> pairs, bool testMode)
 }
 
 void ApiBinance::processMessage(const json& data) {
+    // depth updates and book tickers are handled by processMarketData
     if (data.contains("e")) {
         std::string eventType = data["e"];
         TRACE("received message type: ", eventType, " ", data.dump().substr(0, 300));
-        if (eventType == "depthUpdate") {
-            processOrderBookUpdate(data);
-        } else if (eventType == "executionReport") {
+        if (eventType == "executionReport") {
             ERROR("not implemented: Execution report: ", data.dump());
             // processExecutionReport(data);
         } else {
             ERROR("Unhandled event type: ", eventType);
         }
-    } else if (data.contains("b") && data.contains("a") && data.contains("B") && data.contains("A")) {
-        DEBUG("received bookTicker: ", data.dump().substr(0, 300));
-        processBookTicker(data);
     } else if (data.contains("result") && data["result"] == nullptr) {
         // This is a subscription response
         TRACE("Subscription successful", data.dump());
@@ -54,53 +50,88 @@ void ApiBinance::processMessage(const json& data) {
     }
 }
 
-void ApiBinance::processBookTicker(const json& data) {
+bool ApiBinance::processMarketData(const JsonValue& data) {
+    JsonValue eventType = data["e"];
+    if (eventType.equals("depthUpdate")) {
+        processOrderBookUpdate(data);
+        return true;
+    }
+    if (!eventType.valid() && data["b"].isString() && data["a"].isString()) {
+        DEBUG("received bookTicker: ", data.raw().substr(0, 300));
+        processBookTicker(data);
+        return true;
+    }
+    return false;
+}
+
+void ApiBinance::processBookTicker(const JsonValue& data) {
     try {
-        std::string symbol = data["s"];
+        std::string_view symbol = data["s"].str();
         TradingPair pair = symbolToTradingPair(symbol);
         if (pair == TradingPair::UNKNOWN) {
             ERROR("Unknown trading pair in bookTicker: ", symbol);
             return;
         }
+        int64_t updateId;
+        if (data["u"].getInt(updateId) && !isFirstArrival(pair, FeedArbiter::Stream::TOP, updateId)) {
+            return;
+        }
 
-        double bidPrice = std::stod(data["b"].get<std::string>());
-        double bidQuantity = std::stod(data["B"].get<std::string>());
-        double askPrice = std::stod(data["a"].get<std::string>());
-        double askQuantity = std::stod(data["A"].get<std::string>());
-        std::vector<PriceLevel> bids({{bidPrice, bidQuantity}});
-        std::vector<PriceLevel> asks({{askPrice, askQuantity}});
-        orderBookManager.updateOrderBookBestBidAsk(ExchangeId::BINANCE, pair, bidPrice, bidQuantity, askPrice, askQuantity);
+        FixedLevel bid(FixedPoint::parsePrice(data["b"].str()), FixedPoint::parseQty(data["B"].str()));
+        FixedLevel ask(FixedPoint::parsePrice(data["a"].str()), FixedPoint::parseQty(data["A"].str()));
+        orderBookManager.updateOrderBookBestBidAsk(ExchangeId::BINANCE, pair, bid, ask);
     
     } catch (const std::exception& e) {
-        ERROR("Error processing bookTicker: ", data.dump().substr(0, 300), " ", e.what());
+        ERROR("Error processing bookTicker: ", data.raw().substr(0, 300), " ", e.what());
     }
 }
 
-void ApiBinance::processOrderBookUpdate(const json& data) {
+// Append [price, quantity] pairs; quantity 0 is a delete and is passed through
+static bool parseLevels(const JsonValue& levels, std::vector<FixedLevel>& out) {
+    return levels.forEach([&](const JsonValue& level) {
+        out.push_back({FixedPoint::parsePrice(level.at(0).str()), FixedPoint::parseQty(level.at(1).str())});
+        return true;
+    });
+}
+
+void ApiBinance::processOrderBookUpdate(const JsonValue& data, bool replay) {
     try {
-        if (!data.contains("e") || data["e"] != "depthUpdate") {
+        if (!data["e"].equals("depthUpdate")) {
             return;
         }
 
-        std::string symbol = data["s"].get<std::string>();
+        std::string_view symbol = data["s"].str();
         TradingPair pair = symbolToTradingPair(symbol);
         if (pair == TradingPair::UNKNOWN) {
             TRACE("Unknown trading pair in update: ", symbol);
             return;
         }
+        int64_t finalUpdateId;
+        if (!replay && data["u"].getInt(finalUpdateId) && !isFirstArrival(pair, FeedArbiter::Stream::BOOK, finalUpdateId)) {
+            return;
+        }
 
         auto& state = symbolStates[pair];
         if (!state.hasSnapshot()) {
-            TRACE("No snapshot for ", symbol, " yet, requesting...");
-            if (!getOrderBookSnapshot(pair)) {
-                ERROR("Failed to get order book snapshot for ", symbol);
-                return;
+            // keep the update for when the snapshot is in, the read loop does not wait for it
+            auto& pending = m_pendingUpdates[pair];
+            if (pending.size() < static_cast<size_t>(Config::SNAPSHOT_MAX_BUFFERED_UPDATES)) {
+                pending.emplace_back(data.raw());
+            } else {
+                ERROR("Dropping update for ", symbol, ", ", pending.size(), " already buffered");
+            }
+            if (!state.snapshotPending) {
+                TRACE("No snapshot for ", symbol, " yet, requesting...");
+                if (!getOrderBookSnapshot(pair)) {
+                    ERROR("Failed to get order book snapshot for ", symbol);
+                }
             }
+            return;
         }
 
         // Check if this update is after our last snapshot
-        if (data.contains("u")) {
-            int64_t updateId = data["u"];
+        int64_t updateId;
+        if (data["u"].getInt(updateId)) {
             if (updateId <= state.lastUpdateId) {
                 TRACE("Skipping update for ", symbol, " - update ID ", updateId, " is before or equal to last snapshot ID ", state.lastUpdateId);
                 return;
@@ -108,31 +139,11 @@ void ApiBinance::processOrderBookUpdate(const json& data) {
             TRACE("Processing update for ", symbol, " - update ID ", updateId, " is after last snapshot ID ", state.lastUpdateId);
         }
 
-        std::vector<PriceLevel> bids;
-        std::vector<PriceLevel> asks;
-
-        // Process bids
-        for (const auto& bid : data["b"]) {
-            double price = std::stod(bid[0].get<std::string>());
-            double quantity = std::stod(bid[1].get<std::string>());
-            if (quantity > 0) {
-                bids.push_back({price, quantity});
-            } else {
-                // If quantity is 0, it's a delete - we'll pass it through with 0 quantity
-                bids.push_back({price, 0});
-            }
-        }
-
-        // Process asks
-        for (const auto& ask : data["a"]) {
-            double price = std::stod(ask[0].get<std::string>());
-            double quantity = std::stod(ask[1].get<std::string>());
-            if (quantity > 0) {
-                asks.push_back({price, quantity});
-            } else {
-                // If quantity is 0, it's a delete - we'll pass it through with 0 quantity
-                asks.push_back({price, 0});
-            }
+        std::vector<FixedLevel> bids;
+        std::vector<FixedLevel> asks;
+        if (!parseLevels(data["b"], bids) || !parseLevels(data["a"], asks)) {
+            ERROR("Malformed order book update: ", data.raw().substr(0, 300));
+            return;
         }
 
         // Skip updates that would clear the entire order book
@@ -164,8 +175,8 @@ void ApiBinance::processOrderBookUpdate(const json& data) {
 
         if (!bids.empty() || !asks.empty()) {
             TRACE("Updating order book for ", symbol, " with ", bids.size(), " bids and ", asks.size(), " asks");
-            TRACE("First bid: ", (bids.empty() ? "none" : std::to_string(bids[0].price) + "@" + std::to_string(bids[0].quantity)));
-            TRACE("First ask: ", (asks.empty() ? "none" : std::to_string(asks[0].price) + "@" + std::to_string(asks[0].quantity)));
+            TRACE("First bid: ", (bids.empty() ? "none" : std::to_string(PriceLevel(bids[0]).price) + "@" + std::to_string(PriceLevel(bids[0]).quantity)));
+            TRACE("First ask: ", (asks.empty() ? "none" : std::to_string(PriceLevel(asks[0]).price) + "@" + std::to_string(PriceLevel(asks[0]).quantity)));
             orderBookManager.updateOrderBook(ExchangeId::BINANCE, pair, bids, asks);
         }
 
@@ -182,16 +193,16 @@ void ApiBinance::processOrderBookSnapshot(const json& data, TradingPair pair) {
         TRACE("Processing order book snapshot for ", tradingPairToSymbol(pair));
 
         auto& state = symbolStates[pair];
-        state.lastUpdateId = data["lastUpdateId"];
+        setLastUpdateId(pair, state, data["lastUpdateId"].get<int64_t>());
         setSymbolSnapshotState(pair, true);
         
-        std::vector<PriceLevel> bids;
-        std::vector<PriceLevel> asks;
+        std::vector<FixedLevel> bids;
+        std::vector<FixedLevel> asks;
         
         // Process bids
         for (const auto& bid : data["bids"]) {
-            double price = std::stod(bid[0].get<std::string>());
-            double quantity = std::stod(bid[1].get<std::string>());
+            FixedPoint::Ticks price = FixedPoint::parsePrice(bid[0].get_ref<const std::string&>());
+            FixedPoint::Lots quantity = FixedPoint::parseQty(bid[1].get_ref<const std::string&>());
             if (quantity > 0) {
                 bids.push_back({price, quantity});
             }
@@ -199,8 +210,8 @@ void ApiBinance::processOrderBookSnapshot(const json& data, TradingPair pair) {
         
         // Process asks
         for (const auto& ask : data["asks"]) {
-            double price = std::stod(ask[0].get<std::string>());
-            double quantity = std::stod(ask[1].get<std::string>());
+            FixedPoint::Ticks price = FixedPoint::parsePrice(ask[0].get_ref<const std::string&>());
+            FixedPoint::Lots quantity = FixedPoint::parseQty(ask[1].get_ref<const std::string&>());
             if (quantity > 0) {
                 asks.push_back({price, quantity});
             }
@@ -248,8 +259,14 @@ bool ApiBinance::placeOrder(TradingPair pair, OrderType type, double price, doub
            << "&quantity=" << std::fixed << std::setprecision(8) << quantity
            << "&price=" << std::fixed << std::setprecision(8) << price;
 
-        json response = makeHttpRequest("/order", ss.str());
-        TRACE("Order placed successfully: ", response.dump());
+        makeOrderRequestAsync("/order", ss.str(), "GET", [this](bool ok, const json& response) {
+            if (ok) {
+                TRACE("Order placed successfully: ", response.dump());
+            }
+            if (m_orderCallback) {
+                m_orderCallback(ok);
+            }
+        });
         return true;
     } catch (const std::exception& e) {
         ERROR("Error placing order: ", e.what());
@@ -265,8 +282,14 @@ bool ApiBinance::cancelOrder(const std::string& orderId) {
 
     try {
         std::string params = "orderId=" + orderId;
-        json response = makeHttpRequest("/order", params, "DELETE");
-        TRACE("Order cancelled successfully: ", response.dump());
+        makeOrderRequestAsync("/order", params, "DELETE", [this](bool ok, const json& response) {
+            if (ok) {
+                TRACE("Order cancelled successfully: ", response.dump());
+            }
+            if (m_orderCallback) {
+                m_orderCallback(ok);
+            }
+        });
         return true;
     } catch (const std::exception& e) {
         ERROR("Error cancelling order: ", e.what());
@@ -281,18 +304,26 @@ bool ApiBinance::getBalance(const std::string& asset) {
     }
 
     try {
-        json response = makeHttpRequest("/account", "");
-        
-        for (const auto& balance : response["balances"]) {
-            if (balance["asset"] == asset) {
-                TRACE("Balance for ", asset, ": Free=", balance["free"].get<std::string>(),
-                          ", Locked=", balance["locked"].get<std::string>());
-                return true;
+        makeHttpRequestAsync("/account", "", "GET", [this, asset](bool ok, const json& response) {
+            bool found = false;
+            if (ok && response.contains("balances")) {
+                for (const auto& balance : response["balances"]) {
+                    if (balance.value("asset", "") == asset) {
+                        TRACE("Balance for ", asset, ": Free=", balance.value("free", ""),
+                                  ", Locked=", balance.value("locked", ""));
+                        found = true;
+                        break;
+                    }
+                }
             }
-        }
-        
-        TRACE("No balance found for asset: ", asset);
-        return false;
+            if (ok && !found) {
+                TRACE("No balance found for asset: ", asset);
+            }
+            if (m_balanceCallback) {
+                m_balanceCallback(found);
+            }
+        });
+        return true;
     } catch (const std::exception& e) {
         ERROR("Error getting balance: ", e.what());
         return false;
@@ -318,7 +349,7 @@ bool ApiBinance::subscribeOrderBook() {
         }
 
         TRACE("Subscribing to Binance order book with message: ", message.dump());
-        doWrite(message.dump());  
+        doSubscribe("bookTicker", message.dump());
 
         // Store the subscription state
         for (const auto& pair : m_pairs) {
@@ -354,12 +385,34 @@ bool ApiBinance::getOrderBookSnapshot(TradingPair pair) {
     try {
         std::string symbol = tradingPairToSymbol(pair);
         std::string endpoint = "/depth";
-        std::string params = "symbol=" + symbol + "&limit=10";
+        std::string params = "symbol=" + symbol + "&limit=" +
+            std::to_string(Config::ORDERBOOK_DEEP_MODE ? Config::ORDERBOOK_DEEP_DEPTH : Config::ORDERBOOK_MAX_DEPTH);
+        if (Config::ORDERBOOK_DEEP_MODE) {
+            orderBookManager.enableDeepBook(ExchangeId::BINANCE, pair);
+        }
         
+        auto& state = symbolStates[pair];
+        if (state.snapshotPending) {
+            TRACE("Order book snapshot for ", symbol, " already requested");
+            return true;
+        }
+        state.snapshotPending = true;
+
         TRACE("Getting order book snapshot for ", symbol);
-        json response = makeHttpRequest(endpoint, params);
-        processOrderBookSnapshot(response, pair);
-        
+        makeHttpRequestAsync(endpoint, params, "GET", [this, pair](bool ok, const json& response) {
+            symbolStates[pair].snapshotPending = false;
+            if (!ok) {
+                ERROR("Error getting order book snapshot for ", tradingPairToSymbol(pair));
+                m_pendingUpdates.erase(pair);
+                if (m_snapshotCallback) {
+                    m_snapshotCallback(false);
+                }
+                return;
+            }
+            processOrderBookSnapshot(response, pair);
+            replayPendingUpdates(pair);
+        });
+
         return true;
     } catch (const std::exception& e) {
         ERROR("Error getting order book snapshot: ", e.what());
@@ -368,6 +421,24 @@ bool ApiBinance::getOrderBookSnapshot(TradingPair pair) {
         }
         return false;
     }
+}
+
+void ApiBinance::replayPendingUpdates(TradingPair pair) {
+    auto it = m_pendingUpdates.find(pair);
+    if (it == m_pendingUpdates.end()) {
+        return;
+    }
+    std::vector<std::string> pending = std::move(it->second);
+    m_pendingUpdates.erase(it);
+    if (!symbolStates[pair].hasSnapshot()) {
+        return;
+    }
+
+    TRACE("Replaying ", pending.size(), " buffered updates for ", tradingPairToSymbol(pair));
+    // updates older than the snapshot are skipped by their update id
+    for (const auto& update : pending) {
+        processOrderBookUpdate(JsonValue::parse(update), true);
+    }
 } 
 
 // Implement the cooldown method for Binance-specific rate limiting
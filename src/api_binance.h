@@ -22,11 +22,11 @@ public:
     bool subscribeOrderBook() override;
     bool resubscribeOrderBook(const std::vector<TradingPair>& pairs) override;
 
-    // Get current order book snapshot
+    // Request the current order book snapshot; applied on the exchange's strand when it comes in
     bool getOrderBookSnapshot(TradingPair pair) override;
 
     // Process messages for all exchanges
-    void processBookTicker(const json& data);
+    void processBookTicker(const JsonValue& data);
 
     // Order management
     bool placeOrder(TradingPair pair, OrderType type, double price, double quantity) override;
@@ -42,9 +42,20 @@ protected:
     
     // Implement pure virtual methods from base class
     void processRateLimitHeaders(const std::string& headers) override;
+    // bookTicker and depth updates carry the order book update id "u"
+    bool arbitratesFeeds() const override { return true; }
+
+    std::string getOrderPingEndpoint() const override { return "/ping"; }
 
     // Message processing methods
     void processMessage(const json& data) override;
-    void processOrderBookUpdate(const json& data);
+    bool processMarketData(const JsonValue& data) override;
+    // replay: a buffered update, arbitrated when it came in
+    void processOrderBookUpdate(const JsonValue& data, bool replay = false);
     void processOrderBookSnapshot(const json& data, TradingPair pair);
+    // Depth updates received while the snapshot was in flight, applied on top of it
+    void replayPendingUpdates(TradingPair pair);
+
+    // raw depthUpdate frames by pair, up to Config::SNAPSHOT_MAX_BUFFERED_UPDATES each
+    std::map<TradingPair, std::vector<std::string>> m_pendingUpdates;
 }; 
\ No newline at end of file
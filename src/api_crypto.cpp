@@ -1,5 +1,6 @@
 #include <iostream>
 #include <sstream>
+#include <charconv>
 #include <boost/beast/core.hpp>
 #include <boost/beast/websocket.hpp>
 #include <boost/beast/http.hpp>
@@ -38,23 +39,29 @@ bool ApiCrypto::subscribeOrderBook() {
         ERROR("Not connected to Crypto");
         return false;
     }
+    // Split pairs into batches of Config::WS_SUBSCRIBE_BATCH, a frame each
     int id = 1;
-    std::vector<std::string> symbols;
-    for (auto pair : m_pairs) {
-        symbols.push_back("ticker." + tradingPairToSymbol(pair) + "-PERP");
-        // TRACE("Subscribing to Crypto order book for ");
-        auto symbol = "ticker." + tradingPairToSymbol(pair) + "-PERP";
+    for (size_t first = 0; first < m_pairs.size(); first += Config::WS_SUBSCRIBE_BATCH) {
+        const size_t last = std::min(m_pairs.size(), first + Config::WS_SUBSCRIBE_BATCH);
         json message;
         try {
             message["id"] = id++;
             message["method"] = "subscribe";
-            message["params"] = {{"channels", symbol}};    
-            doWrite(message.dump());
+            json channels = json::array();
+            // kept per pair, a reconnect sends each of them once
+            std::vector<std::pair<std::string, std::string>> replay;
+            for (size_t i = first; i < last; i++) {
+                const std::string channel = "ticker." + tradingPairToSymbol(m_pairs[i]) + "-PERP";
+                channels.push_back(channel);
+                json single = {{"id", id - 1}, {"method", "subscribe"}, {"params", {{"channels", json::array({channel})}}}};
+                replay.emplace_back(channel, single.dump());
+            }
+            message["params"] = {{"channels", channels}};
+            doSubscribe(message.dump(), std::move(replay));
         } catch (const std::exception& e) {
             ERROR("Error subscribing to order book batch: ", e.what(), " message: ", message.dump());
             return false;
         }
-
     }
 
     for (auto pair : m_pairs) {
@@ -84,18 +91,10 @@ void ApiCrypto::processMessage(const json& data) {
         }
         if (data.contains("method")) {
             if(data["method"] == "subscribe") {
-                processLevel1(data); // updates are sent with subscribe tag
+                // ticker updates (sent with the subscribe tag) are handled by processMarketData
+                TRACE("Subscription response: ", data.dump());
             } else if(data["method"] == "error") {
                 ERROR_CNT(CountableTrace::A_REJECTED_ORDER, "Error message, code: ", data["code"], " data: ", data.dump());
-            } else if (data["method"] == "public/heartbeat") {
-                if (!data.contains("id")) {
-                    ERROR_CNT(CountableTrace::A_UNKNOWN_MESSAGE_RECEIVED, "Missing id in heartbeat message: ", data.dump());
-                    return;
-                }
-                json message;
-                message["id"] = data["id"];
-                message["method"] = "public/respond-heartbeat";
-                doWrite(message.dump());
             } else {
                 ERROR_CNT(CountableTrace::A_UNKNOWN_MESSAGE_RECEIVED, "Unhandled message type: ", data["event"], " data: ", data.dump());
             }
@@ -111,76 +110,108 @@ void ApiCrypto::processOrderBookUpdate(const json& data) {
     ERROR("Not implemented: processOrderBookUpdate");
 }
 
-void ApiCrypto::processLevel1(const json& data) {
+bool ApiCrypto::processMarketData(const JsonValue& data) {
+    if (data["method"].equals("subscribe") && data.find("result/data").isArray()) {
+        processLevel1(data); // updates are sent with subscribe tag
+        return true;
+    }
+    if (data["method"].equals("public/heartbeat")) {
+        // answered from the frame: no DOM and no allocation
+        int64_t id;
+        if (!data["id"].getInt(id)) {
+            ERROR_CNT(CountableTrace::A_UNKNOWN_MESSAGE_RECEIVED, "Missing id in heartbeat message: ", data.raw());
+            return true;
+        }
+        respondHeartbeat(id);
+        return true;
+    }
+    return false;
+}
+
+void ApiCrypto::respondHeartbeat(int64_t id) {
+    constexpr std::string_view REPLY_HEAD = "{\"id\":";
+    constexpr std::string_view REPLY_TAIL = ",\"method\":\"public/respond-heartbeat\"}";
+    char message[96];
+    char* end = std::copy(REPLY_HEAD.begin(), REPLY_HEAD.end(), message);
+    end = std::to_chars(end, message + sizeof(message) - REPLY_TAIL.size(), id).ptr;
+    end = std::copy(REPLY_TAIL.begin(), REPLY_TAIL.end(), end);
+    doWrite(std::string_view(message, end - message));
+}
+
+void ApiCrypto::processLevel1(const JsonValue& data) {
     // example:
     // {"id":1,"method":"subscribe","code":0,"result":{"instrument_name":"BTCUSD-PERP","subscription":"ticker.BTCUSD-PERP","channel":"ticker","data":[{"h":"106621.9","l":"104206.1","a":"105390.6","c":"-0.0108","b":"105395.1","bs":"0.1865","k":"105395.2","ks":"0.2914","i":"BTCUSD-PERP","v":"8195.0690","vv":"864533755.30","oi":"6121.7822","t":1749053480565}]}}
 
     try {
-        if (data.contains("code") && data["code"] != 0) {
-            ERROR_CNT(CountableTrace::A_UNKNOWN_MESSAGE_RECEIVED, "Error in subscribe message: ", data.dump());
+        int64_t code;
+        if (data["code"].getInt(code) && code != 0) {
+            ERROR_CNT(CountableTrace::A_UNKNOWN_MESSAGE_RECEIVED, "Error in subscribe message: ", data.raw());
             return;
         }
 
-        if (!data.contains("result")) {
-            ERROR_CNT(CountableTrace::A_UNKNOWN_MESSAGE_RECEIVED, "Missing result in ticker message: ", data.dump());
+        JsonValue result = data["result"];
+        if (!result.valid()) {
+            ERROR_CNT(CountableTrace::A_UNKNOWN_MESSAGE_RECEIVED, "Missing result in ticker message: ", data.raw());
             return;
         }
 
-        if (!data["result"].contains("data") || !data["result"]["data"].is_array() || data["result"]["data"].empty()) {
-            ERROR_CNT(CountableTrace::A_UNKNOWN_MESSAGE_RECEIVED, "Invalid ticker message format: ", data.dump());
+        JsonValue tickerData = result["data"].at(0);
+        if (!tickerData.isObject()) {
+            ERROR_CNT(CountableTrace::A_UNKNOWN_MESSAGE_RECEIVED, "Invalid ticker message format: ", data.raw());
             return;
         }
-        if(!data["result"]["data"][0].contains("i") || !data["result"]["data"][0]["i"].is_string() || data["result"]["data"][0]["i"].empty()) {
-            ERROR_CNT(CountableTrace::A_UNKNOWN_MESSAGE_RECEIVED, "Missing instrument name in ticker message: ", data.dump());
+        if(!tickerData["i"].isString() || tickerData["i"].str().empty()) {
+            ERROR_CNT(CountableTrace::A_UNKNOWN_MESSAGE_RECEIVED, "Missing instrument name in ticker message: ", data.raw());
             return;
         }
 
-        const auto& tickerData = data["result"]["data"][0];
-        const auto& instrumentName = tickerData["i"].get<std::string>();
+        std::string_view instrumentName = tickerData["i"].str();
         
         // Extract symbol from the data
-        int len = instrumentName.length();
-        if (instrumentName.substr(len-5) != "-PERP") {
-            ERROR_CNT(CountableTrace::A_UNKNOWN_MESSAGE_RECEIVED, "Invalid instrument name in ticker message: ", data.dump());
+        constexpr std::string_view PERP_SUFFIX = "-PERP";
+        if (instrumentName.size() <= PERP_SUFFIX.size() || instrumentName.substr(instrumentName.size() - PERP_SUFFIX.size()) != PERP_SUFFIX) {
+            ERROR_CNT(CountableTrace::A_UNKNOWN_MESSAGE_RECEIVED, "Invalid instrument name in ticker message: ", data.raw());
             return;
         }
         // skip last 5 symbols (-PERP)
-        std::string symbol = instrumentName.substr(0, len - 5);
+        std::string_view symbol = instrumentName.substr(0, instrumentName.size() - PERP_SUFFIX.size());
         TradingPair pair = symbolToTradingPair(symbol);
         if (pair == TradingPair::UNKNOWN) {
-            ERROR_CNT(CountableTrace::A_UNKNOWN_TRADING_PAIR, "Unknown trading pair: ", symbol, " data: ", data.dump());
+            ERROR_CNT(CountableTrace::A_UNKNOWN_TRADING_PAIR, "Unknown trading pair: ", symbol, " data: ", data.raw());
             return;
         }
 
         // Extract best bid/ask prices and quantities
-        if (!tickerData.contains("b") || !tickerData.contains("bs") || !tickerData.contains("k") || !tickerData.contains("ks")) {
-            ERROR_CNT(CountableTrace::A_UNKNOWN_MESSAGE_RECEIVED, "Missing price or quantity in ticker message: ", data.dump());
+        JsonValue b = tickerData["b"], bs = tickerData["bs"], k = tickerData["k"], ks = tickerData["ks"];
+        if (!b.valid() || !bs.valid() || !k.valid() || !ks.valid()) {
+            ERROR_CNT(CountableTrace::A_UNKNOWN_MESSAGE_RECEIVED, "Missing price or quantity in ticker message: ", data.raw());
             return;
         }
 
         // Handle null values for prices and quantities
-        double bidPrice = tickerData["b"].is_null() ? 0 : std::stod(tickerData["b"].get<std::string>());
-        double bidQuantity = tickerData["bs"].is_null() ? 0 : std::stod(tickerData["bs"].get<std::string>());
-        double askPrice = tickerData["k"].is_null() ? 0 : std::stod(tickerData["k"].get<std::string>());
-        double askQuantity = tickerData["ks"].is_null() ? 0 : std::stod(tickerData["ks"].get<std::string>());
+        FixedLevel bid(b.isNull() ? 0 : FixedPoint::parsePrice(b.str()),
+                       bs.isNull() ? 0 : FixedPoint::parseQty(bs.str()));
+        FixedLevel ask(k.isNull() ? 0 : FixedPoint::parsePrice(k.str()),
+                       ks.isNull() ? 0 : FixedPoint::parseQty(ks.str()));
 
         // Update order book with best prices
         try {
-            orderBookManager.updateOrderBookBestBidAsk(ExchangeId::CRYPTO, pair, bidPrice, bidQuantity, askPrice, askQuantity);
+            orderBookManager.updateOrderBookBestBidAsk(ExchangeId::CRYPTO, pair, bid, ask);
             TRACE("Updated best prices for ", symbol, 
-                  " bid=", bidPrice, "(", bidQuantity, ")", 
-                  " ask=", askPrice, "(", askQuantity, ")");
+                  " bid=", PriceLevel(bid).price, "(", PriceLevel(bid).quantity, ")", 
+                  " ask=", PriceLevel(ask).price, "(", PriceLevel(ask).quantity, ")");
         } catch (const std::exception& e) {
-            ERROR("Error updating order book: ", e.what(), " data: ", data.dump());
+            ERROR("Error updating order book: ", e.what(), " data: ", data.raw());
         }
 
         // Update symbol state with timestamp if available
         auto& state = symbolStates[pair];
-        if (tickerData.contains("t")) {
-            state.lastUpdateId = tickerData["t"].get<int64_t>();
+        int64_t timestamp;
+        if (tickerData["t"].getInt(timestamp)) {
+            setLastUpdateId(pair, state, timestamp);
         }
     } catch (const std::exception& e) {
-        ERROR("Error processing level1 message: ", e.what(), " data: ", data.dump());
+        ERROR("Error processing level1 message: ", e.what(), " data: ", data.raw());
     }
 }
 
@@ -206,8 +237,14 @@ bool ApiCrypto::placeOrder(TradingPair pair, OrderType type, double price, doubl
            << "&quantity=" << std::fixed << std::setprecision(8) << quantity
            << "&price=" << std::fixed << std::setprecision(8) << price;
 
-        json response = makeHttpRequest("/order", ss.str());
-        TRACE("Order placed successfully: ", response.dump());
+        makeHttpRequestAsync("/order", ss.str(), "GET", [this](bool ok, const json& response) {
+            if (ok) {
+                TRACE("Order placed successfully: ", response.dump());
+            }
+            if (m_orderCallback) {
+                m_orderCallback(ok);
+            }
+        });
         return true;
     } catch (const std::exception& e) {
         ERROR("Error placing order: ", e.what());
@@ -223,8 +260,14 @@ bool ApiCrypto::cancelOrder(const std::string& orderId) {
 
     try {
         std::string params = "orderId=" + orderId;
-        json response = makeHttpRequest("/order", params, "DELETE");
-        TRACE("Order cancelled successfully: ", response.dump());
+        makeHttpRequestAsync("/order", params, "DELETE", [this](bool ok, const json& response) {
+            if (ok) {
+                TRACE("Order cancelled successfully: ", response.dump());
+            }
+            if (m_orderCallback) {
+                m_orderCallback(ok);
+            }
+        });
         return true;
     } catch (const std::exception& e) {
         ERROR("Error cancelling order: ", e.what());
@@ -239,18 +282,26 @@ bool ApiCrypto::getBalance(const std::string& asset) {
     }
 
     try {
-        json response = makeHttpRequest("/account", "");
-        
-        for (const auto& balance : response["balances"]) {
-            if (balance["asset"] == asset) {
-                TRACE("Balance for ", asset, ": Free=", balance["free"].get<std::string>(),
-                          ", Locked=", balance["locked"].get<std::string>());
-                return true;
+        makeHttpRequestAsync("/account", "", "GET", [this, asset](bool ok, const json& response) {
+            bool found = false;
+            if (ok && response.contains("balances")) {
+                for (const auto& balance : response["balances"]) {
+                    if (balance.value("asset", "") == asset) {
+                        TRACE("Balance for ", asset, ": Free=", balance.value("free", ""),
+                                  ", Locked=", balance.value("locked", ""));
+                        found = true;
+                        break;
+                    }
+                }
             }
-        }
-        
-        TRACE("No balance found for asset: ", asset);
-        return false;
+            if (ok && !found) {
+                TRACE("No balance found for asset: ", asset);
+            }
+            if (m_balanceCallback) {
+                m_balanceCallback(found);
+            }
+        });
+        return true;
     } catch (const std::exception& e) {
         ERROR("Error getting balance: ", e.what());
         return false;
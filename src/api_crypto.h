@@ -49,5 +49,7 @@ protected:
     void processMessage(const json& data) override;
     void processOrderBookUpdate(const json& data);
     void processOrderBookSnapshot(const json& data, TradingPair pair);
-    void processLevel1(const json& data);
+    bool processMarketData(const JsonValue& data) override;
+    void processLevel1(const JsonValue& data);
+    void respondHeartbeat(int64_t id);
 }; 
\ No newline at end of file
@@ -1,5 +1,7 @@
 #include <stdexcept>
 #include <algorithm>
+#include <future>
+#include <random>
 
 #include "api_exchange.h"
 #include "api_binance.h"
@@ -42,14 +44,13 @@ ApiExchange::ApiExchange(const std::string& restEndpoint,
     for (const auto& pair : pairs) {
         symbolStates[pair] = SymbolState{};
     }
-
-    // Initialize CURL
-    initCurl();
 }
 
 ApiExchange::~ApiExchange() {
-    disconnect();
+    // no completions from the HTTP threads past this point
+    stopOrderSession();
     cleanupCurl();
+    disconnect();
     timersManager.stopTimer(m_snapshotValidityTimerId);
 }
 
@@ -71,53 +72,32 @@ std::unique_ptr<ApiExchange> createApiExchange(ExchangeId exchangeId, const std:
     return nullptr;
 } 
 
-// CURL callback functions
-size_t ApiExchange::WriteCallback(void* contents, size_t size, size_t nmemb, void* userp) {
-    ((std::string*)userp)->append((char*)contents, size * nmemb);
-    return size * nmemb;
-}
-
-size_t ApiExchange::WriteHeaderCallback(char* buffer, size_t size, size_t nitems, void* userdata) {
-    size_t totalSize = size * nitems;
-    std::string* headers = static_cast<std::string*>(userdata);
-    headers->append(buffer, totalSize);
-    return totalSize;
-}
-
-std::string ApiExchange::formatCurlHeaders(struct curl_slist* headers) {
-    std::string result;
-    for (struct curl_slist* temp = headers; temp != nullptr; temp = temp->next) {
-        result += temp->data;
-        result += "; ";
-    }
-    if (!result.empty()) {
-        result.pop_back(); // remove last space
-        result.pop_back(); // remove last semicolon
-    }
-    return result;
-}
-
-// Initialize CURL
+// Initialize the HTTP client
 bool ApiExchange::initCurl() {
-    if (m_curl) {
+    std::lock_guard<std::mutex> lock(m_httpMutex);
+    if (m_http) {
         return true; // Already initialized
     }
-    
-    m_curl = curl_easy_init();
-    if (!m_curl) {
-        TRACE("Failed to initialize CURL");
+
+    try {
+        m_http = std::make_unique<HttpClient>(getExchangeId(), Config::HTTP_MAX_CONNECTIONS);
+    } catch (const std::exception& e) {
+        TRACE("Failed to initialize the HTTP client: ", e.what());
         return false;
     }
-    
+
     return true;
 }
 
-// Clean up CURL
+// Clean up the HTTP client
 void ApiExchange::cleanupCurl() {
-    if (m_curl) {
-        curl_easy_cleanup(m_curl);
-        m_curl = nullptr;
+    std::unique_ptr<HttpClient> http;
+    {
+        std::lock_guard<std::mutex> lock(m_httpMutex);
+        http = std::move(m_http);
     }
+    // joins the HTTP thread, whose completions may need the mutex
+    http.reset();
 }
 
 
@@ -128,118 +108,277 @@ bool ApiExchange::connect() {
     }
 
     try {
-        // Reset IO context if it was stopped
-        if (m_ioc.stopped()) {
-            m_ioc.restart();
-        }
+        // The IO threads run the context while we are connected (see IoRuntime)
+        m_ioc = &ioRuntime.acquire(getExchangeId());
 
         // Set up SSL context
         m_ctx.set_verify_mode(ssl::verify_peer);
         m_ctx.set_default_verify_paths();
 
-        // Create the WebSocket stream
-        m_ws = std::make_unique<websocket::stream<beast::ssl_stream<beast::tcp_stream>>>(m_ioc, m_ctx);
-
-        // These two lines are needed for SSL
-        if (!SSL_set_tlsext_host_name(m_ws->next_layer().native_handle(), m_wsHost.c_str())) {
-            throw beast::system_error(
-                beast::error_code(static_cast<int>(::ERR_get_error()),
-                                net::error::get_ssl_category()),
-                "Failed to set SNI hostname");
+        // The feeds' handlers serialized with each other and with our HTTP completions
+        {
+            std::lock_guard<std::mutex> lock(m_wsMutex);
+            m_executor = net::make_strand(*m_ioc);
         }
 
         // Look up the domain name
-        tcp::resolver resolver(m_ioc);
+        tcp::resolver resolver(*m_ioc);
         auto const results = resolver.resolve(m_wsHost, m_wsPort);
+        std::vector<tcp::endpoint> addresses;
+        for (const auto& result : results) {
+            addresses.push_back(result.endpoint());
+        }
 
-        // Connect to the IP address we get from a lookup
-        beast::get_lowest_layer(*m_ws).connect(results);
-
-        // Perform the SSL handshake
-        m_ws->next_layer().handshake(ssl::stream_base::client);
-
-        // Perform the websocket handshake
-        std::string target = m_wsEndpoint;
-        if (target.empty() || target[0] != '/') {
-            target = "/" + target;
+        const size_t feedCount = arbitratesFeeds() ? std::max(1, Config::WS_FEEDS_PER_EXCHANGE) : 1;
+        std::vector<std::shared_ptr<Feed>> feeds;
+        for (size_t i = 0; i < feedCount; i++) {
+            auto feed = std::make_shared<Feed>();
+            feed->index = i;
+            // a different path for each feed where the host has several addresses
+            const tcp::endpoint* preferred = Config::WS_FEEDS_DISTINCT_IPS && !addresses.empty()
+                ? &addresses[i % addresses.size()] : nullptr;
+            try {
+                connectFeed(*feed, results, preferred);
+            } catch (const std::exception& e) {
+                // the first one has to make it, the redundant ones are best effort
+                if (i == 0) {
+                    throw;
+                }
+                ERROR("Feed ", i, " failed to connect: ", e.what());
+                continue;
+            }
+            feeds.push_back(std::move(feed));
         }
-        m_ws->handshake(m_wsHost, target);
 
+        m_arbiter.setFeeds(feeds.size());
+        {
+            std::lock_guard<std::mutex> lock(m_wsMutex);
+            m_feeds = std::move(feeds);
+        }
         m_connected = true;
-
-        // Start the IO context in a separate thread for reading
-        m_work = std::make_unique<net::executor_work_guard<net::io_context::executor_type>>(m_ioc.get_executor());
-        m_thread = std::thread([this]() { 
-            TRACE("Starting IO context thread");
-            m_ioc.run();
-            TRACE("IO context thread finished");
-        });
+        m_connectionState = ConnectionState::CONNECTED;
 
         // Start reading
-        doRead();
+        for (auto& feed : m_feeds) {
+            doRead(feed);
+        }
+
+        // Orders get connections of their own, opened now rather than on the first order
+        startOrderSession();
 
-        TRACE("Successfully connected to ", getExchangeName(), " WebSocket at ", m_wsHost, ":", m_wsPort);
+        TRACE("Successfully connected to ", getExchangeName(), " WebSocket at ", m_wsHost, ":", m_wsPort,
+              " with ", m_feeds.size(), " feeds");
         return true;
     } catch (const std::exception& e) {
         ERROR("Error in connect: ", e.what());
+        {
+            std::lock_guard<std::mutex> lock(m_wsMutex);
+            m_feeds.clear();
+            m_executor = net::any_io_executor();
+        }
+        if (m_ioc) {
+            ioRuntime.release(getExchangeId());
+            m_ioc = nullptr;
+        }
         return false;
     }
 }
 
+void ApiExchange::connectFeed(Feed& feed, const tcp::resolver::results_type& endpoints, const tcp::endpoint* preferred) {
+    // Room for the largest frame seen so far, so reads do not grow the buffer
+    feed.buffer.reserve(std::max<size_t>(Config::WS_READ_BUFFER_BYTES, m_maxFrameBytes.load(std::memory_order_relaxed)));
+
+    // Create the WebSocket stream
+    feed.ws = std::make_shared<Feed::Stream>(m_executor, m_ctx);
+
+    // These two lines are needed for SSL
+    if (!SSL_set_tlsext_host_name(feed.ws->next_layer().native_handle(), m_wsHost.c_str())) {
+        throw beast::system_error(
+            beast::error_code(static_cast<int>(::ERR_get_error()),
+                            net::error::get_ssl_category()),
+            "Failed to set SNI hostname");
+    }
+
+    // Connect to the preferred address, or to the first one of the lookup that answers
+    beast::error_code ec;
+    if (preferred) {
+        beast::get_lowest_layer(*feed.ws).connect(*preferred, ec);
+    }
+    if (!preferred || ec) {
+        beast::get_lowest_layer(*feed.ws).connect(endpoints);
+    }
+
+    // Perform the SSL handshake
+    feed.ws->next_layer().handshake(ssl::stream_base::client);
+
+    // Perform the websocket handshake
+    feed.ws->handshake(m_wsHost, wsTarget());
+    enableRxTimestamps(feed);
+    feed.up = true;
+
+    TRACE("Feed ", feed.index, " connected to ", beast::get_lowest_layer(*feed.ws).socket().remote_endpoint(ec));
+}
+
+void ApiExchange::enableRxTimestamps(Feed& feed) {
+    if (Config::WS_RX_TIMESTAMPS && !feed.ws->next_layer().next_layer().enableTimestamps(Config::WS_RX_HARDWARE_TIMESTAMPS)) {
+        TRACE("No kernel receive timestamps on feed ", feed.index);
+    }
+}
+
+std::string ApiExchange::wsTarget() const {
+    if (m_wsEndpoint.empty() || m_wsEndpoint[0] != '/') {
+        return "/" + m_wsEndpoint;
+    }
+    return m_wsEndpoint;
+}
+
+size_t ApiExchange::getFeedsUp() const {
+    size_t up = 0;
+    for (const auto& feed : m_feeds) {
+        up += feed->up ? 1 : 0;
+    }
+    return up;
+}
+
+bool ApiExchange::isFromLeadingFeed() const {
+    for (const auto& feed : m_feeds) {
+        if (feed->up) {
+            return feed->index == m_currentFeed;
+        }
+    }
+    return true;
+}
+
 void ApiExchange::disconnect() {
     if (!m_connected) {
         return;
     }
 
     try {
-        // First, stop the IO context to prevent new operations
-        if (m_work) {
-            m_work.reset();
-        }
-
         // update state now in case of faults below
         m_connected = false;
+        m_connectionState = ConnectionState::DISCONNECTED;
 
-        // Close the WebSocket connection first
-        if (m_ws) {
-            boost::beast::error_code ec;
-            m_ws->close(websocket::close_code::normal, ec);
-            if (ec) {
-                TRACE("Warning: Error during WebSocket close: ", ec.message());
-            }
-            m_ws.reset();
-        }
-
-        // Stop the IO context
-        m_ioc.stop();
-
-        // Wait for the IO thread to finish with a timeout
-        if (m_thread.joinable()) {
-            auto timeout = std::chrono::steady_clock::now() + std::chrono::seconds(5);
-            while (m_thread.joinable() && std::chrono::steady_clock::now() < timeout) {
-                try {
-                    m_thread.join();
-                    break;
-                } catch (const std::exception& e) {
-                    TRACE("Warning: Error joining thread: ", e.what());
-                    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        stopOrderSession();
+
+        // Stop the reconnects where their handlers run
+        net::any_io_executor executor;
+        {
+            std::lock_guard<std::mutex> lock(m_wsMutex);
+            executor = m_executor;
+            m_subscriptions.clear();
+        }
+        if (executor) {
+            auto stopped = std::make_shared<std::promise<void>>();
+            net::post(executor, [this, stopped]() {
+                for (auto& feed : m_feeds) {
+                    if (feed->retryTimer) {
+                        feed->retryTimer->cancel();
+                    }
+                    if (feed->resolver) {
+                        feed->resolver->cancel();
+                    }
+                    // a reconnect between connect and handshakes
+                    if (feed->ws && !feed->up) {
+                        beast::error_code ec;
+                        beast::get_lowest_layer(*feed->ws).socket().close(ec);
+                    }
+                }
+                stopped->set_value();
+            });
+            stopped->get_future().wait_for(std::chrono::seconds(1));
+        }
+
+        // Close the WebSocket connections first
+        for (auto& feed : m_feeds) {
+            if (feed->up.exchange(false) && feed->ws) {
+                boost::beast::error_code ec;
+                feed->ws->close(websocket::close_code::normal, ec);
+                if (ec) {
+                    TRACE("Warning: Error during WebSocket close of feed ", feed->index, ": ", ec.message());
                 }
             }
-            if (m_thread.joinable()) {
-                TRACE("Warning: Could not join thread within timeout");
-                m_thread.detach();
+        }
+        {
+            std::lock_guard<std::mutex> lock(m_wsMutex);
+            for (auto& feed : m_feeds) {
+                feed->ws.reset();
             }
+            m_executor = net::any_io_executor();
         }
 
-        // Reset the IO context for potential reconnection
-        m_ioc.restart();
+        // Let the IO threads go (stopped and joined once no exchange uses the context)
+        if (m_ioc) {
+            ioRuntime.release(getExchangeId());
+            m_ioc = nullptr;
+        }
 
-        TRACE("Disconnected from ", getExchangeName());
+        const ReadStats stats = getReadStats();
+        TRACE("Disconnected from ", getExchangeName(), ", received ", stats.frames, " frames, ", stats.bytes,
+              " bytes, largest ", stats.maxFrameBytes);
+        const FeedArbiter::Stats& arbiter = m_arbiter.getStats();
+        if (arbiter.wins.size() > 1) {
+            std::string wins;
+            for (size_t i = 0; i < arbiter.wins.size(); i++) {
+                wins += (i ? ", " : "") + std::to_string(arbiter.wins[i]);
+            }
+            TRACE("Feeds applied ", arbiter.applied, " updates, dropped ", arbiter.duplicates,
+                  " duplicates, first by feed: ", wins);
+        }
+        const OutageStats outages = getOutageStats();
+        if (outages.reconnects > 0) {
+            TRACE("Feeds reconnected ", outages.reconnects, " times, ", outages.outages, " outages dark for ",
+                  outages.totalDarkMs, " ms, longest ", outages.maxDarkMs, " ms");
+        }
     } catch (const std::exception& e) {
         TRACE("Warning: Error in disconnect: ", e.what());
     }
 }
 
+HttpRequest ApiExchange::buildHttpRequest(const std::string& endpoint, const std::string& params, const std::string& method, bool addJsonHeader) {
+    HttpRequest request;
+    request.method = method;
+    request.url = m_restEndpoint + endpoint;
+    if (!params.empty() && method == "GET") {
+        request.url += "?" + params;
+    }
+    if (method == "POST") {
+        request.body = params;
+    }
+    if (addJsonHeader) {
+        request.headers.push_back("Content-Type: application/json");
+    }
+    return request;
+}
+
+json ApiExchange::parseHttpResponse(const std::string& endpoint, HttpResponse& response) {
+    if (!response.ok()) {
+        ERROR("CURL request failed with code ", response.result, ": ", response.error);
+        throw std::runtime_error("HTTP request failed: " + response.error);
+    }
+    DEBUG_IO("HTTP response code: ", response.status);
+
+    // Process rate limit headers
+    if (!response.headers.empty()) {
+        processRateLimitHeaders(response.headers);
+    }
+
+    // Handle HTTP errors
+    if (response.status >= 400) {
+        ERROR("HTTP error ", response.status, " for endpoint ", endpoint);
+        handleHttpError(response.status, response.body, endpoint);
+    }
+
+    // Parse response as JSON
+    try {
+        DEBUG_IO("Response: ", response.body.substr(0, 500));
+        return json::parse(response.body);
+    } catch (const json::parse_error& e) {
+        ERROR("Failed to parse JSON response: ", e.what(), " for response: ", response.body);
+        throw std::runtime_error("Failed to parse JSON response");
+    }
+}
+
 // Common HTTP request handling
 json ApiExchange::makeHttpRequest(const std::string& endpoint, const std::string& params, const std::string& method, bool addJsonHeader) {
     // Check if we're in a cooldown period
@@ -249,176 +388,459 @@ json ApiExchange::makeHttpRequest(const std::string& endpoint, const std::string
         throw std::runtime_error("API in cooldown period");
     }
 
-    if (!m_curl) {
-        if (!initCurl()) {
-            throw std::runtime_error("CURL not initialized");
-        }
+    if (!initCurl()) {
+        throw std::runtime_error("HTTP client not initialized");
     }
 
-    std::string url = m_restEndpoint + endpoint;
-    if (!params.empty() && method == "GET") {
-        url += "?" + params;
+    HttpRequest request = buildHttpRequest(endpoint, params, method, addJsonHeader);
+    TRACE_IO("Making HTTP ", method, " request to: ", request.url, " with params cnt: ", params.size(), " and headers: ", request.headers.size());
+
+    HttpResponse response = m_http->perform(std::move(request));
+    return parseHttpResponse(endpoint, response);
+}
+
+void ApiExchange::makeHttpRequestAsync(const std::string& endpoint, const std::string& params, const std::string& method,
+                                       HttpDone done, bool addJsonHeader) {
+    if (isInCooldown()) {
+        int remainingSeconds = getRemainingCooldownSeconds();
+        TRACE(getExchangeName(), " API in cooldown for ", remainingSeconds, " more seconds. Skipping request to ", endpoint);
+        done(false, json());
+        return;
+    }
+
+    if (!initCurl()) {
+        done(false, json());
+        return;
     }
 
-    std::string response;
-    std::string headerData;
-    long httpCode = 0;
+    HttpRequest request = buildHttpRequest(endpoint, params, method, addJsonHeader);
+    TRACE_IO("Making async HTTP ", method, " request to: ", request.url, " with params cnt: ", params.size(), " and headers: ", request.headers.size());
 
-    // Initialize headers list
-    struct curl_slist* requestHeaders = nullptr;
-    if (addJsonHeader) {
-        requestHeaders = curl_slist_append(requestHeaders, "Content-Type: application/json");
+    m_http->request(std::move(request), completeOnStrand(endpoint, std::move(done)));
+}
+
+void ApiExchange::makeOrderRequestAsync(const std::string& endpoint, const std::string& params, const std::string& method,
+                                        HttpDone done) {
+    std::unique_lock<std::mutex> lock(m_httpMutex);
+    if (!m_orderSession) {
+        lock.unlock();
+        makeHttpRequestAsync(endpoint, params, method, std::move(done));
+        return;
+    }
 
-        if (!requestHeaders) {
-            throw std::runtime_error("Failed to create headers list");
+    if (isInCooldown()) {
+        lock.unlock();
+        TRACE(getExchangeName(), " API in cooldown for ", getRemainingCooldownSeconds(), " more seconds. Skipping order request to ", endpoint);
+        done(false, json());
+        return;
+    }
+
+    HttpRequest request = buildHttpRequest(endpoint, params, method, false);
+    TRACE_IO("Sending order ", method, " request to: ", request.url, " with params cnt: ", params.size());
+    m_orderSession->send(std::move(request), completeOnStrand(endpoint, std::move(done)));
+}
+
+HttpClient::Callback ApiExchange::completeOnStrand(const std::string& endpoint, HttpDone done) {
+    return [this, endpoint, done = std::move(done)](HttpResponse& response) {
+        // parsed on the HTTP thread, only the result goes to the strand
+        auto result = std::make_shared<json>();
+        bool ok = true;
+        try {
+            *result = parseHttpResponse(endpoint, response);
+        } catch (const std::exception&) {
+            ok = false;  // traced by parseHttpResponse
+        }
+
+        auto complete = [this, endpoint, done, ok, result]() {
+            try {
+                done(ok, *result);
+            } catch (const std::exception& e) {
+                ERROR("HTTP completion for ", endpoint, " failed: ", e.what());
+            }
+        };
+        std::lock_guard<std::mutex> lock(m_wsMutex);
+        if (!m_executor) {
+            // disconnected: nothing serializes the completion with the feeds' handlers any more
+            TRACE("Dropping HTTP completion for ", endpoint, ", not connected");
+            return;
         }
+        net::post(m_executor, std::move(complete));
+    };
+}
+
+void ApiExchange::startOrderSession() {
+    const std::string pingEndpoint = getOrderPingEndpoint();
+    if (!Config::ORDER_SESSION_ENABLED || pingEndpoint.empty()) {
+        return;
     }
 
-    TRACE_IO("Making HTTP ", method, " request to: ", url, " with params cnt: ", params.size(), " and headers: ", formatCurlHeaders(requestHeaders));
+    HttpOptions options;
+    options.maxConnections = Config::ORDER_SESSION_CONNECTIONS;
+    options.http2 = true;
+    auto session = std::make_unique<OrderSession>(getExchangeId(), m_restEndpoint + pingEndpoint, options);
+    session->start();
+    std::lock_guard<std::mutex> lock(m_httpMutex);
+    m_orderSession = std::move(session);
+}
 
-    // Reset first if needed
-    curl_easy_reset(m_curl);
-    curl_easy_setopt(m_curl, CURLOPT_HTTP_VERSION, CURL_HTTP_VERSION_1_1);
+void ApiExchange::stopOrderSession() {
+    std::unique_ptr<OrderSession> session;
+    {
+        std::lock_guard<std::mutex> lock(m_httpMutex);
+        session = std::move(m_orderSession);
+    }
+    // joins its HTTP thread, whose completions may need the mutex
+    session.reset();
+}
 
+void ApiExchange::doRead(const std::shared_ptr<Feed>& feed) {
+    std::lock_guard<std::mutex> lock(m_wsMutex);
+    if (!feed->ws) return;
+
+    feed->ws->async_read(feed->buffer,
+        [this, feed, ws = feed->ws](boost::beast::error_code ec, std::size_t bytes_transferred) {
+            const int64_t readNs = LatencyMonitor::nowNs();
+            {
+                // the feed was reconnected or closed since
+                std::lock_guard<std::mutex> lock(m_wsMutex);
+                if (ws != feed->ws) return;
+            }
+            latencyMonitor.beginFrame(getExchangeId(), ws->next_layer().next_layer().takeRxNs(), readNs);
+            onRead(feed, ec, bytes_transferred);
+            latencyMonitor.endFrame();
+        });
+}
 
-    // Now set all options
-    curl_easy_setopt(m_curl, CURLOPT_URL, url.c_str());
-    curl_easy_setopt(m_curl, CURLOPT_TIMEOUT, 10L);
-    curl_easy_setopt(m_curl, CURLOPT_CONNECTTIMEOUT, 5L);
-    curl_easy_setopt(m_curl, CURLOPT_WRITEFUNCTION, WriteCallback);
-    curl_easy_setopt(m_curl, CURLOPT_WRITEDATA, &response);
-    curl_easy_setopt(m_curl, CURLOPT_HEADERFUNCTION, WriteHeaderCallback);
-    curl_easy_setopt(m_curl, CURLOPT_HEADERDATA, &headerData);
-    curl_easy_setopt(m_curl, CURLOPT_SSL_VERIFYPEER, 1L);
-    curl_easy_setopt(m_curl, CURLOPT_SSL_VERIFYHOST, 2L);
-    curl_easy_setopt(m_curl, CURLOPT_HTTPHEADER, requestHeaders);
+void ApiExchange::onRead(const std::shared_ptr<Feed>& feed, beast::error_code ec, std::size_t bytes) {
+    if (ec) {
+        onFeedDown(feed, ec);
+        return;
+    }
 
-    if (method == "DELETE") {
-        curl_easy_setopt(m_curl, CURLOPT_CUSTOMREQUEST, "DELETE");
-    } else if (method == "POST") {
-        curl_easy_setopt(m_curl, CURLOPT_POST, 1L);
-        if (params.empty()) {
-            curl_easy_setopt(m_curl, CURLOPT_POSTFIELDS, "");
-        } else {
-            curl_easy_setopt(m_curl, CURLOPT_POSTFIELDS, params.c_str());
-        }
-        curl_easy_setopt(m_curl, CURLOPT_POSTFIELDSIZE, params.size());
-    } else {
-        curl_easy_setopt(m_curl, CURLOPT_HTTPGET, 1L);
+    // flat_buffer keeps the frame contiguous: parse it where it is
+    const auto data = feed->buffer.cdata();
+    const std::string_view message(static_cast<const char*>(data.data()), data.size());
+    m_readFrames.fetch_add(1, std::memory_order_relaxed);
+    m_readBytes.fetch_add(bytes, std::memory_order_relaxed);
+    if (message.size() > m_maxFrameBytes.load(std::memory_order_relaxed)) {
+        m_maxFrameBytes.store(message.size(), std::memory_order_relaxed);
     }
+    DEBUG_IO("Received message on feed ", feed->index, ": ", message.substr(0, 500));
 
-    curl_easy_setopt(m_curl, CURLOPT_DNS_CACHE_TIMEOUT, 60L);
-    // curl_easy_setopt(m_curl, CURLOPT_VERBOSE, 1L);
-    
-    DEBUG("Starting CURL request...");
+    m_currentFeed = feed->index;
+    processMessage(message);
+    if (m_connectionState == ConnectionState::RESUBSCRIBED) {
+        checkRecovered();
+    }
+    // keeps the capacity for the next frame
+    feed->buffer.consume(feed->buffer.size());
+    doRead(feed);
+}
+
+void ApiExchange::doWrite(std::string_view message) {
+    std::lock_guard<std::mutex> lock(m_wsMutex);
+    if (m_feeds.empty()) return;
+
+    TRACE_BASE(TraceInstance::A_IO, getExchangeId(), "Sending: ", message);
     
-    // Perform the request with error checking
-    CURLcode res = curl_easy_perform(m_curl);
+    for (auto& feed : m_feeds) {
+        if (!feed->ws || !feed->up) {
+            continue;
+        }
+        queueWrite(feed, message);
+    }
+}
 
-    if (res != CURLE_OK) {
-        ERROR("CURL request failed with code ", res, ": ", curl_easy_strerror(res));
-        
-        // Clean up headers list
-        if (requestHeaders) {
-            curl_slist_free_all(requestHeaders);
+void ApiExchange::doSubscribe(const std::string& key, std::string message) {
+    {
+        std::lock_guard<std::mutex> lock(m_wsMutex);
+        keepSubscription(key, message);
+    }
+    doWrite(message);
+}
+
+void ApiExchange::doSubscribe(std::string_view message, std::vector<std::pair<std::string, std::string>> replay) {
+    {
+        std::lock_guard<std::mutex> lock(m_wsMutex);
+        for (auto& [key, single] : replay) {
+            keepSubscription(key, std::move(single));
         }
-        
-        throw std::runtime_error(std::string("curl_easy_perform() failed: ") + curl_easy_strerror(res));
     }
-    
-    // Get response code
-    curl_easy_getinfo(m_curl, CURLINFO_RESPONSE_CODE, &httpCode);
-    DEBUG_IO("HTTP response code: ", httpCode);
-    
-    // Clean up headers list
-    if (requestHeaders) {
-        curl_slist_free_all(requestHeaders);
+    doWrite(message);
+}
+
+void ApiExchange::doUnsubscribe(std::string_view message, const std::vector<std::string>& keys) {
+    {
+        std::lock_guard<std::mutex> lock(m_wsMutex);
+        m_subscriptions.erase(std::remove_if(m_subscriptions.begin(), m_subscriptions.end(),
+            [&keys](const auto& subscription) {
+                return std::find(keys.begin(), keys.end(), subscription.first) != keys.end();
+            }), m_subscriptions.end());
     }
-    
-    // Process rate limit headers
-    if (!headerData.empty()) {
-        processRateLimitHeaders(headerData);
+    doWrite(message);
+}
+
+void ApiExchange::keepSubscription(const std::string& key, std::string message) {
+    auto it = std::find_if(m_subscriptions.begin(), m_subscriptions.end(),
+        [&key](const auto& subscription) { return subscription.first == key; });
+    if (it != m_subscriptions.end()) {
+        it->second = std::move(message);
+    } else {
+        m_subscriptions.emplace_back(key, std::move(message));
     }
-    
-    // Handle HTTP errors
-    if (httpCode >= 400) {
-        ERROR("HTTP error ", httpCode, " for endpoint ", endpoint);
-        handleHttpError(httpCode, response, endpoint);
+}
+
+void ApiExchange::queueWrite(const std::shared_ptr<Feed>& feed, std::string_view message) {
+    if (!feed->writeRing.push(message)) {
+        ERROR_CNT(CountableTrace::A_EXCHANGE_WRITE_ERROR, "Write ring of feed ", feed->index, " full, dropping: ", message);
+        return;
     }
-    
-    // Parse response as JSON
-    try {
-        DEBUG_IO("Response: ", response.substr(0, 500));
-        return json::parse(response);
-    } catch (const json::parse_error& e) {
-        ERROR("Failed to parse JSON response: ", e.what(), " for response: ", response);
-        throw std::runtime_error("Failed to parse JSON response");
+
+    // If not already writing, start the write chain
+    if (!feed->isWriting) {
+        writeNext(feed);
     }
 }
 
-void ApiExchange::doRead() {
-    std::lock_guard<std::mutex> lock(m_wsMutex);
-    if (!m_ws) return;
+void ApiExchange::writeNext(const std::shared_ptr<Feed>& feed) {
+    if (!feed->ws || !feed->up || feed->writeRing.empty()) {
+        feed->isWriting = false;
+        return;
+    }
+
+    feed->isWriting = true;
+    // stays in its slot at the front of the ring until written
+    const std::string& message = feed->writeRing.front();
 
-    m_ws->async_read(m_buffer,
-        [this](boost::beast::error_code ec, std::size_t bytes_transferred) {
+    feed->ws->async_write(net::buffer(message),
+        [this, feed, ws = feed->ws](beast::error_code ec, std::size_t bytes_transferred) {
+            std::lock_guard<std::mutex> lock(m_wsMutex);
+            if (ws != feed->ws) {
+                // written to a connection that is gone: go on with the queue on the new one
+                feed->writeRing.pop();
+                writeNext(feed);
+                return;
+            }
             if (ec) {
-                TRACE("Read error: ", ec.message());
+                ERROR_CNT(CountableTrace::A_EXCHANGE_WRITE_ERROR, ec.message(), " on feed ", feed->index,
+                          " for message: ", feed->writeRing.empty() ? std::string() : feed->writeRing.front());
+                feed->isWriting = false;
                 return;
             }
 
-            std::string message = boost::beast::buffers_to_string(m_buffer.data());
-            m_buffer.consume(m_buffer.size());
-            
-            // Truncate long messages for logging
-            std::string logMessage = message;
-            if (logMessage.length() > 500) {
-                logMessage = logMessage.substr(0, 497) + "...";
-            }
-            DEBUG("Received message: ", logMessage);
-            
-            processMessage(message);
-            doRead();
+            // Write next message if any
+            feed->writeRing.pop();
+            writeNext(feed);
         });
 }
 
-void ApiExchange::doWrite(std::string message) {
-    std::lock_guard<std::mutex> lock(m_wsMutex);
-    if (!m_ws) return;
+int ApiExchange::reconnectDelayMs(unsigned attempt) {
+    const int64_t delay = std::min<int64_t>(Config::WS_RECONNECT_MAX_MS,
+        static_cast<int64_t>(Config::WS_RECONNECT_BASE_MS) << std::min(attempt, 20u));
+    thread_local std::mt19937 rng(std::random_device{}());
+    return static_cast<int>(std::uniform_int_distribution<int64_t>(delay / 2, delay)(rng));
+}
 
-    TRACE_BASE(TraceInstance::A_IO, getExchangeId(), "Sending: ", message);
-    
-    // Add message to queue
-    m_writeQueue.push(std::move(message));
-    
-    // If not already writing, start the write chain
-    if (!m_isWriting) {
-        writeNext();
-    }
+ApiExchange::OutageStats ApiExchange::getOutageStats() const {
+    std::lock_guard<std::mutex> lock(m_outageMutex);
+    return m_outageStats;
 }
 
-void ApiExchange::writeNext() {
-    if (!m_ws || m_writeQueue.empty()) {
-        m_isWriting = false;
+void ApiExchange::onFeedDown(const std::shared_ptr<Feed>& feed, const beast::error_code& ec) {
+    if (!feed->up.exchange(false)) {
+        return;
+    }
+    const size_t up = getFeedsUp();
+    if (up > 0) {
+        ERROR("Read error on feed ", feed->index, ": ", ec.message(), ", ", up, " feeds left");
+    } else {
+        ERROR("Read error on feed ", feed->index, ": ", ec.message(), ", no feeds left");
+    }
+    if (!m_connected) {
         return;
     }
+    if (up == 0) {
+        beginOutage();
+    }
+    scheduleReconnect(feed);
+}
 
-    m_isWriting = true;
-    std::string message = std::move(m_writeQueue.front());
-    m_writeQueue.pop();
+void ApiExchange::beginOutage() {
+    // a feed that came back and went down again before any fresh data continues the outage
+    if (m_connectionState == ConnectionState::CONNECTED) {
+        m_darkSince = std::chrono::steady_clock::now();
+        std::lock_guard<std::mutex> lock(m_outageMutex);
+        m_outageStats.outages++;
+    }
+    m_connectionState = ConnectionState::RECONNECTING;
 
-    m_ws->async_write(net::buffer(message),
-        [this, message](beast::error_code ec, std::size_t bytes_transferred) {
-            if (ec) {
-                ERROR_CNT(CountableTrace::A_EXCHANGE_WRITE_ERROR, ec.message(), " for message: ", message);
-                m_isWriting = false;
+    // Nothing is known of the books until the exchange sends them again
+    for (const auto& pair : m_pairs) {
+        setSymbolSnapshotState(pair, false);
+        symbolStates[pair].hasProcessedFirstUpdate = false;
+        // its last quotes would otherwise keep winning the scans of the pair on every exchange
+        orderBookManager.markStale(getExchangeId(), pair);
+    }
+    m_arbiter.reset();
+    ERROR("All feeds of ", getExchangeName(), " down, ", m_pairs.size(), " books stale until they are back");
+}
+
+void ApiExchange::scheduleReconnect(const std::shared_ptr<Feed>& feed) {
+    {
+        std::lock_guard<std::mutex> lock(m_wsMutex);
+        if (!m_connected || !m_executor) {
+            return;
+        }
+        if (!feed->retryTimer) {
+            feed->retryTimer = std::make_unique<net::steady_timer>(m_executor);
+        }
+    }
+
+    const int delayMs = reconnectDelayMs(feed->attempts++);
+    TRACE("Reconnecting feed ", feed->index, " in ", delayMs, " ms, attempt ", feed->attempts);
+    feed->retryTimer->expires_after(std::chrono::milliseconds(delayMs));
+    feed->retryTimer->async_wait([this, feed](beast::error_code ec) {
+        if (ec || !m_connected) {
+            return;
+        }
+        reconnectFeed(feed);
+    });
+}
+
+void ApiExchange::feedReconnectFailed(const std::shared_ptr<Feed>& feed, const char* step, const beast::error_code& ec) {
+    ERROR("Feed ", feed->index, " failed to reconnect at ", step, ": ", ec.message());
+    scheduleReconnect(feed);
+}
+
+void ApiExchange::reconnectFeed(const std::shared_ptr<Feed>& feed) {
+    refreshWsEndpoint([this, feed](bool ok) {
+        if (!m_connected) {
+            return;
+        }
+        if (!ok) {
+            feedReconnectFailed(feed, "endpoint", net::error::not_found);
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_wsMutex);
+            if (!m_executor) {
                 return;
             }
+            if (!feed->resolver) {
+                feed->resolver = std::make_unique<tcp::resolver>(m_executor);
+            }
+        }
+        feed->resolver->async_resolve(m_wsHost, m_wsPort,
+            [this, feed](beast::error_code ec, tcp::resolver::results_type results) {
+                if (!m_connected) {
+                    return;
+                }
+                if (ec) {
+                    feedReconnectFailed(feed, "resolve", ec);
+                    return;
+                }
 
-            // Write next message if any
-            std::lock_guard<std::mutex> lock(m_wsMutex);
-            writeNext();
-        });
+                std::shared_ptr<Feed::Stream> ws;
+                {
+                    std::lock_guard<std::mutex> lock(m_wsMutex);
+                    if (!m_executor) {
+                        return;
+                    }
+                    ws = std::make_shared<Feed::Stream>(m_executor, m_ctx);
+                    // what the old connection left unsent is dropped, but not a write still in flight on it
+                    feed->writeRing.truncate(feed->isWriting ? 1 : 0);
+                    feed->ws = ws;
+                }
+                feed->buffer.consume(feed->buffer.size());
+
+                if (!SSL_set_tlsext_host_name(ws->next_layer().native_handle(), m_wsHost.c_str())) {
+                    feedReconnectFailed(feed, "SNI",
+                        beast::error_code(static_cast<int>(::ERR_get_error()), net::error::get_ssl_category()));
+                    return;
+                }
+
+                beast::get_lowest_layer(*ws).expires_after(std::chrono::milliseconds(Config::WS_CONNECT_TIMEOUT_MS));
+                beast::get_lowest_layer(*ws).async_connect(results,
+                    [this, feed, ws](beast::error_code ec, const tcp::endpoint&) {
+                        if (!m_connected || ws != feed->ws) {
+                            return;
+                        }
+                        if (ec) {
+                            feedReconnectFailed(feed, "connect", ec);
+                            return;
+                        }
+                        ws->next_layer().async_handshake(ssl::stream_base::client, [this, feed, ws](beast::error_code ec) {
+                            if (!m_connected || ws != feed->ws) {
+                                return;
+                            }
+                            if (ec) {
+                                feedReconnectFailed(feed, "SSL handshake", ec);
+                                return;
+                            }
+                            ws->async_handshake(m_wsHost, wsTarget(), [this, feed, ws](beast::error_code ec) {
+                                if (!m_connected || ws != feed->ws) {
+                                    return;
+                                }
+                                if (ec) {
+                                    feedReconnectFailed(feed, "websocket handshake", ec);
+                                    return;
+                                }
+                                // the websocket keeps its own timeouts from here
+                                beast::get_lowest_layer(*ws).expires_never();
+                                enableRxTimestamps(*feed);
+                                onFeedReconnected(feed);
+                            });
+                        });
+                    });
+            });
+    });
+}
+
+void ApiExchange::onFeedReconnected(const std::shared_ptr<Feed>& feed) {
+    feed->attempts = 0;
+    size_t replayed = 0;
+    {
+        std::lock_guard<std::mutex> lock(m_wsMutex);
+        feed->up = true;
+        for (const auto& subscription : m_subscriptions) {
+            queueWrite(feed, subscription.second);
+        }
+        replayed = m_subscriptions.size();
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_outageMutex);
+        m_outageStats.reconnects++;
+    }
+
+    if (m_connectionState == ConnectionState::RECONNECTING) {
+        m_connectionState = ConnectionState::RESUBSCRIBED;
+        m_darkVersions.clear();
+        for (const auto& pair : m_pairs) {
+            m_darkVersions.push_back(orderBookManager.getVersion(getExchangeId(), pair));
+        }
+    }
+    TRACE("Feed ", feed->index, " reconnected, ", replayed, " subscriptions replayed, ", getFeedsUp(), " feeds up");
+    doRead(feed);
+}
+
+void ApiExchange::checkRecovered() {
+    for (size_t i = 0; i < m_pairs.size() && i < m_darkVersions.size(); i++) {
+        if (orderBookManager.getVersion(getExchangeId(), m_pairs[i]) == m_darkVersions[i]) {
+            continue;
+        }
+        const uint64_t darkMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - m_darkSince).count();
+        {
+            std::lock_guard<std::mutex> lock(m_outageMutex);
+            m_outageStats.lastDarkMs = darkMs;
+            m_outageStats.maxDarkMs = std::max(m_outageStats.maxDarkMs, darkMs);
+            m_outageStats.totalDarkMs += darkMs;
+        }
+        m_connectionState = ConnectionState::CONNECTED;
+        TRACE(getExchangeName(), " is back with fresh data on ", m_pairs[i], " after ", darkMs, " ms dark");
+        return;
+    }
 }
 
 void ApiExchange::startCooldown(int minutes) {
@@ -449,10 +871,13 @@ bool ApiExchange::checkCooldownExpired() {
 }
 
 void ApiExchange::updateRateLimit(const std::string& endpoint, int limit, int remaining, int reset) {
-    // Store rate limit info for this endpoint
-    m_rateLimits[endpoint + "_limit"] = limit;
-    m_rateLimits[endpoint + "_remaining"] = remaining;
-    m_rateLimits[endpoint + "_reset"] = reset;
+    // Store rate limit info for this endpoint; responses are parsed on the HTTP thread as well
+    {
+        std::lock_guard<std::mutex> lock(m_cooldownMutex);
+        m_rateLimits[endpoint + "_limit"] = limit;
+        m_rateLimits[endpoint + "_remaining"] = remaining;
+        m_rateLimits[endpoint + "_reset"] = reset;
+    }
     
     TRACE(getExchangeName(), " rate limit for ", endpoint, ": ", remaining, "/", limit, " (reset in ", reset, "s)");
     
@@ -553,6 +978,11 @@ ApiExchange::SnapshotRestoring ApiExchange::checkSnapshotValidity() {
             getExchangeName(), ": Not connected to ", getExchangeName(), ". Skipping snapshot validity check");
         return ApiExchange::SnapshotRestoring::NONE;
     }
+    if (m_connectionState != ConnectionState::CONNECTED) {
+        // the books come back with the feeds, resubscribing would only add to the replay
+        TRACE(getExchangeName(), ": Feeds reconnecting. Skipping snapshot validity check");
+        return ApiExchange::SnapshotRestoring::IN_PROGRESS;
+    }
 
     auto now = std::chrono::system_clock::now();
     std::vector<TradingPair> needResubscribe;
@@ -589,9 +1019,13 @@ ApiExchange::SnapshotRestoring ApiExchange::checkSnapshotValidity() {
     return ApiExchange::SnapshotRestoring::NONE;
 }
 
-void ApiExchange::processMessage(std::string message) {
+void ApiExchange::processMessage(std::string_view message) {
     TRACE("Processing message: ", message.substr(0, 500));
     try {
+        JsonValue frame = JsonValue::parse(message);
+        if (frame.isObject() && processMarketData(frame)) {
+            return;
+        }
         json parsedMessage = json::parse(message);
         processMessage(parsedMessage);
     } catch (const json::parse_error& e) {
@@ -6,6 +6,9 @@
 #include <memory>
 #include <chrono>
 #include <mutex>
+#include <array>
+#include <atomic>
+#include <string_view>
 #include <thread>
 #include <map>
 #include <nlohmann/json.hpp>
@@ -15,13 +18,20 @@
 #include <boost/beast/ssl.hpp>
 #include <boost/beast/websocket.hpp>
 #include <boost/beast/websocket/ssl.hpp>
-#include <boost/asio/strand.hpp>
+#include <boost/asio/steady_timer.hpp>
 #include <nlohmann/json.hpp>
-#include <queue>
 
 #include "tracer.h"
 #include "types.h"
 #include "timers.h"
+#include "json_scanner.h"
+#include "io_runtime.h"
+#include "http_client.h"
+#include "order_session.h"
+#include "feed_arbiter.h"
+#include "write_ring.h"
+#include "rx_timestamp_stream.h"
+#include "latency.h"
 
 namespace beast = boost::beast;
 namespace websocket = beast::websocket;
@@ -50,7 +60,7 @@ public:
     // Get order book snapshot for a trading pair
     virtual bool getOrderBookSnapshot(TradingPair pair) = 0;
 
-    // Order management
+    // Order management; true once the request is sent, the outcome goes to the order/balance callback
     virtual bool placeOrder(TradingPair pair, OrderType type, double price, double quantity) = 0;
     virtual bool cancelOrder(const std::string& orderId) = 0;
     virtual bool getBalance(const std::string& asset) = 0;
@@ -61,9 +71,53 @@ public:
     // Get exchange ID
     virtual ExchangeId getExchangeId() const = 0;
 
-    // Check if connected to the exchange
+    // Check if connected to the exchange; stays true while lost feeds reconnect, see getConnectionState()
     bool isConnected() const { return m_connected; }
 
+    // Connection lifecycle between connect() and disconnect()
+    enum class ConnectionState {
+        DISCONNECTED,
+        CONNECTED,     // a feed is up and the books are live
+        RECONNECTING,  // all feeds down: the books are stale, the feeds reconnect with backoff
+        RESUBSCRIBED,  // a feed is back with its subscriptions replayed, waiting for the first fresh update
+    };
+    ConnectionState getConnectionState() const { return m_connectionState.load(std::memory_order_relaxed); }
+
+    // An outage lasts from the last feed going down to the first book update after a feed is back;
+    // that is the time the exchange is dark
+    struct OutageStats {
+        uint64_t outages = 0;
+        uint64_t reconnects = 0;  // feeds reconnected, also the redundant ones that dropped alone
+        uint64_t lastDarkMs = 0;
+        uint64_t maxDarkMs = 0;
+        uint64_t totalDarkMs = 0;
+    };
+    OutageStats getOutageStats() const;
+
+    // Delay before reconnect attempt n (from 0): exponential from Config::WS_RECONNECT_BASE_MS up to
+    // Config::WS_RECONNECT_MAX_MS, randomly in its upper half so the feeds do not retry in step
+    static int reconnectDelayMs(unsigned attempt);
+
+    // Websocket feeds connected and reading
+    size_t getFeedsUp() const;
+    FeedArbiter::Stats getArbiterStats() const { return m_arbiter.getStats(); }
+
+    // Websocket frames received since construction
+    struct ReadStats {
+        uint64_t frames = 0;
+        uint64_t bytes = 0;
+        uint64_t maxFrameBytes = 0;
+    };
+    ReadStats getReadStats() const {
+        return {m_readFrames.load(std::memory_order_relaxed), m_readBytes.load(std::memory_order_relaxed),
+                m_maxFrameBytes.load(std::memory_order_relaxed)};
+    }
+
+    // Sequence id of the last applied order book update for a pair (0 if none); any thread
+    int64_t getLastUpdateId(TradingPair pair) const {
+        return m_lastUpdateIds.at(static_cast<size_t>(pair)).load(std::memory_order_relaxed);
+    }
+
     // Check if in test mode
     virtual bool isTestMode() const { return m_testMode; }
 
@@ -93,13 +147,22 @@ public:
         return str;
     }
 
-    // Common HTTP request handling
+    // Common HTTP request handling; blocks the caller, keep it off the IO threads
     json makeHttpRequest(const std::string& endpoint, const std::string& params = "", const std::string& method = "GET", bool addJsonHeader = false);
-    
-    // Initialize CURL
+
+    // Completion of makeHttpRequestAsync: ok is false on transport, HTTP or parse errors (already traced)
+    using HttpDone = std::function<void(bool ok, const json& response)>;
+    // Returns at once; done runs on the exchange's strand, and not at all if the exchange disconnects first
+    void makeHttpRequestAsync(const std::string& endpoint, const std::string& params, const std::string& method,
+                              HttpDone done, bool addJsonHeader = false);
+    // Same for order entry: on the warm order session while connected, on the shared client otherwise
+    void makeOrderRequestAsync(const std::string& endpoint, const std::string& params, const std::string& method,
+                               HttpDone done);
+
+    // Initialize the HTTP client, created on first use
     virtual bool initCurl();
     
-    // Clean up CURL
+    // Clean up the HTTP client, dropping requests in flight
     virtual void cleanupCurl();
 
     // Cooldown and rate limiting
@@ -129,6 +192,7 @@ protected:
         bool subscribed{false};
         int64_t lastUpdateId{0};
         bool hasProcessedFirstUpdate{false};  // Track if we've processed the first update after snapshot
+        bool snapshotPending{false};  // REST snapshot requested and not yet in
     private:
         bool m_hasSnapshot{false};
     public:
@@ -136,9 +200,76 @@ protected:
         void setHasSnapshot(bool value) { m_hasSnapshot = value; }
     };
 
-    void doRead();
-    void doWrite(std::string message);
-    void writeNext();
+    // One websocket connection. Exchanges that arbitrate run Config::WS_FEEDS_PER_EXCHANGE of them with the
+    // same subscriptions; the first copy of each update is applied (see FeedArbiter).
+    struct Feed {
+        using Stream = websocket::stream<beast::ssl_stream<RxTimestampStream>>;
+        size_t index = 0;
+        // replaced on a reconnect; the handlers keep the stream they were started on
+        std::shared_ptr<Stream> ws;
+        beast::flat_buffer buffer;  // reserved on connect, frames are parsed in place and consumed after
+        WriteRing writeRing{Config::WS_WRITE_RING_SLOTS, Config::WS_WRITE_SLOT_BYTES};  // the front one is being written
+        bool isWriting{false};
+        std::atomic<bool> up{false};
+        // reconnects, on the strand
+        unsigned attempts{0};
+        std::unique_ptr<net::steady_timer> retryTimer;
+        std::unique_ptr<tcp::resolver> resolver;
+    };
+
+    // Connects and handshakes the feed, to the given endpoint or else to the first that answers
+    void connectFeed(Feed& feed, const tcp::resolver::results_type& endpoints, const tcp::endpoint* preferred);
+    // Kernel receive timestamps on the feed's socket (Config::WS_RX_TIMESTAMPS), for the latency stages
+    void enableRxTimestamps(Feed& feed);
+    // The handlers hold on to the feed, it may be dropped while they are pending
+    void doRead(const std::shared_ptr<Feed>& feed);
+    // Handles the frame in the feed's buffer in place and reads the next one
+    void onRead(const std::shared_ptr<Feed>& feed, beast::error_code ec, std::size_t bytes);
+    // Sends to every feed that is up
+    void doWrite(std::string_view message);
+    // Sends a subscription to every feed and keeps it under key, so feeds that reconnect send it again;
+    // a later subscription with the same key replaces it
+    void doSubscribe(const std::string& key, std::string message);
+    // A frame covering several subscriptions: sends message and keeps each of replay in its place, one per
+    // key, so that unsubscribing one key leaves the others and a reconnect sends each of them once
+    void doSubscribe(std::string_view message, std::vector<std::pair<std::string, std::string>> replay);
+    // Sends message and forgets the subscriptions under keys
+    void doUnsubscribe(std::string_view message, const std::vector<std::string>& keys);
+    // With m_wsMutex held
+    void keepSubscription(const std::string& key, std::string message);
+    void queueWrite(const std::shared_ptr<Feed>& feed, std::string_view message);
+    void writeNext(const std::shared_ptr<Feed>& feed);
+
+    // Reconnect state machine, on the strand. A feed that fails is reconnected with backoff; when it was
+    // the last one up, the books are marked stale and the outage is timed until fresh data is in.
+    void onFeedDown(const std::shared_ptr<Feed>& feed, const beast::error_code& ec);
+    virtual void scheduleReconnect(const std::shared_ptr<Feed>& feed);
+    // Opens a new websocket for the feed without blocking the strand
+    virtual void reconnectFeed(const std::shared_ptr<Feed>& feed);
+    // The feed is up again: replays the subscriptions and starts reading
+    void onFeedReconnected(const std::shared_ptr<Feed>& feed);
+    // For exchanges whose websocket endpoint is only good for one session; done(false) retries later
+    virtual void refreshWsEndpoint(std::function<void(bool ok)> done) { done(true); }
+    void feedReconnectFailed(const std::shared_ptr<Feed>& feed, const char* step, const beast::error_code& ec);
+    void beginOutage();
+    // Ends the outage once a book got an update since the resubscribe
+    void checkRecovered();
+    std::string wsTarget() const;
+
+    // Exchanges whose updates carry a sequence the arbiter can go by run redundant feeds
+    virtual bool arbitratesFeeds() const { return false; }
+    // True for the first copy of an update among the feeds, false for the duplicates to drop
+    bool isFirstArrival(TradingPair pair, FeedArbiter::Stream stream, uint64_t seq, uint64_t tag = 0) {
+        return m_arbiter.firstArrival(pair, stream, seq, tag, m_currentFeed);
+    }
+    // For messages without a sequence: true on the first feed that is up, which the others stand by for
+    bool isFromLeadingFeed() const;
+
+    // Keep the pair's sequence id in its state and for getLastUpdateId() on other threads
+    void setLastUpdateId(TradingPair pair, SymbolState& state, int64_t updateId) {
+        state.lastUpdateId = updateId;
+        m_lastUpdateIds[static_cast<size_t>(pair)].store(updateId, std::memory_order_relaxed);
+    }
 
     // Helper method to set snapshot state and manage timer
     void setSymbolSnapshotState(TradingPair pair, bool hasSnapshot) {
@@ -150,7 +281,8 @@ protected:
         }
     }
 
-    bool m_connected{false};
+    std::atomic<bool> m_connected{false};
+    std::atomic<ConnectionState> m_connectionState{ConnectionState::DISCONNECTED};
     bool m_subscribed{false};
     bool m_testMode;
     bool m_inCooldown;
@@ -159,27 +291,34 @@ protected:
     std::map<std::string, int> m_rateLimits;
     uint64_t m_snapshotValidityTimerId;  // Timer ID for snapshot validity check
     
-    TradingPair symbolToTradingPair(const std::string& symbol) const {
-        try {
-            return TradingPairData::fromSymbol(getExchangeId(), symbol);
-        } catch (const std::exception& e) {
-            throw std::runtime_error("Error converting symbol (" + symbol + ") to trading pair: " + std::string(e.what()));
-        }
+    // TradingPair::UNKNOWN for symbols this exchange does not list
+    TradingPair symbolToTradingPair(std::string_view symbol) const {
+        return TradingPairData::fromSymbol(getExchangeId(), symbol);
     }
 
     std::string tradingPairToSymbol(TradingPair pair) const {
         return TradingPairData::getSymbol(getExchangeId(), pair);
     }
 
-    // CURL callback functions
-    static size_t WriteCallback(void* contents, size_t size, size_t nmemb, void* userp);
-    static size_t WriteHeaderCallback(char* buffer, size_t size, size_t nitems, void* userdata);
-    std::string formatCurlHeaders(struct curl_slist* headers);
+    // HTTP helpers shared by the blocking and the async request
+    HttpRequest buildHttpRequest(const std::string& endpoint, const std::string& params, const std::string& method, bool addJsonHeader);
+    // Throws on transport, HTTP and parse errors
+    json parseHttpResponse(const std::string& endpoint, HttpResponse& response);
+    // Parses the response and runs done with the result on the strand
+    HttpClient::Callback completeOnStrand(const std::string& endpoint, HttpDone done);
+
+    // Public endpoint the order session pings to keep its connections warm; empty for no order session
+    virtual std::string getOrderPingEndpoint() const { return ""; }
+    void startOrderSession();
+    void stopOrderSession();
     // Helper methods for derived classes
     virtual void processRateLimitHeaders(const std::string& headers) = 0;
 
-    void processMessage(std::string message);
+    void processMessage(std::string_view message);
     virtual void processMessage(const json& data) = 0;
+    // Market data read straight from the frame, without building a DOM.
+    // Returns true if the message was handled; everything else goes to processMessage(const json&).
+    virtual bool processMarketData(const JsonValue& data) { return false; }
     
     // Callbacks
     std::function<void()> m_updateCallback;
@@ -187,16 +326,30 @@ protected:
     std::function<void(bool)> m_orderCallback;
     std::function<void(bool)> m_balanceCallback;
 
-    net::io_context m_ioc;
+    net::io_context* m_ioc{nullptr};  // from ioRuntime while connected
+    // strand on m_ioc: websocket handlers and HTTP completions of this exchange never run concurrently
+    net::any_io_executor m_executor;
     ssl::context m_ctx{ssl::context::tlsv12_client};
-    std::unique_ptr<websocket::stream<beast::ssl_stream<beast::tcp_stream>>> m_ws;
-    beast::flat_buffer m_buffer;
-
-    std::unique_ptr<net::executor_work_guard<net::io_context::executor_type>> m_work;
-    std::thread m_thread;
-    CURL* m_curl{nullptr};
-
-    std::map<TradingPair, SymbolState> symbolStates;
+    std::vector<std::shared_ptr<Feed>> m_feeds;
+    FeedArbiter m_arbiter;
+    size_t m_currentFeed{0};  // feed of the frame being processed
+    std::vector<std::pair<std::string, std::string>> m_subscriptions;  // key, message; under m_wsMutex
+    // outage in progress, on the strand
+    std::chrono::steady_clock::time_point m_darkSince;
+    std::vector<uint64_t> m_darkVersions;  // book versions by pair when the subscriptions were replayed
+    OutageStats m_outageStats;
+    mutable std::mutex m_outageMutex;
+    std::atomic<uint64_t> m_readFrames{0};
+    std::atomic<uint64_t> m_readBytes{0};
+    std::atomic<uint64_t> m_maxFrameBytes{0};
+
+    std::unique_ptr<HttpClient> m_http;
+    std::unique_ptr<OrderSession> m_orderSession;  // while connected
+    std::mutex m_httpMutex;
+
+    std::map<TradingPair, SymbolState> symbolStates;  // on the feed strand
+    // SymbolState::lastUpdateId mirrored for the order book snapshots, saved from the timer thread
+    std::array<std::atomic<int64_t>, static_cast<size_t>(TradingPair::COUNT)> m_lastUpdateIds{};
     std::string m_restEndpoint;
     std::string m_wsHost;
     std::string m_wsPort;
@@ -206,8 +359,6 @@ protected:
 
     // WebSocket synchronization
     std::mutex m_wsMutex;
-    std::queue<std::string> m_writeQueue;
-    bool m_isWriting{false};
 };
 
 // Factory function to create exchange API instances
@@ -1,7 +1,9 @@
 #include "api_kraken.h"
 #include "orderbook_mgr.h"
+#include "kraken_checksum.h"
 #include <iostream>
 #include <sstream>
+#include <charconv>
 #include <boost/beast/core.hpp>
 #include <boost/beast/websocket.hpp>
 #include <boost/beast/http.hpp>
@@ -37,28 +39,43 @@ bool ApiKraken::handleSubscribeUnsubscribe(const std::vector<TradingPair>& pairs
         ERROR("No pairs to subscribe/unsubscribe");
         return false;
     }
+    auto request = [subscribe](const std::vector<std::string>& symbols) {
+        return json{
+            {"method", subscribe ? "subscribe" : "unsubscribe"},
+            {"req_id", reqId++},
+            {"params", {
+                {"channel", "ticker"},
+                {"symbol", symbols}
+            }}
+        };
+    };
+
     std::vector<std::string> symbols;
     std::string symbolsStr;
-    for (const auto& pair : pairs) {
-       symbols.push_back(tradingPairToSymbol(pair));
-        symbolsStr += tradingPairToSymbol(pair) + ", ";
-
-        symbolStates[pair].subscribed = subscribe;
-    }
+    // kept per pair: a checksum resubscribe of one pair replaces its own subscription only
+    std::vector<std::pair<std::string, std::string>> replay;
+    std::vector<std::string> keys;
+    try  {
+        for (const auto& pair : pairs) {
+            const std::string symbol = tradingPairToSymbol(pair);
+            symbols.push_back(symbol);
+            symbolsStr += symbol + ", ";
+            if (subscribe) {
+                replay.emplace_back("ticker " + symbol, request({symbol}).dump());
+            } else {
+                keys.push_back("ticker " + symbol);
+            }
 
-    TRACE(subscribe ? "Subscribing to " : "Unsubscribing from ", symbolsStr);
+            symbolStates[pair].subscribed = subscribe;
+        }
 
-    json request = {
-        {"method", subscribe ? "subscribe" : "unsubscribe"},
-        {"req_id", reqId++},
-        {"params", {
-            {"channel", "ticker"},
-            {"symbol", symbols}
-        }}
-    };
+        TRACE(subscribe ? "Subscribing to " : "Unsubscribing from ", symbolsStr);
 
-    try  {
-        doWrite(request.dump());
+        if (subscribe) {
+            doSubscribe(request(symbols).dump(), std::move(replay));
+        } else {
+            doUnsubscribe(request(symbols).dump(), keys);
+        }
         return true;
     } catch (const std::exception& e) {
         ERROR("Error ", subscribe ? "subscribing to" : "unsubscribing from", " order book: ", e.what());
@@ -153,6 +170,10 @@ void ApiKraken::processMessage(const json& data) {
 }
 
 void ApiKraken::processTickerUpdate(const json& data) {
+    // no sequence to arbitrate by: the standby feeds only take over when the leading one is down
+    if (!isFromLeadingFeed()) {
+        return;
+    }
     TRACE("Processing ticker update: ", data.dump());
     
     try {
@@ -161,11 +182,9 @@ void ApiKraken::processTickerUpdate(const json& data) {
         const std::string& symbol = tickerData["symbol"];
         
         // Convert Kraken symbol to our internal format
-        TradingPair pair;
-        try {
-            pair = TradingPairData::fromSymbol(ExchangeId::KRAKEN, symbol);
-        } catch (const std::exception& e) {
-            ERROR("Failed to convert symbol ", symbol, ": ", e.what(), " - ", data.dump());
+        TradingPair pair = symbolToTradingPair(symbol);
+        if (pair == TradingPair::UNKNOWN) {
+            ERROR_CNT(CountableTrace::A_UNKNOWN_TRADING_PAIR, "Unknown trading pair: ", symbol, " - ", data.dump());
             return;
         }
         
@@ -196,7 +215,6 @@ void ApiKraken::processTickerUpdate(const json& data) {
 }
 
 void ApiKraken::processOrderBookUpdate(const json& data) {
-    static int countCalls = 0;
     if (!data.contains("type") ||
         !data.contains("data") ||
         !data["data"].is_array() ||
@@ -209,8 +227,8 @@ void ApiKraken::processOrderBookUpdate(const json& data) {
         return;
     }
 
-    std::vector<PriceLevel> asks;
-    std::vector<PriceLevel> bids;
+    std::vector<FixedLevel> asks;
+    std::vector<FixedLevel> bids;
     TradingPair pair = TradingPair::UNKNOWN;
     std::string symbol;
 
@@ -227,35 +245,38 @@ void ApiKraken::processOrderBookUpdate(const json& data) {
             ERROR("Unknown trading pair: ", symbol, " - ", data.dump().substr(0, 300));
             return;
         }
+        if (isCompleteUpdate) {
+            // every feed gets its own snapshot; the book already has one unless it is being restored
+            if (m_arbiter.getFeeds() > 1 && symbolStates[pair].hasSnapshot()) {
+                DEBUG("Dropping snapshot for ", symbol, " from standby feed ", m_currentFeed);
+                return;
+            }
+        } else if (data["data"][0].contains("timestamp")) {
+            uint64_t sequence = timestampSequence(data["data"][0]["timestamp"].get<std::string>());
+            if (!isFirstArrival(pair, FeedArbiter::Stream::BOOK, sequence, data["data"][0]["checksum"].get<uint32_t>())) {
+                return;
+            }
+        }
         DEBUG("Processing order book ", data["type"], " for ", symbol, " - ", data.dump().substr(0, 3000));  
     } catch (const std::exception& e) {
         ERROR("Error processing order book update: ", e.what());
         return;
     }
 
-    // Store previous state for debugging
-    auto& book = orderBookManager.getOrderBook(ExchangeId::KRAKEN, pair);
-    std::vector<PriceLevel> prevBids, prevAsks;
-    uint32_t prevChecksum = 0;
-    if (++countCalls % Config::KRAKEN_CHECKSUM_CHECK_PERIOD == 1) {
-        prevBids = book.getBids();
-        prevAsks = book.getAsks();
-        prevChecksum = computeChecksum(buildChecksumString(pair, prevAsks) + buildChecksumString(pair, prevBids));
-    }
-    
     try {
         // Process asks
+        // Kraken sends JSON numbers at the pair's precision, so rounding them to ticks is exact
         for (const auto& ask : data["data"][0]["asks"]) {
-            double price = ask["price"];
-            double qty = ask["qty"];
+            FixedPoint::Ticks price = FixedPoint::toTicks(ask["price"].get<double>());
+            FixedPoint::Lots qty = FixedPoint::toLots(ask["qty"].get<double>());
 
             asks.push_back({price, qty});
         }
 
         // Process bids
         for (const auto& bid : data["data"][0]["bids"]) {
-            double price = bid["price"];
-            double qty = bid["qty"];
+            FixedPoint::Ticks price = FixedPoint::toTicks(bid["price"].get<double>());
+            FixedPoint::Lots qty = FixedPoint::toLots(bid["qty"].get<double>());
             
             bids.push_back({price, qty});
         }
@@ -268,27 +289,22 @@ void ApiKraken::processOrderBookUpdate(const json& data) {
         orderBookManager.updateOrderBook(ExchangeId::KRAKEN, pair, bids, asks, isCompleteUpdate);
 
         uint32_t receivedChecksum = data["data"][0]["checksum"];
-        // performance optimization as validation is slow. countCalls is increased above
-        if (countCalls % Config::KRAKEN_CHECKSUM_CHECK_PERIOD == 1 && !isOrderBookValid(pair, receivedChecksum)) {
-            // Get current state after update
-            auto& currentBook = orderBookManager.getOrderBook(ExchangeId::KRAKEN, pair);
-            auto currentBids = currentBook.getBids();
-            auto currentAsks = currentBook.getAsks();
-            std::string currentChecksumStr = buildChecksumString(pair, currentAsks) + buildChecksumString(pair, currentBids);
-            uint32_t currentChecksum = computeChecksum(currentChecksumStr);
-
-            // Print detailed debug info
-            TRACE_CNT(CountableTrace::A_KRAKEN_ORDERBOOK_CHECKSUM_CHECK,    
+        // every update is verified; the checksum is cheap and a corrupted book must not live on
+        if (!isOrderBookValid(pair, receivedChecksum)) {
+            // slow path from here: copies of the book for the trace
+            auto& book = orderBookManager.getOrderBook(ExchangeId::KRAKEN, pair);
+            auto currentBids = book.getBidLevels();
+            auto currentAsks = book.getAskLevels();
+            TRACE_CNT(CountableTrace::A_KRAKEN_ORDERBOOK_CHECKSUM_CHECK,
                 "Invalid order book checksum for ", symbol, "\n"
-                "Previous checksum: ", prevChecksum, "\n"
-                "Received checksum: ", receivedChecksum, "\n",  
-                "Current checksum:  ", currentChecksum, "\n",
-                "Previous asks: ", book.traceBidsAsks(prevAsks), 
-                "\nPrevious bids: ", book.traceBidsAsks(prevBids), 
-                "\nCurrent asks: ", book.traceBidsAsks(currentAsks), 
-                "\nCurrent bids: ", book.traceBidsAsks(currentBids), 
+                "Received checksum: ", receivedChecksum, "\n",
+                "Current checksum:  ", KrakenChecksum::of(currentAsks, currentBids, pair), "\n",
+                "Current asks: ", book.traceBidsAsks(currentAsks),
+                "\nCurrent bids: ", book.traceBidsAsks(currentBids),
                 "\nUpdate data: ", data.dump());
 
+            // the book is not trusted until the snapshot that comes with the new subscription
+            setSymbolSnapshotState(pair, false);
             if (!resubscribeOrderBook({pair})) {
                 ERROR("Failed to resubscribe after checksum mismatch for ", symbol);
                 return;
@@ -308,43 +324,75 @@ void ApiKraken::processOrderBookUpdate(const json& data) {
     }
 }
 
+// Orders the RFC 3339 timestamps of book updates, e.g. "2025-05-06T09:17:26.208075Z" -> 250506091726208075
+uint64_t ApiKraken::timestampSequence(std::string_view timestamp) {
+    uint64_t sequence = 0;
+    int fractionDigits = -1;  // -1 until the decimal point
+    for (size_t i = 2; i < timestamp.size(); i++) {
+        const char c = timestamp[i];
+        if (c == '.') {
+            fractionDigits = 0;
+        } else if (c >= '0' && c <= '9' && fractionDigits < 6) {
+            sequence = sequence * 10 + static_cast<uint64_t>(c - '0');
+            if (fractionDigits >= 0) {
+                fractionDigits++;
+            }
+        }
+    }
+    // microseconds, whatever the precision sent
+    for (int i = std::max(fractionDigits, 0); i < 6; i++) {
+        sequence *= 10;
+    }
+    return sequence;
+}
+
 // CHECKSUM functions
+// The check itself runs on KrakenChecksum; the strings below are for tests and traces.
+
+// Append the decimal digits of a non-negative integer. Zero yields nothing, as Kraken strips leading zeros.
+static void appendDigits(std::string& out, int64_t value) {
+    if (value <= 0) {
+        return;
+    }
+    char buf[20];
+    auto res = std::to_chars(buf, buf + sizeof(buf), value);
+    out.append(buf, res.ptr);
+}
 
 // rules defined here: https://docs.kraken.com/api/docs/guides/spot-ws-book-v2
 // Remove the decimal character, '.', from the price, i.e. "45285.2" -> "452852".
 // Remove all leading zero characters from the price. i.e. "452852" -> "452852".
 std::string ApiKraken::formatPrice(TradingPair pair, double price) {
-    std::ostringstream out;
-    // Get the trading pair from the current order book being processed
-    int precision = TradingPairData::getPrecision(pair);
-    out << std::fixed << std::setprecision(precision) << price;
-    std::string s = out.str();
-    s.erase(std::remove(s.begin(), s.end(), '.'), s.end());
-    s.erase(0, s.find_first_not_of('0'));
+    std::string s;
+    appendDigits(s, FixedPoint::toPrecisionUnits(FixedPoint::toTicks(price), pair));
     return s;
 }
 
 // Remove the decimal character, '.', from the qty, i.e. "0.00100000" -> "000100000".
 // Remove all leading zero characters from the qty. i.e. "000100000" -> "100000".
+// Kraken quantities have 8 decimals, the same as lots, so the digits are the lots themselves.
 std::string ApiKraken::formatQty(double qty) {
-    std::ostringstream out;
-    out << std::fixed << std::setprecision(8) << qty;   
-    std::string s = out.str();
-    s.erase(std::remove(s.begin(), s.end(), '.'), s.end());
-    s.erase(0, s.find_first_not_of('0'));
+    std::string s;
+    appendDigits(s, FixedPoint::toLots(qty));
     return s;
 }
 
-std::string ApiKraken::buildChecksumString(TradingPair pair, const std::vector<PriceLevel>& prices) {
-    std::ostringstream oss;
-    
+std::string ApiKraken::buildChecksumString(TradingPair pair, const std::vector<FixedLevel>& prices) {
+    std::string out;
+    out.reserve(Config::ORDERBOOK_MAX_DEPTH * 2 * 20);
+
     // Process asks (sorted by price from low to high)
     size_t depth = std::min(size_t(10), prices.size());
     for (size_t i = 0; i < depth; ++i) {
-        oss << formatPrice(pair, prices[i].price) << formatQty(prices[i].quantity);
+        appendDigits(out, FixedPoint::toPrecisionUnits(prices[i].price, pair));
+        appendDigits(out, prices[i].quantity);
     }
 
-    return oss.str();
+    return out;
+}
+
+std::string ApiKraken::buildChecksumString(TradingPair pair, const std::vector<PriceLevel>& prices) {
+    return buildChecksumString(pair, toFixedLevels(prices));
 }
 
 uint32_t ApiKraken::computeChecksum(const std::string& checksumString) {
@@ -353,14 +401,11 @@ uint32_t ApiKraken::computeChecksum(const std::string& checksumString) {
 
 bool ApiKraken::isOrderBookValid(TradingPair pair, uint32_t receivedChecksum) {
     auto& book = orderBookManager.getOrderBook(ExchangeId::KRAKEN, pair);
-    auto bids = book.getBids();
-    auto asks = book.getAsks();
-    std::string str = buildChecksumString(pair, asks) + buildChecksumString(pair, bids);
-    uint32_t localChecksum = computeChecksum(str);
-    
+    uint32_t localChecksum = KrakenChecksum::of(book, pair);
+
     if (localChecksum != receivedChecksum) {
         TRACE_CNT(CountableTrace::A_KRAKEN_ORDERBOOK_CHECKSUM_CHECK2,
-            "Invalid order book checksum: ", receivedChecksum, " local: ", localChecksum, " for ", pair, " - [", str, "] ");
+            "Invalid order book checksum: ", receivedChecksum, " local: ", localChecksum, " for ", pair);
         return false;
     } else {
         TRACE_CNT(CountableTrace::A_KRAKEN_ORDERBOOK_CHECKSUM_CHECK_OK, "[", pair, "]",
@@ -386,8 +431,14 @@ bool ApiKraken::placeOrder(TradingPair pair, OrderType type, double price, doubl
            << "&volume=" << std::fixed << std::setprecision(8) << quantity
            << "&price=" << std::fixed << std::setprecision(8) << price;
 
-        json response = makeHttpRequest("/AddOrder", ss.str(), "POST");
-        TRACE("Order placed successfully: ", response.dump());
+        makeOrderRequestAsync("/AddOrder", ss.str(), "POST", [this](bool ok, const json& response) {
+            if (ok) {
+                TRACE("Order placed successfully: ", response.dump());
+            }
+            if (m_orderCallback) {
+                m_orderCallback(ok);
+            }
+        });
         return true;
     } catch (const std::exception& e) {
         ERROR("Error placing order: ", e.what());
@@ -403,8 +454,14 @@ bool ApiKraken::cancelOrder(const std::string& orderId) {
 
     try {
         std::string params = "txid=" + orderId;
-        json response = makeHttpRequest("/CancelOrder", params, "POST");
-        TRACE("Order cancelled successfully: ", response.dump());
+        makeOrderRequestAsync("/CancelOrder", params, "POST", [this](bool ok, const json& response) {
+            if (ok) {
+                TRACE("Order cancelled successfully: ", response.dump());
+            }
+            if (m_orderCallback) {
+                m_orderCallback(ok);
+            }
+        });
         return true;
     } catch (const std::exception& e) {
         ERROR("Error cancelling order: ", e.what());
@@ -419,15 +476,18 @@ bool ApiKraken::getBalance(const std::string& asset) {
     }
 
     try {
-        json response = makeHttpRequest("/Balance", "", "POST");
-        
-        if (response.contains("result") && response["result"].contains(asset)) {
-            TRACE("Balance for ", asset, ": ", response["result"][asset].get<std::string>());
-            return true;
-        }
-        
-        TRACE("No balance found for asset: ", asset);
-        return false;
+        makeHttpRequestAsync("/Balance", "", "POST", [this, asset](bool ok, const json& response) {
+            const bool found = ok && response.contains("result") && response["result"].contains(asset);
+            if (found) {
+                TRACE("Balance for ", asset, ": ", response["result"][asset].get<std::string>());
+            } else if (ok) {
+                TRACE("No balance found for asset: ", asset);
+            }
+            if (m_balanceCallback) {
+                m_balanceCallback(found);
+            }
+        });
+        return true;
     } catch (const std::exception& e) {
         ERROR("Error getting balance: ", e.what());
         return false;
@@ -37,16 +37,24 @@ public:
     // Helper functions for checksum calculation
     std::string formatPrice(TradingPair pair, double price);
     std::string formatQty(double qty);
+    std::string buildChecksumString(TradingPair pair, const std::vector<FixedLevel>& prices);
     std::string buildChecksumString(TradingPair pair, const std::vector<PriceLevel>& prices);
     uint32_t computeChecksum(const std::string& checksumString);
     bool isOrderBookValid(TradingPair pair, uint32_t receivedChecksum);
 
+    // Sequence for feed arbitration from the timestamp of a book update, in microseconds
+    static uint64_t timestampSequence(std::string_view timestamp);
+
 protected:
     // Override the cooldown method for Kraken-specific rate limiting
     void cooldown(int httpCode, const std::string& response, const std::string& endpoint = "") override;
     
     // Implement pure virtual methods from base class
     void processRateLimitHeaders(const std::string& headers) override;
+
+    std::string getOrderPingEndpoint() const override { return "/Time"; }
+    // book updates carry a timestamp and a checksum; tickers follow the leading feed
+    bool arbitratesFeeds() const override { return true; }
     
     // WebSocket callbacks
     void processMessage(const json& data) override;
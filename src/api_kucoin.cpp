@@ -1,6 +1,7 @@
 #include <iostream>
 #include <sstream>
 #include <regex>
+#include <charconv>
 #include <boost/beast/core.hpp>
 #include <boost/beast/websocket.hpp>
 #include <boost/beast/http.hpp>
@@ -56,7 +57,7 @@ bool ApiKucoin::subscribeOrderBook() {
         message["response"] = true;
 
         TRACE("Subscribing to Kucoin order book with message: ", message.dump());
-        doWrite(message.dump());
+        doSubscribe(message["topic"].get<std::string>(), message.dump());
     } catch (const std::exception& e) {
         ERROR("Error subscribing to order book: ", e.what(), " message: ", message.dump());
         success = false;
@@ -102,7 +103,14 @@ bool ApiKucoin::connect() {
 
 void ApiKucoin::sendPing() {
     static int pingId = 1;
-    doWrite("{\"id\": \"" + std::to_string(pingId++) + "\", \"type\": \"ping\"}");
+    // formatted on the stack, the feed's write ring holds the only copy
+    constexpr std::string_view PING_HEAD = "{\"id\": \"";
+    constexpr std::string_view PING_TAIL = "\", \"type\": \"ping\"}";
+    char message[64];
+    char* end = std::copy(PING_HEAD.begin(), PING_HEAD.end(), message);
+    end = std::to_chars(end, message + sizeof(message) - PING_TAIL.size(), pingId++).ptr;
+    end = std::copy(PING_TAIL.begin(), PING_TAIL.end(), end);
+    doWrite(std::string_view(message, end - message));
 }
 
 bool ApiKucoin::initWebSocketEndpoint() {
@@ -114,7 +122,17 @@ bool ApiKucoin::initWebSocketEndpoint() {
         TRACE("Failed to get WebSocket endpoint: ", ex.what(), " response: ", response.dump());
         return false;
     }
+    return applyWebSocketEndpoint(response);
+}
+
+void ApiKucoin::refreshWsEndpoint(std::function<void(bool ok)> done) {
+    // the token is for one connection: a reconnect needs a new one
+    makeHttpRequestAsync("/api/v1/bullet-public", "", "POST", [this, done](bool ok, const json& response) {
+        done(ok && applyWebSocketEndpoint(response));
+    }, true);
+}
 
+bool ApiKucoin::applyWebSocketEndpoint(const json& response) {
     DEBUG("Got response: ", response.dump());
 
     // Validate response
@@ -178,7 +196,12 @@ void ApiKucoin::processSubscribeResponse(const json& data) {
             std::stringstream ss2(item);
             std::string symbol;
             while (std::getline(ss2, symbol, ',')) {
-                symbols.push_back(symbolToTradingPair(symbol));
+                TradingPair pair = symbolToTradingPair(symbol);
+                if (pair == TradingPair::UNKNOWN) {
+                    ERROR_CNT(CountableTrace::A_UNKNOWN_TRADING_PAIR, "Unknown trading pair: ", symbol, " in topic: ", topic);
+                    continue;
+                }
+                symbols.push_back(pair);
             }
         }
     }
@@ -298,45 +321,56 @@ void ApiKucoin::processOrderBookUpdate(const json& data) {
 
 }
 
-void ApiKucoin::processLevel1(const json& data) {
-    if(!data.contains("topic")) {
-        ERROR_CNT(CountableTrace::A_UNKNOWN_MESSAGE_RECEIVED, "Missing topic in level1 message: ", data.dump());
+void ApiKucoin::processLevel1(const JsonValue& data) {
+    JsonValue topicValue = data["topic"];
+    if(!topicValue.isString()) {
+        ERROR_CNT(CountableTrace::A_UNKNOWN_MESSAGE_RECEIVED, "Missing topic in level1 message: ", data.raw());
         return;
     }
-    std::string topic = data["topic"];
+    std::string_view topic = topicValue.str();
     // example: "/spotMarket/level1:BTC-USDT"
-    std::string symbol = topic.substr(19);
+    constexpr std::string_view TOPIC_PREFIX = "/spotMarket/level1:";
+    if(topic.substr(0, TOPIC_PREFIX.size()) != TOPIC_PREFIX) {
+        ERROR_CNT(CountableTrace::A_UNKNOWN_MESSAGE_RECEIVED, "Unexpected topic in level1 message: ", data.raw());
+        return;
+    }
+    std::string_view symbol = topic.substr(TOPIC_PREFIX.size());
 
     TradingPair pair;
     pair = symbolToTradingPair(symbol);
-    TRACE("Received level1 message for ", pair, " data: ", data.dump());
+    TRACE("Received level1 message for ", pair, " data: ", data.raw());
 
-    int64_t timestamp = data["data"]["timestamp"];
+    JsonValue level1 = data["data"];
+    int64_t timestamp = 0;
+    level1["timestamp"].getInt(timestamp);
     if(pair == TradingPair::UNKNOWN) {
-        ERROR_CNT(CountableTrace::A_UNKNOWN_TRADING_PAIR, "Unknown trading pair: ", symbol, " data: ", data.dump());
+        ERROR_CNT(CountableTrace::A_UNKNOWN_TRADING_PAIR, "Unknown trading pair: ", symbol, " data: ", data.raw());
         return;
     }
-    if(!data.contains("data") || !data["data"].contains("asks") || !data["data"].contains("bids") 
-        || !data["data"]["asks"].is_array() || !data["data"]["bids"].is_array()
-        || data["data"]["asks"].size() != 2 || data["data"]["bids"].size() != 2
-    ) {
-        ERROR_CNT(CountableTrace::A_UNKNOWN_MESSAGE_RECEIVED, "Missing asks or bids in level1 message: ", data.dump());
+    JsonValue asks = level1["asks"];
+    JsonValue bids = level1["bids"];
+    if(!asks.isArray() || !bids.isArray() || asks.size() != 2 || bids.size() != 2) {
+        ERROR_CNT(CountableTrace::A_UNKNOWN_MESSAGE_RECEIVED, "Missing asks or bids in level1 message: ", data.raw());
         return;
     }
-    double bidPrice = std::stod(data["data"]["bids"][0].get<std::string>());
-    double bidQuantity = std::stod(data["data"]["bids"][1].get<std::string>());
-    double askPrice = std::stod(data["data"]["asks"][0].get<std::string>());
-    double askQuantity = std::stod(data["data"]["asks"][1].get<std::string>());
-    std::vector<PriceLevel> bids({{bidPrice, bidQuantity}});
-    std::vector<PriceLevel> asks({{askPrice, askQuantity}});
+    FixedLevel bid(FixedPoint::parsePrice(bids.at(0).str()), FixedPoint::parseQty(bids.at(1).str()));
+    FixedLevel ask(FixedPoint::parsePrice(asks.at(0).str()), FixedPoint::parseQty(asks.at(1).str()));
     try {
-        orderBookManager.updateOrderBookBestBidAsk(ExchangeId::KUCOIN, pair, bidPrice, bidQuantity, askPrice, askQuantity);
+        orderBookManager.updateOrderBookBestBidAsk(ExchangeId::KUCOIN, pair, bid, ask);
     } catch (const std::exception& e) {
-        ERROR("Error updating order book: ", e.what(), " data: ", data.dump());
+        ERROR("Error updating order book: ", e.what(), " data: ", data.raw());
     }
     // update symbol state
     auto& state = symbolStates[pair];
-    state.lastUpdateId = timestamp;
+    setLastUpdateId(pair, state, timestamp);
+}
+
+bool ApiKucoin::processMarketData(const JsonValue& data) {
+    if (data["type"].equals("message") && data["subject"].equals("level1")) {
+        processLevel1(data);
+        return true;
+    }
+    return false;
 }
 
 void ApiKucoin::processMessage(const json& data) {
@@ -350,9 +384,8 @@ void ApiKucoin::processMessage(const json& data) {
         } else if (data["type"] == "subscribe" && data.contains("response") && data["response"] == true) {
             processSubscribeResponse(data);
         } else if (data["type"] == "message") {
-            if(data.contains("subject") && data["subject"] == "level1") {
-                processLevel1(data);
-            }
+            // level1 messages are handled by processMarketData
+            TRACE("Unhandled message: ", data.dump());
         } else {
             ERROR_CNT(CountableTrace::A_UNKNOWN_MESSAGE_RECEIVED, "Unhandled message type: ", data["type"], " data: ", data.dump());
         }
@@ -431,8 +464,14 @@ bool ApiKucoin::placeOrder(TradingPair pair, OrderType type, double price, doubl
            << "&quantity=" << std::fixed << std::setprecision(8) << quantity
            << "&price=" << std::fixed << std::setprecision(8) << price;
 
-        json response = makeHttpRequest("/order", ss.str());
-        TRACE("Order placed successfully: ", response.dump());
+        makeHttpRequestAsync("/order", ss.str(), "GET", [this](bool ok, const json& response) {
+            if (ok) {
+                TRACE("Order placed successfully: ", response.dump());
+            }
+            if (m_orderCallback) {
+                m_orderCallback(ok);
+            }
+        });
         return true;
     } catch (const std::exception& e) {
         ERROR("Error placing order: ", e.what());
@@ -448,8 +487,14 @@ bool ApiKucoin::cancelOrder(const std::string& orderId) {
 
     try {
         std::string params = "orderId=" + orderId;
-        json response = makeHttpRequest("/order", params, "DELETE");
-        TRACE("Order cancelled successfully: ", response.dump());
+        makeHttpRequestAsync("/order", params, "DELETE", [this](bool ok, const json& response) {
+            if (ok) {
+                TRACE("Order cancelled successfully: ", response.dump());
+            }
+            if (m_orderCallback) {
+                m_orderCallback(ok);
+            }
+        });
         return true;
     } catch (const std::exception& e) {
         ERROR("Error cancelling order: ", e.what());
@@ -464,18 +509,26 @@ bool ApiKucoin::getBalance(const std::string& asset) {
     }
 
     try {
-        json response = makeHttpRequest("/account", "");
-        
-        for (const auto& balance : response["balances"]) {
-            if (balance["asset"] == asset) {
-                TRACE("Balance for ", asset, ": Free=", balance["free"].get<std::string>(),
-                          ", Locked=", balance["locked"].get<std::string>());
-                return true;
+        makeHttpRequestAsync("/account", "", "GET", [this, asset](bool ok, const json& response) {
+            bool found = false;
+            if (ok && response.contains("balances")) {
+                for (const auto& balance : response["balances"]) {
+                    if (balance.value("asset", "") == asset) {
+                        TRACE("Balance for ", asset, ": Free=", balance.value("free", ""),
+                                  ", Locked=", balance.value("locked", ""));
+                        found = true;
+                        break;
+                    }
+                }
             }
-        }
-        
-        TRACE("No balance found for asset: ", asset);
-        return false;
+            if (ok && !found) {
+                TRACE("No balance found for asset: ", asset);
+            }
+            if (m_balanceCallback) {
+                m_balanceCallback(found);
+            }
+        });
+        return true;
     } catch (const std::exception& e) {
         ERROR("Error getting balance: ", e.what());
         return false;
@@ -20,6 +20,7 @@ public:
 
     bool connect() override;
     bool initWebSocketEndpoint();
+    bool applyWebSocketEndpoint(const json& response);
     void sendPing();
     void startPingTimer();
 
@@ -52,10 +53,14 @@ protected:
     // Implement pure virtual methods from base class
     void processRateLimitHeaders(const std::string& headers) override;
 
+    // A new token and endpoint before each reconnect
+    void refreshWsEndpoint(std::function<void(bool ok)> done) override;
+
     // Message processing methods
     // Process messages for all exchanges
     void processMessage(const json& data) override;
-    void processLevel1(const json& data);
+    bool processMarketData(const JsonValue& data) override;
+    void processLevel1(const JsonValue& data);
     void processSubscribeResponse(const json& data);
     void processOrderBookUpdate(const json& data);
     void processOrderBookSnapshot(const json& data, TradingPair pair);
@@ -41,21 +41,28 @@ bool ApiOkx::subscribeOrderBook() {
 
     bool success = true;
 
-    // Split pairs into batches of MAX_SYMBOLS_PER_REQUEST
+    // Split pairs into batches of Config::WS_SUBSCRIBE_BATCH, a frame each
     int id = 1;
-    for (auto pair : m_pairs) {
-        TRACE("Subscribing to Okx order book for ", pair);
+    for (size_t first = 0; first < m_pairs.size(); first += Config::WS_SUBSCRIBE_BATCH) {
+        const size_t last = std::min(m_pairs.size(), first + Config::WS_SUBSCRIBE_BATCH);
+        TRACE("Subscribing to Okx order book for ", last - first, " pairs from ", m_pairs[first]);
         json message;
         try {
             message["id"] = id++;
             message["op"] = "subscribe";
-            message["args"] = {
-                {
+            message["args"] = json::array();
+            // kept per pair, a reconnect sends each of them once
+            std::vector<std::pair<std::string, std::string>> replay;
+            for (size_t i = first; i < last; i++) {
+                json arg = {
                     {"channel", "bbo-tbt"},
-                    {"instId", tradingPairToSymbol(pair)}
-                }
-            };
-            doWrite(message.dump());
+                    {"instId", tradingPairToSymbol(m_pairs[i])}
+                };
+                message["args"].push_back(arg);
+                json single = {{"id", id - 1}, {"op", "subscribe"}, {"args", json::array({arg})}};
+                replay.emplace_back("bbo-tbt " + tradingPairToSymbol(m_pairs[i]), single.dump());
+            }
+            doSubscribe(message.dump(), std::move(replay));
         } catch (const std::exception& e) {
             ERROR("Error subscribing to order book batch: ", e.what(), " message: ", message.dump());
             success = false;
@@ -80,7 +87,7 @@ void ApiOkx::processSubscribeResponse(const json& data) {
         ERROR_CNT(CountableTrace::A_UNKNOWN_MESSAGE_RECEIVED, "Missing instId in subscribe response: ", data.dump());
         return;
     }
-    auto symbol = data["arg"]["instId"];
+    std::string symbol = data["arg"]["instId"];
     auto pair = symbolToTradingPair(symbol);
     if(pair == TradingPair::UNKNOWN) {
         ERROR_CNT(CountableTrace::A_UNKNOWN_TRADING_PAIR, "Unknown trading pair: ", symbol);
@@ -94,54 +101,65 @@ void ApiOkx::processOrderBookUpdate(const json& data) {
     ERROR("Not implemented: processOrderBookUpdate");
 }
 
-void ApiOkx::processLevel1(const json& data) {
+void ApiOkx::processLevel1(const JsonValue& data) {
     // example:
     // {"arg":{"channel":"bbo-tbt","instId":"BTC-USDT"},"data":[{"asks":[["105252.6","0.16271274","0","5"]],"bids":[["105252.5","1.1133491","0","19"]],"ts":"1749044565306","seqId":55729075884}]}
 
 try {
-    if(!data.contains("arg") || !data["arg"].contains("instId")) {
-        ERROR_CNT(CountableTrace::A_UNKNOWN_MESSAGE_RECEIVED, "Missing instId in level1 message: ", data.dump());
+    JsonValue instId = data.find("arg/instId");
+    if(!instId.isString()) {
+        ERROR_CNT(CountableTrace::A_UNKNOWN_MESSAGE_RECEIVED, "Missing instId in level1 message: ", data.raw());
         return;
     }
-    std::string symbol = data["arg"]["instId"];
+    std::string_view symbol = instId.str();
     TradingPair pair = symbolToTradingPair(symbol);
     if(pair == TradingPair::UNKNOWN) {
-        ERROR_CNT(CountableTrace::A_UNKNOWN_TRADING_PAIR, "Unknown trading pair: ", symbol, " data: ", data.dump());
+        ERROR_CNT(CountableTrace::A_UNKNOWN_TRADING_PAIR, "Unknown trading pair: ", symbol, " data: ", data.raw());
+        return;
+    }
+    JsonValue list = data["data"];
+    JsonValue level1 = list.at(0);
+    int64_t seqId;
+    if(!list.isArray() || list.size() != 1 || !level1["ts"].valid() || !level1["seqId"].getInt(seqId)) {
+        ERROR_CNT(CountableTrace::A_UNKNOWN_MESSAGE_RECEIVED, "Missing data in level1 message: ", data.raw());
         return;
     }
-    if(!data.contains("data") || !data["data"].is_array() || data["data"].size() != 1
-        || !data["data"][0].contains("ts") || !data["data"][0].contains("seqId")) {
-        ERROR_CNT(CountableTrace::A_UNKNOWN_MESSAGE_RECEIVED, "Missing data in level1 message: ", data.dump());
+    if (!isFirstArrival(pair, FeedArbiter::Stream::TOP, seqId)) {
         return;
     }
-    int64_t seqId = data["data"][0]["seqId"];
-    TRACE("Received level1 message for ", pair, " seqId: ", seqId, " data: ", data.dump());
+    TRACE("Received level1 message for ", pair, " seqId: ", seqId, " data: ", data.raw());
 
-    if(!data["data"][0].contains("asks") || !data["data"][0].contains("bids") 
-        || !data["data"][0]["asks"].is_array() || !data["data"][0]["bids"].is_array()
-        || data["data"][0]["asks"].size() != 1 || data["data"][0]["bids"].size() != 1 
-        || data["data"][0]["asks"][0].size() != 4 || data["data"][0]["bids"][0].size() != 4
+    JsonValue asks = level1["asks"];
+    JsonValue bids = level1["bids"];
+    if(!asks.isArray() || !bids.isArray() || asks.size() != 1 || bids.size() != 1
+        || asks.at(0).size() != 4 || bids.at(0).size() != 4
     ) {
-        ERROR_CNT(CountableTrace::A_UNKNOWN_MESSAGE_RECEIVED, "Missing asks or bids in level1 message: ", data.dump());
+        ERROR_CNT(CountableTrace::A_UNKNOWN_MESSAGE_RECEIVED, "Missing asks or bids in level1 message: ", data.raw());
         return;
     }
-    double bidPrice = std::stod(data["data"][0]["bids"][0][0].get<std::string>());
-    double bidQuantity = std::stod(data["data"][0]["bids"][0][1].get<std::string>());
-    double askPrice = std::stod(data["data"][0]["asks"][0][0].get<std::string>());
-    double askQuantity = std::stod(data["data"][0]["asks"][0][1].get<std::string>());
-    std::vector<PriceLevel> bids({{bidPrice, bidQuantity}});
-    std::vector<PriceLevel> asks({{askPrice, askQuantity}});
+    JsonValue bestBid = bids.at(0);
+    JsonValue bestAsk = asks.at(0);
+    FixedLevel bid(FixedPoint::parsePrice(bestBid.at(0).str()), FixedPoint::parseQty(bestBid.at(1).str()));
+    FixedLevel ask(FixedPoint::parsePrice(bestAsk.at(0).str()), FixedPoint::parseQty(bestAsk.at(1).str()));
     try {
-        orderBookManager.updateOrderBookBestBidAsk(ExchangeId::OKX, pair, bidPrice, bidQuantity, askPrice, askQuantity);
+        orderBookManager.updateOrderBookBestBidAsk(ExchangeId::OKX, pair, bid, ask);
     } catch (const std::exception& e) {
-        ERROR("Error updating order book: ", e.what(), " data: ", data.dump());
+        ERROR("Error updating order book: ", e.what(), " data: ", data.raw());
     }
     // update symbol state
     auto& state = symbolStates[pair];
-    state.lastUpdateId = seqId;
+    setLastUpdateId(pair, state, seqId);
     } catch (const std::exception& e) {
-        ERROR("Error processing level1 message: ", e.what(), " data: ", data.dump());
+        ERROR("Error processing level1 message: ", e.what(), " data: ", data.raw());
+    }
+}
+
+bool ApiOkx::processMarketData(const JsonValue& data) {
+    if (data.find("arg/channel").equals("bbo-tbt") && data["data"].valid()) {
+        processLevel1(data);
+        return true;
     }
+    return false;
 }
 
 void ApiOkx::processMessage(const json& data) {
@@ -155,8 +173,9 @@ void ApiOkx::processMessage(const json& data) {
             ERROR_CNT(CountableTrace::A_UNKNOWN_MESSAGE_RECEIVED, "Unhandled message type: ", data["event"], " data: ", data.dump());
         }
     } else if (data.contains("arg")) {
+        // bbo-tbt messages with data are handled by processMarketData
         if(data["arg"].contains("channel") && data["arg"]["channel"] == "bbo-tbt") {
-            processLevel1(data);
+            ERROR_CNT(CountableTrace::A_UNKNOWN_MESSAGE_RECEIVED, "Malformed level1 message: ", data.dump());
         } else {
             ERROR_CNT(CountableTrace::A_UNKNOWN_MESSAGE_RECEIVED, "Unhandled message type: ", data["arg"]["channel"], " data: ", data.dump());
         }
@@ -190,8 +209,14 @@ bool ApiOkx::placeOrder(TradingPair pair, OrderType type, double price, double q
            << "&quantity=" << std::fixed << std::setprecision(8) << quantity
            << "&price=" << std::fixed << std::setprecision(8) << price;
 
-        json response = makeHttpRequest("/order", ss.str());
-        TRACE("Order placed successfully: ", response.dump());
+        makeOrderRequestAsync("/order", ss.str(), "GET", [this](bool ok, const json& response) {
+            if (ok) {
+                TRACE("Order placed successfully: ", response.dump());
+            }
+            if (m_orderCallback) {
+                m_orderCallback(ok);
+            }
+        });
         return true;
     } catch (const std::exception& e) {
         ERROR("Error placing order: ", e.what());
@@ -207,8 +232,14 @@ bool ApiOkx::cancelOrder(const std::string& orderId) {
 
     try {
         std::string params = "orderId=" + orderId;
-        json response = makeHttpRequest("/order", params, "DELETE");
-        TRACE("Order cancelled successfully: ", response.dump());
+        makeOrderRequestAsync("/order", params, "DELETE", [this](bool ok, const json& response) {
+            if (ok) {
+                TRACE("Order cancelled successfully: ", response.dump());
+            }
+            if (m_orderCallback) {
+                m_orderCallback(ok);
+            }
+        });
         return true;
     } catch (const std::exception& e) {
         ERROR("Error cancelling order: ", e.what());
@@ -223,18 +254,26 @@ bool ApiOkx::getBalance(const std::string& asset) {
     }
 
     try {
-        json response = makeHttpRequest("/account", "");
-        
-        for (const auto& balance : response["balances"]) {
-            if (balance["asset"] == asset) {
-                TRACE("Balance for ", asset, ": Free=", balance["free"].get<std::string>(),
-                          ", Locked=", balance["locked"].get<std::string>());
-                return true;
+        makeHttpRequestAsync("/account", "", "GET", [this, asset](bool ok, const json& response) {
+            bool found = false;
+            if (ok && response.contains("balances")) {
+                for (const auto& balance : response["balances"]) {
+                    if (balance.value("asset", "") == asset) {
+                        TRACE("Balance for ", asset, ": Free=", balance.value("free", ""),
+                                  ", Locked=", balance.value("locked", ""));
+                        found = true;
+                        break;
+                    }
+                }
             }
-        }
-        
-        TRACE("No balance found for asset: ", asset);
-        return false;
+            if (ok && !found) {
+                TRACE("No balance found for asset: ", asset);
+            }
+            if (m_balanceCallback) {
+                m_balanceCallback(found);
+            }
+        });
+        return true;
     } catch (const std::exception& e) {
         ERROR("Error getting balance: ", e.what());
         return false;
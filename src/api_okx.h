@@ -46,10 +46,15 @@ protected:
     // Implement pure virtual methods from base class
     void processRateLimitHeaders(const std::string& headers) override;
 
+    std::string getOrderPingEndpoint() const override { return "/api/v5/public/time"; }
+    // bbo-tbt carries seqId
+    bool arbitratesFeeds() const override { return true; }
+
     // Message processing methods
     // Process messages for all exchanges
     void processMessage(const json& data) override;
-    void processLevel1(const json& data);
+    bool processMarketData(const JsonValue& data) override;
+    void processLevel1(const JsonValue& data);
     void processSubscribeResponse(const json& data);
     void processOrderBookUpdate(const json& data);
     void processOrderBookSnapshot(const json& data, TradingPair pair);
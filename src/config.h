@@ -23,9 +23,44 @@ namespace Config {
     constexpr int COUNTABLE_TRACES_PRINT_INTERVAL3 = 1000;
     constexpr int COUNTABLE_TRACES_PRINT_INTERVAL4 = 50000;
     constexpr int COUNTABLE_TRACES_RESET_INTERVAL_MS = 600000; // 10 minutes
+    constexpr bool TRACE_ASYNC = true; // write traces from a background thread (see FastTraceLogger::startAsync)
+    constexpr int TRACE_RING_BYTES = 1 << 20; // per thread ring for async traces, power of two
+    constexpr int TRACE_MAX_TEXT = 16384; // longer async traces are cut
+    constexpr int TRACE_DRAIN_IDLE_US = 500; // drain thread sleep when all rings are empty
+    constexpr const char* TRACE_JOURNAL_FILE = ""; // e.g. "trading.trace": binary async traces, read with lla_tracedump
+
+    // Order book settings
+    constexpr int ORDERBOOK_MAX_DEPTH = 10; // levels kept per side; capacity of the inline price ladders
+    constexpr bool ORDERBOOK_DEEP_MODE = false; // keep full depth books (deep_orderbook.h) behind the top levels
+    constexpr int ORDERBOOK_DEEP_DEPTH = 1000; // levels requested from the exchanges in deep mode
+    constexpr int DEEP_ORDERBOOK_WINDOW_TICKS = 1 << 16; // price range of a deep book side, in ticks
+    constexpr const char* ORDERBOOK_SNAPSHOT_FILE = "orderbooks.bin"; // books saved for warm restarts
+    constexpr int ORDERBOOK_SNAPSHOT_INTERVAL_MS = 60000; // periodic save
+    constexpr int ORDERBOOK_SNAPSHOT_MAX_AGE_MS = 600000; // older files are not restored
 
     // Exchange settings
-    constexpr int KRAKEN_CHECKSUM_CHECK_PERIOD = 10; // check checksum every 100th update as it is slow
+    constexpr bool IO_SHARED_POOL = false; // one io_context run by IO_POOL_THREADS threads instead of a thread per exchange
+    constexpr int IO_POOL_THREADS = 2;
+    constexpr bool IO_BUSY_POLL = false; // IO threads spin on poll() instead of blocking: lower latency, a full core each
+    constexpr int IO_EXCHANGE_CPUS[] = {-1, -1, -1, -1, -1, -1}; // core per ExchangeId for the exchange threads, -1: not pinned
+    constexpr int IO_UTILIZATION_TRACE_INTERVAL_MS = 60000;
+    constexpr int WS_READ_BUFFER_BYTES = 64 * 1024; // websocket read buffer reserved on connect, or the largest frame seen
+    constexpr int WS_FEEDS_PER_EXCHANGE = 2; // redundant websockets with the same subscriptions, for exchanges that arbitrate
+    constexpr bool WS_FEEDS_DISTINCT_IPS = true; // spread the feeds over the addresses the host resolves to
+    constexpr int WS_RECONNECT_BASE_MS = 100; // a dropped feed reconnects after 50-100 ms, the delay doubling per failed attempt
+    constexpr int WS_RECONNECT_MAX_MS = 30000; // cap of the reconnect backoff
+    constexpr int WS_CONNECT_TIMEOUT_MS = 5000; // connect and handshakes of a reconnecting feed
+    constexpr int WS_WRITE_RING_SLOTS = 64; // outbound messages a feed holds until written
+    constexpr int WS_WRITE_SLOT_BYTES = 1024; // reserved per slot, pings and heartbeat replies fit
+    constexpr int WS_SUBSCRIBE_BATCH = 50; // pairs per subscribe frame where the exchange takes a list
+    constexpr bool WS_RX_TIMESTAMPS = true; // kernel receive timestamps on the feed sockets (SO_TIMESTAMPING), see latency.h
+    constexpr bool WS_RX_HARDWARE_TIMESTAMPS = false; // NIC stamps instead; only with its clock synced by phc2sys
+    constexpr int LATENCY_TRACE_INTERVAL_MS = 60000; // tick-to-decision percentiles by exchange and stage
+    constexpr int HTTP_MAX_CONNECTIONS = 4; // REST connections kept alive per exchange
+    constexpr int SNAPSHOT_MAX_BUFFERED_UPDATES = 1000; // depth updates kept per pair while its snapshot is in flight
+    constexpr bool ORDER_SESSION_ENABLED = true; // orders go out on warm connections of their own (order_session.h)
+    constexpr int ORDER_SESSION_CONNECTIONS = 2; // warm order connections per exchange; HTTP/2 multiplexes on each
+    constexpr int ORDER_SESSION_PING_INTERVAL_MS = 15000; // keeps them ahead of idle timeouts
 
     // New configuration constants
     constexpr int SNAPSHOT_VALIDITY_CHECK_INTERVAL_MS = 1000;  // Check every second
@@ -0,0 +1,232 @@
+#include "deep_orderbook.h"
+
+#define TRACE(...) TRACE_THIS(TraceInstance::ORDERBOOK, exchangeId, __VA_ARGS__)
+#define DEBUG(...) DEBUG_THIS(TraceInstance::ORDERBOOK, exchangeId, __VA_ARGS__)
+
+namespace {
+constexpr size_t SUMMARY_SPAN = 64 * 64; // ticks covered by one summary word
+}
+
+DeepLadder::DeepLadder(bool isBid, FixedPoint::Ticks tickSize, size_t windowTicks)
+    : isBid(isBid), tick(tickSize > 0 ? tickSize : 1) {
+    // power of two so that the slot is a mask, at least one summary word
+    window = SUMMARY_SPAN;
+    while (window < windowTicks) {
+        window <<= 1;
+    }
+    mask = window - 1;
+    quantities.assign(window, 0);
+    words.assign(window / 64, 0);
+    summary.assign(window / SUMMARY_SPAN, 0);
+}
+
+void DeepLadder::clear() {
+    std::fill(quantities.begin(), quantities.end(), 0);
+    std::fill(words.begin(), words.end(), 0);
+    std::fill(summary.begin(), summary.end(), 0);
+    levelCount = 0;
+    bestTick = NONE;
+}
+
+FixedLevel DeepLadder::best() const {
+    return levelCount == 0 ? FixedLevel() : FixedLevel(bestTick * tick, quantities[slot(bestTick)]);
+}
+
+void DeepLadder::setBit(size_t s) {
+    size_t w = s >> 6;
+    words[w] |= 1ULL << (s & 63);
+    summary[w >> 6] |= 1ULL << (w & 63);
+}
+
+void DeepLadder::clearBit(size_t s) {
+    size_t w = s >> 6;
+    words[w] &= ~(1ULL << (s & 63));
+    if (words[w] == 0) {
+        summary[w >> 6] &= ~(1ULL << (w & 63));
+    }
+}
+
+int64_t DeepLadder::findUp(int64_t from, int64_t to) const {
+    while (from < to) {
+        size_t s = slot(from);
+        uint64_t bits = words[s >> 6] >> (s & 63);
+        if (bits) {
+            int64_t t = from + __builtin_ctzll(bits);
+            return t < to ? t : NONE;
+        }
+        from += 64 - static_cast<int64_t>(s & 63);  // first tick of the next word
+        if (from >= to) {
+            break;
+        }
+        // skip empty words using the summary
+        size_t w = slot(from) >> 6;
+        uint64_t summaryBits = summary[w >> 6] >> (w & 63);
+        if (summaryBits) {
+            from += static_cast<int64_t>(__builtin_ctzll(summaryBits)) * 64;
+        } else {
+            from += static_cast<int64_t>(64 - (w & 63)) * 64;
+        }
+    }
+    return NONE;
+}
+
+int64_t DeepLadder::findDown(int64_t from, int64_t to) const {
+    while (from >= to) {
+        size_t s = slot(from);
+        uint64_t bits = words[s >> 6] << (63 - (s & 63));
+        if (bits) {
+            int64_t t = from - __builtin_clzll(bits);
+            return t >= to ? t : NONE;
+        }
+        from -= static_cast<int64_t>(s & 63) + 1;  // last tick of the previous word
+        if (from < to) {
+            break;
+        }
+        size_t w = slot(from) >> 6;
+        uint64_t summaryBits = summary[w >> 6] << (63 - (w & 63));
+        if (summaryBits) {
+            from -= static_cast<int64_t>(__builtin_clzll(summaryBits)) * 64;
+        } else {
+            from -= static_cast<int64_t>((w & 63) + 1) * 64;
+        }
+    }
+    return NONE;
+}
+
+void DeepLadder::recenter(int64_t t) {
+    const int64_t w = static_cast<int64_t>(window);
+    const int64_t headroom = w / 8;
+    const int64_t newLow = isBid ? t + headroom - w + 1 : t - headroom;
+
+    if (levelCount > 0) {
+        recenters++;
+        // ticks of the old window that are not in the new one
+        int64_t first, last;
+        if (newLow > low) {
+            first = low;
+            last = std::min(newLow, low + w);
+        } else {
+            first = std::max(newLow + w, low);
+            last = low + w;
+        }
+        if (last - first >= w) {
+            dropped += levelCount;
+            clear();
+        } else {
+            for (int64_t tick = first; tick < last; tick++) {
+                size_t s = slot(tick);
+                if (test(s)) {
+                    clearBit(s);
+                    quantities[s] = 0;
+                    levelCount--;
+                    dropped++;
+                }
+            }
+        }
+    }
+    low = newLow;
+}
+
+bool DeepLadder::apply(const FixedLevel& level) {
+    if (level.price <= 0 || level.quantity < 0) {
+        return false;
+    }
+    if (level.price % tick != 0) {
+        offGrid++;
+        return false;
+    }
+    const int64_t t = level.price / tick;
+
+    if (!inWindow(t)) {
+        if (level.quantity == 0) {
+            return false;  // never stored
+        }
+        if (levelCount == 0 || isBetter(t, bestTick)) {
+            recenter(t);
+        } else {
+            dropped++;  // deeper than the window
+            return false;
+        }
+    }
+
+    const size_t s = slot(t);
+    if (level.quantity > 0) {
+        if (!test(s)) {
+            setBit(s);
+            levelCount++;
+        }
+        const FixedPoint::Lots previous = quantities[s];
+        quantities[s] = level.quantity;
+        if (levelCount == 1 ? previous == 0 : isBetter(t, bestTick)) {
+            bestTick = t;
+            return true;
+        }
+        return t == bestTick && previous != level.quantity;
+    }
+
+    if (!test(s)) {
+        return false;
+    }
+    clearBit(s);
+    quantities[s] = 0;
+    levelCount--;
+    if (t != bestTick) {
+        return false;
+    }
+    if (levelCount == 0) {
+        bestTick = NONE;
+    } else {
+        bestTick = isBid ? findDown(t - 1, low) : findUp(t + 1, low + static_cast<int64_t>(window));
+    }
+    return true;
+}
+
+DeepOrderBook::DeepOrderBook(ExchangeId exchangeId, TradingPair pair, FixedPoint::Ticks tickSize, size_t windowTicks)
+    : exchangeId(exchangeId), pair(pair),
+      bids(true, tickSize > 0 ? tickSize : defaultTickSize(pair), windowTicks),
+      asks(false, tickSize > 0 ? tickSize : defaultTickSize(pair), windowTicks) {}
+
+FixedPoint::Ticks DeepOrderBook::defaultTickSize(TradingPair pair) {
+    // the pair precision is the coarsest one quoted (Kraken); other exchanges quote up to 10x finer
+    int decimals = std::min(TradingPairData::getPrecision(pair) + 1, FixedPoint::PRICE_DECIMALS);
+    return FixedPoint::pow10(FixedPoint::PRICE_DECIMALS - decimals);
+}
+
+bool DeepOrderBook::update(const std::vector<FixedLevel>& newBids, const std::vector<FixedLevel>& newAsks, bool isCompleteUpdate) {
+    bool changed = false;
+    uint64_t offGrid = 0;
+    {
+        MUTEX_LOCK(mutex);
+        if (isCompleteUpdate) {
+            changed = !bids.empty() || !asks.empty();
+            bids.clear();
+            asks.clear();
+        }
+        uint64_t offGridBefore = bids.getOffGrid() + asks.getOffGrid();
+        for (const auto& bid : newBids) {
+            changed |= bids.apply(bid);
+        }
+        for (const auto& ask : newAsks) {
+            changed |= asks.apply(ask);
+        }
+        offGrid = bids.getOffGrid() + asks.getOffGrid() - offGridBefore;
+    }
+    if (offGrid > 0) {
+        TRACE(pair, ": ", offGrid, " levels off the ", FixedPoint::fromTicks(bids.tickSize()), " tick grid ignored");
+    }
+    return changed;
+}
+
+size_t DeepOrderBook::getBidCount() const {
+    MUTEX_LOCK(mutex);
+    return bids.size();
+}
+
+size_t DeepOrderBook::getAskCount() const {
+    MUTEX_LOCK(mutex);
+    return asks.size();
+}
+
+void DeepOrderBook::trace(std::ostream& os) const {
+    os << "Deep " << pair << " " << bids.size() << "/" << asks.size();
+}
@@ -0,0 +1,130 @@
+#pragma once
+
+#include <vector>
+#include <mutex>
+#include <cstdint>
+#include "orderbook.h"
+#include "tracer.h"
+#include "config.h"
+
+// One side of a deep book, indexed by price: slot = (price / tick) mod W.
+// The ladder covers a window of W ticks next to the touch (most of it on the deep side, W/8 as
+// headroom for the price to move); levels beyond the window are ignored. When the best price
+// leaves the window the window is re-centered and the levels that fall out of it are dropped.
+// Set/delete of a level is O(1); when the best level is deleted the next one is found with a
+// two-level bitmap scan (64 slots per word, 64 words per summary bit word).
+class DeepLadder {
+public:
+    // W is rounded up to a multiple of 4096 ticks (one summary word)
+    DeepLadder(bool isBid, FixedPoint::Ticks tickSize, size_t windowTicks);
+
+    // Set the quantity at a price; quantity 0 deletes. Returns true if the best level changed
+    // (price or quantity). Prices off the tick grid or beyond the window are not stored.
+    bool apply(const FixedLevel& level);
+    void clear();
+
+    bool empty() const { return levelCount == 0; }
+    size_t size() const { return levelCount; }
+    FixedLevel best() const;
+    FixedPoint::Ticks tickSize() const { return tick; }
+
+    // Visit the levels from the best outwards until fn(const FixedLevel&) returns false
+    template <typename Fn>
+    void forEachLevel(Fn&& fn) const {
+        if (levelCount == 0) {
+            return;
+        }
+        int64_t t = bestTick;
+        while (t != NONE) {
+            if (!fn(FixedLevel(t * tick, quantities[slot(t)]))) {
+                return;
+            }
+            t = isBid ? findDown(t - 1, low) : findUp(t + 1, low + static_cast<int64_t>(window));
+        }
+    }
+
+    // Copy the best levels into a top-N ladder
+    template <size_t N>
+    void top(PriceLadder<N>& out, size_t maxDepth = N) const {
+        out.clear();
+        forEachLevel([&](const FixedLevel& level) {
+            return out.size() < maxDepth && out.push_back(level);
+        });
+    }
+
+    // Diagnostics
+    uint64_t getOffGrid() const { return offGrid; }
+    uint64_t getDropped() const { return dropped; }
+    uint64_t getRecenters() const { return recenters; }
+
+private:
+    static constexpr int64_t NONE = INT64_MIN;
+
+    bool isBid;
+    FixedPoint::Ticks tick;
+    size_t window;
+    uint64_t mask;
+    int64_t low = 0;        // first tick index of the window
+    int64_t bestTick = NONE;
+    size_t levelCount = 0;
+
+    std::vector<FixedPoint::Lots> quantities;
+    std::vector<uint64_t> words;    // bit per slot
+    std::vector<uint64_t> summary;  // bit per non-empty word
+
+    uint64_t offGrid = 0;
+    uint64_t dropped = 0;
+    uint64_t recenters = 0;
+
+    size_t slot(int64_t t) const { return static_cast<size_t>(static_cast<uint64_t>(t) & mask); }
+    bool inWindow(int64_t t) const { return t >= low && t < low + static_cast<int64_t>(window); }
+    bool isBetter(int64_t a, int64_t b) const { return isBid ? a > b : a < b; }
+    bool test(size_t s) const { return (words[s >> 6] >> (s & 63)) & 1; }
+    void setBit(size_t s);
+    void clearBit(size_t s);
+
+    // Lowest set tick in [from, to) / highest set tick in [to, from]; NONE if there is none
+    int64_t findUp(int64_t from, int64_t to) const;
+    int64_t findDown(int64_t from, int64_t to) const;
+
+    // Move the window so that tick t is the best level with headroom, dropping what falls out
+    void recenter(int64_t t);
+};
+
+// Full depth book for one exchange and pair (hundreds to thousands of levels).
+// OrderBookManager keeps it behind the regular top-N OrderBook when deep mode is enabled:
+// updates go here first and the top levels are copied into the OrderBook, so all readers of
+// the top of book keep working unchanged.
+class DeepOrderBook : public Traceable {
+public:
+    // tickSize 0 picks a grid 10x finer than the pair's precision
+    DeepOrderBook(ExchangeId exchangeId, TradingPair pair, FixedPoint::Ticks tickSize = 0,
+                  size_t windowTicks = Config::DEEP_ORDERBOOK_WINDOW_TICKS);
+
+    // Apply level changes (quantity 0 deletes); a complete update replaces the book first.
+    // Returns true if the best bid or ask changed.
+    bool update(const std::vector<FixedLevel>& bids, const std::vector<FixedLevel>& asks, bool isCompleteUpdate);
+
+    // Copy the best levels of both sides
+    template <size_t N>
+    void top(PriceLadder<N>& bidsOut, PriceLadder<N>& asksOut, size_t maxDepth = N) const {
+        MUTEX_LOCK(mutex);
+        bids.top(bidsOut, maxDepth);
+        asks.top(asksOut, maxDepth);
+    }
+
+    size_t getBidCount() const;
+    size_t getAskCount() const;
+
+    static FixedPoint::Ticks defaultTickSize(TradingPair pair);
+
+protected:
+    void trace(std::ostream& os) const override;
+
+private:
+    ExchangeId exchangeId;
+    TradingPair pair;
+    DeepLadder bids;
+    DeepLadder asks;
+    mutable std::mutex mutex;
+};
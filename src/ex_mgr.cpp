@@ -1,5 +1,7 @@
 #include "ex_mgr.h"
 #include "tracer.h"
+#include "timers.h"
+#include "orderbook_snapshot.h"
 
 // Define TRACE macro for ExchangeManager
 #define TRACE(...) TRACE_THIS(TraceInstance::EX_MGR, ExchangeId::UNKNOWN, __VA_ARGS__)
@@ -73,3 +75,27 @@ bool ExchangeManager::getOrderBookSnapshots(TradingPair pair) {
   TRACE("Ignored getting order book snapshot for ", pair);
   return true;
 }
+
+bool ExchangeManager::saveOrderBooks(const std::string& path) {
+  return OrderBookSnapshot::save(path, orderBookManager,
+      [this](ExchangeId exchangeId, TradingPair pair) -> int64_t {
+        ApiExchange* api = getExchange(exchangeId);
+        return api ? api->getLastUpdateId(pair) : 0;
+      });
+}
+
+size_t ExchangeManager::loadOrderBooks(const std::string& path) {
+  // the restored books stay provisional until the exchanges send live data after subscribing;
+  // the saved sequence ids are only traced as the subscriptions start with fresh snapshots
+  size_t restored = OrderBookSnapshot::load(path, orderBookManager, Config::ORDERBOOK_SNAPSHOT_MAX_AGE_MS,
+      [this](ExchangeId exchangeId, TradingPair pair, int64_t sequenceId) {
+        TRACE("restored order book ", exchangeId, " ", pair, " at sequence ", sequenceId);
+      });
+  TRACE("restored ", restored, " order books from ", path);
+  return restored;
+}
+
+void ExchangeManager::startOrderBookSnapshotTimer() {
+  timersManager.addTimer(Config::ORDERBOOK_SNAPSHOT_INTERVAL_MS, orderBookSnapshotTimerCallback, this,
+                         TimerType::ORDERBOOK_SNAPSHOT, true);
+}
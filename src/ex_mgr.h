@@ -7,6 +7,7 @@
 #include <memory>
 #include <map>
 #include "tracer.h"
+#include "config.h"
 
 class ExchangeManager : public Traceable {
 public:
@@ -34,6 +35,15 @@ public:
     // Get order book snapshots for all exchanges
     bool getOrderBookSnapshots(TradingPair pair);
 
+    // Save/restore all order books with their sequence ids (orderbook_snapshot.h)
+    bool saveOrderBooks(const std::string& path);
+    size_t loadOrderBooks(const std::string& path);
+    // Save the books periodically while running
+    void startOrderBookSnapshotTimer();
+    static void orderBookSnapshotTimerCallback(int id, void* data) {
+        static_cast<ExchangeManager*>(data)->saveOrderBooks(Config::ORDERBOOK_SNAPSHOT_FILE);
+    }
+
     // For TRACE identification
     const std::vector<ExchangeId>& getExchangeIds() const { return exchangeIds; }
 
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include "types.h"
+
+// First-arrival arbitration between the redundant websocket feeds of one exchange.
+//
+// The feeds carry the same subscriptions, so every update comes in once per feed. Each copy is checked
+// against the last sequence applied for its pair and stream: the first copy is applied, the later ones are
+// dropped. A feed delivers its updates in order, so a sequence below the last applied one was seen. Updates
+// sharing the last sequence are told apart by their tags, all of which are kept until the sequence moves on.
+// Not thread safe: the feeds of an exchange share a strand.
+class FeedArbiter {
+public:
+    enum class Stream : uint8_t {
+        BOOK,  // depth updates
+        TOP,   // best bid/ask
+        COUNT
+    };
+
+    struct Stats {
+        uint64_t applied = 0;
+        uint64_t duplicates = 0;
+        std::vector<uint64_t> wins;  // by feed: copies that came in first on it
+    };
+
+    // With fewer than two feeds every message is applied
+    void setFeeds(size_t count) {
+        feeds = count;
+        reset();
+        stats = Stats{};
+        stats.wins.assign(count, 0);
+    }
+    size_t getFeeds() const { return feeds; }
+
+    // True if this copy is the first to arrive and is to be applied.
+    // tag tells apart different updates sharing a sequence (Kraken timestamps); 0 where sequences are unique.
+    bool firstArrival(TradingPair pair, Stream stream, uint64_t seq, uint64_t tag, size_t feed) {
+        if (feeds < 2) {
+            return true;
+        }
+        Last& last = lastOf(pair, stream);
+        if (last.seen && (seq < last.seq || (seq == last.seq && last.hasTag(tag)))) {
+            stats.duplicates++;
+            return false;
+        }
+        if (!last.seen || seq > last.seq) {
+            last = Last{};
+            last.seq = seq;
+            last.seen = true;
+        }
+        last.addTag(tag);
+        stats.applied++;
+        if (feed < stats.wins.size()) {
+            stats.wins[feed]++;
+        }
+        return true;
+    }
+
+    // Forget the pair, e.g. when a resubscribe restarts its sequence
+    void reset(TradingPair pair) {
+        lasts[static_cast<size_t>(pair)] = {};
+    }
+    void reset() {
+        lasts = {};
+    }
+
+    const Stats& getStats() const { return stats; }
+
+private:
+    // Tags remembered per sequence; beyond that the oldest are forgotten
+    static constexpr size_t TAGS_PER_SEQ = 8;
+
+    struct Last {
+        uint64_t seq = 0;
+        std::array<uint64_t, TAGS_PER_SEQ> tags{};
+        size_t tagCount = 0;  // tags applied at seq, the last TAGS_PER_SEQ of them kept
+        bool seen = false;
+
+        bool hasTag(uint64_t tag) const {
+            const size_t kept = tagCount < TAGS_PER_SEQ ? tagCount : TAGS_PER_SEQ;
+            for (size_t i = 0; i < kept; i++) {
+                if (tags[i] == tag) {
+                    return true;
+                }
+            }
+            return false;
+        }
+        void addTag(uint64_t tag) {
+            tags[tagCount % TAGS_PER_SEQ] = tag;
+            tagCount++;
+        }
+    };
+
+    Last& lastOf(TradingPair pair, Stream stream) {
+        return lasts[static_cast<size_t>(pair)][static_cast<size_t>(stream)];
+    }
+
+    std::array<std::array<Last, static_cast<size_t>(Stream::COUNT)>, static_cast<size_t>(TradingPair::COUNT)> lasts{};
+    size_t feeds = 1;
+    Stats stats;
+};
@@ -0,0 +1,228 @@
+#include "fixed_point.h"
+
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+namespace FixedPoint {
+
+namespace {
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+constexpr bool SWAR_SUPPORTED = true;
+#else
+constexpr bool SWAR_SUPPORTED = false;
+#endif
+
+constexpr uint64_t ASCII_ZEROS = 0x3030303030303030ULL;
+constexpr uint64_t POW10[19] = {
+    1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL, 1000000ULL, 10000000ULL, 100000000ULL,
+    1000000000ULL, 10000000000ULL, 100000000000ULL, 1000000000000ULL, 10000000000000ULL,
+    100000000000000ULL, 1000000000000000ULL, 10000000000000000ULL, 100000000000000000ULL,
+    1000000000000000000ULL};
+
+inline uint64_t load8(const char* p) {
+    uint64_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+// True if all 8 bytes are digit characters
+inline bool allDigits8(uint64_t v) {
+    uint64_t x = v ^ ASCII_ZEROS;  // digits become 0..9
+    // high bit set in every byte that is >= 10
+    return (((x + 0x7676767676767676ULL) | x) & 0x8080808080808080ULL) == 0;
+}
+
+// Value of 8 digit characters (first character in the lowest byte)
+inline uint64_t digits8(uint64_t v) {
+    v -= ASCII_ZEROS;
+    v = (v * 10) + (v >> 8);
+    return (((v & 0x000000FF000000FFULL) * (100 + (1000000ULL << 32))) +
+            (((v >> 16) & 0x000000FF000000FFULL) * (1 + (10000ULL << 32)))) >> 32;
+}
+
+// Accumulates the digit run starting at s[i] into value and advances i past it; returns the
+// number of digits. Eight at a time while they lie inside the string, then one by one.
+inline size_t digitRun(std::string_view s, size_t& i, uint64_t& value) {
+    const size_t start = i;
+    const size_t n = s.size();
+    if (SWAR_SUPPORTED) {
+        while (i + 8 <= n) {
+            uint64_t chunk = load8(s.data() + i);
+            if (!allDigits8(chunk)) {
+                break;
+            }
+            value = value * 100000000ULL + digits8(chunk);
+            i += 8;
+        }
+    }
+    for (; i < n; i++) {
+        unsigned digit = static_cast<unsigned char>(s[i]) - '0';
+        if (digit > 9) {
+            break;
+        }
+        value = value * 10 + digit;
+    }
+    return i - start;
+}
+
+// Plain decimals ("50000.01", "-0.5", "7"): optional sign, digits, optional point and digits.
+// Takes only what it can convert exactly without rounding or overflow checks; false means
+// "not handled here", the general parser decides whether the string is valid.
+bool parsePlainDecimal(std::string_view s, int decimals, int64_t& out) {
+    const size_t n = s.size();
+    // 18 digits always fit into int64 after scaling; longer strings are not worth a look
+    if (n == 0 || n > 20 || decimals < 0 || decimals > 18) {
+        return false;
+    }
+    size_t i = (s[0] == '-' || s[0] == '+') ? 1 : 0;
+    uint64_t value = 0;
+    const size_t intDigits = digitRun(s, i, value);
+    size_t fracDigits = 0;
+    if (i < n && s[i] == '.') {
+        i++;
+        fracDigits = digitRun(s, i, value);
+    }
+    if (i != n || intDigits + fracDigits == 0 || fracDigits > static_cast<size_t>(decimals) ||
+        intDigits + static_cast<size_t>(decimals) > 18) {
+        return false;
+    }
+    value *= POW10[static_cast<size_t>(decimals) - fracDigits];
+    out = s[0] == '-' ? -static_cast<int64_t>(value) : static_cast<int64_t>(value);
+    return true;
+}
+
+} // namespace
+
+bool parseDecimal(std::string_view s, int decimals, int64_t& out) {
+    if (parsePlainDecimal(s, decimals, out)) {
+        return true;
+    }
+    size_t i = 0;
+    const size_t n = s.size();
+    bool negative = false;
+
+    if (i < n && (s[i] == '-' || s[i] == '+')) {
+        negative = s[i] == '-';
+        i++;
+    }
+
+    // collect up to 18 significant digits as an unsigned mantissa and remember where the point was
+    uint64_t mantissa = 0;
+    int fractionDigits = 0;   // digits of the mantissa after the decimal point
+    int extraDigits = 0;      // integer digits that did not fit into the mantissa
+    int firstExtra = -1;      // first digit not kept in the mantissa, used for rounding
+    bool anyDigit = false;
+    bool seenPoint = false;
+
+    for (; i < n; i++) {
+        char c = s[i];
+        if (c >= '0' && c <= '9') {
+            anyDigit = true;
+            if (mantissa < 100000000000000000ULL) {
+                mantissa = mantissa * 10 + static_cast<uint64_t>(c - '0');
+                if (seenPoint) fractionDigits++;
+            } else {
+                if (firstExtra < 0) firstExtra = c - '0';
+                if (!seenPoint) extraDigits++;
+            }
+        } else if (c == '.' && !seenPoint) {
+            seenPoint = true;
+        } else {
+            break;
+        }
+    }
+    if (!anyDigit) {
+        return false;
+    }
+
+    int exponent = 0;
+    if (i < n && (s[i] == 'e' || s[i] == 'E')) {
+        i++;
+        bool negativeExp = false;
+        if (i < n && (s[i] == '-' || s[i] == '+')) {
+            negativeExp = s[i] == '-';
+            i++;
+        }
+        if (i == n) {
+            return false;
+        }
+        for (; i < n && s[i] >= '0' && s[i] <= '9'; i++) {
+            exponent = exponent * 10 + (s[i] - '0');
+            if (exponent > 400) {
+                return false;
+            }
+        }
+        if (negativeExp) exponent = -exponent;
+    }
+    if (i != n) {
+        return false;
+    }
+
+    // value = mantissa * 10^(extraDigits + exponent - fractionDigits); rescale it to 10^-decimals
+    int shift = decimals - fractionDigits + extraDigits + exponent;
+    constexpr uint64_t limit = static_cast<uint64_t>(std::numeric_limits<int64_t>::max());
+    if (mantissa == 0) {
+        out = 0;
+        return true;
+    }
+    if (shift >= 0) {
+        for (int k = 0; k < shift; k++) {
+            if (mantissa > limit / 10) {
+                return false;
+            }
+            mantissa *= 10;
+        }
+        // digits dropped while collecting are below the requested precision only if shift is 0
+        if (shift == 0 && firstExtra >= 5) {
+            mantissa++;
+        }
+    } else if (-shift > 19) {
+        // below half a unit even for the largest mantissa
+        mantissa = 0;
+    } else {
+        // round on the digit right after the kept precision, 0 if the mantissa has no digit there
+        for (int k = 1; k < -shift; k++) {
+            mantissa /= 10;
+        }
+        const int roundDigit = static_cast<int>(mantissa % 10);
+        mantissa /= 10;
+        if (roundDigit >= 5) {
+            mantissa++;
+        }
+    }
+    if (mantissa > limit) {
+        return false;
+    }
+
+    out = negative ? -static_cast<int64_t>(mantissa) : static_cast<int64_t>(mantissa);
+    return true;
+}
+
+bool parseDecimal(std::string_view s, int decimals, int64_t& out, double& value) {
+    if (!parseDecimal(s, decimals, out)) {
+        return false;
+    }
+    // exact integer divided by an exact power of ten: the double nearest to the fixed-point value
+    value = static_cast<double>(out) / static_cast<double>(pow10(decimals));
+    return true;
+}
+
+Ticks parsePrice(std::string_view s) {
+    Ticks ticks;
+    if (!parseDecimal(s, PRICE_DECIMALS, ticks)) {
+        throw std::invalid_argument("Invalid price: " + std::string(s));
+    }
+    return ticks;
+}
+
+Lots parseQty(std::string_view s) {
+    Lots lots;
+    if (!parseDecimal(s, QTY_DECIMALS, lots)) {
+        throw std::invalid_argument("Invalid quantity: " + std::string(s));
+    }
+    return lots;
+}
+
+} // namespace FixedPoint
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstdint>
+#include <cmath>
+#include <string>
+#include <string_view>
+#include "types.h"
+
+// Exact integer representation of prices and quantities.
+//
+// Prices are kept in ticks and quantities in lots, both on a 1e-8 grid. The grid is shared by all
+// pairs: TradingPairInfo::precision is the quoted (Kraken) precision and is coarser than what other
+// exchanges send (e.g. BTC 0.1 vs 0.01 on Binance), so it is used only to render prices at the
+// pair's precision (see toPrecisionUnits) and never to round incoming data.
+// Doubles are produced only at the edges: logging, strategy output and order submission.
+namespace FixedPoint {
+
+using Ticks = int64_t;  // price * 10^PRICE_DECIMALS
+using Lots = int64_t;   // quantity * 10^QTY_DECIMALS
+
+constexpr int PRICE_DECIMALS = 8;
+constexpr int QTY_DECIMALS = 8;
+
+constexpr int64_t pow10(int n) {
+    int64_t result = 1;
+    for (int i = 0; i < n; i++) {
+        result *= 10;
+    }
+    return result;
+}
+
+constexpr int64_t PRICE_SCALE = pow10(PRICE_DECIMALS);
+constexpr int64_t QTY_SCALE = pow10(QTY_DECIMALS);
+
+inline Ticks toTicks(double price) { return std::llround(price * PRICE_SCALE); }
+inline double fromTicks(Ticks ticks) { return static_cast<double>(ticks) / PRICE_SCALE; }
+inline Lots toLots(double quantity) { return std::llround(quantity * QTY_SCALE); }
+inline double fromLots(Lots lots) { return static_cast<double>(lots) / QTY_SCALE; }
+
+// Parse a decimal string ("50000.01", "-1.5", "5.325e-05") into an integer scaled by 10^decimals.
+// Digits beyond the requested decimals are rounded half away from zero.
+// Returns false on malformed input or if the value does not fit into int64.
+// Plain decimals of up to 18 digits, which is what the exchanges send, take a fast path that
+// converts runs of 8 digits at once (SWAR); anything else goes through the general digit loop.
+bool parseDecimal(std::string_view s, int decimals, int64_t& out);
+// Same, also returning the value as a double (the fixed-point value, correctly rounded)
+bool parseDecimal(std::string_view s, int decimals, int64_t& out, double& value);
+
+// Throwing variants for the exchange adapters (same contract as std::stod)
+Ticks parsePrice(std::string_view s);
+Lots parseQty(std::string_view s);
+
+// Price expressed in units of the pair's precision, e.g. BTC 93888.1 -> 938881
+inline int64_t toPrecisionUnits(Ticks ticks, TradingPair pair) {
+    const int64_t divisor = pow10(PRICE_DECIMALS - TradingPairData::getPrecision(pair));
+    return (ticks >= 0 ? ticks + divisor / 2 : ticks - divisor / 2) / divisor;
+}
+
+} // namespace FixedPoint
@@ -0,0 +1,236 @@
+#include "http_client.h"
+
+#include <algorithm>
+#include <future>
+#include <sys/socket.h>
+
+#define TRACE(...) TRACE_THIS(TraceInstance::A_IO, exchangeId, __VA_ARGS__)
+#define DEBUG(...) DEBUG_THIS(TraceInstance::A_IO, exchangeId, __VA_ARGS__)
+#define ERROR(...) ERROR_BASE(TraceInstance::A_IO, exchangeId, __VA_ARGS__)
+
+static HttpOptions withMaxConnections(int maxConnections) {
+    HttpOptions options;
+    options.maxConnections = maxConnections;
+    return options;
+}
+
+HttpClient::HttpClient(ExchangeId exchangeId, int maxConnections)
+    : HttpClient(exchangeId, withMaxConnections(maxConnections)) {}
+
+HttpClient::HttpClient(ExchangeId exchangeId, const HttpOptions& options) : exchangeId(exchangeId), options(options) {
+    static std::once_flag curlInit;
+    std::call_once(curlInit, []() { curl_global_init(CURL_GLOBAL_DEFAULT); });
+
+    multi = curl_multi_init();
+    curl_multi_setopt(multi, CURLMOPT_MAX_HOST_CONNECTIONS, static_cast<long>(options.maxConnections));
+    curl_multi_setopt(multi, CURLMOPT_MAXCONNECTS, static_cast<long>(options.maxConnections));
+    curl_multi_setopt(multi, CURLMOPT_PIPELINING, options.http2 ? CURLPIPE_MULTIPLEX : CURLPIPE_NOTHING);
+
+    // only the client thread uses the handles, so the share needs no locks
+    share = curl_share_init();
+    curl_share_setopt(share, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+    curl_share_setopt(share, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+
+    thread = std::thread([this]() { run(); });
+}
+
+HttpClient::~HttpClient() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    curl_multi_wakeup(multi);
+    if (thread.joinable()) {
+        thread.join();
+    }
+    for (auto& transfer : running) {
+        curl_multi_remove_handle(multi, transfer->easy);
+        curl_easy_cleanup(transfer->easy);
+        curl_slist_free_all(transfer->headers);
+    }
+    for (CURL* easy : idleHandles) {
+        curl_easy_cleanup(easy);
+    }
+    curl_multi_cleanup(multi);
+    curl_share_cleanup(share);
+}
+
+void HttpClient::request(HttpRequest request, Callback done) {
+    auto transfer = std::make_unique<Transfer>();
+    transfer->request = std::move(request);
+    transfer->done = std::move(done);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!stopping) {
+            queued.push_back(std::move(transfer));
+        }
+    }
+    if (transfer) {
+        // the client thread is gone or going, nobody would start it
+        cancel(*transfer);
+        return;
+    }
+    curl_multi_wakeup(multi);
+}
+
+HttpResponse HttpClient::perform(HttpRequest request) {
+    std::promise<HttpResponse> promise;
+    auto future = promise.get_future();
+    this->request(std::move(request), [&promise](HttpResponse& response) { promise.set_value(std::move(response)); });
+    return future.get();
+}
+
+void HttpClient::run() {
+    TRACE("HTTP client thread started");
+    std::deque<std::unique_ptr<Transfer>> starting;
+    while (true) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            starting.swap(queued);
+            if (stopping) {
+                break;
+            }
+        }
+        for (auto& transfer : starting) {
+            start(std::move(transfer));
+        }
+        starting.clear();
+
+        int active = 0;
+        curl_multi_perform(multi, &active);
+        int pending = 0;
+        while (CURLMsg* message = curl_multi_info_read(multi, &pending)) {
+            if (message->msg == CURLMSG_DONE) {
+                finish(message->easy_handle, message->data.result);
+            }
+        }
+        // sleeps until a socket is ready, a timeout is due or request()/~HttpClient wakes us up
+        curl_multi_poll(multi, nullptr, 0, 1000, nullptr);
+    }
+    TRACE("HTTP client thread finished, ", running.size() + starting.size(), " requests cancelled");
+    for (auto& transfer : running) {
+        cancel(*transfer);
+    }
+    for (auto& transfer : starting) {
+        cancel(*transfer);
+    }
+}
+
+void HttpClient::start(std::unique_ptr<Transfer> transfer) {
+    CURL* easy;
+    if (!idleHandles.empty()) {
+        easy = idleHandles.back();
+        idleHandles.pop_back();
+        curl_easy_reset(easy);
+    } else {
+        easy = curl_easy_init();
+    }
+    if (!easy) {
+        ERROR("Failed to initialize CURL");
+        transfer->response.result = CURLE_FAILED_INIT;
+        transfer->response.error = "curl_easy_init() failed";
+        transfer->done(transfer->response);
+        return;
+    }
+    transfer->easy = easy;
+
+    const HttpRequest& request = transfer->request;
+    for (const auto& header : request.headers) {
+        transfer->headers = curl_slist_append(transfer->headers, header.c_str());
+    }
+
+    curl_easy_setopt(easy, CURLOPT_SHARE, share);
+    if (options.http2) {
+        curl_easy_setopt(easy, CURLOPT_HTTP_VERSION, CURL_HTTP_VERSION_2TLS);
+        // wait for a connection that can multiplex rather than open another one
+        curl_easy_setopt(easy, CURLOPT_PIPEWAIT, 1L);
+    } else {
+        curl_easy_setopt(easy, CURLOPT_HTTP_VERSION, CURL_HTTP_VERSION_1_1);
+    }
+    curl_easy_setopt(easy, CURLOPT_URL, request.url.c_str());
+    curl_easy_setopt(easy, CURLOPT_TIMEOUT, 10L);
+    curl_easy_setopt(easy, CURLOPT_CONNECTTIMEOUT, 5L);
+    curl_easy_setopt(easy, CURLOPT_TCP_KEEPALIVE, 1L);
+    curl_easy_setopt(easy, CURLOPT_TCP_NODELAY, 1L);
+    curl_easy_setopt(easy, CURLOPT_DNS_CACHE_TIMEOUT, 60L);
+    curl_easy_setopt(easy, CURLOPT_SSL_VERIFYPEER, options.verifyPeer ? 1L : 0L);
+    curl_easy_setopt(easy, CURLOPT_SSL_VERIFYHOST, options.verifyPeer ? 2L : 0L);
+    if (!options.caFile.empty()) {
+        curl_easy_setopt(easy, CURLOPT_CAINFO, options.caFile.c_str());
+    }
+    curl_easy_setopt(easy, CURLOPT_WRITEFUNCTION, writeBody);
+    curl_easy_setopt(easy, CURLOPT_WRITEDATA, &transfer->response.body);
+    curl_easy_setopt(easy, CURLOPT_HEADERFUNCTION, writeHeader);
+    curl_easy_setopt(easy, CURLOPT_HEADERDATA, &transfer->response.headers);
+    curl_easy_setopt(easy, CURLOPT_OPENSOCKETFUNCTION, openSocket);
+    curl_easy_setopt(easy, CURLOPT_OPENSOCKETDATA, &connectionsOpened);
+    curl_easy_setopt(easy, CURLOPT_HTTPHEADER, transfer->headers);
+
+    if (request.method == "DELETE") {
+        curl_easy_setopt(easy, CURLOPT_CUSTOMREQUEST, "DELETE");
+    } else if (request.method == "POST") {
+        curl_easy_setopt(easy, CURLOPT_POST, 1L);
+        curl_easy_setopt(easy, CURLOPT_POSTFIELDS, request.body.c_str());
+        curl_easy_setopt(easy, CURLOPT_POSTFIELDSIZE, static_cast<long>(request.body.size()));
+    } else {
+        curl_easy_setopt(easy, CURLOPT_HTTPGET, 1L);
+    }
+
+    DEBUG("Starting ", request.method, " ", request.url);
+    curl_multi_add_handle(multi, easy);
+    running.push_back(std::move(transfer));
+}
+
+void HttpClient::finish(CURL* easy, CURLcode result) {
+    auto it = std::find_if(running.begin(), running.end(), [easy](const auto& transfer) { return transfer->easy == easy; });
+    if (it == running.end()) {
+        return;
+    }
+    std::unique_ptr<Transfer> transfer = std::move(*it);
+    running.erase(it);
+
+    curl_multi_remove_handle(multi, easy);
+    transfer->response.result = result;
+    if (result == CURLE_OK) {
+        curl_easy_getinfo(easy, CURLINFO_RESPONSE_CODE, &transfer->response.status);
+    } else {
+        transfer->response.error = curl_easy_strerror(result);
+    }
+    curl_slist_free_all(transfer->headers);
+    transfer->headers = nullptr;
+    idleHandles.push_back(easy);
+
+    DEBUG(transfer->request.method, " ", transfer->request.url, " done: ", transfer->response.status);
+    try {
+        transfer->done(transfer->response);
+    } catch (const std::exception& e) {
+        ERROR("HTTP completion failed: ", e.what());
+    }
+}
+
+void HttpClient::cancel(Transfer& transfer) {
+    transfer.response.result = CURLE_ABORTED_BY_CALLBACK;
+    transfer.response.status = 0;
+    transfer.response.body = "cancelled";
+    transfer.response.error = "cancelled";
+    try {
+        transfer.done(transfer.response);
+    } catch (const std::exception& e) {
+        ERROR("HTTP completion failed: ", e.what());
+    }
+}
+
+size_t HttpClient::writeBody(char* data, size_t size, size_t count, void* userp) {
+    static_cast<std::string*>(userp)->append(data, size * count);
+    return size * count;
+}
+
+size_t HttpClient::writeHeader(char* data, size_t size, size_t count, void* userp) {
+    static_cast<std::string*>(userp)->append(data, size * count);
+    return size * count;
+}
+
+curl_socket_t HttpClient::openSocket(void* clientp, curlsocktype purpose, struct curl_sockaddr* address) {
+    static_cast<std::atomic<uint64_t>*>(clientp)->fetch_add(1, std::memory_order_relaxed);
+    return socket(address->family, address->socktype, address->protocol);
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <curl/curl.h>
+
+#include "tracer.h"
+#include "types.h"
+
+struct HttpRequest {
+    std::string method = "GET";  // GET, POST or DELETE
+    std::string url;
+    std::string body;            // POST fields
+    std::vector<std::string> headers;
+};
+
+struct HttpResponse {
+    CURLcode result = CURLE_OK;
+    long status = 0;
+    std::string body;
+    std::string headers;
+    std::string error;  // set when result is not CURLE_OK
+
+    bool ok() const { return result == CURLE_OK; }
+};
+
+struct HttpOptions {
+    int maxConnections = 4;  // per host
+    // negotiate HTTP/2 over TLS and multiplex requests on one connection, HTTP/1.1 where the server has no h2
+    bool http2 = false;
+    bool verifyPeer = true;
+    std::string caFile;      // trusted certificates, empty for the system store
+};
+
+// Non-blocking HTTP client of one exchange.
+//
+// A curl multi handle driven by a thread of its own: requests are queued from any thread and run
+// concurrently, at most HttpOptions::maxConnections at a time to a host. Connections are kept alive and reused, and
+// new ones resume the TLS sessions of the old. Completions run on the client thread; callers post them
+// wherever they belong. Requests still queued or running when the client is destroyed complete with a "cancelled"
+// error and status 0, so perform() never waits for a response that cannot come.
+class HttpClient : public Traceable {
+public:
+    using Callback = std::function<void(HttpResponse& response)>;
+
+    HttpClient(ExchangeId exchangeId, int maxConnections);
+    HttpClient(ExchangeId exchangeId, const HttpOptions& options);
+    ~HttpClient();
+
+    void request(HttpRequest request, Callback done);
+    // Blocks until the response is in; not from the client thread
+    HttpResponse perform(HttpRequest request);
+
+    // Connections opened since construction; stays low while they are reused
+    uint64_t getConnectionsOpened() const { return connectionsOpened.load(std::memory_order_relaxed); }
+
+protected:
+    void trace(std::ostream& os) const override { os << "http " << exchangeId; }
+
+private:
+    struct Transfer {
+        CURL* easy = nullptr;
+        curl_slist* headers = nullptr;
+        HttpRequest request;
+        HttpResponse response;
+        Callback done;
+    };
+
+    void run();
+    void start(std::unique_ptr<Transfer> transfer);
+    void finish(CURL* easy, CURLcode result);
+    void cancel(Transfer& transfer);
+
+    static size_t writeBody(char* data, size_t size, size_t count, void* userp);
+    static size_t writeHeader(char* data, size_t size, size_t count, void* userp);
+    static curl_socket_t openSocket(void* clientp, curlsocktype purpose, struct curl_sockaddr* address);
+
+    ExchangeId exchangeId;
+    HttpOptions options;
+    CURLM* multi = nullptr;
+    CURLSH* share = nullptr;
+    std::vector<CURL*> idleHandles;  // reset and reused, only touched by the client thread
+    std::vector<std::unique_ptr<Transfer>> running;
+
+    std::mutex mutex;
+    std::deque<std::unique_ptr<Transfer>> queued;
+    bool stopping = false;
+    std::thread thread;
+    std::atomic<uint64_t> connectionsOpened{0};
+};
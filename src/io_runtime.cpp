@@ -0,0 +1,253 @@
+#include "io_runtime.h"
+
+#include <algorithm>
+#include <ctime>
+#include <pthread.h>
+#if defined(__APPLE__)
+#include <mach/mach.h>
+#include <mach/thread_policy.h>
+#endif
+
+#include "config.h"
+#include "timers.h"
+
+#define TRACE(...) TRACE_THIS(TraceInstance::A_IO, ExchangeId::UNKNOWN, __VA_ARGS__)
+#define ERROR(...) ERROR_BASE(TraceInstance::A_IO, ExchangeId::UNKNOWN, __VA_ARGS__)
+
+static_assert(sizeof(Config::IO_EXCHANGE_CPUS) / sizeof(Config::IO_EXCHANGE_CPUS[0]) == static_cast<size_t>(ExchangeId::COUNT),
+              "Config::IO_EXCHANGE_CPUS needs a core for every ExchangeId");
+
+namespace {
+
+uint64_t threadCpuNs() {
+    timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000ULL + static_cast<uint64_t>(ts.tv_nsec);
+}
+
+uint64_t elapsedNs(std::chrono::steady_clock::time_point since) {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - since).count());
+}
+
+} // namespace
+
+IoRuntime::~IoRuntime() {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (auto& context : contexts) {
+        if (context && context->users > 0) {
+            stop(context);
+        }
+    }
+    for (auto& context : retired) {
+        if (context->reaper.joinable()) {
+            context->reaper.join();
+        }
+    }
+}
+
+bool IoRuntime::configure(const IoConfig& newConfig) {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (auto& context : contexts) {
+        if (context && context->users > 0) {
+            ERROR("IO threading can not change while exchanges are connected");
+            return false;
+        }
+    }
+    for (auto& context : contexts) {
+        context.reset();
+    }
+    config = newConfig;
+    if (config.poolThreads < 1) {
+        config.poolThreads = 1;
+    }
+    TRACE("IO threading configured, pool threads: ", config.poolThreads);
+    return true;
+}
+
+std::unique_ptr<IoRuntime::Context>& IoRuntime::slotFor(ExchangeId exchangeId) {
+    const size_t index = config.threading == IoThreading::SHARED_POOL ? 0 : static_cast<size_t>(exchangeId);
+    return contexts[index];
+}
+
+IoRuntime::Context& IoRuntime::contextFor(ExchangeId exchangeId) {
+    auto& context = slotFor(exchangeId);
+    if (!context) {
+        context = std::make_unique<Context>();
+    }
+    return *context;
+}
+
+boost::asio::io_context& IoRuntime::acquire(ExchangeId exchangeId) {
+    std::lock_guard<std::mutex> lock(mutex);
+    Context& context = contextFor(exchangeId);
+    if (context.users++ == 0) {
+        start(context, exchangeId);
+    }
+    return context.ioc;
+}
+
+void IoRuntime::release(ExchangeId exchangeId) {
+    std::lock_guard<std::mutex> lock(mutex);
+    Context& context = contextFor(exchangeId);
+    if (context.users > 0 && --context.users == 0) {
+        stop(slotFor(exchangeId));
+    }
+}
+
+void IoRuntime::start(Context& context, ExchangeId exchangeId) {
+    if (context.ioc.stopped()) {
+        context.ioc.restart();
+    }
+    context.work = std::make_unique<boost::asio::executor_work_guard<boost::asio::io_context::executor_type>>(
+        context.ioc.get_executor());
+
+    const bool shared = config.threading == IoThreading::SHARED_POOL;
+    const int count = shared ? config.poolThreads : 1;
+    for (int i = 0; i < count; i++) {
+        auto thread = std::make_unique<Thread>();
+        thread->name = shared ? "pool-" + std::to_string(i) : std::string(FastTraceLogger::exchangeIdToStr(exchangeId));
+        thread->cpu = shared ? -1 : config.exchangeCpus[static_cast<size_t>(exchangeId)];
+        thread->sampledAt = std::chrono::steady_clock::now();
+        Thread* raw = thread.get();
+        thread->thread = std::thread([this, &context, raw]() { run(context, *raw); });
+        context.threads.push_back(std::move(thread));
+    }
+}
+
+void IoRuntime::stop(std::unique_ptr<Context>& context) {
+    context->work.reset();
+    context->ioc.stop();
+
+    const auto self = std::this_thread::get_id();
+    const bool fromOwnHandler = std::any_of(context->threads.begin(), context->threads.end(),
+        [self](const std::unique_ptr<Thread>& thread) { return thread->thread.get_id() == self; });
+    if (fromOwnHandler) {
+        // Released from one of its own handlers: this thread can not join itself and still uses its
+        // Thread and the context until the handler returns. The context is retired as it is, a helper
+        // thread joins its runners, and the next acquire() starts a fresh one; the stopped context is
+        // never restarted, so its runners can not pick up new handlers.
+        Context* raw = context.get();
+        raw->reaper = std::thread([raw]() {
+            for (auto& thread : raw->threads) {
+                thread->thread.join();
+            }
+        });
+        retired.push_back(std::move(context));
+        return;
+    }
+
+    for (auto& thread : context->threads) {
+        if (thread->thread.joinable()) {
+            thread->thread.join();
+        }
+    }
+    context->threads.clear();
+    context->ioc.restart();
+}
+
+void IoRuntime::run(Context& context, Thread& thread) {
+    if (thread.cpu >= 0) {
+        thread.pinned = pinCurrentThread(thread.cpu);
+        if (!thread.pinned.load()) {
+            ERROR("IO thread ", thread.name, " could not be pinned to core ", thread.cpu);
+        }
+    }
+    TRACE("IO thread ", thread.name, " started", thread.pinned ? " on core " + std::to_string(thread.cpu) : "");
+
+    auto& ioc = context.ioc;
+    while (!ioc.stopped()) {
+        try {
+            if (config.busyPoll) {
+                uint32_t idle = 0;
+                while (!ioc.stopped()) {
+                    const auto start = std::chrono::steady_clock::now();
+                    const size_t count = ioc.poll();
+                    if (count > 0) {
+                        thread.busyNs.fetch_add(elapsedNs(start), std::memory_order_relaxed);
+                        thread.handlers.fetch_add(count, std::memory_order_relaxed);
+                        thread.cpuNs.store(threadCpuNs(), std::memory_order_relaxed);
+                    } else if ((++idle & 1023) == 0) {
+                        thread.cpuNs.store(threadCpuNs(), std::memory_order_relaxed);
+                    }
+                }
+            } else {
+                // a thread blocked in run_one() is off the core, so its cpu time is the time in handlers
+                while (ioc.run_one() > 0) {
+                    const uint64_t cpu = threadCpuNs();
+                    thread.handlers.fetch_add(1, std::memory_order_relaxed);
+                    thread.cpuNs.store(cpu, std::memory_order_relaxed);
+                    thread.busyNs.store(cpu, std::memory_order_relaxed);
+                }
+            }
+        } catch (const std::exception& e) {
+            ERROR("IO thread ", thread.name, " handler failed: ", e.what());
+        }
+    }
+    thread.cpuNs.store(threadCpuNs(), std::memory_order_relaxed);
+    TRACE("IO thread ", thread.name, " finished");
+}
+
+std::vector<IoThreadUsage> IoRuntime::sampleUtilization() {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::vector<IoThreadUsage> usage;
+    const auto now = std::chrono::steady_clock::now();
+    for (auto& context : contexts) {
+        if (!context) {
+            continue;
+        }
+        for (auto& thread : context->threads) {
+            const uint64_t busyNs = thread->busyNs.load(std::memory_order_relaxed);
+            const uint64_t cpuNs = thread->cpuNs.load(std::memory_order_relaxed);
+            const uint64_t handlers = thread->handlers.load(std::memory_order_relaxed);
+            const double wallNs = static_cast<double>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(now - thread->sampledAt).count());
+
+            IoThreadUsage sample;
+            sample.name = thread->name;
+            sample.cpu = thread->pinned ? thread->cpu : -1;
+            if (wallNs > 0) {
+                sample.busy = std::min(1.0, static_cast<double>(busyNs - thread->sampledBusyNs) / wallNs);
+                sample.cpuShare = std::min(1.0, static_cast<double>(cpuNs - thread->sampledCpuNs) / wallNs);
+            }
+            sample.handlers = handlers - thread->sampledHandlers;
+            usage.push_back(sample);
+
+            thread->sampledAt = now;
+            thread->sampledBusyNs = busyNs;
+            thread->sampledCpuNs = cpuNs;
+            thread->sampledHandlers = handlers;
+        }
+    }
+    return usage;
+}
+
+void IoRuntime::traceUtilization() {
+    for (const auto& usage : sampleUtilization()) {
+        TRACE("IO thread ", usage.name, usage.cpu >= 0 ? " core " + std::to_string(usage.cpu) : "",
+              " busy ", std::fixed, std::setprecision(1), usage.busy * 100, "% cpu ", usage.cpuShare * 100,
+              "% handlers ", usage.handlers);
+    }
+}
+
+void IoRuntime::startUtilizationTimer() {
+    timersManager.addTimer(Config::IO_UTILIZATION_TRACE_INTERVAL_MS, utilizationTimerCallback, this,
+                           TimerType::IO_UTILIZATION, true);
+}
+
+bool IoRuntime::pinCurrentThread(int cpu) {
+#if defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#elif defined(__APPLE__)
+    // an affinity tag: a hint to keep the thread apart from others, not supported on Apple silicon
+    thread_affinity_policy_data_t policy = {cpu + 1};
+    return thread_policy_set(pthread_mach_thread_np(pthread_self()), THREAD_AFFINITY_POLICY,
+                             reinterpret_cast<thread_policy_t>(&policy), THREAD_AFFINITY_POLICY_COUNT) == KERN_SUCCESS;
+#else
+    (void)cpu;
+    return false;
+#endif
+}
@@ -0,0 +1,119 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <boost/asio/executor_work_guard.hpp>
+#include <boost/asio/io_context.hpp>
+
+#include "tracer.h"
+#include "types.h"
+
+// How the exchange websockets are driven
+enum class IoThreading {
+    PER_EXCHANGE,  // an io_context and a thread per exchange, optionally pinned to a core
+    SHARED_POOL,   // one io_context run by a pool of threads
+};
+
+struct IoConfig {
+    IoThreading threading = IoThreading::PER_EXCHANGE;
+    int poolThreads = 2;
+    // spin on poll() instead of blocking in run(): lowest wake-up latency, costs a full core per thread
+    bool busyPoll = false;
+    // core for each exchange thread in PER_EXCHANGE mode, by ExchangeId; -1 leaves it to the scheduler
+    std::array<int, static_cast<int>(ExchangeId::COUNT)> exchangeCpus;
+
+    IoConfig() { exchangeCpus.fill(-1); }
+};
+
+// Use of one IO thread between two samples
+struct IoThreadUsage {
+    std::string name;         // exchange, or pool-N
+    int cpu = -1;             // pinned core, -1 if not pinned
+    double busy = 0.0;        // share of the wall time spent running handlers
+    double cpuShare = 0.0;    // share of the wall time on a core (busy-polling threads are always near 1)
+    uint64_t handlers = 0;    // handlers run
+};
+
+// Owns the io_contexts and threads of the exchange websockets.
+// Configure once at startup, before the first exchange connects; an exchange acquires its context on
+// connect and releases it on disconnect. The threads run while a context has users.
+class IoRuntime : public Traceable {
+public:
+    IoRuntime() = default;
+    ~IoRuntime();
+
+    // False if contexts are in use
+    bool configure(const IoConfig& config);
+    const IoConfig& getConfig() const { return config; }
+
+    // The context for the exchange, with its threads running
+    boost::asio::io_context& acquire(ExchangeId exchangeId);
+    // Stops and joins the threads of the context once its last user is gone
+    void release(ExchangeId exchangeId);
+
+    // Per thread use since the previous sample
+    std::vector<IoThreadUsage> sampleUtilization();
+    void traceUtilization();
+    // Trace the utilization every Config::IO_UTILIZATION_TRACE_INTERVAL_MS
+    void startUtilizationTimer();
+    static void utilizationTimerCallback(int id, void* data) {
+        static_cast<IoRuntime*>(data)->traceUtilization();
+    }
+
+    // Pins the calling thread; false where the platform can not
+    static bool pinCurrentThread(int cpu);
+
+protected:
+    void trace(std::ostream& os) const override {
+        os << (config.threading == IoThreading::SHARED_POOL ? "shared" : "per exchange")
+           << (config.busyPoll ? " busy-poll" : "");
+    }
+
+private:
+    struct Thread {
+        std::thread thread;
+        std::string name;
+        int cpu = -1;
+        std::atomic<bool> pinned{false};
+        // written by the thread itself
+        std::atomic<uint64_t> busyNs{0};
+        std::atomic<uint64_t> cpuNs{0};
+        std::atomic<uint64_t> handlers{0};
+        // at the previous sample
+        std::chrono::steady_clock::time_point sampledAt;
+        uint64_t sampledBusyNs = 0;
+        uint64_t sampledCpuNs = 0;
+        uint64_t sampledHandlers = 0;
+    };
+
+    struct Context {
+        boost::asio::io_context ioc;
+        std::unique_ptr<boost::asio::executor_work_guard<boost::asio::io_context::executor_type>> work;
+        std::vector<std::unique_ptr<Thread>> threads;
+        int users = 0;
+        // joins the threads of a context retired by stop() from one of its own handlers
+        std::thread reaper;
+    };
+
+    void start(Context& context, ExchangeId exchangeId);
+    // Retires the context instead of stopping it in place when called from one of its threads
+    void stop(std::unique_ptr<Context>& context);
+    void run(Context& context, Thread& thread);
+    std::unique_ptr<Context>& slotFor(ExchangeId exchangeId);
+    Context& contextFor(ExchangeId exchangeId);
+
+    IoConfig config;
+    std::mutex mutex;
+    // PER_EXCHANGE: by ExchangeId; SHARED_POOL: only the first one
+    std::array<std::unique_ptr<Context>, static_cast<int>(ExchangeId::COUNT)> contexts;
+    // stopped from their own handlers, kept until their threads are joined and the runtime goes
+    std::vector<std::unique_ptr<Context>> retired;
+};
+
+extern IoRuntime ioRuntime;
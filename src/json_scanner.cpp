@@ -0,0 +1,244 @@
+#include "json_scanner.h"
+
+#include <cstring>
+#include <limits>
+
+namespace {
+
+bool isNumberChar(char c) {
+    return (c >= '0' && c <= '9') || c == '-' || c == '+' || c == '.' || c == 'e' || c == 'E';
+}
+
+bool matchLiteral(const char* p, const char* end, const char* literal, size_t length) {
+    return static_cast<size_t>(end - p) >= length && std::memcmp(p, literal, length) == 0;
+}
+
+} // namespace
+
+JsonValue::JsonValue(const char* pos, const char* end) : pos(pos), end(end) {
+    if (pos >= end) {
+        return;
+    }
+    switch (*pos) {
+        case '{': kind = Type::OBJECT; break;
+        case '[': kind = Type::ARRAY; break;
+        case '"': kind = Type::STRING; break;
+        case 't':
+        case 'f': kind = Type::BOOLEAN; break;
+        case 'n': kind = Type::NUL; break;
+        default:
+            if (*pos == '-' || (*pos >= '0' && *pos <= '9')) {
+                kind = Type::NUMBER;
+            }
+            break;
+    }
+}
+
+JsonValue JsonValue::parse(std::string_view frame) {
+    JsonValue root(frame.data(), frame.data() + frame.size());
+    return root.valueAt(root.skipWs(frame.data()));
+}
+
+const char* JsonValue::skipString(const char* p, const char* end) {
+    // p is at the opening quote
+    for (p++; p < end; p++) {
+        if (*p == '"') {
+            return p + 1;
+        }
+        if (*p == '\\') {
+            p++;  // the escaped character can not close the string
+        }
+    }
+    return nullptr;
+}
+
+const char* JsonValue::skipValue(const char* p, const char* end) {
+    if (p >= end) {
+        return nullptr;
+    }
+    switch (*p) {
+        case '"':
+            return skipString(p, end);
+        case '{':
+        case '[': {
+            // brackets only need to balance; strings are skipped whole so their contents do not count
+            int depth = 0;
+            while (p < end) {
+                char c = *p;
+                if (c == '"') {
+                    p = skipString(p, end);
+                    if (!p) {
+                        return nullptr;
+                    }
+                    continue;
+                }
+                if (c == '{' || c == '[') {
+                    depth++;
+                } else if (c == '}' || c == ']') {
+                    if (--depth == 0) {
+                        return p + 1;
+                    }
+                }
+                p++;
+            }
+            return nullptr;
+        }
+        case 't':
+            return matchLiteral(p, end, "true", 4) ? p + 4 : nullptr;
+        case 'f':
+            return matchLiteral(p, end, "false", 5) ? p + 5 : nullptr;
+        case 'n':
+            return matchLiteral(p, end, "null", 4) ? p + 4 : nullptr;
+        default: {
+            const char* start = p;
+            while (p < end && isNumberChar(*p)) {
+                p++;
+            }
+            return p > start ? p : nullptr;
+        }
+    }
+}
+
+std::string_view JsonValue::raw() const {
+    const char* next = valid() ? skipValue(pos, end) : nullptr;
+    return next ? std::string_view(pos, static_cast<size_t>(next - pos)) : std::string_view();
+}
+
+std::string_view JsonValue::str() const {
+    if (kind == Type::STRING) {
+        const char* next = skipString(pos, end);
+        return next ? std::string_view(pos + 1, static_cast<size_t>(next - pos - 2)) : std::string_view();
+    }
+    if (kind == Type::NUMBER || kind == Type::BOOLEAN) {
+        return raw();
+    }
+    return {};
+}
+
+bool JsonValue::getInt(int64_t& out) const {
+    std::string_view s = (kind == Type::STRING || kind == Type::NUMBER) ? str() : std::string_view();
+    if (s.empty()) {
+        return false;
+    }
+    bool negative = s[0] == '-';
+    size_t i = negative ? 1 : 0;
+    if (i == s.size()) {
+        return false;
+    }
+    uint64_t value = 0;
+    const uint64_t limit = static_cast<uint64_t>(std::numeric_limits<int64_t>::max()) + (negative ? 1 : 0);
+    for (; i < s.size(); i++) {
+        unsigned digit = static_cast<unsigned char>(s[i]) - '0';
+        if (digit > 9 || value > (limit - digit) / 10) {
+            return false;
+        }
+        value = value * 10 + digit;
+    }
+    out = negative ? static_cast<int64_t>(0 - value) : static_cast<int64_t>(value);
+    return true;
+}
+
+bool JsonValue::getBool(bool& out) const {
+    std::string_view s = kind == Type::BOOLEAN ? raw() : std::string_view();
+    if (s.empty()) {
+        return false;
+    }
+    out = s == "true";
+    return true;
+}
+
+JsonValue JsonValue::operator[](std::string_view key) const {
+    if (kind != Type::OBJECT) {
+        return {};
+    }
+    const char* p = skipWs(pos + 1);
+    while (p < end && *p == '"') {
+        const char* keyEnd = skipString(p, end);
+        if (!keyEnd) {
+            return {};
+        }
+        std::string_view name(p + 1, static_cast<size_t>(keyEnd - p - 2));
+        p = skipWs(keyEnd);
+        if (p >= end || *p != ':') {
+            return {};
+        }
+        p = skipWs(p + 1);
+        if (name == key) {
+            return valueAt(p);
+        }
+        p = skipValue(p, end);
+        if (!p) {
+            return {};
+        }
+        p = skipWs(p);
+        if (p >= end || *p != ',') {
+            return {};  // '}' or malformed: not found either way
+        }
+        p = skipWs(p + 1);
+    }
+    return {};
+}
+
+JsonValue JsonValue::at(size_t index) const {
+    JsonValue result;
+    size_t i = 0;
+    forEach([&](const JsonValue& element) {
+        if (i++ == index) {
+            result = element;
+            return false;
+        }
+        return true;
+    });
+    return result;
+}
+
+JsonValue JsonValue::find(std::string_view path) const {
+    JsonValue current = *this;
+    while (!path.empty() && current.valid()) {
+        size_t slash = path.find('/');
+        std::string_view segment = path.substr(0, slash);
+        path = slash == std::string_view::npos ? std::string_view() : path.substr(slash + 1);
+
+        size_t index = 0;
+        bool isIndex = current.isArray() && !segment.empty();
+        for (char c : segment) {
+            if (c < '0' || c > '9') {
+                isIndex = false;
+                break;
+            }
+            index = index * 10 + static_cast<size_t>(c - '0');
+        }
+        current = isIndex ? current.at(index) : current[segment];
+    }
+    return current;
+}
+
+size_t JsonValue::size() const {
+    size_t count = 0;
+    if (kind == Type::ARRAY) {
+        forEach([&](const JsonValue&) {
+            count++;
+            return true;
+        });
+    } else if (kind == Type::OBJECT) {
+        const char* p = skipWs(pos + 1);
+        while (p < end && *p == '"') {
+            p = skipString(p, end);
+            p = p ? skipWs(p) : nullptr;
+            if (!p || p >= end || *p != ':') {
+                break;
+            }
+            p = skipValue(skipWs(p + 1), end);
+            if (!p) {
+                break;
+            }
+            count++;
+            p = skipWs(p);
+            if (p >= end || *p != ',') {
+                break;
+            }
+            p = skipWs(p + 1);
+        }
+    }
+    return count;
+}
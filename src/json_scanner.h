@@ -0,0 +1,107 @@
+#pragma once
+
+#include <string_view>
+#include <cstdint>
+#include <cstddef>
+
+// On-demand JSON scanner over a raw frame: no DOM, no allocation.
+//
+// A JsonValue is a position in the frame; navigating to a member or element scans the text
+// from there and skips whatever is not asked for. The frame must outlive the values taken from it.
+// Strings are returned as views of the raw bytes between the quotes, escape sequences are not
+// decoded (exchange symbols, decimals and ids never contain any). Malformed input never reads
+// past the end of the frame; the value that cannot be scanned comes back invalid.
+//
+// Meant for the market data hot path, where the adapters know exactly which fields they need.
+// Control messages keep going through nlohmann::json.
+class JsonValue {
+public:
+    enum class Type : uint8_t { INVALID, OBJECT, ARRAY, STRING, NUMBER, BOOLEAN, NUL };
+
+    JsonValue() = default;
+
+    // Root value of a frame (leading whitespace skipped)
+    static JsonValue parse(std::string_view frame);
+
+    Type type() const { return kind; }
+    bool valid() const { return kind != Type::INVALID; }
+    bool isObject() const { return kind == Type::OBJECT; }
+    bool isArray() const { return kind == Type::ARRAY; }
+    bool isString() const { return kind == Type::STRING; }
+    bool isNumber() const { return kind == Type::NUMBER; }
+    bool isNull() const { return kind == Type::NUL; }
+
+    // String contents without the quotes, or the literal of a number/boolean; empty otherwise
+    std::string_view str() const;
+    // True if this is a string equal to s
+    bool equals(std::string_view s) const { return isString() && str() == s; }
+    // Integer number or string holding one (some exchanges quote their timestamps)
+    bool getInt(int64_t& out) const;
+    bool getBool(bool& out) const;
+
+    // The whole value as it appears in the frame, for traces
+    std::string_view raw() const;
+
+    // Object member by key; invalid if absent or not an object
+    JsonValue operator[](std::string_view key) const;
+    // Array element by index; invalid if out of range or not an array
+    JsonValue at(size_t index) const;
+    // Nested lookup by '/' separated keys and indices, e.g. "data/0/bids"
+    JsonValue find(std::string_view path) const;
+
+    // Number of array elements or object members; 0 for scalars
+    size_t size() const;
+
+    // Visit array elements in order until fn(const JsonValue&) returns false.
+    // Returns false if the array is malformed (or this is not an array).
+    template <typename Fn>
+    bool forEach(Fn&& fn) const {
+        if (kind != Type::ARRAY) {
+            return false;
+        }
+        const char* p = skipWs(pos + 1);
+        if (p < end && *p == ']') {
+            return true;
+        }
+        while (p < end) {
+            JsonValue element = valueAt(p);
+            const char* next = skipValue(p, end);
+            if (!next) {
+                return false;
+            }
+            if (!fn(element)) {
+                return true;
+            }
+            p = skipWs(next);
+            if (p >= end) {
+                return false;
+            }
+            if (*p == ']') {
+                return true;
+            }
+            if (*p != ',') {
+                return false;
+            }
+            p = skipWs(p + 1);
+        }
+        return false;
+    }
+
+private:
+    const char* pos = nullptr;  // first character of the value
+    const char* end = nullptr;  // end of the frame
+    Type kind = Type::INVALID;
+
+    JsonValue(const char* pos, const char* end);
+    JsonValue valueAt(const char* p) const { return JsonValue(p, end); }
+
+    const char* skipWs(const char* p) const {
+        while (p < end && (*p == ' ' || *p == '\n' || *p == '\r' || *p == '\t')) {
+            p++;
+        }
+        return p;
+    }
+    // Position just past the value starting at p, nullptr if it is malformed or truncated
+    static const char* skipValue(const char* p, const char* end);
+    static const char* skipString(const char* p, const char* end);
+};
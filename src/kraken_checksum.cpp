@@ -0,0 +1,50 @@
+#include "kraken_checksum.h"
+
+#include <algorithm>
+#include <charconv>
+#include <zlib.h>
+
+KrakenChecksum::KrakenChecksum(TradingPair pair)
+    : crc(crc32(0L, Z_NULL, 0)),
+      priceDivisor(FixedPoint::pow10(FixedPoint::PRICE_DECIMALS - TradingPairData::getPrecision(pair))) {}
+
+// Zero yields nothing, as Kraken strips leading zeros
+void KrakenChecksum::appendDigits(int64_t value) {
+    if (value <= 0) {
+        return;
+    }
+    auto res = std::to_chars(buffer + length, buffer + BUFFER_SIZE, value);
+    length = static_cast<size_t>(res.ptr - buffer);
+}
+
+void KrakenChecksum::add(const FixedLevel& level) {
+    if (length + 2 * MAX_DIGITS > BUFFER_SIZE) {
+        flush();
+    }
+    // same rounding as FixedPoint::toPrecisionUnits, with the divisor looked up once
+    const int64_t half = priceDivisor / 2;
+    appendDigits((level.price >= 0 ? level.price + half : level.price - half) / priceDivisor);
+    // Kraken quantities have 8 decimals, the same as lots, so the digits are the lots themselves
+    appendDigits(level.quantity);
+}
+
+void KrakenChecksum::flush() {
+    crc = crc32(crc, reinterpret_cast<const Bytef*>(buffer), static_cast<uInt>(length));
+    length = 0;
+}
+
+uint32_t KrakenChecksum::finish() {
+    flush();
+    return static_cast<uint32_t>(crc);
+}
+
+uint32_t KrakenChecksum::of(const std::vector<FixedLevel>& asks, const std::vector<FixedLevel>& bids, TradingPair pair) {
+    KrakenChecksum checksum(pair);
+    for (size_t i = 0; i < std::min(DEPTH, asks.size()); i++) {
+        checksum.add(asks[i]);
+    }
+    for (size_t i = 0; i < std::min(DEPTH, bids.size()); i++) {
+        checksum.add(bids[i]);
+    }
+    return checksum.finish();
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include "orderbook.h"
+#include "types.h"
+
+// Kraken book checksum (https://docs.kraken.com/api/docs/guides/spot-ws-book-v2): CRC32 of the
+// top 10 asks followed by the top 10 bids, each level written as the price and then the quantity
+// with the decimal point and leading zeros removed.
+//
+// The digits come straight from the fixed-point values (price at the pair's precision, quantity as
+// lots) and are written into a stack buffer that is fed to zlib's crc32 as it fills: no strings,
+// no float formatting, cheap enough to check every update.
+class KrakenChecksum {
+public:
+    static constexpr size_t DEPTH = 10;
+
+    explicit KrakenChecksum(TradingPair pair);
+
+    void add(const FixedLevel& level);
+    uint32_t finish();
+
+    // Checksum of a book's current top levels, both sides read under one lock
+    template <typename Book>
+    static uint32_t of(const Book& book, TradingPair pair) {
+        KrakenChecksum checksum(pair);
+        book.forEachTopLevel(DEPTH, [&checksum](const FixedLevel& level) { checksum.add(level); });
+        return checksum.finish();
+    }
+
+    // Checksum of explicit sides, asks first as Kraken orders them
+    static uint32_t of(const std::vector<FixedLevel>& asks, const std::vector<FixedLevel>& bids, TradingPair pair);
+
+private:
+    static constexpr size_t MAX_DIGITS = 19;  // int64
+    static constexpr size_t BUFFER_SIZE = 256;
+
+    char buffer[BUFFER_SIZE];
+    size_t length = 0;
+    unsigned long crc;
+    int64_t priceDivisor;
+
+    void appendDigits(int64_t value);
+    void flush();
+};
@@ -0,0 +1,164 @@
+#include "latency.h"
+
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <sstream>
+
+#include "config.h"
+#include "timers.h"
+
+#define TRACE(...) TRACE_THIS(TraceInstance::A_IO, ExchangeId::UNKNOWN, __VA_ARGS__)
+
+const char* toString(LatencyStage stage) {
+    switch (stage) {
+        case LatencyStage::WIRE: return "wire";
+        case LatencyStage::PARSE: return "parse";
+        case LatencyStage::BOOK: return "book";
+        case LatencyStage::DECISION: return "decision";
+        case LatencyStage::TOTAL: return "total";
+        default: return "unknown";
+    }
+}
+
+int LatencyHistogram::bucketOf(uint64_t ns) {
+    if (ns < SUB_BUCKETS) {
+        return static_cast<int>(ns);
+    }
+    const int msb = 63 - __builtin_clzll(ns);
+    const int sub = static_cast<int>((ns >> (msb - 2)) & (SUB_BUCKETS - 1));
+    return (msb - 1) * SUB_BUCKETS + sub;
+}
+
+uint64_t LatencyHistogram::bucketUpperNs(int bucket) {
+    if (bucket < SUB_BUCKETS) {
+        return static_cast<uint64_t>(bucket);
+    }
+    const int msb = bucket / SUB_BUCKETS + 1;
+    const uint64_t sub = static_cast<uint64_t>(bucket % SUB_BUCKETS);
+    const uint64_t lower = (SUB_BUCKETS + sub) << (msb - 2);
+    return lower + (uint64_t(1) << (msb - 2)) - 1;
+}
+
+uint64_t LatencyHistogram::percentile(double p) const {
+    const uint64_t n = count();
+    if (n == 0) {
+        return 0;
+    }
+    const uint64_t target = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(p / 100.0 * static_cast<double>(n))));
+    uint64_t seen = 0;
+    for (int i = 0; i < BUCKETS; i++) {
+        seen += buckets[i].load(std::memory_order_relaxed);
+        if (seen >= target) {
+            return std::min(bucketUpperNs(i), max());
+        }
+    }
+    return max();
+}
+
+void LatencyHistogram::reset() {
+    for (auto& bucket : buckets) {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+    total.store(0, std::memory_order_relaxed);
+    sumNs.store(0, std::memory_order_relaxed);
+    maxNs.store(0, std::memory_order_relaxed);
+}
+
+namespace {
+
+// The frame being handled on this thread
+struct Frame {
+    ExchangeId exchangeId = ExchangeId::UNKNOWN;
+    int64_t rxNs = 0;
+    int64_t readNs = 0;
+    int64_t parsedNs = 0;
+    int64_t bookNs = 0;
+    bool active = false;
+    bool decided = false;
+};
+
+thread_local Frame frame;
+
+double toUs(uint64_t ns) {
+    return static_cast<double>(ns) / 1000.0;
+}
+
+} // namespace
+
+int64_t LatencyMonitor::nowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+void LatencyMonitor::beginFrame(ExchangeId exchangeId, int64_t rxNs, int64_t readNs) {
+    frame = Frame{};
+    frame.exchangeId = exchangeId;
+    frame.rxNs = rxNs;
+    frame.readNs = readNs;
+    frame.active = static_cast<size_t>(exchangeId) < static_cast<size_t>(ExchangeId::COUNT);
+}
+
+void LatencyMonitor::parsed() {
+    // up to the first book update; the frame's further books are not parsing time
+    if (frame.active && frame.bookNs == 0) {
+        frame.parsedNs = nowNs();
+    }
+}
+
+void LatencyMonitor::bookUpdated() {
+    // the first book a frame updates; the frame's other updates took no time on the wire
+    if (!frame.active || frame.bookNs != 0) {
+        return;
+    }
+    frame.bookNs = nowNs();
+    record(frame.exchangeId, LatencyStage::WIRE, frame.rxNs, frame.readNs);
+    record(frame.exchangeId, LatencyStage::PARSE, frame.readNs, frame.parsedNs);
+    record(frame.exchangeId, LatencyStage::BOOK, frame.parsedNs ? frame.parsedNs : frame.readNs, frame.bookNs);
+}
+
+void LatencyMonitor::decided() {
+    if (!frame.active || frame.bookNs == 0 || frame.decided) {
+        return;
+    }
+    frame.decided = true;
+    const int64_t now = nowNs();
+    record(frame.exchangeId, LatencyStage::DECISION, frame.bookNs, now);
+    record(frame.exchangeId, LatencyStage::TOTAL, frame.rxNs ? frame.rxNs : frame.readNs, now);
+}
+
+void LatencyMonitor::endFrame() {
+    frame.active = false;
+}
+
+void LatencyMonitor::reset() {
+    for (auto& stages : histograms) {
+        for (auto& histogram : stages) {
+            histogram.reset();
+        }
+    }
+}
+
+void LatencyMonitor::traceReport() {
+    for (size_t e = 0; e < histograms.size(); e++) {
+        const auto exchangeId = static_cast<ExchangeId>(e);
+        if (get(exchangeId, LatencyStage::BOOK).count() == 0) {
+            continue;
+        }
+        std::ostringstream os;
+        os << std::fixed << std::setprecision(1);
+        for (size_t s = 0; s < static_cast<size_t>(LatencyStage::COUNT); s++) {
+            const auto stage = static_cast<LatencyStage>(s);
+            const LatencyHistogram& histogram = get(exchangeId, stage);
+            os << (s ? ", " : "") << toString(stage) << " p50 " << toUs(histogram.percentile(50))
+               << " p99 " << toUs(histogram.percentile(99)) << " max " << toUs(histogram.max());
+        }
+        TRACE(exchangeId, " latency us over ", get(exchangeId, LatencyStage::BOOK).count(), " frames: ", os.str());
+    }
+    reset();
+}
+
+void LatencyMonitor::startReportTimer() {
+    timersManager.addTimer(Config::LATENCY_TRACE_INTERVAL_MS, reportTimerCallback, this,
+                           TimerType::LATENCY_REPORT, true);
+}
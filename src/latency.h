@@ -0,0 +1,105 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+#include "tracer.h"
+#include "types.h"
+
+// Stages of a market data frame, from the wire to the strategy
+enum class LatencyStage {
+    WIRE,      // kernel receive -> websocket read completed
+    PARSE,     // read completed -> frame parsed and its fields read, at the entry of OrderBookManager
+    BOOK,      // parsed -> order book updated and published
+    DECISION,  // book published -> strategy decided on it
+    TOTAL,     // kernel receive (or read completed, without a kernel timestamp) -> decision
+    COUNT
+};
+
+const char* toString(LatencyStage stage);
+
+// Lock-free histogram of nanosecond latencies: four buckets per power of two, so a percentile is off by
+// at most a quarter of its value. Any thread records, any thread reads.
+class LatencyHistogram {
+public:
+    static constexpr int SUB_BUCKETS = 4;
+    static constexpr int BUCKETS = 64 * SUB_BUCKETS;
+
+    void record(uint64_t ns) {
+        buckets[bucketOf(ns)].fetch_add(1, std::memory_order_relaxed);
+        total.fetch_add(1, std::memory_order_relaxed);
+        sumNs.fetch_add(ns, std::memory_order_relaxed);
+        uint64_t max = maxNs.load(std::memory_order_relaxed);
+        while (ns > max && !maxNs.compare_exchange_weak(max, ns, std::memory_order_relaxed)) {
+        }
+    }
+
+    uint64_t count() const { return total.load(std::memory_order_relaxed); }
+    uint64_t max() const { return maxNs.load(std::memory_order_relaxed); }
+    uint64_t mean() const {
+        const uint64_t n = count();
+        return n ? sumNs.load(std::memory_order_relaxed) / n : 0;
+    }
+    // Upper bound of the bucket holding the p-th percentile (0..100), 0 when empty
+    uint64_t percentile(double p) const;
+    void reset();
+
+    static int bucketOf(uint64_t ns);
+    static uint64_t bucketUpperNs(int bucket);
+
+private:
+    std::array<std::atomic<uint64_t>, BUCKETS> buckets{};
+    std::atomic<uint64_t> total{0};
+    std::atomic<uint64_t> sumNs{0};
+    std::atomic<uint64_t> maxNs{0};
+};
+
+// Tick-to-decision latency by exchange and stage.
+//
+// The whole chain of a frame runs on the IO thread that read it: ApiExchange::onRead opens a frame with
+// its kernel receive time, and the OrderBookManager (on entry and once the book is published) and the
+// strategy stamp it as it passes. The adapters read their fields lazily, so parsing ends where the
+// update reaches the OrderBookManager.
+// The stamps live in a thread-local frame, so nothing is shared but the histograms. A decision taken on
+// another thread (a scan already running there) is not attributed to the frame.
+class LatencyMonitor : public Traceable {
+public:
+    // Wall clock in nanoseconds, the clock of the kernel receive timestamps
+    static int64_t nowNs();
+
+    // rxNs: kernel receive time, 0 if not known; readNs: websocket read completion
+    void beginFrame(ExchangeId exchangeId, int64_t rxNs, int64_t readNs);
+    void parsed();
+    void bookUpdated();
+    void decided();
+    void endFrame();
+
+    const LatencyHistogram& get(ExchangeId exchangeId, LatencyStage stage) const {
+        return histograms[static_cast<size_t>(exchangeId)][static_cast<size_t>(stage)];
+    }
+    void reset();
+
+    // Percentiles of every exchange with frames since the last report, then starts over
+    void traceReport();
+    // Report every Config::LATENCY_TRACE_INTERVAL_MS
+    void startReportTimer();
+    static void reportTimerCallback(int id, void* data) {
+        static_cast<LatencyMonitor*>(data)->traceReport();
+    }
+
+protected:
+    void trace(std::ostream& os) const override { os << "latency"; }
+
+private:
+    void record(ExchangeId exchangeId, LatencyStage stage, int64_t fromNs, int64_t toNs) {
+        if (fromNs > 0 && toNs >= fromNs) {
+            histograms[static_cast<size_t>(exchangeId)][static_cast<size_t>(stage)].record(static_cast<uint64_t>(toNs - fromNs));
+        }
+    }
+
+    std::array<std::array<LatencyHistogram, static_cast<size_t>(LatencyStage::COUNT)>,
+               static_cast<size_t>(ExchangeId::COUNT)> histograms;
+};
+
+extern LatencyMonitor latencyMonitor;
@@ -13,6 +13,8 @@
 #include "balance.h"
 #include "config.h"
 #include "tracer_timer.h"
+#include "io_runtime.h"
+#include "latency.h"
 using namespace std;
 
 // Define TRACE macro for main
@@ -24,6 +26,8 @@ volatile sig_atomic_t g_running = 1;
 std::atomic<bool> g_shutdown_requested{false};
 
 TimersManager timersManager;
+LatencyMonitor latencyMonitor; // before the IO threads that record into it
+IoRuntime ioRuntime; // before the exchanges: they release their contexts when destroyed
 OrderBookManager orderBookManager;
 OrderManager orderManager;
 ExchangeManager exchangeManager;
@@ -78,6 +82,14 @@ int main() {
     TRACE("Trace types enabled: EVENT_LOOP, TRACES, TIMER, STRAT, BALANCE, ORDERBOOK, A_EXCHANGE, A_IO, A_KRAKEN, A_BINANCE, A_KUCOIN, A_OKX, A_CRYPTO, MAIN");
     TRACE("Exchange logging enabled: BINANCE, KRAKEN, KUCOIN, OKX, CRYPTO");
 
+    // Keep formatting and file writes off the exchange and strategy threads
+    if (Config::TRACE_ASYNC) {
+        if (Config::TRACE_JOURNAL_FILE[0] != '\0' && !FastTraceLogger::setJournalFile(Config::TRACE_JOURNAL_FILE)) {
+            TRACE("Cannot open trace journal ", Config::TRACE_JOURNAL_FILE, ", tracing as text");
+        }
+        FastTraceLogger::startAsync();
+    }
+
     // Set up signal handlers
     TRACE("Setting up signal handlers...");
     signal(SIGINT, signal_handler);
@@ -112,6 +124,22 @@ int main() {
         return 1;
     }
 
+    // Warm start: books from the last run are kept provisionally, out of the strategy view, until live data arrives
+    TRACE("Loading saved order books...");
+    exchangeManager.loadOrderBooks(Config::ORDERBOOK_SNAPSHOT_FILE);
+
+    // IO threads: a pinned thread per exchange or a shared pool
+    IoConfig ioConfig;
+    ioConfig.threading = Config::IO_SHARED_POOL ? IoThreading::SHARED_POOL : IoThreading::PER_EXCHANGE;
+    ioConfig.poolThreads = Config::IO_POOL_THREADS;
+    ioConfig.busyPoll = Config::IO_BUSY_POLL;
+    for (size_t i = 0; i < ioConfig.exchangeCpus.size(); i++) {
+        ioConfig.exchangeCpus[i] = Config::IO_EXCHANGE_CPUS[i];
+    }
+    ioRuntime.configure(ioConfig);
+    ioRuntime.startUtilizationTimer();
+    latencyMonitor.startReportTimer();
+
     // Connect to exchanges
     TRACE("Connecting to exchanges...");
     if (!exchangeManager.connectAll()) {
@@ -145,6 +173,8 @@ int main() {
         strategies.back()->setBalances(balanceManager.getBalances());
     }
 
+    exchangeManager.startOrderBookSnapshotTimer();
+
     TRACE("System initialization complete, starting main loop...");
     
     // Main event loop
@@ -206,7 +236,11 @@ int main() {
     // Final cleanup
     TRACE("Disconnecting from exchanges...");
     exchangeManager.disconnectAll();
+
+    TRACE("Saving order books...");
+    exchangeManager.saveOrderBooks(Config::ORDERBOOK_SNAPSHOT_FILE);
     
     TRACE("Shutting down...");
+    FastTraceLogger::stopAsync();
     return 0;
 }
@@ -0,0 +1,60 @@
+#include "order_session.h"
+
+#include "config.h"
+#include "timers.h"
+
+#define TRACE(...) TRACE_THIS(TraceInstance::A_IO, exchangeId, __VA_ARGS__)
+#define DEBUG(...) DEBUG_THIS(TraceInstance::A_IO, exchangeId, __VA_ARGS__)
+#define ERROR(...) ERROR_BASE(TraceInstance::A_IO, exchangeId, __VA_ARGS__)
+
+OrderSession::OrderSession(ExchangeId exchangeId, std::string pingUrl, const HttpOptions& options)
+    : exchangeId(exchangeId), pingUrl(std::move(pingUrl)), connections(options.maxConnections),
+      client(exchangeId, options) {}
+
+OrderSession::~OrderSession() {
+    stop();
+}
+
+void OrderSession::start() {
+    if (pingTimerId >= 0) {
+        return;
+    }
+    TRACE("Warming up ", connections, " order connections to ", pingUrl);
+    ping();
+    pingTimerId = timersManager.addTimer(Config::ORDER_SESSION_PING_INTERVAL_MS, pingTimerCallback, this,
+                                         TimerType::ORDER_SESSION_PING, true);
+}
+
+void OrderSession::stop() {
+    if (pingTimerId >= 0) {
+        timersManager.stopTimer(pingTimerId);
+        pingTimerId = -1;
+    }
+    warm = false;
+}
+
+void OrderSession::ping() {
+    // concurrent, so HTTP/1.1 opens all the connections; HTTP/2 waits for the first and multiplexes
+    for (int i = 0; i < connections; i++) {
+        HttpRequest request;
+        request.url = pingUrl;
+        client.request(std::move(request), [this](HttpResponse& response) {
+            if (response.ok() && response.status < 500) {
+                pings.fetch_add(1, std::memory_order_relaxed);
+                if (!warm.exchange(true, std::memory_order_relaxed)) {
+                    TRACE("Order connections warm, ", client.getConnectionsOpened(), " opened");
+                }
+            } else {
+                warm = false;
+                ERROR("Order session ping failed: ", response.ok() ? "HTTP " + std::to_string(response.status) : response.error);
+            }
+        });
+    }
+}
+
+void OrderSession::send(HttpRequest request, HttpClient::Callback done) {
+    if (!isWarm()) {
+        DEBUG("Sending on a cold order session: ", request.method, " ", request.url);
+    }
+    client.request(std::move(request), std::move(done));
+}
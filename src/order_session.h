@@ -0,0 +1,49 @@
+#pragma once
+
+#include <atomic>
+#include <string>
+
+#include "http_client.h"
+#include "tracer.h"
+#include "types.h"
+
+// Order-entry connections of one exchange, kept open and warm.
+//
+// start() opens them with pings to a cheap public endpoint, so DNS, TCP and TLS are paid before the first
+// order rather than on it, and a timer repeats the pings every Config::ORDER_SESSION_PING_INTERVAL_MS so
+// neither curl nor the exchange closes them as idle. Where the exchange speaks HTTP/2, orders are
+// multiplexed on a connection; elsewhere each connection carries one order at a time.
+class OrderSession : public Traceable {
+public:
+    // pingUrl: full URL of an endpoint that answers quickly and costs no rate limit weight worth mentioning
+    OrderSession(ExchangeId exchangeId, std::string pingUrl, const HttpOptions& options);
+    ~OrderSession();
+
+    void start();
+    void stop();
+    // One ping per connection
+    void ping();
+
+    void send(HttpRequest request, HttpClient::Callback done);
+
+    // A ping got through since start()
+    bool isWarm() const { return warm.load(std::memory_order_relaxed); }
+    uint64_t getPings() const { return pings.load(std::memory_order_relaxed); }
+    uint64_t getConnectionsOpened() const { return client.getConnectionsOpened(); }
+
+    static void pingTimerCallback(int id, void* data) {
+        static_cast<OrderSession*>(data)->ping();
+    }
+
+protected:
+    void trace(std::ostream& os) const override { os << "order session " << exchangeId; }
+
+private:
+    ExchangeId exchangeId;
+    std::string pingUrl;
+    int connections;
+    int pingTimerId = -1;
+    std::atomic<bool> warm{false};
+    std::atomic<uint64_t> pings{0};
+    HttpClient client;  // last: its thread runs the ping completions until it is joined
+};
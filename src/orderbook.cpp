@@ -9,7 +9,8 @@
 #define NOTICE(...) DEBUG_BASE(TraceInstance::ORDERBOOK, exchangeId, __VA_ARGS__)
 #define ERROR(...) ERROR_BASE(TraceInstance::ORDERBOOK, exchangeId, __VA_ARGS__)
 
-bool OrderBook::hasPricesChanged(const BestPrices& oldPrices, const BestPrices& newPrices) const {
+template <size_t N>
+bool OrderBookT<N>::hasPricesChanged(const BestPrices& oldPrices, const BestPrices& newPrices) const {
     if(oldPrices.bestBid != newPrices.bestBid) {
         NOTICE("changed bestBid: ", oldPrices.bestBid, "->", newPrices.bestBid);
         return true;
@@ -29,30 +30,30 @@ bool OrderBook::hasPricesChanged(const BestPrices& oldPrices, const BestPrices&
     return false;
 }
 
-bool OrderBook::isSorted(const std::vector<PriceLevel>& list, bool isBid) {
-    if (list.empty()) return true;
-    if (isBid) {
-        // sort in descending order
-        return std::is_sorted(list.begin(), list.end(), [](const PriceLevel& a, const PriceLevel& b) { return a.price > b.price; });
-    } else {
-        // sort in ascending order
-        return std::is_sorted(list.begin(), list.end(), [](const PriceLevel& a, const PriceLevel& b) { return a.price < b.price; });
+template <size_t N>
+bool OrderBookT<N>::hasPricesChanged(const BestTicks& oldTicks, const BestTicks& newTicks) const {
+    if(oldTicks.bestBid != newTicks.bestBid) {
+        NOTICE("changed bestBid: ", oldTicks.bestBid, "->", newTicks.bestBid);
+        return true;
     }
-}
-
-void OrderBook::sortList(std::vector<PriceLevel>& list, bool isBid) {
-    if (!OrderBook::isSorted(list, isBid)) {
-        if (isBid) {
-            // sort bids in descending order
-            std::sort(list.begin(), list.end(), [](const PriceLevel& a, const PriceLevel& b) { return a.price > b.price; });
-        } else {
-            // sort asks in ascending order
-            std::sort(list.begin(), list.end(), [](const PriceLevel& a, const PriceLevel& b) { return a.price < b.price; });
-        }
+    if(oldTicks.bestAsk != newTicks.bestAsk) {
+        NOTICE("changed bestAsk: ", oldTicks.bestAsk, "->", newTicks.bestAsk);
+        return true;
+    }
+    if(oldTicks.worstBid != newTicks.worstBid) {
+        NOTICE("changed worstBid: ", oldTicks.worstBid, "->", newTicks.worstBid);
+        return true;
     }
+    if(oldTicks.worstAsk != newTicks.worstAsk) {
+        NOTICE("changed worstAsk: ", oldTicks.worstAsk, "->", newTicks.worstAsk);
+        return true;
+    }
+    return false;
 }
 
-void OrderBook::pushElement(std::vector<PriceLevel>& result, std::vector<PriceLevel>::iterator& it, int scenario) {
+template <size_t N>
+template <typename Result, typename Iterator>
+void OrderBookT<N>::pushElement(Result& result, Iterator& it, int scenario) {
     NOTICE("Pushing element - Price: ", it->price, " Quantity: ", it->quantity, " Scenario: ", scenario);
     if(it->price > 0 && it->quantity > 0) {
         result.push_back(*it);
@@ -60,45 +61,32 @@ void OrderBook::pushElement(std::vector<PriceLevel>& result, std::vector<PriceLe
     it++;
 }
 
-// Helper function to merge sorted lists while maintaining size limit
-void OrderBook::mergeSortedLists(std::vector<PriceLevel>& oldList, std::vector<PriceLevel>& newList, bool isBid) {
-
-    if(newList.empty()) {
-        NOTICE("New list is empty for ", isBid ? "bid" : "ask", ", returning");
-        return;
-    }
-
-    MUTEX_LOCK(mutex);
-
-    std::vector<PriceLevel> result;
-    result.reserve(oldList.size() + newList.size());
-
-    // Sort both lists before merging
-    OrderBook::sortList(oldList, isBid);
-    OrderBook::sortList(newList, isBid);
-
+// Helper function to merge sorted lists
+template <size_t N>
+template <typename OldList, typename NewList, typename Result>
+void OrderBookT<N>::mergeLevels(const OldList& oldList, const NewList& newList, bool isBid, Result& result) {
     auto ito=oldList.begin();
-    auto itn=newList.begin();
-    while((ito != oldList.end() || itn != newList.end())) {
+    auto itn=newList.cbegin();
+    while((ito != oldList.end() || itn != newList.cend())) {
         int scenario = 0;
         bool pushOld = false;
         bool pushNew = false;
 
         NOTICE("Merging - Old it: ", 
             ito == oldList.end() ? "x" : "",
-            ito != oldList.end() ? ito->price : 0.0, "/",
-            ito != oldList.end() ? ito->quantity : 0.0,
+            ito != oldList.end() ? ito->price : 0, "/",
+            ito != oldList.end() ? ito->quantity : 0,
             " New it: ", 
-            itn == newList.end() ? "x" : "",
-            itn != newList.end() ? itn->price : 0.0, "/",
-            itn != newList.end() ? itn->quantity : 0.0);
+            itn == newList.cend() ? "x" : "",
+            itn != newList.cend() ? itn->price : 0, "/",
+            itn != newList.cend() ? itn->quantity : 0);
 
-        if(itn != newList.end() && (itn->price < 0.0 || itn->quantity < 0.0)) {
+        if(itn != newList.cend() && (itn->price < 0 || itn->quantity < 0)) {
             NOTICE("New list has negative price or quantity, skipping: ", itn->price, " ", itn->quantity);
             itn++;
             continue;
         }
-        if(ito != oldList.end() && ito->price == 0.0) {
+        if(ito != oldList.end() && ito->price == 0) {
             NOTICE("Old list has zero price, skipping: ", ito->price, " ", ito->quantity);
             ito++;
             continue;
@@ -107,7 +95,7 @@ void OrderBook::mergeSortedLists(std::vector<PriceLevel>& oldList, std::vector<P
         if(ito == oldList.end()) {
             pushNew = true;
             scenario = 1;
-        } else if(itn == newList.end()) {
+        } else if(itn == newList.cend()) {
             pushOld = true;
             scenario = 2;
         } else if(ito->price == itn->price) {
@@ -145,9 +133,30 @@ void OrderBook::mergeSortedLists(std::vector<PriceLevel>& oldList, std::vector<P
             NOTICE("Pushing - Scenario: ", scenario, " Push old: ", pushOld, " Push new: ", pushNew);
         }
     }
+}
+
+// Merge two vectors while maintaining sort order
+template <size_t N>
+void OrderBookT<N>::mergeSortedLists(std::vector<PriceLevel>& oldList, std::vector<PriceLevel>& newList, bool isBid) {
+
+    if(newList.empty()) {
+        NOTICE("New list is empty for ", isBid ? "bid" : "ask", ", returning");
+        return;
+    }
+
+    MUTEX_LOCK(mutex);
+
+    std::vector<PriceLevel> result;
+    result.reserve(oldList.size() + newList.size());
+
+    // Sort both lists before merging
+    sortList(oldList, isBid);
+    sortList(newList, isBid);
+
+    mergeLevels(oldList, newList, isBid, result);
 
     // Sort the result list
-    OrderBook::sortList(result, isBid);
+    sortList(result, isBid);
 
     oldList = std::move(result);
     // trace belongs to exchange more than to the order book, so use 
@@ -155,8 +164,16 @@ void OrderBook::mergeSortedLists(std::vector<PriceLevel>& oldList, std::vector<P
         isBid ? " bids" : " asks", " ", traceBidsAsks(oldList));
 }
 
-OrderBook::UpdateOutcome OrderBook::update(TradingPair pair, std::vector<PriceLevel>& newBids, std::vector<PriceLevel>& newAsks, bool isCompleteUpdate, int maxDepth) {
-    BestPrices oldPrices = getBestPrices();
+template <size_t N>
+typename OrderBookT<N>::UpdateOutcome OrderBookT<N>::update(TradingPair pair, std::vector<PriceLevel>& newBids, std::vector<PriceLevel>& newAsks, bool isCompleteUpdate, int maxDepth) {
+    std::vector<FixedLevel> fixedBids = toFixedLevels(newBids);
+    std::vector<FixedLevel> fixedAsks = toFixedLevels(newAsks);
+    return update(pair, fixedBids, fixedAsks, isCompleteUpdate, maxDepth);
+}
+
+template <size_t N>
+typename OrderBookT<N>::UpdateOutcome OrderBookT<N>::update(TradingPair pair, std::vector<FixedLevel>& newBids, std::vector<FixedLevel>& newAsks, bool isCompleteUpdate, int maxDepth) {
+    BestTicks oldTicks = getBestTicks();
     bool pricesChanged = false;
     TRACE("OrderBook update - Bids: ", newBids.size(), " Asks: ", newAsks.size(), " Complete update: ", isCompleteUpdate);
     
@@ -172,6 +189,7 @@ OrderBook::UpdateOutcome OrderBook::update(TradingPair pair, std::vector<PriceLe
             // Validate bids are sorted in descending order
             if (!newBids.empty() && newBids.front().price < newBids.back().price) {
                 ERROR(pair, ": Bids are not sorted in descending order");
+                publishTopOfBook();
                 return UpdateOutcome::UPDATE_ERROR;
             }
             
@@ -185,6 +203,7 @@ OrderBook::UpdateOutcome OrderBook::update(TradingPair pair, std::vector<PriceLe
             // Validate asks are sorted in ascending order
             if (!newAsks.empty() && newAsks.front().price > newAsks.back().price) {
                 ERROR(pair, ": Asks are not sorted in ascending order");
+                publishTopOfBook();
                 return UpdateOutcome::UPDATE_ERROR;
             }
             
@@ -197,24 +216,24 @@ OrderBook::UpdateOutcome OrderBook::update(TradingPair pair, std::vector<PriceLe
             
             pricesChanged = true;
         } else {
-            // we don't need MUTEX here and merge requests below will need it
-            
-            // For incremental updates (like Kraken), merge with existing data
-            mergeSortedLists(bids, newBids, true);
-            mergeSortedLists(asks, newAsks, false);
-            bids.resize(std::min(size_t(maxDepth), bids.size()));
-            asks.resize(std::min(size_t(maxDepth), asks.size()));
+            MUTEX_LOCK(mutex);
+
+            // For incremental updates (like Kraken), merge the whole message into each side and
+            // truncate once, as the exchange does: deltas truncated one by one lose levels
+            bids.applyAll(newBids, true, size_t(maxDepth));
+            asks.applyAll(newAsks, false, size_t(maxDepth));
             DEBUG(pair, ": After merge - Bids size: ", bids.size(), " ask size: ", asks.size());
         }
         
-        // Check if prices changed
-        BestPrices newPrices = getBestPrices();
-        pricesChanged = hasPricesChanged(oldPrices, newPrices);
+        // Check if prices changed; exact, as the book holds integers
+        pricesChanged = hasPricesChanged(oldTicks, getBestTicks());
     }
     
     {
         MUTEX_LOCK(mutex);
         lastUpdate = std::chrono::system_clock::now();
+        provisional.store(false, std::memory_order_release);
+        publishTopOfBook();
     }
 
     // Update lastUpdate only if prices changed
@@ -226,57 +245,105 @@ OrderBook::UpdateOutcome OrderBook::update(TradingPair pair, std::vector<PriceLe
     return UpdateOutcome::NO_CHANGES_TO_BEST_PRICES;
 }
 
-OrderBook::UpdateOutcome OrderBook::setBestBidAsk(double bidPrice, double bidQuantity, double askPrice, double askQuantity) {
-    BestPrices oldPrices = getBestPrices();
+template <size_t N>
+typename OrderBookT<N>::UpdateOutcome OrderBookT<N>::replace(const Ladder& newBids, const Ladder& newAsks) {
+    BestTicks oldTicks = getBestTicks();
+    {
+        MUTEX_LOCK(mutex);
+        bids = newBids;
+        asks = newAsks;
+        lastUpdate = std::chrono::system_clock::now();
+        provisional.store(false, std::memory_order_release);
+        publishTopOfBook();
+    }
+    if (hasPricesChanged(oldTicks, getBestTicks())) {
+        TRACE(pair, ": Order book replaced - Best prices changed");
+        return UpdateOutcome::BEST_PRICES_CHANGED;
+    }
+    return UpdateOutcome::NO_CHANGES_TO_BEST_PRICES;
+}
+
+template <size_t N>
+void OrderBookT<N>::restore(const Ladder& savedBids, const Ladder& savedAsks, std::chrono::system_clock::time_point savedUpdate) {
+    {
+        MUTEX_LOCK(mutex);
+        bids = savedBids;
+        asks = savedAsks;
+        lastUpdate = savedUpdate;
+        provisional.store(true, std::memory_order_release);
+        publishTopOfBook();
+    }
+    TRACE(pair, ": Order book restored (provisional) - ", bids.size(), "/", asks.size(), " levels from ", savedUpdate);
+}
+
+template <size_t N>
+typename OrderBookT<N>::UpdateOutcome OrderBookT<N>::applyDelta(const FixedLevel& level, bool isBid) {
+    bool topChanged = false;
+    {
+        MUTEX_LOCK(mutex);
+        topChanged = isBid ? bids.apply(level, true) : asks.apply(level, false);
+        lastUpdate = std::chrono::system_clock::now();
+        provisional.store(false, std::memory_order_release);
+        publishTopOfBook();
+    }
+    DEBUG("applyDelta ", isBid ? "bid " : "ask ", level.price, "@", level.quantity, " top changed: ", topChanged);
+    return topChanged ? UpdateOutcome::BEST_PRICES_CHANGED : UpdateOutcome::NO_CHANGES_TO_BEST_PRICES;
+}
+
+template <size_t N>
+typename OrderBookT<N>::UpdateOutcome OrderBookT<N>::setBestBidAsk(const FixedLevel& bid, const FixedLevel& ask) {
+    BestTicks oldTicks = getBestTicks();
     bool pricesChanged = false;
-    DEBUG("setBestBidAsk - Bid: ", bidPrice, "@", bidQuantity, " Ask: ", askPrice, "@", askQuantity);
+    DEBUG("setBestBidAsk - Bid: ", bid.price, "@", bid.quantity, " Ask: ", ask.price, "@", ask.quantity);
     
     {
         MUTEX_LOCK(mutex);
         
         // Set new best bid if valid
         if (bids.size() == 1) {
-            if (bids[0].price != bidPrice) {
-                bids[0].price = bidPrice;
+            if (bids[0].price != bid.price) {
                 pricesChanged = true;
             }
-            bids[0].quantity = bidQuantity;
-        } else if (bidPrice > 0 && bidQuantity > 0) {
+            bids.set(0, bid);
+        } else if (bid.price > 0 && bid.quantity > 0) {
             bids.clear();
-            bids.push_back(PriceLevel(bidPrice, bidQuantity));
+            bids.push_back(bid);
         }
         
         // Set new best ask if valid
-        if (askPrice > 0 && askQuantity > 0) {
+        if (ask.price > 0 && ask.quantity > 0) {
             if (asks.size() == 1) {
-                if (asks[0].price != askPrice) {
-                    asks[0].price = askPrice;
+                if (asks[0].price != ask.price) {
                     pricesChanged = true;
                 }
-                asks[0].quantity = askQuantity;
+                asks.set(0, ask);
             } else {
                 asks.clear();
-                asks.push_back(PriceLevel(askPrice, askQuantity));
+                asks.push_back(ask);
             }
         }
     }
     
     // these checks will need mutex so do not allocate mutex here
     // Check if prices changed
-    BestPrices newPrices = getBestPrices();
-    pricesChanged = hasPricesChanged(oldPrices, newPrices);
+    pricesChanged = hasPricesChanged(oldTicks, getBestTicks());
     
     {
         MUTEX_LOCK(mutex);
         lastUpdate = std::chrono::system_clock::now();
+        provisional.store(false, std::memory_order_release);
+        publishTopOfBook();
     }
 
     // Update lastUpdate only if prices changed
     if (pricesChanged) {
         
         // no traces under nutex
-        TRACE("setBestBidAsk updated - b/a: ", bidPrice, "@", bidQuantity, " ", askPrice, "@", askQuantity, " u: ", lastUpdate);
+        TRACE("setBestBidAsk updated - b/a: ", PriceLevel(bid).price, "@", PriceLevel(bid).quantity, " ",
+            PriceLevel(ask).price, "@", PriceLevel(ask).quantity, " u: ", lastUpdate);
         return UpdateOutcome::BEST_PRICES_CHANGED;
     }
     return UpdateOutcome::NO_CHANGES_TO_BEST_PRICES;
 }
+
+template class OrderBookT<Config::ORDERBOOK_MAX_DEPTH>;
@@ -2,35 +2,432 @@
 
 #include <string>
 #include <vector>
+#include <array>
 #include <mutex>
 #include <chrono>
 #include <cassert>
+#include <cstdint>
+#include <cmath>
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <type_traits>
 #include "tracer.h"
 #include "types.h"
+#include "config.h"
+#include "fixed_point.h"
 
+struct FixedLevel;
+
+// Price level as exchanged with the outside world (parsed doubles, getters, logging)
 struct PriceLevel {
     double price;
     double quantity;
     PriceLevel(double p = 0.0, double q = 0.0) : price(p), quantity(q) {}
+    PriceLevel(const FixedLevel& level);
+};
+
+// Price level in exact fixed point (see fixed_point.h); this is what the books store and compare
+struct FixedLevel {
+    FixedPoint::Ticks price;
+    FixedPoint::Lots quantity;
+    FixedLevel(FixedPoint::Ticks p = 0, FixedPoint::Lots q = 0) : price(p), quantity(q) {}
+    explicit FixedLevel(const PriceLevel& level)
+        : price(FixedPoint::toTicks(level.price)), quantity(FixedPoint::toLots(level.quantity)) {}
+};
+
+inline PriceLevel::PriceLevel(const FixedLevel& level)
+    : price(FixedPoint::fromTicks(level.price)), quantity(FixedPoint::fromLots(level.quantity)) {}
+
+inline std::vector<FixedLevel> toFixedLevels(const std::vector<PriceLevel>& levels) {
+    std::vector<FixedLevel> result;
+    result.reserve(levels.size());
+    for (const auto& level : levels) {
+        result.emplace_back(level);
+    }
+    return result;
+}
+
+// One side of the book stored inline: a sorted array of N fixed-point levels plus a size.
+// No heap, and each side starts on its own cache line with the levels first, so the best level
+// is on that first line. push_back() drops levels beyond the capacity, which is how merges
+// truncate to N.
+//
+// Next to the levels the ladder keeps cumulative quantity and notional from the top, updated
+// from the first modified level on every change, so depth queries are binary searches.
+// Levels are only modified through the member functions to keep the sums in step.
+// With the sums a side at N=10 is 384 bytes (six lines); Depth is the 168 bytes without them.
+template <size_t N>
+class alignas(64) PriceLadder {
+public:
+    using const_iterator = const FixedLevel*;
+
+    static constexpr size_t capacity() { return N; }
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    bool full() const { return count == N; }
+
+    const FixedLevel& operator[](size_t i) const { return levels[i]; }
+    const FixedLevel& front() const { return levels[0]; }
+    const FixedLevel& back() const { return levels[count - 1]; }
+
+    const_iterator begin() const { return levels.data(); }
+    const_iterator end() const { return levels.data() + count; }
+
+    void clear() { count = 0; }
+
+    // Append at the tail; returns false (and drops the level) when the ladder is full
+    bool push_back(const FixedLevel& level) {
+        if (count == N) {
+            return false;
+        }
+        levels[count++] = level;
+        refreshSums(count - 1);
+        return true;
+    }
+
+    // Overwrite level i in place (caller keeps the order)
+    void set(size_t i, const FixedLevel& level) {
+        levels[i] = level;
+        refreshSums(i);
+    }
+
+    // Shrink to at most n levels
+    void resize(size_t n) {
+        count = static_cast<uint32_t>(std::min(n, size_t(count)));
+    }
+
+    // Apply a single level change in place: quantity 0 removes the price, otherwise the level is
+    // updated or inserted. Binary search plus a shift of the tail; a level pushed past the
+    // capacity is dropped. Returns true if the best level (index 0) changed.
+    bool apply(const FixedLevel& level, bool isBid) {
+        if (level.price <= 0 || level.quantity < 0) {
+            return false;
+        }
+        auto first = levels.begin();
+        auto last = first + count;
+        auto it = isBid
+            ? std::lower_bound(first, last, level.price, [](const FixedLevel& l, FixedPoint::Ticks p) { return l.price > p; })
+            : std::lower_bound(first, last, level.price, [](const FixedLevel& l, FixedPoint::Ticks p) { return l.price < p; });
+        size_t pos = static_cast<size_t>(it - first);
+
+        if (it != last && it->price == level.price) {
+            if (level.quantity == 0) {
+                std::move(it + 1, last, it);
+                count--;
+            } else {
+                it->quantity = level.quantity;
+            }
+            refreshSums(pos);
+            return pos == 0;
+        }
+        if (level.quantity == 0 || pos >= N) {
+            return false;
+        }
+        // shift [pos, tail) one slot right; when full the last level falls off
+        size_t tail = count < N ? count : N - 1;
+        std::move_backward(first + pos, first + tail, first + tail + 1);
+        levels[pos] = level;
+        if (count < N) {
+            count++;
+        }
+        refreshSums(pos);
+        return pos == 0;
+    }
+
+    // Apply all level changes of one message, then truncate once to at most depth levels. An insert
+    // that pushes the worst level out does not lose it if the same message deletes another one, so a
+    // full side stays full. Returns true if the best level (index 0) changed.
+    bool applyAll(const std::vector<FixedLevel>& changes, bool isBid, size_t depth = N) {
+        // room for the levels and every insert of the message; reused, so no allocation once warm
+        static thread_local std::vector<FixedLevel> merged;
+        merged.assign(begin(), end());
+        size_t firstChanged = merged.size();
+        for (const auto& level : changes) {
+            if (level.price <= 0 || level.quantity < 0) {
+                continue;
+            }
+            auto it = isBid
+                ? std::lower_bound(merged.begin(), merged.end(), level.price, [](const FixedLevel& l, FixedPoint::Ticks p) { return l.price > p; })
+                : std::lower_bound(merged.begin(), merged.end(), level.price, [](const FixedLevel& l, FixedPoint::Ticks p) { return l.price < p; });
+            const size_t pos = static_cast<size_t>(it - merged.begin());
+            if (it != merged.end() && it->price == level.price) {
+                if (level.quantity == 0) {
+                    merged.erase(it);
+                } else {
+                    it->quantity = level.quantity;
+                }
+            } else if (level.quantity > 0) {
+                merged.insert(it, level);
+            } else {
+                continue;
+            }
+            firstChanged = std::min(firstChanged, pos);
+        }
+        count = static_cast<uint32_t>(std::min({merged.size(), N, depth}));
+        std::copy(merged.begin(), merged.begin() + count, levels.begin());
+        refreshSums(firstChanged);
+        return firstChanged == 0;
+    }
+
+    // Quantity and notional of the levels [0, i]
+    FixedPoint::Lots cumulativeQuantity(size_t i) const { return cumQty[i]; }
+    double cumulativeNotional(size_t i) const { return cumNotional[i]; }
+    FixedPoint::Lots totalQuantity() const { return count == 0 ? 0 : cumQty[count - 1]; }
+
+    // Result of taking quantity from the top of this side
+    struct Fill {
+        FixedPoint::Lots quantity = 0;   // filled; less than asked if the ladder is too shallow
+        double notional = 0.0;           // in quote currency
+        FixedPoint::Ticks worstPrice = 0; // last level touched, i.e. the limit price needed
+        double vwap() const { return quantity > 0 ? notional / FixedPoint::fromLots(quantity) : 0.0; }
+    };
+
+    // Walk quantity into the ladder; O(log N)
+    Fill fill(FixedPoint::Lots quantity) const {
+        Fill result;
+        if (quantity <= 0 || count == 0) {
+            return result;
+        }
+        // first level where the cumulative quantity covers the request
+        size_t k = static_cast<size_t>(std::lower_bound(cumQty.begin(), cumQty.begin() + count, quantity) - cumQty.begin());
+        if (k == count) {
+            result.quantity = cumQty[count - 1];
+            result.notional = cumNotional[count - 1];
+            result.worstPrice = levels[count - 1].price;
+            return result;
+        }
+        FixedPoint::Lots before = k == 0 ? 0 : cumQty[k - 1];
+        result.quantity = quantity;
+        result.notional = (k == 0 ? 0.0 : cumNotional[k - 1]) +
+            FixedPoint::fromLots(quantity - before) * FixedPoint::fromTicks(levels[k].price);
+        result.worstPrice = levels[k].price;
+        return result;
+    }
+
+    // Quantity offered at limit or better (bids >= limit, asks <= limit); O(log N)
+    FixedPoint::Lots quantityUpToPrice(FixedPoint::Ticks limit, bool isBid) const {
+        auto first = levels.begin();
+        auto it = std::partition_point(first, first + count,
+            [limit, isBid](const FixedLevel& l) { return isBid ? l.price >= limit : l.price <= limit; });
+        size_t k = static_cast<size_t>(it - first);
+        return k == 0 ? 0 : cumQty[k - 1];
+    }
+
+    // Largest quantity that can be bought on asks and sold on bids such that every unit still
+    // clears marginPercent: bid >= ask * (1 + marginPercent / 100) at the levels it is filled at.
+    // Binary search over the ask levels with a bid lookup per probe, O(log^2 N).
+    static FixedPoint::Lots maxSizeAboveMargin(const PriceLadder& asks, const PriceLadder& bids, double marginPercent) {
+        if (asks.empty() || bids.empty()) {
+            return 0;
+        }
+        const double factor = 1.0 + marginPercent / 100;
+        // bid quantity that can be hit against ask level i
+        auto sellable = [&](size_t i) {
+            auto limit = static_cast<FixedPoint::Ticks>(std::ceil(static_cast<double>(asks.levels[i].price) * factor));
+            return bids.quantityUpToPrice(limit, true);
+        };
+        // ask level i is (partly) tradable if the bids cover more than the levels before it;
+        // this holds for a prefix of the ask levels, find its end
+        auto tradable = [&](size_t i) { return sellable(i) > (i == 0 ? 0 : asks.cumQty[i - 1]); };
+        if (!tradable(0)) {
+            return 0;
+        }
+        size_t lo = 0, hi = asks.count;  // tradable(lo), !tradable(hi) or hi == count
+        while (hi - lo > 1) {
+            size_t mid = lo + (hi - lo) / 2;
+            if (tradable(mid)) {
+                lo = mid;
+            } else {
+                hi = mid;
+            }
+        }
+        return std::min(asks.cumQty[lo], sellable(lo));
+    }
+
+    // Copy out as doubles (edge conversion) or as fixed-point levels
+    std::vector<PriceLevel> toVector() const {
+        return std::vector<PriceLevel>(begin(), end());
+    }
+    std::vector<FixedLevel> toFixedVector() const {
+        return std::vector<FixedLevel>(begin(), end());
+    }
+
+    // Just the levels and their number, without the sums; slots past count are zero so two
+    // copies of the same ladder compare equal bytewise
+    struct Depth {
+        std::array<FixedLevel, N> levels{};
+        uint64_t count = 0;
+        bool operator==(const Depth& other) const {
+            return std::memcmp(this, &other, sizeof(Depth)) == 0;
+        }
+        bool operator!=(const Depth& other) const { return !(*this == other); }
+    };
+    Depth depth() const {
+        Depth result;
+        std::copy(begin(), end(), result.levels.begin());
+        result.count = count;
+        return result;
+    }
+    // Inverse of depth(); recomputes the sums
+    static PriceLadder fromDepth(const Depth& depth) {
+        PriceLadder ladder;
+        ladder.count = static_cast<uint32_t>(std::min(depth.count, uint64_t(N)));
+        std::copy(depth.levels.begin(), depth.levels.begin() + ladder.count, ladder.levels.begin());
+        ladder.refreshSums(0);
+        return ladder;
+    }
+
+private:
+    std::array<FixedLevel, N> levels{};
+    uint32_t count = 0;
+    std::array<FixedPoint::Lots, N> cumQty{};
+    std::array<double, N> cumNotional{};  // double: ticks * lots overflows int64 for BTC sized books
+
+    // Recompute the sums of levels [from, count) from the ones before
+    void refreshSums(size_t from) {
+        FixedPoint::Lots quantity = from == 0 ? 0 : cumQty[from - 1];
+        double notional = from == 0 ? 0.0 : cumNotional[from - 1];
+        for (size_t i = from; i < count; i++) {
+            quantity += levels[i].quantity;
+            notional += FixedPoint::fromLots(levels[i].quantity) * FixedPoint::fromTicks(levels[i].price);
+            cumQty[i] = quantity;
+            cumNotional[i] = notional;
+        }
+    }
 };
 
-// Order book for a specific trading pair
-class OrderBook : public Traceable {
+// Consistent snapshot of the best bid/ask of one book. seq is even and grows by 2 on
+// every publish, so it doubles as a cheap version of the book.
+// The fixed-point fields are authoritative; the doubles are derived for logging and orders.
+struct TopOfBook {
+    FixedPoint::Ticks bidTicks = 0;
+    FixedPoint::Ticks askTicks = 0;
+    FixedPoint::Lots bidLots = 0;
+    FixedPoint::Lots askLots = 0;
+    double bestBid = 0.0;
+    double bestAsk = 0.0;
+    double bestBidQuantity = 0.0;
+    double bestAskQuantity = 0.0;
+    std::chrono::system_clock::time_point lastUpdate{};
+    uint64_t seq = 0;
+};
+
+// A trivially copyable value kept as relaxed atomic words, so a seqlock reader may copy it while
+// the writer replaces it
+template <typename T>
+class AtomicWords {
 public:
-    OrderBook() : exchangeId(ExchangeId::UNKNOWN), pair(TradingPair::UNKNOWN) {}
-    OrderBook(ExchangeId exchangeId, TradingPair pair) 
+    void store(const T& value) {
+        uint64_t buffer[WORDS];
+        std::memcpy(buffer, &value, sizeof(T));
+        for (size_t i = 0; i < WORDS; i++) {
+            words[i].store(buffer[i], std::memory_order_relaxed);
+        }
+    }
+    void load(T& value) const {
+        uint64_t buffer[WORDS];
+        for (size_t i = 0; i < WORDS; i++) {
+            buffer[i] = words[i].load(std::memory_order_relaxed);
+        }
+        std::memcpy(&value, buffer, sizeof(T));
+    }
+
+private:
+    static_assert(std::is_trivially_copyable_v<T> && sizeof(T) % sizeof(uint64_t) == 0, "copied as whole words");
+    static constexpr size_t WORDS = sizeof(T) / sizeof(uint64_t);
+    std::array<std::atomic<uint64_t>, WORDS> words{};
+};
+
+// Seqlock around a TopOfBook. There is a single writer (the book, under its mutex);
+// readers never lock and simply retry if they raced with a publish.
+// Fields are relaxed atomics so concurrent reads are well defined, not just benign races.
+// The writer may publish more relaxed atomics under the same sequence (storeMore), for readers
+// that need them consistent with the top (loadMore), like the book's depth.
+class alignas(64) TopOfBookSeqlock {
+public:
+    void store(const FixedLevel& bid, const FixedLevel& ask, std::chrono::system_clock::time_point updated) {
+        store(bid, ask, updated, [] {});
+    }
+    template <typename StoreMore>
+    void store(const FixedLevel& bid, const FixedLevel& ask, std::chrono::system_clock::time_point updated, StoreMore&& storeMore) {
+        uint64_t s = seq.load(std::memory_order_relaxed);
+        seq.store(s + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        bidTicks.store(bid.price, std::memory_order_relaxed);
+        askTicks.store(ask.price, std::memory_order_relaxed);
+        bidLots.store(bid.quantity, std::memory_order_relaxed);
+        askLots.store(ask.quantity, std::memory_order_relaxed);
+        lastUpdate.store(updated.time_since_epoch().count(), std::memory_order_relaxed);
+        storeMore();
+        seq.store(s + 2, std::memory_order_release);
+    }
+
+    TopOfBook load() const {
+        return load([] {});
+    }
+    template <typename LoadMore>
+    TopOfBook load(LoadMore&& loadMore) const {
+        TopOfBook tob;
+        uint64_t before, after;
+        do {
+            before = seq.load(std::memory_order_acquire);
+            tob.bidTicks = bidTicks.load(std::memory_order_relaxed);
+            tob.askTicks = askTicks.load(std::memory_order_relaxed);
+            tob.bidLots = bidLots.load(std::memory_order_relaxed);
+            tob.askLots = askLots.load(std::memory_order_relaxed);
+            tob.lastUpdate = std::chrono::system_clock::time_point(
+                std::chrono::system_clock::duration(lastUpdate.load(std::memory_order_relaxed)));
+            loadMore();
+            std::atomic_thread_fence(std::memory_order_acquire);
+            after = seq.load(std::memory_order_relaxed);
+        } while (before != after || (before & 1));
+        tob.seq = before;
+        tob.bestBid = FixedPoint::fromTicks(tob.bidTicks);
+        tob.bestAsk = FixedPoint::fromTicks(tob.askTicks);
+        tob.bestBidQuantity = FixedPoint::fromLots(tob.bidLots);
+        tob.bestAskQuantity = FixedPoint::fromLots(tob.askLots);
+        return tob;
+    }
+
+    // Number of publishes so far
+    uint64_t version() const {
+        return seq.load(std::memory_order_acquire) >> 1;
+    }
+
+private:
+    std::atomic<uint64_t> seq{0};
+    std::atomic<FixedPoint::Ticks> bidTicks{0};
+    std::atomic<FixedPoint::Ticks> askTicks{0};
+    std::atomic<FixedPoint::Lots> bidLots{0};
+    std::atomic<FixedPoint::Lots> askLots{0};
+    std::atomic<std::chrono::system_clock::rep> lastUpdate{0};
+};
+
+// Order book for a specific trading pair, holding at most N levels per side.
+// Member functions live in orderbook.cpp and are instantiated there for the depths in use.
+template <size_t N>
+class OrderBookT : public Traceable {
+public:
+    using Ladder = PriceLadder<N>;
+    static constexpr size_t MAX_DEPTH = N;
+
+    OrderBookT() : exchangeId(ExchangeId::UNKNOWN), pair(TradingPair::UNKNOWN) {}
+    OrderBookT(ExchangeId exchangeId, TradingPair pair)
         : exchangeId(exchangeId), pair(pair) {}
-    
+
     // Copy constructor
-    OrderBook(const OrderBook& other) 
+    OrderBookT(const OrderBookT& other)
         : exchangeId(other.exchangeId), pair(other.pair), lastUpdate(other.lastUpdate) {
         MUTEX_LOCK(other.mutex);
         bids = other.bids;
         asks = other.asks;
+        provisional.store(other.provisional.load());
+        publishTopOfBook();
     }
-    
+
     // Assignment operator
-    OrderBook& operator=(const OrderBook& other) {
+    OrderBookT& operator=(const OrderBookT& other) {
         if (this != &other) {
             MUTEX_LOCK(mutex);
             MUTEX_LOCK(other.mutex);
@@ -39,11 +436,13 @@ public:
             bids = other.bids;
             asks = other.asks;
             lastUpdate = other.lastUpdate;
+            provisional.store(other.provisional.load());
+            publishTopOfBook();
         }
         return *this;
     }
-    
-    ~OrderBook() = default;
+
+    ~OrderBookT() = default;
 
     enum class UpdateOutcome {
         BEST_PRICES_CHANGED,
@@ -52,60 +451,86 @@ public:
     };
 
     // Update the order book with new price levels (assumes sorted input)
+    UpdateOutcome update(TradingPair pair,
+                        std::vector<FixedLevel>& newBids,
+                        std::vector<FixedLevel>& newAsks,
+                        bool isCompleteUpdate = false, int maxDepth = N);
+
+    // Same with double levels; they are converted to fixed point first
     UpdateOutcome update(TradingPair pair,
                         std::vector<PriceLevel>& newBids,
                         std::vector<PriceLevel>& newAsks,
-                        bool isCompleteUpdate = false, int maxDepth = 10);
+                        bool isCompleteUpdate = false, int maxDepth = N);
+
+    // Replace both sides with ready-made ladders (e.g. the top of a DeepOrderBook)
+    UpdateOutcome replace(const Ladder& newBids, const Ladder& newAsks);
+
+    // Load saved levels on a warm restart; the book is provisional until the next live update
+    void restore(const Ladder& savedBids, const Ladder& savedAsks, std::chrono::system_clock::time_point savedUpdate);
+
+    // True while the book holds data not confirmed by the exchange: restored, or kept over an outage; lock-free
+    bool isProvisional() const { return provisional.load(std::memory_order_acquire); }
+
+    // The exchange went dark: the levels stay, provisional until the next live update.
+    // OrderBookManager::markStale() also takes the book out of the strategy view.
+    void markStale() { provisional.store(true, std::memory_order_release); }
+
+    // Apply a single level change (quantity 0 deletes) in place.
+    // Reports BEST_PRICES_CHANGED only when the best level of that side changed.
+    UpdateOutcome applyDelta(const FixedLevel& level, bool isBid);
 
     // Set best bid and ask prices directly (for bookTicker style updates)
-    UpdateOutcome setBestBidAsk(double bidPrice, double bidQuantity, double askPrice, double askQuantity);
+    UpdateOutcome setBestBidAsk(const FixedLevel& bid, const FixedLevel& ask);
+    UpdateOutcome setBestBidAsk(double bidPrice, double bidQuantity, double askPrice, double askQuantity) {
+        return setBestBidAsk(FixedLevel(PriceLevel(bidPrice, bidQuantity)), FixedLevel(PriceLevel(askPrice, askQuantity)));
+    }
 
     // Get best bid price
     double getBestBid() const {
         MUTEX_LOCK(mutex);
-        return bids.empty() ? 0.0 : bids[0].price;
+        return bids.empty() ? 0.0 : FixedPoint::fromTicks(bids[0].price);
     }
 
     // Get best ask price
     double getBestAsk() const {
         MUTEX_LOCK(mutex);
-        return asks.empty() ? 0.0 : asks[0].price;
+        return asks.empty() ? 0.0 : FixedPoint::fromTicks(asks[0].price);
     }
 
     // Get worst bid price (lowest)
     double getWorstBid() const {
         MUTEX_LOCK(mutex);
-        return bids.empty() ? 0.0 : bids.back().price;
+        return bids.empty() ? 0.0 : FixedPoint::fromTicks(bids.back().price);
     }
 
     // Get worst ask price (highest)
     double getWorstAsk() const {
         MUTEX_LOCK(mutex);
-        return asks.empty() ? 0.0 : asks.back().price;
+        return asks.empty() ? 0.0 : FixedPoint::fromTicks(asks.back().price);
     }
 
     // Get bid quantity at best price
     double getBestBidQuantity() const {
         MUTEX_LOCK(mutex);
-        return bids.empty() ? 0.0 : bids[0].quantity;
+        return bids.empty() ? 0.0 : FixedPoint::fromLots(bids[0].quantity);
     }
 
     // Get ask quantity at best price
     double getBestAskQuantity() const {
         MUTEX_LOCK(mutex);
-        return asks.empty() ? 0.0 : asks[0].quantity;
+        return asks.empty() ? 0.0 : FixedPoint::fromLots(asks[0].quantity);
     }
 
     // Get bid quantity at worst price
     double getWorstBidQuantity() const {
         MUTEX_LOCK(mutex);
-        return bids.empty() ? 0.0 : bids.back().quantity;
+        return bids.empty() ? 0.0 : FixedPoint::fromLots(bids.back().quantity);
     }
 
     // Get ask quantity at worst price
     double getWorstAskQuantity() const {
         MUTEX_LOCK(mutex);
-        return asks.empty() ? 0.0 : asks.back().quantity;
+        return asks.empty() ? 0.0 : FixedPoint::fromLots(asks.back().quantity);
     }
 
     // Get best prices and quantities atomically
@@ -130,14 +555,14 @@ public:
     BestPrices getBestPrices() const {
         MUTEX_LOCK(mutex);
         BestPrices bp =  BestPrices(
-            bids.empty() ? 0.0 : bids[0].price,
-            asks.empty() ? 0.0 : asks[0].price,
-            bids.empty() ? 0.0 : bids.back().price,
-            asks.empty() ? 0.0 : asks.back().price,
-            bids.empty() ? 0.0 : bids[0].quantity,
-            asks.empty() ? 0.0 : asks[0].quantity,
-            bids.empty() ? 0.0 : bids.back().quantity,
-            asks.empty() ? 0.0 : asks.back().quantity);
+            bids.empty() ? 0.0 : FixedPoint::fromTicks(bids[0].price),
+            asks.empty() ? 0.0 : FixedPoint::fromTicks(asks[0].price),
+            bids.empty() ? 0.0 : FixedPoint::fromTicks(bids.back().price),
+            asks.empty() ? 0.0 : FixedPoint::fromTicks(asks.back().price),
+            bids.empty() ? 0.0 : FixedPoint::fromLots(bids[0].quantity),
+            asks.empty() ? 0.0 : FixedPoint::fromLots(asks[0].quantity),
+            bids.empty() ? 0.0 : FixedPoint::fromLots(bids.back().quantity),
+            asks.empty() ? 0.0 : FixedPoint::fromLots(asks.back().quantity));
         return bp;
     }
 
@@ -151,33 +576,110 @@ public:
     OrderBookData getOrderBookData() const {
         MUTEX_LOCK(mutex);
         return OrderBookData{
-            bids.empty() ? 0.0 : bids[0].price,
-            asks.empty() ? 0.0 : asks[0].price,
-            bids.empty() ? 0.0 : bids[0].quantity,
-            asks.empty() ? 0.0 : asks[0].quantity,
+            bids.empty() ? 0.0 : FixedPoint::fromTicks(bids[0].price),
+            asks.empty() ? 0.0 : FixedPoint::fromTicks(asks[0].price),
+            bids.empty() ? 0.0 : FixedPoint::fromLots(bids[0].quantity),
+            asks.empty() ? 0.0 : FixedPoint::fromLots(asks[0].quantity),
             lastUpdate
         };
     }
-    
+
+    // Lock-free read of the best bid/ask; safe to call from any thread while the book updates
+    TopOfBook getTopOfBook() const {
+        return topOfBook.load();
+    }
+
+    // Monotonic version of the book, bumped by every applied update; lock-free
+    uint64_t getVersion() const {
+        return topOfBook.version();
+    }
+
     // Get a copy of the current state atomically
     std::pair<std::vector<PriceLevel>, std::vector<PriceLevel>> getState() const {
         MUTEX_LOCK(mutex);
         // assert that bids and asks are sorted
         assert(isSorted(bids, true));
         assert(isSorted(asks, false));
-        return {bids, asks};
+        return {bids.toVector(), asks.toVector()};
     }
-    
+
     // Get a copy of current bids atomically
-    std::vector<PriceLevel> getBids() const { 
+    std::vector<PriceLevel> getBids() const {
         MUTEX_LOCK(mutex);
-        return bids; 
+        return bids.toVector();
     }
 
     // Get a copy of current asks atomically
-    std::vector<PriceLevel> getAsks() const { 
+    std::vector<PriceLevel> getAsks() const {
         MUTEX_LOCK(mutex);
-        return asks; 
+        return asks.toVector();
+    }
+
+    // Fixed-point copies of the sides, for exact consumers like the Kraken checksum
+    std::vector<FixedLevel> getBidLevels() const {
+        MUTEX_LOCK(mutex);
+        return bids.toFixedVector();
+    }
+    std::vector<FixedLevel> getAskLevels() const {
+        MUTEX_LOCK(mutex);
+        return asks.toFixedVector();
+    }
+    // Visit the best `depth` levels of one side under the book mutex, without copying the side.
+    // fn(const FixedLevel&) must not call back into the book.
+    template <typename Fn>
+    void forEachLevel(bool isBid, size_t depth, Fn&& fn) const {
+        MUTEX_LOCK(mutex);
+        const Ladder& side = isBid ? bids : asks;
+        const size_t count = std::min(depth, side.size());
+        for (size_t i = 0; i < count; i++) {
+            fn(side[i]);
+        }
+    }
+    // The best `depth` asks and then the best `depth` bids, both under one hold of the mutex: one state of the book
+    template <typename Fn>
+    void forEachTopLevel(size_t depth, Fn&& fn) const {
+        MUTEX_LOCK(mutex);
+        for (const Ladder* side : {&asks, &bids}) {
+            const size_t count = std::min(depth, side->size());
+            for (size_t i = 0; i < count; i++) {
+                fn((*side)[i]);
+            }
+        }
+    }
+
+    // Depth queries on the cached prefix sums; O(log N) under the book mutex
+    typename Ladder::Fill fillEstimate(FixedPoint::Lots quantity, bool isBid) const {
+        MUTEX_LOCK(mutex);
+        return isBid ? bids.fill(quantity) : asks.fill(quantity);
+    }
+    FixedPoint::Lots quantityUpToPrice(FixedPoint::Ticks limit, bool isBid) const {
+        MUTEX_LOCK(mutex);
+        return isBid ? bids.quantityUpToPrice(limit, true) : asks.quantityUpToPrice(limit, false);
+    }
+    // VWAP of taking quantity (base currency) from one side; 0 if the visible depth is not enough
+    double vwapToFill(double quantity, bool isBid) const {
+        auto fill = fillEstimate(FixedPoint::toLots(quantity), isBid);
+        return fill.quantity == FixedPoint::toLots(quantity) ? fill.vwap() : 0.0;
+    }
+
+    // Copy of one side with its sums, for queries combining several books without holding their locks
+    Ladder getLadder(bool isBid) const {
+        MUTEX_LOCK(mutex);
+        return isBid ? bids : asks;
+    }
+    // Copy of both sides (bids, asks) from one state of the book
+    std::pair<Ladder, Ladder> getLadders() const {
+        MUTEX_LOCK(mutex);
+        return {bids, asks};
+    }
+
+    // Lock-free copy of one side with its sums and the top of book of the same publish; for the
+    // strategy hot path, which must not take the book mutex
+    TopOfBook getDepthSnapshot(bool isBid, Ladder& side) const {
+        typename Ladder::Depth depth;
+        const TopOfBook top = topOfBook.load([&] { (isBid ? bidDepth : askDepth).load(depth); });
+        side = Ladder::fromDepth(depth);
+        return top;
     }
 
     // For TRACE identification
@@ -187,22 +689,47 @@ public:
     // Helper function to check if best/worst prices changed
     bool hasPricesChanged(const BestPrices& oldPrices, const BestPrices& newPrices) const;
 
-    static bool isSorted(const std::vector<PriceLevel>& list, bool isBid);
-    static void sortList(std::vector<PriceLevel>& list, bool isBid);
+    template <typename List>
+    static bool isSorted(const List& list, bool isBid) {
+        if (list.empty()) return true;
+        if (isBid) {
+            // sort in descending order
+            return std::is_sorted(list.begin(), list.end(), [](const auto& a, const auto& b) { return a.price > b.price; });
+        } else {
+            // sort in ascending order
+            return std::is_sorted(list.begin(), list.end(), [](const auto& a, const auto& b) { return a.price < b.price; });
+        }
+    }
+    template <typename List>
+    static void sortList(List& list, bool isBid) {
+        if (!isSorted(list, isBid)) {
+            using Level = typename List::value_type;
+            if (isBid) {
+                // sort bids in descending order
+                std::sort(list.begin(), list.end(), [](const Level& a, const Level& b) { return a.price > b.price; });
+            } else {
+                // sort asks in ascending order
+                std::sort(list.begin(), list.end(), [](const Level& a, const Level& b) { return a.price < b.price; });
+            }
+        }
+    }
 
+    // Merge newList into oldList (both vectors); kept for callers working on plain level lists
     void mergeSortedLists(std::vector<PriceLevel>& oldList, std::vector<PriceLevel>& newList, bool isBid);
 
     void trace(std::ostream& os) const override {
         os << pair << " " << bids.size() << "/" << asks.size() << " " << std::fixed << std::setprecision(3) <<
             getBestPrices() << "u: " << (lastUpdate);
     }
-    std::string traceBidsAsks(std::vector<PriceLevel>& list) const {
+    template <typename List>
+    std::string traceBidsAsks(const List& list) const {
         std::stringstream ss;
         auto precision = TradingPairData::getPrecision(pair);
         ss << std::fixed;
         ss << "[";
         for(const auto& entry : list) {
-            ss << std::setprecision(precision) << entry.price << "/" << std::setprecision(8) << entry.quantity << " ";
+            const PriceLevel level(entry);
+            ss << std::setprecision(precision) << level.price << "/" << std::setprecision(8) << level.quantity << " ";
         }
         ss << "]";
         return ss.str();
@@ -211,14 +738,68 @@ public:
 protected:
 
 private:
-    std::vector<PriceLevel> bids;
-    std::vector<PriceLevel> asks;
+    Ladder bids;
+    Ladder asks;
     mutable std::mutex mutex;
     ExchangeId exchangeId;
     TradingPair pair;
 
     // lastUpdate is the timestamp of the last update; not the "u" field in the exchange upadate message
     std::chrono::system_clock::time_point lastUpdate = std::chrono::system_clock::now();
+    // set by restore(), cleared by any live update
+    std::atomic<bool> provisional{false};
 
-    void pushElement(std::vector<PriceLevel>& result, std::vector<PriceLevel>::iterator& it, int scenario);
+    // Best bid/ask and the levels of both sides mirrored for lock-free readers, under one sequence;
+    // written only under mutex. The mirrors leave out the sums (readers rebuild them) and a side is
+    // only stored again when its levels changed, so a publish that moved one side, or just the
+    // timestamp, does not rewrite the words of the other.
+    TopOfBookSeqlock topOfBook;
+    AtomicWords<typename Ladder::Depth> bidDepth;
+    AtomicWords<typename Ladder::Depth> askDepth;
+    typename Ladder::Depth publishedBids;
+    typename Ladder::Depth publishedAsks;
+    void publishTopOfBook() {
+        const auto bidLevels = bids.depth();
+        const auto askLevels = asks.depth();
+        const bool bidsChanged = bidLevels != publishedBids;
+        const bool asksChanged = askLevels != publishedAsks;
+        topOfBook.store(bids.empty() ? FixedLevel() : bids[0], asks.empty() ? FixedLevel() : asks[0], lastUpdate, [&] {
+            if (bidsChanged) {
+                bidDepth.store(bidLevels);
+            }
+            if (asksChanged) {
+                askDepth.store(askLevels);
+            }
+        });
+        if (bidsChanged) {
+            publishedBids = bidLevels;
+        }
+        if (asksChanged) {
+            publishedAsks = askLevels;
+        }
+    }
+
+    // Merge a sorted update into a sorted list
+    template <typename OldList, typename NewList, typename Result>
+    void mergeLevels(const OldList& oldList, const NewList& newList, bool isBid, Result& result);
+
+    // Best/worst prices in ticks, for exact change detection
+    struct BestTicks {
+        FixedPoint::Ticks bestBid, bestAsk, worstBid, worstAsk;
+    };
+    BestTicks getBestTicks() const {
+        MUTEX_LOCK(mutex);
+        return BestTicks{
+            bids.empty() ? 0 : bids[0].price,
+            asks.empty() ? 0 : asks[0].price,
+            bids.empty() ? 0 : bids.back().price,
+            asks.empty() ? 0 : asks.back().price};
+    }
+    bool hasPricesChanged(const BestTicks& oldTicks, const BestTicks& newTicks) const;
+
+    template <typename Result, typename Iterator>
+    void pushElement(Result& result, Iterator& it, int scenario);
 };
+
+// Default book used across the bot
+using OrderBook = OrderBookT<Config::ORDERBOOK_MAX_DEPTH>;
@@ -1,4 +1,5 @@
 #include "orderbook_mgr.h"
+#include "latency.h"
 
 #define TRACE(_exchangeId, ...) TRACE_THIS(TraceInstance::ORDERBOOK_MGR, _exchangeId, __VA_ARGS__)
 #define DEBUG(_exchangeId, ...) DEBUG_THIS(TraceInstance::ORDERBOOK_MGR, _exchangeId, __VA_ARGS__)
@@ -7,29 +8,43 @@
 #define ERROR_CNT(_id, _exchangeId, ...) ERROR_COUNT(TraceInstance::ORDERBOOK_MGR, _exchangeId, _id, __VA_ARGS__)
 
 OrderBookManager::OrderBookManager() {
-    for (int pair = 0; pair < static_cast<int>(TradingPair::COUNT); pair++) {
-        if (pair == static_cast<int>(TradingPair::UNKNOWN)) continue;
-        for (int exchangeIx = static_cast<int>(ExchangeId::UNKNOWN) + 1; 
-            exchangeIx < static_cast<int>(ExchangeId::COUNT); exchangeIx++) {
-            if (exchangeIx == static_cast<int>(ExchangeId::UNKNOWN)) continue;
-            ExchangeId exchangeId = static_cast<ExchangeId>(exchangeIx);
-            orderBooks[exchangeId][static_cast<TradingPair>(pair)] = OrderBook(exchangeId, static_cast<TradingPair>(pair));
+    for (size_t exchangeIx = 0; exchangeIx < EXCHANGE_COUNT; exchangeIx++) {
+        for (size_t pair = 0; pair < PAIR_COUNT; pair++) {
+            orderBooks[exchangeIx][pair] = OrderBook(static_cast<ExchangeId>(exchangeIx), static_cast<TradingPair>(pair));
         }
     }
 }
 
 void OrderBookManager::updateOrderBook(ExchangeId exchangeId, TradingPair pair, std::vector<PriceLevel>& bids, std::vector<PriceLevel>& asks, bool isCompleteUpdate, int maxDepth) {
+    std::vector<FixedLevel> fixedBids = toFixedLevels(bids);
+    std::vector<FixedLevel> fixedAsks = toFixedLevels(asks);
+    updateOrderBook(exchangeId, pair, fixedBids, fixedAsks, isCompleteUpdate, maxDepth);
+}
+
+void OrderBookManager::updateOrderBook(ExchangeId exchangeId, TradingPair pair, std::vector<FixedLevel>& bids, std::vector<FixedLevel>& asks, bool isCompleteUpdate, int maxDepth) {
+    // the adapter is done with the frame: JsonValue parses lazily, the fields were read just now
+    latencyMonitor.parsed();
     bool changed = false;
     {
-        MUTEX_LOCK(mutex);
-    
-        auto& book = orderBooks[exchangeId][pair];
+        // the book locks itself; no manager-wide lock on the update path
+        auto& book = slot(exchangeId, pair);
         
-        // Update the order book
-        auto result = book.update(pair, bids, asks, isCompleteUpdate, maxDepth);
+        // Update the order book; in deep mode through the deep book, which feeds the top levels
+        OrderBook::UpdateOutcome result;
+        auto& deepBook = deepBooks.at(static_cast<size_t>(exchangeId)).at(static_cast<size_t>(pair));
+        if (deepBook) {
+            deepBook->update(bids, asks, isCompleteUpdate);
+            OrderBook::Ladder topBids, topAsks;
+            deepBook->top(topBids, topAsks, static_cast<size_t>(maxDepth));
+            result = book.replace(topBids, topAsks);
+        } else {
+            result = book.update(pair, bids, asks, isCompleteUpdate, maxDepth);
+        }
         if(result == OrderBook::UpdateOutcome::UPDATE_ERROR) {
             return;
         }
+        // quantities at the best prices may have moved even if the prices did not
+        publish(exchangeId, pair, book);
         
         // Only trigger callback if the lastUpdate timestamp changed
         if (result == OrderBook::UpdateOutcome::BEST_PRICES_CHANGED) {
@@ -42,40 +57,45 @@ void OrderBookManager::updateOrderBook(ExchangeId exchangeId, TradingPair pair,
     }
 
     if (changed) {        
-        if (updateCallback) {
-            TRACE(exchangeId, "Calling update callback for exchange: ", exchangeId, " pair: ", pair);
-            updateCallback(exchangeId, pair);
-        }
+        notifyChanged(exchangeId, pair);
     }
 }
 
 void OrderBookManager::updateOrderBookBestBidAsk(ExchangeId exchangeId, TradingPair pair, 
                                                 double bidPrice, double bidQuantity, 
                                                 double askPrice, double askQuantity) {
+    updateOrderBookBestBidAsk(exchangeId, pair,
+        FixedLevel(PriceLevel(bidPrice, bidQuantity)), FixedLevel(PriceLevel(askPrice, askQuantity)));
+}
+
+void OrderBookManager::updateOrderBookBestBidAsk(ExchangeId exchangeId, TradingPair pair,
+                                                const FixedLevel& bid, const FixedLevel& ask) {
+    latencyMonitor.parsed();
     bool changed = false;
     TRACE(exchangeId, "Updating order book best bid/ask - Exchange: ", exchangeId, " Pair: ", pair, 
-          " Bid: ", bidPrice, "@", bidQuantity,
-          " Ask: ", askPrice, "@", askQuantity);
+          " Bid: ", PriceLevel(bid).price, "@", PriceLevel(bid).quantity,
+          " Ask: ", PriceLevel(ask).price, "@", PriceLevel(ask).quantity);
     
     try {
-        MUTEX_LOCK(mutex);
-    
-        auto& book = orderBooks[exchangeId][pair];
+        // the book locks itself; no manager-wide lock on the update path
+        auto& book = slot(exchangeId, pair);
         
         // Update the order book with best bid/ask
-        auto result = book.setBestBidAsk(bidPrice, bidQuantity, askPrice, askQuantity);
+        auto result = book.setBestBidAsk(bid, ask);
         if(result == OrderBook::UpdateOutcome::UPDATE_ERROR) {
             return;
         }
+        // quantities at the best prices may have moved even if the prices did not
+        publish(exchangeId, pair, book);
         
         // Only trigger callback if the lastUpdate timestamp changed
         if (result == OrderBook::UpdateOutcome::BEST_PRICES_CHANGED) {
             changed = true;
         }
 
-        NOTICE("Update order book best bid/ask - Exchange: ", exchangeId, " Pair: ", pair, 
-               " Bid: ", bidPrice, "@", bidQuantity,
-               " Ask: ", askPrice, "@", askQuantity,
+        NOTICE(exchangeId, "Update order book best bid/ask - Exchange: ", exchangeId, " Pair: ", pair, 
+               " Bid: ", bid.price, "@", bid.quantity,
+               " Ask: ", ask.price, "@", ask.quantity,
                " calling callback: ", changed, 
                " updated: ", book.getLastUpdate());
     } catch (const std::exception& e) {
@@ -83,51 +103,124 @@ void OrderBookManager::updateOrderBookBestBidAsk(ExchangeId exchangeId, TradingP
     }
 
     if (changed) {        
-        if (updateCallback) {
-            TRACE(exchangeId, "Calling update callback for exchange: ", exchangeId, " pair: ", pair);
-            updateCallback(exchangeId, pair);
-        } else {
-            TRACE(exchangeId, "No update callback for exchange: ", exchangeId, " pair: ", pair);
-        }
+        notifyChanged(exchangeId, pair);
+    }
+}
+
+void OrderBookManager::notifyChanged(ExchangeId exchangeId, TradingPair pair) {
+    latencyMonitor.bookUpdated();
+    // set the dirty bit first: a consumer woken by the callback must find it
+    dirty[static_cast<size_t>(pair)].exchanges.fetch_or(exchangeBit(exchangeId), std::memory_order_release);
+
+    auto pairCallback = std::atomic_load_explicit(&pairCallbacks[static_cast<size_t>(pair)], std::memory_order_acquire);
+    if (pairCallback) {
+        TRACE(exchangeId, "Calling pair update callback for exchange: ", exchangeId, " pair: ", pair);
+        (*pairCallback)(exchangeId, pair);
+    }
+    if (updateCallback) {
+        TRACE(exchangeId, "Calling update callback for exchange: ", exchangeId, " pair: ", pair);
+        updateCallback(exchangeId, pair);
+    } else if (!pairCallback) {
+        TRACE(exchangeId, "No update callback for exchange: ", exchangeId, " pair: ", pair);
+    }
+}
+
+void OrderBookManager::restoreOrderBook(ExchangeId exchangeId, TradingPair pair, const OrderBook::Ladder& bids, const OrderBook::Ladder& asks,
+                                        std::chrono::system_clock::time_point savedUpdate) {
+    // a stale quote in the matrix could win every scan of the pair and then be refused as provisional
+    slot(exchangeId, pair).restore(bids, asks, savedUpdate);
+    withdraw(exchangeId, pair);
+}
+
+void OrderBookManager::markStale(ExchangeId exchangeId, TradingPair pair) {
+    slot(exchangeId, pair).markStale();
+    withdraw(exchangeId, pair);
+}
+
+void OrderBookManager::publish(ExchangeId exchangeId, TradingPair pair, const OrderBook& book) {
+    if (book.isProvisional()) {
+        withdraw(exchangeId, pair);
+        return;
+    }
+    tobMatrix.update(exchangeId, pair, book.getTopOfBook());
+    live[static_cast<size_t>(pair)].exchanges.fetch_or(exchangeBit(exchangeId), std::memory_order_release);
+}
+
+void OrderBookManager::withdraw(ExchangeId exchangeId, TradingPair pair) {
+    live[static_cast<size_t>(pair)].exchanges.fetch_and(~exchangeBit(exchangeId), std::memory_order_release);
+    tobMatrix.clear(exchangeId, pair);
+}
+
+void OrderBookManager::enableDeepBook(ExchangeId exchangeId, TradingPair pair, FixedPoint::Ticks tickSize) {
+    auto& deepBook = deepBooks.at(static_cast<size_t>(exchangeId)).at(static_cast<size_t>(pair));
+    if (!deepBook) {
+        deepBook = std::make_unique<DeepOrderBook>(exchangeId, pair, tickSize);
+        NOTICE(exchangeId, "Deep book enabled - Exchange: ", exchangeId, " Pair: ", pair);
     }
 }
 
+const DeepOrderBook* OrderBookManager::getDeepBook(ExchangeId exchangeId, TradingPair pair) const {
+    return deepBooks.at(static_cast<size_t>(exchangeId)).at(static_cast<size_t>(pair)).get();
+}
+
 OrderBook& OrderBookManager::getOrderBook(ExchangeId exchangeId, TradingPair pair) {
-    MUTEX_LOCK(mutex);
-    return orderBooks[exchangeId][pair];
+    return slot(exchangeId, pair);
+}
+
+TopOfBook OrderBookManager::getTopOfBook(ExchangeId exchangeId, TradingPair pair) const {
+    return slot(exchangeId, pair).getTopOfBook();
+}
+
+const TopOfBookMatrix& OrderBookManager::getTopOfBookMatrix() const {
+    return tobMatrix;
 }
 
 std::vector<std::reference_wrapper<OrderBook>> OrderBookManager::getOrderBooks(TradingPair pair) {
-    MUTEX_LOCK(mutex);
     std::vector<std::reference_wrapper<OrderBook>> books;
-    
+    books.reserve(EXCHANGE_COUNT - 1);
+
     // Get all order books for the given trading pair across exchanges
-    for (auto& [exchangeId, exchangeBooks] : orderBooks) {
-        auto it = exchangeBooks.find(pair);
-        if (it != exchangeBooks.end()) {
-            books.push_back(std::ref(it->second));
-        }
+    for (size_t exchangeIx = static_cast<size_t>(ExchangeId::UNKNOWN) + 1; exchangeIx < EXCHANGE_COUNT; exchangeIx++) {
+        books.push_back(std::ref(slot(static_cast<ExchangeId>(exchangeIx), pair)));
     }
     
     return books;
 }
 
 std::vector<std::reference_wrapper<OrderBook>> OrderBookManager::getOrderBooks(ExchangeId exchangeId) {
-    MUTEX_LOCK(mutex);
     std::vector<std::reference_wrapper<OrderBook>> books;
-    
+    books.reserve(PAIR_COUNT - 1);
+
     // Get all order books for the given exchange
-    auto it = orderBooks.find(exchangeId);
-    if (it != orderBooks.end()) {
-        for (auto& [pair, book] : it->second) {
-            books.push_back(std::ref(book));
-        }
+    for (size_t pair = static_cast<size_t>(TradingPair::UNKNOWN) + 1; pair < PAIR_COUNT; pair++) {
+        books.push_back(std::ref(slot(exchangeId, static_cast<TradingPair>(pair))));
     }
     
     return books;
 }
 
-void OrderBookManager::setUpdateCallback(std::function<void(ExchangeId, TradingPair)> callback) {
+void OrderBookManager::setUpdateCallback(UpdateCallback callback) {
     MUTEX_LOCK(mutex);
     updateCallback = callback;
-} 
\ No newline at end of file
+}
+
+void OrderBookManager::setUpdateCallback(TradingPair pair, UpdateCallback callback) {
+    auto ptr = callback ? std::make_shared<const UpdateCallback>(std::move(callback)) : nullptr;
+    std::atomic_store_explicit(&pairCallbacks.at(static_cast<size_t>(pair)), std::move(ptr), std::memory_order_release);
+}
+
+uint64_t OrderBookManager::getVersion(ExchangeId exchangeId, TradingPair pair) const {
+    return slot(exchangeId, pair).getVersion();
+}
+
+uint32_t OrderBookManager::getLiveMask(TradingPair pair) const {
+    return live.at(static_cast<size_t>(pair)).exchanges.load(std::memory_order_acquire);
+}
+
+uint32_t OrderBookManager::drainDirty(TradingPair pair) {
+    return dirty.at(static_cast<size_t>(pair)).exchanges.exchange(0, std::memory_order_acq_rel);
+}
+
+bool OrderBookManager::isDirty(TradingPair pair) const {
+    return dirty.at(static_cast<size_t>(pair)).exchanges.load(std::memory_order_acquire) != 0;
+}
@@ -1,6 +1,12 @@
 #pragma once
 
+#include <array>
+#include <atomic>
+#include <functional>
+#include <memory>
 #include "orderbook.h"
+#include "tob_matrix.h"
+#include "deep_orderbook.h"
 #include "tracer.h"
 
 // Order book manager for all trading pairs
@@ -10,25 +16,72 @@ public:
     ~OrderBookManager() {};
 
     // Update order book for a trading pair
+    void updateOrderBook(ExchangeId exchangeId, TradingPair pair, std::vector<FixedLevel>& bids, std::vector<FixedLevel>& asks,
+                        bool isCompleteUpdate = false, int maxDepth = Config::ORDERBOOK_MAX_DEPTH);
     void updateOrderBook(ExchangeId exchangeId, TradingPair pair, std::vector<PriceLevel>& bids, std::vector<PriceLevel>& asks,
-                        bool isCompleteUpdate = false, int maxDepth = 10);
+                        bool isCompleteUpdate = false, int maxDepth = Config::ORDERBOOK_MAX_DEPTH);
 
     // Update order book with best bid/ask prices (for bookTicker style updates)
+    void updateOrderBookBestBidAsk(ExchangeId exchangeId, TradingPair pair,
+                                 const FixedLevel& bid, const FixedLevel& ask);
     void updateOrderBookBestBidAsk(ExchangeId exchangeId, TradingPair pair, 
                                  double bidPrice, double bidQuantity, 
                                  double askPrice, double askQuantity);
 
-    // Get order book for a specific exchange and trading pair
+    // Get order book for a specific exchange and trading pair.
+    // Books live in fixed slots for the lifetime of the manager, so the reference stays valid;
+    // the book itself synchronizes access. Throws std::out_of_range for ids outside the table.
     OrderBook& getOrderBook(ExchangeId exchangeId, TradingPair pair);
 
+    // Put saved levels into a book as provisional data (warm restart, see orderbook_snapshot.h).
+    // The book stays out of the matrix and the live mask until the exchange sends a live update.
+    void restoreOrderBook(ExchangeId exchangeId, TradingPair pair, const OrderBook::Ladder& bids, const OrderBook::Ladder& asks,
+                          std::chrono::system_clock::time_point savedUpdate);
+
+    // The exchange went dark: the book turns provisional and leaves the matrix and the live mask
+    // until its next live update. Call from the exchange's feed thread.
+    void markStale(ExchangeId exchangeId, TradingPair pair);
+
+    // Keep a full depth book behind this OrderBook: updates are applied to the deep book and its
+    // top levels are copied into the OrderBook. Call before the exchange's feed starts or from
+    // that feed's thread; a book is only ever updated by its own exchange. Idempotent.
+    void enableDeepBook(ExchangeId exchangeId, TradingPair pair, FixedPoint::Ticks tickSize = 0);
+    // Deep book or nullptr if deep mode is not enabled for the book
+    const DeepOrderBook* getDeepBook(ExchangeId exchangeId, TradingPair pair) const;
+
+    // Lock-free best bid/ask of a book; no copy and no mutex, meant for the strategy hot path
+    TopOfBook getTopOfBook(ExchangeId exchangeId, TradingPair pair) const;
+
+    // Best bid/ask of all exchanges side by side, refreshed on every applied live update
+    const TopOfBookMatrix& getTopOfBookMatrix() const;
+
+    // Exchanges (exchangeBit()) whose book of the pair holds live data, i.e. is in the matrix. Lock-free.
+    uint32_t getLiveMask(TradingPair pair) const;
+
     // Get all order books for a trading pair
     std::vector<std::reference_wrapper<OrderBook>> getOrderBooks(TradingPair pair);
 
     // Get all order books for an exchange
     std::vector<std::reference_wrapper<OrderBook>> getOrderBooks(ExchangeId exchangeId);
 
-    // Set callback for order book updates
-    void setUpdateCallback(std::function<void(ExchangeId, TradingPair)> callback);
+    using UpdateCallback = std::function<void(ExchangeId, TradingPair)>;
+
+    // Set callback for order book updates; set it before the feeds start, it is read without locking
+    void setUpdateCallback(UpdateCallback callback);
+
+    // Set callback for updates of one pair only; safe to (re)set while the feeds run.
+    // Called after the book's dirty bit is set, so the consumer finds it in drainDirty().
+    void setUpdateCallback(TradingPair pair, UpdateCallback callback);
+
+    // Version of a book: grows with every applied update, read lock-free
+    uint64_t getVersion(ExchangeId exchangeId, TradingPair pair) const;
+
+    // Dirty set: one bit per exchange (exchangeBit()) for each pair whose best prices changed since
+    // the last drain. Lock-free; a consumer takes the whole batch at once, so bursts of updates to
+    // the same book collapse into one bit. Meant for a single consumer per pair.
+    static constexpr uint32_t exchangeBit(ExchangeId exchangeId) { return 1u << static_cast<uint32_t>(exchangeId); }
+    uint32_t drainDirty(TradingPair pair);
+    bool isDirty(TradingPair pair) const;
 
 protected:
     void trace(std::ostream& os) const override {
@@ -36,10 +89,45 @@ protected:
     }
 
 private:
-    // Map of exchange ID to map of trading pair to order book
-    std::unordered_map<ExchangeId, std::unordered_map<TradingPair, OrderBook>> orderBooks;
-    std::function<void(ExchangeId, TradingPair)> updateCallback;
-    mutable std::mutex mutex;
+    static constexpr size_t EXCHANGE_COUNT = static_cast<size_t>(ExchangeId::COUNT);
+    static constexpr size_t PAIR_COUNT = static_cast<size_t>(TradingPair::COUNT);
+
+    // Dense [exchange][pair] table. Every book starts on its own cache line (the ladders are
+    // 64-byte aligned) and has its own mutex, so feeds of different exchanges never contend.
+    // The UNKNOWN rows/columns are kept to allow direct indexing by the enum value.
+    std::array<std::array<OrderBook, PAIR_COUNT>, EXCHANGE_COUNT> orderBooks;
+    TopOfBookMatrix tobMatrix;
+    // optional full depth books, allocated only where deep mode is enabled (about 1MB each)
+    std::array<std::array<std::unique_ptr<DeepOrderBook>, PAIR_COUNT>, EXCHANGE_COUNT> deepBooks;
+    UpdateCallback updateCallback;
+    mutable std::mutex mutex; // guards updateCallback assignment only
+
+    // per-pair dirty masks, each on its own cache line as they are written by all feed threads
+    struct alignas(64) DirtyMask {
+        std::atomic<uint32_t> exchanges{0};
+    };
+    static_assert(EXCHANGE_COUNT <= 32, "dirty mask holds one bit per exchange");
+    std::array<DirtyMask, PAIR_COUNT> dirty;
+
+    // per-pair live masks, see getLiveMask()
+    std::array<DirtyMask, PAIR_COUNT> live;
+
+    // per-pair callbacks, swapped atomically so they can be set while the feeds run
+    std::array<std::shared_ptr<const UpdateCallback>, PAIR_COUNT> pairCallbacks;
+
+    // Mark the book dirty and notify the callbacks
+    void notifyChanged(ExchangeId exchangeId, TradingPair pair);
+    // Put the book's top into the matrix and the live mask; a provisional book is kept out of both
+    void publish(ExchangeId exchangeId, TradingPair pair, const OrderBook& book);
+    // Take the book out of the matrix and the live mask
+    void withdraw(ExchangeId exchangeId, TradingPair pair);
+
+    OrderBook& slot(ExchangeId exchangeId, TradingPair pair) {
+        return orderBooks.at(static_cast<size_t>(exchangeId)).at(static_cast<size_t>(pair));
+    }
+    const OrderBook& slot(ExchangeId exchangeId, TradingPair pair) const {
+        return orderBooks.at(static_cast<size_t>(exchangeId)).at(static_cast<size_t>(pair));
+    }
 }; 
 
 extern OrderBookManager orderBookManager;
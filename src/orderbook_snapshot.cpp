@@ -0,0 +1,162 @@
+#include "orderbook_snapshot.h"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <type_traits>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define TRACE(...) TRACE_BASE(TraceInstance::ORDERBOOK_MGR, ExchangeId::UNKNOWN, __VA_ARGS__)
+#define ERROR(...) ERROR_BASE(TraceInstance::ORDERBOOK_MGR, ExchangeId::UNKNOWN, __VA_ARGS__)
+
+namespace {
+
+constexpr char MAGIC[8] = {'L', 'L', 'A', 'B', 'O', 'O', 'K', 'S'};
+
+static_assert(std::is_trivially_copyable<OrderBookSnapshot::Header>::value, "header is written as raw bytes");
+static_assert(std::is_trivially_copyable<OrderBookSnapshot::Record>::value, "records are written as raw bytes");
+
+int64_t toNs(std::chrono::system_clock::time_point t) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(t.time_since_epoch()).count();
+}
+
+std::chrono::system_clock::time_point fromNs(int64_t ns) {
+    return std::chrono::system_clock::time_point(
+        std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::nanoseconds(ns)));
+}
+
+// Copy saved levels into a ladder; false if they are not a valid side
+bool toLadder(const OrderBookSnapshot::Level* levels, uint16_t count, bool isBid, OrderBook::Ladder& out) {
+    out.clear();
+    for (uint16_t i = 0; i < count; i++) {
+        if (levels[i].price <= 0 || levels[i].quantity <= 0) {
+            return false;
+        }
+        out.push_back(FixedLevel(levels[i].price, levels[i].quantity));
+    }
+    return OrderBook::isSorted(out, isBid);
+}
+
+} // namespace
+
+bool OrderBookSnapshot::save(const std::string& path, OrderBookManager& manager, const SequenceFn& sequenceOf) {
+    std::vector<Record> records;
+    for (size_t ex = static_cast<size_t>(ExchangeId::UNKNOWN) + 1; ex < static_cast<size_t>(ExchangeId::COUNT); ex++) {
+        for (auto& bookRef : manager.getOrderBooks(static_cast<ExchangeId>(ex))) {
+            const OrderBook& book = bookRef.get();
+            // both sides under one hold of the book's lock, so the saved book is one that existed
+            const auto [bids, asks] = book.getLadders();
+            if (bids.empty() && asks.empty()) {
+                continue;
+            }
+            Record record{};
+            record.exchangeId = static_cast<uint8_t>(ex);
+            record.pair = static_cast<uint8_t>(book.getTradingPair());
+            record.bidCount = static_cast<uint16_t>(bids.size());
+            record.askCount = static_cast<uint16_t>(asks.size());
+            record.sequenceId = sequenceOf ? sequenceOf(static_cast<ExchangeId>(ex), book.getTradingPair()) : 0;
+            record.lastUpdateNs = toNs(book.getLastUpdate());
+            for (size_t i = 0; i < bids.size(); i++) {
+                record.bids[i] = Level{bids[i].price, bids[i].quantity};
+            }
+            for (size_t i = 0; i < asks.size(); i++) {
+                record.asks[i] = Level{asks[i].price, asks[i].quantity};
+            }
+            records.push_back(record);
+        }
+    }
+
+    Header header{};
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.depth = Config::ORDERBOOK_MAX_DEPTH;
+    header.recordCount = static_cast<uint32_t>(records.size());
+    header.savedAtNs = toNs(std::chrono::system_clock::now());
+
+    const std::string tmpPath = path + ".tmp";
+    {
+        std::ofstream out(tmpPath, std::ios::binary | std::ios::trunc);
+        if (!out) {
+            ERROR("Cannot open ", tmpPath, " for writing");
+            return false;
+        }
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.write(reinterpret_cast<const char*>(records.data()), static_cast<std::streamsize>(records.size() * sizeof(Record)));
+        if (!out) {
+            ERROR("Failed to write ", tmpPath);
+            return false;
+        }
+    }
+    if (std::rename(tmpPath.c_str(), path.c_str()) != 0) {
+        ERROR("Failed to rename ", tmpPath, " to ", path);
+        std::remove(tmpPath.c_str());
+        return false;
+    }
+    TRACE("Saved ", records.size(), " order books to ", path);
+    return true;
+}
+
+size_t OrderBookSnapshot::load(const std::string& path, OrderBookManager& manager, int maxAgeMs, const RestoredFn& onRestored) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        TRACE("No order book snapshot at ", path);
+        return 0;
+    }
+    struct stat st;
+    if (::fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(Header)) {
+        ERROR("Order book snapshot ", path, " is truncated");
+        ::close(fd);
+        return 0;
+    }
+    const size_t size = static_cast<size_t>(st.st_size);
+    void* mapped = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapped == MAP_FAILED) {
+        ERROR("Cannot map order book snapshot ", path);
+        return 0;
+    }
+
+    size_t restored = 0;
+    const auto* bytes = static_cast<const char*>(mapped);
+    Header header;
+    std::memcpy(&header, bytes, sizeof(header));
+    const auto age = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now() - fromNs(header.savedAtNs)).count();
+
+    if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 || header.version != VERSION ||
+        header.depth != static_cast<uint32_t>(Config::ORDERBOOK_MAX_DEPTH)) {
+        ERROR("Order book snapshot ", path, " has an unknown format (version ", header.version, ", depth ", header.depth, ")");
+    } else if (size != sizeof(Header) + static_cast<size_t>(header.recordCount) * sizeof(Record)) {
+        ERROR("Order book snapshot ", path, " has ", size, " bytes for ", header.recordCount, " books");
+    } else if (maxAgeMs > 0 && age > maxAgeMs) {
+        TRACE("Order book snapshot ", path, " is too old (", age, "ms), ignored");
+    } else {
+        // the records are aligned in the mapping (header and records are multiples of 8 bytes)
+        const auto* records = reinterpret_cast<const Record*>(bytes + sizeof(Header));
+        OrderBook::Ladder bids, asks;
+        for (uint32_t i = 0; i < header.recordCount; i++) {
+            const Record& record = records[i];
+            if (record.exchangeId == static_cast<uint8_t>(ExchangeId::UNKNOWN) || record.exchangeId >= static_cast<uint8_t>(ExchangeId::COUNT) ||
+                record.pair == static_cast<uint8_t>(TradingPair::UNKNOWN) || record.pair >= static_cast<uint8_t>(TradingPair::COUNT) ||
+                record.bidCount > Config::ORDERBOOK_MAX_DEPTH || record.askCount > Config::ORDERBOOK_MAX_DEPTH ||
+                !toLadder(record.bids, record.bidCount, true, bids) || !toLadder(record.asks, record.askCount, false, asks)) {
+                ERROR("Skipping invalid record ", i, " in order book snapshot ", path);
+                continue;
+            }
+            auto exchangeId = static_cast<ExchangeId>(record.exchangeId);
+            auto pair = static_cast<TradingPair>(record.pair);
+            manager.restoreOrderBook(exchangeId, pair, bids, asks, fromNs(record.lastUpdateNs));
+            if (onRestored) {
+                onRestored(exchangeId, pair, record.sequenceId);
+            }
+            restored++;
+        }
+        TRACE("Restored ", restored, " order books from ", path, " saved ", age, "ms ago");
+    }
+
+    ::munmap(mapped, size);
+    return restored;
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <string>
+#include <functional>
+#include <cstdint>
+#include "orderbook_mgr.h"
+
+// Binary dump of all order books for warm restarts.
+//
+// The file is a fixed header followed by one fixed-size record per non-empty book: exchange,
+// pair, the exchange's sequence id (SymbolState::lastUpdateId), the book's last update time and
+// the levels in ticks/lots. Host byte order; a file written with a different depth or format
+// version is rejected. Saving writes a temporary file and renames it, so a crash never leaves
+// a torn file behind. Loading maps the file and copies the records into the books as
+// provisional data (OrderBook::isProvisional) until the exchange sends live updates.
+class OrderBookSnapshot {
+public:
+    using SequenceFn = std::function<int64_t(ExchangeId, TradingPair)>;
+    using RestoredFn = std::function<void(ExchangeId, TradingPair, int64_t sequenceId)>;
+
+    static constexpr uint32_t VERSION = 1;
+
+    // Write all non-empty books; sequenceOf supplies the exchange sequence id of a book (0 if null).
+    // Returns false if the file could not be written.
+    static bool save(const std::string& path, OrderBookManager& manager, const SequenceFn& sequenceOf = nullptr);
+
+    // Restore books from a file written within maxAgeMs (0: any age).
+    // onRestored is called for every restored book. Returns the number of books restored.
+    static size_t load(const std::string& path, OrderBookManager& manager, int maxAgeMs = 0,
+                       const RestoredFn& onRestored = nullptr);
+
+    // On-disk layout
+    struct Header {
+        char magic[8];
+        uint32_t version;
+        uint32_t depth;        // levels per side in every record
+        uint32_t recordCount;
+        uint32_t reserved;
+        int64_t savedAtNs;     // system_clock
+    };
+    struct Level {
+        int64_t price;         // ticks
+        int64_t quantity;      // lots
+    };
+    struct Record {
+        uint8_t exchangeId;
+        uint8_t pair;
+        uint16_t bidCount;
+        uint16_t askCount;
+        uint16_t reserved;
+        int64_t sequenceId;
+        int64_t lastUpdateNs;  // system_clock
+        Level bids[Config::ORDERBOOK_MAX_DEPTH];
+        Level asks[Config::ORDERBOOK_MAX_DEPTH];
+    };
+};
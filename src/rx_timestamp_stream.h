@@ -0,0 +1,178 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <utility>
+#include <boost/asio/associated_executor.hpp>
+#include <boost/asio/async_result.hpp>
+#include <boost/asio/bind_executor.hpp>
+#include <boost/beast/core/tcp_stream.hpp>
+#if defined(__linux__)
+#include <linux/net_tstamp.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <cerrno>
+#include <ctime>
+#endif
+
+// A beast::tcp_stream that reads with recvmsg() to get the kernel receive time of the bytes.
+//
+// Goes between the TLS layer and the socket of a websocket feed; get_lowest_layer() still finds the
+// tcp_stream. Until enableTimestamps() it is the plain stream. After it, reads wait for the socket to be
+// readable and take the data and the SO_TIMESTAMPING control message in one call. The software receive
+// time is on the system clock, like LatencyMonitor::nowNs(). The NIC's raw hardware time is on its PTP
+// hardware clock instead and only comparable while phc2sys keeps that clock synced to the system one,
+// so it is opt-in. Timeouts of the tcp_stream do not cover these reads, the websocket keeps its own.
+// Linux only; elsewhere no timestamps are taken.
+class RxTimestampStream {
+public:
+    using next_layer_type = boost::beast::tcp_stream;
+    using lowest_layer_type = next_layer_type::socket_type;
+    using executor_type = next_layer_type::executor_type;
+
+    template <class... Args>
+    explicit RxTimestampStream(Args&&... args) : stream(std::forward<Args>(args)...) {}
+
+    executor_type get_executor() noexcept { return stream.get_executor(); }
+    next_layer_type& next_layer() noexcept { return stream; }
+    const next_layer_type& next_layer() const noexcept { return stream; }
+    lowest_layer_type& lowest_layer() noexcept { return stream.socket(); }
+    const lowest_layer_type& lowest_layer() const noexcept { return stream.socket(); }
+
+    // On the connected socket; false where the platform or the socket has no receive timestamps.
+    // rawHardware: prefer the NIC's stamps where it has them; needs its clock synced (phc2sys).
+    bool enableTimestamps(bool rawHardware = false) {
+#if defined(__linux__)
+        int flags = SOF_TIMESTAMPING_RX_SOFTWARE | SOF_TIMESTAMPING_SOFTWARE;
+        if (rawHardware) {
+            flags |= SOF_TIMESTAMPING_RX_HARDWARE | SOF_TIMESTAMPING_RAW_HARDWARE;
+        }
+        hardware = rawHardware;
+        timestamps = ::setsockopt(stream.socket().native_handle(), SOL_SOCKET, SO_TIMESTAMPING, &flags, sizeof(flags)) == 0;
+        if (!timestamps) {
+            const int on = 1;
+            timestamps = ::setsockopt(stream.socket().native_handle(), SOL_SOCKET, SO_TIMESTAMPNS, &on, sizeof(on)) == 0;
+        }
+        return timestamps;
+#else
+        return false;
+#endif
+    }
+    bool hasTimestamps() const { return timestamps; }
+
+    // Kernel receive time (ns since the epoch) of the first bytes read since the last call, 0 if none.
+    // TLS reads ahead: a frame that came in with the previous one has no time of its own.
+    int64_t takeRxNs() {
+        return std::exchange(firstRxNs, 0);
+    }
+
+    template <class MutableBufferSequence>
+    std::size_t read_some(const MutableBufferSequence& buffers) { return stream.read_some(buffers); }
+    template <class MutableBufferSequence>
+    std::size_t read_some(const MutableBufferSequence& buffers, boost::system::error_code& ec) { return stream.read_some(buffers, ec); }
+    template <class ConstBufferSequence>
+    std::size_t write_some(const ConstBufferSequence& buffers) { return stream.write_some(buffers); }
+    template <class ConstBufferSequence>
+    std::size_t write_some(const ConstBufferSequence& buffers, boost::system::error_code& ec) { return stream.write_some(buffers, ec); }
+
+    template <class ConstBufferSequence, class WriteHandler>
+    auto async_write_some(const ConstBufferSequence& buffers, WriteHandler&& handler) {
+        return stream.async_write_some(buffers, std::forward<WriteHandler>(handler));
+    }
+
+    template <class MutableBufferSequence, class ReadHandler>
+    auto async_read_some(const MutableBufferSequence& buffers, ReadHandler&& handler) {
+        return boost::asio::async_initiate<ReadHandler, void(boost::system::error_code, std::size_t)>(
+            [this](auto&& handler, const MutableBufferSequence& buffers) {
+                if (!timestamps || boost::asio::buffer_size(buffers) == 0) {
+                    stream.async_read_some(buffers, std::forward<decltype(handler)>(handler));
+                    return;
+                }
+                readWhenReady(buffers, std::forward<decltype(handler)>(handler));
+            },
+            handler, buffers);
+    }
+
+private:
+    template <class MutableBufferSequence, class Handler>
+    void readWhenReady(const MutableBufferSequence& buffers, Handler&& handler) {
+        auto executor = boost::asio::get_associated_executor(handler, get_executor());
+        stream.socket().async_wait(boost::asio::socket_base::wait_read, boost::asio::bind_executor(executor,
+            [this, buffers, handler = std::forward<Handler>(handler)](boost::system::error_code ec) mutable {
+                std::size_t bytes = 0;
+                if (!ec && !receive(buffers, bytes, ec)) {
+                    // woken without data
+                    readWhenReady(buffers, std::move(handler));
+                    return;
+                }
+                std::move(handler)(ec, bytes);
+            }));
+    }
+
+    // False if the socket had nothing to read after all
+    template <class MutableBufferSequence>
+    bool receive(const MutableBufferSequence& buffers, std::size_t& bytes, boost::system::error_code& ec) {
+#if defined(__linux__)
+        iovec iov[16];
+        size_t count = 0;
+        for (auto it = boost::asio::buffer_sequence_begin(buffers); it != boost::asio::buffer_sequence_end(buffers) && count < 16; ++it) {
+            boost::asio::mutable_buffer buffer(*it);
+            if (buffer.size() > 0) {
+                iov[count].iov_base = buffer.data();
+                iov[count].iov_len = buffer.size();
+                count++;
+            }
+        }
+        alignas(cmsghdr) char control[CMSG_SPACE(3 * sizeof(timespec))];
+        msghdr message{};
+        message.msg_iov = iov;
+        message.msg_iovlen = count;
+        message.msg_control = control;
+        message.msg_controllen = sizeof(control);
+
+        const ssize_t received = ::recvmsg(stream.socket().native_handle(), &message, MSG_DONTWAIT);
+        if (received < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) {
+                return false;
+            }
+            ec.assign(errno, boost::system::system_category());
+            return true;
+        }
+        if (received == 0) {
+            ec = boost::asio::error::eof;
+            return true;
+        }
+        bytes = static_cast<std::size_t>(received);
+
+        for (cmsghdr* cmsg = CMSG_FIRSTHDR(&message); cmsg; cmsg = CMSG_NXTHDR(&message, cmsg)) {
+            if (cmsg->cmsg_level != SOL_SOCKET) {
+                continue;
+            }
+            timespec ts{};
+            if (cmsg->cmsg_type == SO_TIMESTAMPING) {
+                // software, (deprecated), raw hardware
+                timespec stamps[3];
+                std::memcpy(stamps, CMSG_DATA(cmsg), sizeof(stamps));
+                ts = hardware && (stamps[2].tv_sec || stamps[2].tv_nsec) ? stamps[2] : stamps[0];
+            } else if (cmsg->cmsg_type == SO_TIMESTAMPNS) {
+                std::memcpy(&ts, CMSG_DATA(cmsg), sizeof(ts));
+            } else {
+                continue;
+            }
+            const int64_t ns = static_cast<int64_t>(ts.tv_sec) * 1000000000LL + ts.tv_nsec;
+            if (ns > 0 && firstRxNs == 0) {
+                firstRxNs = ns;
+            }
+        }
+        return true;
+#else
+        bytes = stream.socket().read_some(buffers, ec);
+        return true;
+#endif
+    }
+
+    next_layer_type stream;
+    bool timestamps = false;
+    bool hardware = false;  // raw hardware stamps requested
+    int64_t firstRxNs = 0;
+};
@@ -8,6 +8,7 @@
 #include "types.h"
 #include "orderbook_mgr.h"
 #include "order_mgr.h"
+#include "latency.h"
 
 using namespace std;
 
@@ -25,11 +26,21 @@ StrategyPoplavki::StrategyPoplavki(const std::string& baseAsset,
     , baseAsset(baseAsset)
     , quoteAsset(quoteAsset)
     , exchangeIds(exchangeIds) {
+
+    for (size_t i = 0; i < exchangeIds.size(); i++) {
+        exchangeMask |= OrderBookManager::exchangeBit(exchangeIds[i]);
+        for (size_t j = 0; j < exchangeIds.size(); j++) {
+            auto& sells = j > i ? opp1Sells : opp2Sells;
+            if (j != i) {
+                sells[static_cast<size_t>(exchangeIds[i])] |= OrderBookManager::exchangeBit(exchangeIds[j]);
+            }
+        }
+    }
     
     TRACE("Initializing with ", exchangeIds.size(), " exchanges");
     
-    // Set up order book update callback
-    orderBookManager.setUpdateCallback([this](ExchangeId exchangeId, TradingPair pair) {
+    // Set up order book update callback for our pair only
+    orderBookManager.setUpdateCallback(pair, [this](ExchangeId exchangeId, TradingPair pair) {
         updateOrderBookData(exchangeId);
     });
     
@@ -39,7 +50,9 @@ StrategyPoplavki::StrategyPoplavki(const std::string& baseAsset,
 }
 
 StrategyPoplavki::~StrategyPoplavki() {
-    // Nothing to clean up - ExchangeManager handles exchange lifecycle
+    // ExchangeManager handles exchange lifecycle; just stop being called back
+    orderBookManager.setUpdateCallback(pair, nullptr);
+    timersManager.stopTimer(timerId);
 }
 
 void StrategyPoplavki::onExchangeUpdate(ExchangeId exchange) {
@@ -58,73 +71,135 @@ void StrategyPoplavki::startTimerToScan(int ms) {
 }
 
 void StrategyPoplavki::updateOrderBookData(ExchangeId exchange) {
-    scanOpportunities();
+    processDirtyBooks();
 }
 
-Opportunity StrategyPoplavki::calculateProfit(ExchangeId buyExchange, ExchangeId sellExchange, TradingPair pair) {
-    auto buyBook = orderBookManager.getOrderBook(buyExchange, pair);
-    auto sellBook = orderBookManager.getOrderBook(sellExchange, pair);
+void StrategyPoplavki::processDirtyBooks() {
+    // Only one thread scans at a time. The others just leave their dirty bits behind,
+    // so a burst of updates from several feeds ends up in as few passes as possible.
+    while (!scanInProgress.exchange(true, std::memory_order_acquire)) {
+        uint32_t dirtyMask;
+        while ((dirtyMask = orderBookManager.drainDirty(pair)) != 0) {
+            scanOpportunities(dirtyMask);
+            latencyMonitor.decided();
+        }
+        scanInProgress.store(false, std::memory_order_release);
 
-    double buyPrice = buyBook.getBestAsk();
-    double sellPrice = sellBook.getBestBid();
-    double amount  = std::min(buyBook.getBestAskQuantity(), sellBook.getBestBidQuantity());
+        // a bit set after the last drain but before the flag was cleared would be lost otherwise
+        if (!orderBookManager.isDirty(pair)) {
+            break;
+        }
+    }
+}
+
+Opportunity StrategyPoplavki::calculateProfit(ExchangeId buyExchange, ExchangeId sellExchange, TradingPair pair) {
+    // lock-free snapshots of the side each book is traded on, with the top of the same publish; no mutex
+    OrderBook::Ladder asks, bids;
+    const TopOfBook buyBook = orderBookManager.getOrderBook(buyExchange, pair).getDepthSnapshot(false, asks);
+    const TopOfBook sellBook = orderBookManager.getOrderBook(sellExchange, pair).getDepthSnapshot(true, bids);
+
+    // compare in ticks/lots; same grid on all exchanges, so the comparisons are exact
+    FixedPoint::Ticks buyTicks = buyBook.askTicks;
+    FixedPoint::Ticks sellTicks = sellBook.bidTicks;
+    FixedPoint::Lots lots = std::min(buyBook.askLots, sellBook.bidLots);
+    double buyPrice = buyBook.bestAsk;
+    double sellPrice = sellBook.bestBid;
 
     DEBUG("Calculating profit for ", 
-        buyExchange, "(", buyBook.getLastUpdate(), ") -> ",
-        sellExchange, "(", sellBook.getLastUpdate(), ") ",
+        buyExchange, "(", buyBook.lastUpdate, ") -> ",
+        sellExchange, "(", sellBook.lastUpdate, ") ",
         buyPrice, " -> ", sellPrice,
         " = ", (sellPrice - buyPrice), " (", (((sellPrice - buyPrice) / buyPrice) * 100), "%)");
 
-    if(buyPrice * 2 < sellPrice || sellPrice * 2 < buyPrice) {
-        ERROR_CNT(CountableTrace::S_POPLAVKI_OPPORTUNITY_PRICE_DIFF, buyPrice < sellPrice ? buyExchange : sellExchange,
+    if(buyTicks * 2 < sellTicks || sellTicks * 2 < buyTicks) {
+        ERROR_CNT(CountableTrace::S_POPLAVKI_OPPORTUNITY_PRICE_DIFF, buyTicks < sellTicks ? buyExchange : sellExchange,
             "Major price difference: ",
-            buyPrice, " at ", buyExchange, " (", buyBook.getLastUpdate(), ") -> ",
-            sellPrice, " at ", sellExchange, " (", sellBook.getLastUpdate(), ")");
+            buyPrice, " at ", buyExchange, " (", buyBook.lastUpdate, ") -> ",
+            sellPrice, " at ", sellExchange, " (", sellBook.lastUpdate, ")");
+        return Opportunity(buyExchange, sellExchange, TradingPair::UNKNOWN, 0.0, 0.0, 0.0, std::chrono::system_clock::now());
+    }
+
+    if (orderBookManager.getOrderBook(buyExchange, pair).isProvisional() ||
+        orderBookManager.getOrderBook(sellExchange, pair).isProvisional()) {
+        // restored from the last run; wait for live data before acting on it
+        DEBUG("Skipping provisional book ", buyExchange, " -> ", sellExchange);
         return Opportunity(buyExchange, sellExchange, TradingPair::UNKNOWN, 0.0, 0.0, 0.0, std::chrono::system_clock::now());
     }
 
-    if (buyPrice > 0 && sellPrice > 0 && amount > 0 && buyPrice < sellPrice) {
-        return Opportunity(buyExchange, sellExchange, pair, amount, buyPrice, sellPrice, std::chrono::system_clock::now());
+    if (buyTicks > 0 && sellTicks > 0 && lots > 0 && buyTicks < sellTicks) {
+        // size on depth: take further levels as long as every unit still clears the execution margin
+        FixedPoint::Lots depthLots = OrderBook::Ladder::maxSizeAboveMargin(asks, bids, Config::MIN_EXECUTION_MARGIN);
+        if (depthLots > lots) {
+            // limit prices are the worst levels touched, so profit() is the margin of the last unit
+            lots = depthLots;
+            buyPrice = FixedPoint::fromTicks(asks.fill(lots).worstPrice);
+            sellPrice = FixedPoint::fromTicks(bids.fill(lots).worstPrice);
+            DEBUG("Sized on depth: ", FixedPoint::fromLots(lots), " ", buyPrice, " -> ", sellPrice);
+        }
+
+        // doubles only from here on: the opportunity goes to tracing and order submission
+        return Opportunity(buyExchange, sellExchange, pair, FixedPoint::fromLots(lots), buyPrice, sellPrice, std::chrono::system_clock::now());
     }
 
     return Opportunity(buyExchange, sellExchange, TradingPair::UNKNOWN, 0.0, 0.0, 0.0, std::chrono::system_clock::now());
 }
 
 void StrategyPoplavki::scanOpportunities() {
-    for (size_t i = 0; i < exchangeIds.size(); ++i) {
-        for (size_t j = i + 1; j < exchangeIds.size(); ++j) {
-            // Try both directions
-            Opportunity opp1 = calculateProfit(exchangeIds[i], exchangeIds[j], pair);
-            if (opp1.amount > 0 && opp1.profit() > Config::MIN_TRACEABLE_MARGIN) {
-                DEBUG("Found opportunity: ", opp1);
-                // TODO: Execute opportunity
-                if (bestOpportunity1.amount == 0 || opp1.profit() > bestOpportunity1.profit()) {
-                    TRACE_CNT(CountableTrace::S_POPLAVKI_OPPORTUNITY, "Updating best opp1: ", opp1);
-                    bestOpportunity1 = opp1;
-                } else {
-                    DEBUG("Best seen opportunity is better: ", bestOpportunity1, " vs ", opp1);
-                }
-                if (bestOpportunity1.profit() > Config::MIN_EXECUTION_MARGIN) {
-                    TRACE_CNT(CountableTrace::S_POPLAVKI_OPPORTUNITY_EXECUTABLE, "EXECUTABLE: ", bestOpportunity1);
-                    orderManager.handleOpportunity(bestOpportunity1);
-                }
-            }
+    scanOpportunities(~0u);
+}
 
-            Opportunity opp2 = calculateProfit(exchangeIds[j], exchangeIds[i], pair);
-            if (opp2.amount > 0 && opp2.profit() > Config::MIN_TRACEABLE_MARGIN) {
-                DEBUG("Found opportunity: ", opp2);
-                if (bestOpportunity2.amount == 0 || opp2.profit() > bestOpportunity2.profit()) {
-                    TRACE_CNT(CountableTrace::S_POPLAVKI_OPPORTUNITY, "Updating best opp2: ", opp2);
-                    bestOpportunity2 = opp2;
-                } else {
-                    DEBUG("Best seen opportunity is better: ", bestOpportunity2, " vs ", opp2);
-                }
-                if (bestOpportunity2.profit() > Config::MIN_EXECUTION_MARGIN) {
-                    TRACE_CNT(CountableTrace::S_POPLAVKI_OPPORTUNITY_EXECUTABLE, "EXECUTABLE: ", bestOpportunity2);
-                    orderManager.handleOpportunity(bestOpportunity2);
-                }
-            }
+void StrategyPoplavki::scanOpportunities(uint32_t dirtyMask) {
+    TopOfBookMatrix::Quotes quotes;
+    orderBookManager.getTopOfBookMatrix().snapshot(pair, quotes);
+
+    // all directed spreads of the pair in one pass; only the winner is checked on the books.
+    // Books without live data are not in the matrix, so they cannot shadow a live combination.
+    // A winner the books reject (an outlier quote, a provisional book) is left out and the pass repeated,
+    // so it does not hide the combinations behind it. An accepted one is the best of its direction:
+    // the direction is left out and the next pass finds the best of the other one.
+    const uint32_t activeMask = exchangeMask & orderBookManager.getLiveMask(pair);
+    TopOfBookMatrix::Exclusions excluded{};
+    bool opp1Done = false;
+    bool opp2Done = false;
+    while (!opp1Done || !opp2Done) {
+        TopOfBookMatrix::Candidate candidate = TopOfBookMatrix::findBestSpread(quotes, activeMask, dirtyMask, &excluded);
+        if (candidate.buy < 0 || candidate.margin <= 0.0) {
+            return;
+        }
+
+        ExchangeId buyExchange = static_cast<ExchangeId>(candidate.buy);
+        ExchangeId sellExchange = static_cast<ExchangeId>(candidate.sell);
+        // the matrix is in doubles; the decision is made on ticks, with fresh tops of both books
+        Opportunity opp = calculateProfit(buyExchange, sellExchange, pair);
+        if (opp.amount <= 0) {
+            excluded[candidate.buy] |= OrderBookManager::exchangeBit(sellExchange);
+            continue;
         }
+
+        // keep the direction bookkeeping of the exchange list: opp1 buys on the earlier exchange
+        const bool opp1 = (opp1Sells[candidate.buy] & OrderBookManager::exchangeBit(sellExchange)) != 0;
+        if (opp.profit() > Config::MIN_TRACEABLE_MARGIN) {
+            DEBUG("Found opportunity: ", opp);
+            trackOpportunity(opp, opp1 ? bestOpportunity1 : bestOpportunity2, opp1 ? "opp1" : "opp2");
+        }
+        const TopOfBookMatrix::Exclusions& direction = opp1 ? opp1Sells : opp2Sells;
+        for (size_t i = 0; i < TopOfBookMatrix::LANES; i++) {
+            excluded[i] |= direction[i];
+        }
+        (opp1 ? opp1Done : opp2Done) = true;
+    }
+}
+
+void StrategyPoplavki::trackOpportunity(const Opportunity& opp, Opportunity& best, const char* name) {
+    if (best.amount == 0 || opp.profit() > best.profit()) {
+        TRACE_CNT(CountableTrace::S_POPLAVKI_OPPORTUNITY, "Updating best ", name, ": ", opp);
+        best = opp;
+    } else {
+        DEBUG("Best seen opportunity is better: ", best, " vs ", opp);
+    }
+    if (best.profit() > Config::MIN_EXECUTION_MARGIN) {
+        TRACE_CNT(CountableTrace::S_POPLAVKI_OPPORTUNITY_EXECUTABLE, "EXECUTABLE: ", best);
+        orderManager.handleOpportunity(best);
     }
 }
 
@@ -137,7 +212,9 @@ void StrategyPoplavki::timerCallback(int id, void *data) {
     auto* strategy = static_cast<StrategyPoplavki*>(data);
     
     DEBUG_OBJ("INFO: ", strategy, TraceInstance::STRAT, ExchangeId::UNKNOWN, "Timer callback for strategy: ", strategy->getName());
-    strategy->scanOpportunities();
+    // safety net only: the update callbacks normally drain the changes already, so this is a no-op
+    // unless something is still dirty
+    strategy->processDirtyBooks();
 }
 
 // Make the callback function a static member of Strategy
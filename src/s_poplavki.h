@@ -2,8 +2,10 @@
 
 #include <string>
 #include <mutex>
+#include <atomic>
 #include <vector>
 #include "strategy.h"
+#include "tob_matrix.h"
 
 class StrategyPoplavki : public Strategy
 {
@@ -21,6 +23,10 @@ public:
     void scanOpportunities() override;
     void startTimerToScan(int ms) override;
 
+    // Evaluate only the exchange combinations whose books changed since the last pass.
+    // Concurrent calls coalesce: the thread already scanning picks up the new changes.
+    void processDirtyBooks();
+
     static void timerCallback(int id, void *data);
     void execute() override;
 
@@ -37,14 +43,24 @@ private:
 
     // List of exchanges this strategy uses
     std::vector<ExchangeId> exchangeIds;
+    uint32_t exchangeMask = 0; // exchangeIds as OrderBookManager::exchangeBit() bits
+    // Directed spreads per direction, indexed by buy exchange: opp1 sells on a later exchange of exchangeIds,
+    // opp2 on an earlier one
+    TopOfBookMatrix::Exclusions opp1Sells{};
+    TopOfBookMatrix::Exclusions opp2Sells{};
 
     // Order book data
     std::mutex dataMutex;
     int timerId = -1; // Store the timer identifier
+    std::atomic<bool> scanInProgress{false};
 
     // Helper methods
     void updateOrderBookData(ExchangeId exchange);
     Opportunity calculateProfit(ExchangeId buyExchange, ExchangeId sellExchange, TradingPair pair);
+    // Scan combinations involving at least one exchange from dirtyMask (OrderBookManager::exchangeBit)
+    void scanOpportunities(uint32_t dirtyMask);
+    // Remember opp if it beats best and hand best to the order manager once it is executable
+    void trackOpportunity(const Opportunity& opp, Opportunity& best, const char* name);
 
     // For TRACE identification
     const std::vector<ExchangeId> &getExchangeIds() const { return exchangeIds; }
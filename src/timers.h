@@ -24,6 +24,10 @@ enum class TimerType {
     EXCHANGE_PING,
     OPPORTUNITY_TIMEOUT,
     ORDER_TEST_STATE_CHANGE,
+    ORDERBOOK_SNAPSHOT,
+    IO_UTILIZATION,
+    ORDER_SESSION_PING,
+    LATENCY_REPORT,
 };
 
 // Convert timer type to string (only used in traces)
@@ -37,6 +41,10 @@ inline const char* timerTypeToString(TimerType type) {
         case TimerType::EXCHANGE_PING: return "EXCHANGE_PING";
         case TimerType::OPPORTUNITY_TIMEOUT: return "OPPORTUNITY_TIMEOUT";
         case TimerType::ORDER_TEST_STATE_CHANGE: return "ORDER_TEST_STATE_CHANGE";
+        case TimerType::ORDERBOOK_SNAPSHOT: return "ORDERBOOK_SNAPSHOT";
+        case TimerType::IO_UTILIZATION: return "IO_UTILIZATION";
+        case TimerType::ORDER_SESSION_PING: return "ORDER_SESSION_PING";
+        case TimerType::LATENCY_REPORT: return "LATENCY_REPORT";
         default: return "INVALID";
     }
 }
@@ -0,0 +1,263 @@
+#include "tob_matrix.h"
+#include "orderbook.h"
+
+#include <limits>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace {
+
+constexpr double NO_ASK = std::numeric_limits<double>::infinity();
+constexpr double NO_VALUE = -std::numeric_limits<double>::infinity();
+constexpr size_t LANES = TopOfBookMatrix::LANES;
+
+// Exchanges that may be sold on when buying on `buy`: active ones except `buy` itself and the
+// excluded ones, and if `buy` did not change, only the ones that did
+inline uint32_t sellMaskFor(uint32_t buy, uint32_t activeMask, uint32_t dirtyMask,
+                            const TopOfBookMatrix::Exclusions* excluded) {
+    uint32_t mask = activeMask & ~(1u << buy);
+    if (excluded) {
+        mask &= ~(*excluded)[buy];
+    }
+    return (dirtyMask >> buy) & 1u ? mask : mask & dirtyMask;
+}
+
+// Final step shared by all kernels: per sell lane j, best[j] = max over buys of bid[j] / ask[buy]
+// and bestBuy[j] = that buy. Pick the best lane; ratios <= 0 mean an empty side.
+TopOfBookMatrix::Candidate reduce(const double* best, const double* bestBuy) {
+    TopOfBookMatrix::Candidate candidate;
+    double bestRatio = 0.0;
+    for (size_t j = 0; j < LANES; j++) {
+        if (best[j] > bestRatio) {
+            bestRatio = best[j];
+            candidate.buy = static_cast<int>(bestBuy[j]);
+            candidate.sell = static_cast<int>(j);
+        }
+    }
+    if (candidate.buy >= 0) {
+        candidate.margin = bestRatio - 1.0;
+    }
+    return candidate;
+}
+
+} // namespace
+
+TopOfBookMatrix::TopOfBookMatrix() {
+    for (auto& row : rows) {
+        for (size_t j = 0; j < LANES; j++) {
+            row.bid[j].store(0.0, std::memory_order_relaxed);
+            row.ask[j].store(NO_ASK, std::memory_order_relaxed);
+            row.bidQty[j].store(0.0, std::memory_order_relaxed);
+            row.askQty[j].store(0.0, std::memory_order_relaxed);
+        }
+    }
+}
+
+void TopOfBookMatrix::update(ExchangeId exchangeId, TradingPair pair, const TopOfBook& tob) {
+    Row& row = rows.at(static_cast<size_t>(pair));
+    const size_t lane = static_cast<size_t>(exchangeId);
+
+    // empty sides are stored so that they never win: bid 0, ask +inf
+    const bool hasBid = tob.bidTicks > 0 && tob.bidLots > 0;
+    const bool hasAsk = tob.askTicks > 0 && tob.askLots > 0;
+
+    while (row.writer.test_and_set(std::memory_order_acquire)) {
+        // other exchange of the same pair is writing; it takes a few stores
+    }
+    uint64_t s = row.seq.load(std::memory_order_relaxed);
+    row.seq.store(s + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    row.bid[lane].store(hasBid ? tob.bestBid : 0.0, std::memory_order_relaxed);
+    row.ask[lane].store(hasAsk ? tob.bestAsk : NO_ASK, std::memory_order_relaxed);
+    row.bidQty[lane].store(hasBid ? tob.bestBidQuantity : 0.0, std::memory_order_relaxed);
+    row.askQty[lane].store(hasAsk ? tob.bestAskQuantity : 0.0, std::memory_order_relaxed);
+    row.seq.store(s + 2, std::memory_order_release);
+    row.writer.clear(std::memory_order_release);
+}
+
+void TopOfBookMatrix::clear(ExchangeId exchangeId, TradingPair pair) {
+    update(exchangeId, pair, TopOfBook{});
+}
+
+void TopOfBookMatrix::snapshot(TradingPair pair, Quotes& out) const {
+    const Row& row = rows.at(static_cast<size_t>(pair));
+    uint64_t before, after;
+    do {
+        before = row.seq.load(std::memory_order_acquire);
+        for (size_t j = 0; j < LANES; j++) {
+            out.bid[j] = row.bid[j].load(std::memory_order_relaxed);
+            out.ask[j] = row.ask[j].load(std::memory_order_relaxed);
+            out.bidQty[j] = row.bidQty[j].load(std::memory_order_relaxed);
+            out.askQty[j] = row.askQty[j].load(std::memory_order_relaxed);
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+        after = row.seq.load(std::memory_order_relaxed);
+    } while (before != after || (before & 1));
+}
+
+TopOfBookMatrix::Candidate TopOfBookMatrix::findBestSpreadScalar(const Quotes& q, uint32_t activeMask, uint32_t dirtyMask,
+                                                                 const Exclusions* excluded) {
+    double best[LANES];
+    double bestBuy[LANES];
+    for (size_t j = 0; j < LANES; j++) {
+        best[j] = NO_VALUE;
+        bestBuy[j] = -1.0;
+    }
+    for (uint32_t i = 0; i < LANES; i++) {
+        const uint32_t sellMask = (activeMask >> i) & 1u ? sellMaskFor(i, activeMask, dirtyMask, excluded) : 0;
+        if (!sellMask) {
+            continue;
+        }
+        const double inv = 1.0 / q.ask[i];
+        for (size_t j = 0; j < LANES; j++) {
+            const double ratio = q.bid[j] * inv;
+            if ((sellMask >> j) & 1u && ratio > best[j]) {
+                best[j] = ratio;
+                bestBuy[j] = static_cast<double>(i);
+            }
+        }
+    }
+    return reduce(best, bestBuy);
+}
+
+#if defined(__AVX2__)
+
+TopOfBookMatrix::Candidate TopOfBookMatrix::findBestSpread(const Quotes& q, uint32_t activeMask, uint32_t dirtyMask,
+                                                           const Exclusions* excluded) {
+    constexpr size_t GROUPS = LANES / 4;
+    __m256d best[GROUPS];
+    __m256d bestBuy[GROUPS];
+    __m256i laneBits[GROUPS];
+    for (size_t g = 0; g < GROUPS; g++) {
+        best[g] = _mm256_set1_pd(NO_VALUE);
+        bestBuy[g] = _mm256_set1_pd(-1.0);
+        laneBits[g] = _mm256_setr_epi64x(1LL << (4 * g), 1LL << (4 * g + 1), 1LL << (4 * g + 2), 1LL << (4 * g + 3));
+    }
+    for (uint32_t i = 0; i < LANES; i++) {
+        const uint32_t sellMask = (activeMask >> i) & 1u ? sellMaskFor(i, activeMask, dirtyMask, excluded) : 0;
+        if (!sellMask) {
+            continue;
+        }
+        const __m256d inv = _mm256_set1_pd(1.0 / q.ask[i]);
+        const __m256d buy = _mm256_set1_pd(static_cast<double>(i));
+        const __m256i mask = _mm256_set1_epi64x(sellMask);
+        for (size_t g = 0; g < GROUPS; g++) {
+            const __m256d ratio = _mm256_mul_pd(_mm256_load_pd(q.bid + 4 * g), inv);
+            const __m256d allowed = _mm256_castsi256_pd(
+                _mm256_cmpeq_epi64(_mm256_and_si256(mask, laneBits[g]), laneBits[g]));
+            const __m256d better = _mm256_and_pd(_mm256_cmp_pd(ratio, best[g], _CMP_GT_OQ), allowed);
+            best[g] = _mm256_blendv_pd(best[g], ratio, better);
+            bestBuy[g] = _mm256_blendv_pd(bestBuy[g], buy, better);
+        }
+    }
+    alignas(32) double bestOut[LANES];
+    alignas(32) double buyOut[LANES];
+    for (size_t g = 0; g < GROUPS; g++) {
+        _mm256_store_pd(bestOut + 4 * g, best[g]);
+        _mm256_store_pd(buyOut + 4 * g, bestBuy[g]);
+    }
+    return reduce(bestOut, buyOut);
+}
+
+const char* TopOfBookMatrix::kernelName() { return "avx2"; }
+
+#elif defined(__SSE2__)
+
+TopOfBookMatrix::Candidate TopOfBookMatrix::findBestSpread(const Quotes& q, uint32_t activeMask, uint32_t dirtyMask,
+                                                           const Exclusions* excluded) {
+    constexpr size_t GROUPS = LANES / 2;
+    // lane masks for every 2-bit pattern of the sell mask (SSE2 has no 64-bit integer compare)
+    const __m128d patterns[4] = {
+        _mm_castsi128_pd(_mm_set_epi64x(0, 0)),
+        _mm_castsi128_pd(_mm_set_epi64x(0, -1)),
+        _mm_castsi128_pd(_mm_set_epi64x(-1, 0)),
+        _mm_castsi128_pd(_mm_set_epi64x(-1, -1)),
+    };
+    __m128d best[GROUPS];
+    __m128d bestBuy[GROUPS];
+    for (size_t g = 0; g < GROUPS; g++) {
+        best[g] = _mm_set1_pd(NO_VALUE);
+        bestBuy[g] = _mm_set1_pd(-1.0);
+    }
+    for (uint32_t i = 0; i < LANES; i++) {
+        const uint32_t sellMask = (activeMask >> i) & 1u ? sellMaskFor(i, activeMask, dirtyMask, excluded) : 0;
+        if (!sellMask) {
+            continue;
+        }
+        const __m128d inv = _mm_set1_pd(1.0 / q.ask[i]);
+        const __m128d buy = _mm_set1_pd(static_cast<double>(i));
+        for (size_t g = 0; g < GROUPS; g++) {
+            const __m128d ratio = _mm_mul_pd(_mm_load_pd(q.bid + 2 * g), inv);
+            const __m128d allowed = patterns[(sellMask >> (2 * g)) & 3u];
+            const __m128d better = _mm_and_pd(_mm_cmpgt_pd(ratio, best[g]), allowed);
+            best[g] = _mm_or_pd(_mm_and_pd(better, ratio), _mm_andnot_pd(better, best[g]));
+            bestBuy[g] = _mm_or_pd(_mm_and_pd(better, buy), _mm_andnot_pd(better, bestBuy[g]));
+        }
+    }
+    alignas(16) double bestOut[LANES];
+    alignas(16) double buyOut[LANES];
+    for (size_t g = 0; g < GROUPS; g++) {
+        _mm_store_pd(bestOut + 2 * g, best[g]);
+        _mm_store_pd(buyOut + 2 * g, bestBuy[g]);
+    }
+    return reduce(bestOut, buyOut);
+}
+
+const char* TopOfBookMatrix::kernelName() { return "sse2"; }
+
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+
+TopOfBookMatrix::Candidate TopOfBookMatrix::findBestSpread(const Quotes& q, uint32_t activeMask, uint32_t dirtyMask,
+                                                           const Exclusions* excluded) {
+    constexpr size_t GROUPS = LANES / 2;
+    float64x2_t best[GROUPS];
+    float64x2_t bestBuy[GROUPS];
+    uint64x2_t laneBits[GROUPS];
+    for (size_t g = 0; g < GROUPS; g++) {
+        best[g] = vdupq_n_f64(NO_VALUE);
+        bestBuy[g] = vdupq_n_f64(-1.0);
+        const uint64_t bits[2] = {1ULL << (2 * g), 1ULL << (2 * g + 1)};
+        laneBits[g] = vld1q_u64(bits);
+    }
+    for (uint32_t i = 0; i < LANES; i++) {
+        const uint32_t sellMask = (activeMask >> i) & 1u ? sellMaskFor(i, activeMask, dirtyMask, excluded) : 0;
+        if (!sellMask) {
+            continue;
+        }
+        const float64x2_t inv = vdupq_n_f64(1.0 / q.ask[i]);
+        const float64x2_t buy = vdupq_n_f64(static_cast<double>(i));
+        const uint64x2_t mask = vdupq_n_u64(sellMask);
+        for (size_t g = 0; g < GROUPS; g++) {
+            const float64x2_t ratio = vmulq_f64(vld1q_f64(q.bid + 2 * g), inv);
+            const uint64x2_t better = vandq_u64(vcgtq_f64(ratio, best[g]), vtstq_u64(mask, laneBits[g]));
+            best[g] = vbslq_f64(better, ratio, best[g]);
+            bestBuy[g] = vbslq_f64(better, buy, bestBuy[g]);
+        }
+    }
+    double bestOut[LANES];
+    double buyOut[LANES];
+    for (size_t g = 0; g < GROUPS; g++) {
+        vst1q_f64(bestOut + 2 * g, best[g]);
+        vst1q_f64(buyOut + 2 * g, bestBuy[g]);
+    }
+    return reduce(bestOut, buyOut);
+}
+
+const char* TopOfBookMatrix::kernelName() { return "neon"; }
+
+#else
+
+TopOfBookMatrix::Candidate TopOfBookMatrix::findBestSpread(const Quotes& q, uint32_t activeMask, uint32_t dirtyMask,
+                                                           const Exclusions* excluded) {
+    return findBestSpreadScalar(q, activeMask, dirtyMask, excluded);
+}
+
+const char* TopOfBookMatrix::kernelName() { return "scalar"; }
+
+#endif
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+#include "types.h"
+
+struct TopOfBook;
+
+// Cross-exchange top of book, laid out as a structure of arrays [pair][exchange]:
+// for every pair the best bids, best asks and their quantities of all exchanges are contiguous,
+// so a whole pair is a handful of vector loads. Slots are indexed by the ExchangeId value and
+// padded to LANES; empty slots hold bid 0 / ask +inf and can never win a comparison.
+//
+// Rows are written by the feed threads through OrderBookManager and read by the strategies.
+// Each row is a seqlock with a tiny writer spinlock (several exchanges write the same pair);
+// readers copy the row with snapshot() and run the kernels on the copy.
+class TopOfBookMatrix {
+public:
+    static constexpr size_t LANES = 8; // multiple of 4 (one AVX2 register of doubles)
+    static constexpr size_t PAIR_COUNT = static_cast<size_t>(TradingPair::COUNT);
+    static_assert(static_cast<size_t>(ExchangeId::COUNT) <= LANES, "grow LANES for more exchanges");
+    static_assert(LANES % 4 == 0, "kernels process lanes in groups of 4");
+
+    // Plain copy of one pair's row, the kernels' input
+    struct alignas(64) Quotes {
+        double bid[LANES];
+        double ask[LANES];
+        double bidQty[LANES];
+        double askQty[LANES];
+    };
+
+    // Best directed spread: buy at `buy`'s ask, sell at `sell`'s bid; margin = bid / ask - 1.
+    // buy/sell are ExchangeId values, -1 if no pair of exchanges qualifies.
+    struct Candidate {
+        int buy = -1;
+        int sell = -1;
+        double margin = 0.0;
+    };
+
+    // Directed spreads left out of a search: bit j of excluded[i] drops buying at i and selling at j
+    using Exclusions = std::array<uint32_t, LANES>;
+
+    TopOfBookMatrix();
+
+    // Publish the top of book of one exchange for a pair
+    void update(ExchangeId exchangeId, TradingPair pair, const TopOfBook& tob);
+    // Empty the exchange's slot of a pair, so it never wins until the next update
+    void clear(ExchangeId exchangeId, TradingPair pair);
+
+    // Consistent copy of one pair's row
+    void snapshot(TradingPair pair, Quotes& out) const;
+
+    // Evaluate all directed spreads between exchanges in activeMask and return the best one.
+    // Only combinations with at least one exchange in dirtyMask and not in excluded are considered.
+    // Masks hold one bit per ExchangeId value (see OrderBookManager::exchangeBit).
+    static Candidate findBestSpread(const Quotes& quotes, uint32_t activeMask, uint32_t dirtyMask = ~0u,
+                                    const Exclusions* excluded = nullptr);
+
+    // Reference implementation, also used when no SIMD instruction set is available
+    static Candidate findBestSpreadScalar(const Quotes& quotes, uint32_t activeMask, uint32_t dirtyMask = ~0u,
+                                          const Exclusions* excluded = nullptr);
+
+    // Name of the kernel compiled in (for logs and tests)
+    static const char* kernelName();
+
+private:
+    struct alignas(64) Row {
+        std::atomic<uint64_t> seq{0};
+        std::atomic_flag writer = ATOMIC_FLAG_INIT;
+        std::atomic<double> bid[LANES];
+        std::atomic<double> ask[LANES];
+        std::atomic<double> bidQty[LANES];
+        std::atomic<double> askQty[LANES];
+    };
+    std::array<Row, PAIR_COUNT> rows;
+};
@@ -0,0 +1,131 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+// Typed trace arguments for async tracing: the calling thread stores values raw (tag + bytes)
+// and they are rendered later, by the drain thread or offline by lla_tracedump (trace_journal.h).
+namespace TraceArgs {
+
+enum class Tag : uint8_t {
+    I64 = 1,   // int64_t
+    U64,       // uint64_t
+    F64,       // double, uint8_t precision, uint8_t FloatFormat
+    BOOL,      // uint8_t
+    CHAR,      // char, signed char, unsigned char
+    STR,       // uint32_t length, bytes
+};
+
+enum class FloatFormat : uint8_t { DEFAULT, FIXED, SCIENTIFIC };
+
+// Writes the payload of one trace.
+//
+// Types without a raw encoding (Traceable objects, enums, json, ...) are formatted on the calling
+// thread through `stream`, whose output lands in `scratch`. The stream also keeps the manipulator
+// state of the trace (std::fixed, std::setprecision, ...): doubles are stored with the precision
+// and format in effect, and anything that would not print plainly falls back to text, so the
+// rendered trace reads exactly as if it had been streamed.
+class Encoder {
+public:
+    Encoder(std::string& payload, std::string& scratch, std::ostream& stream)
+        : payload(payload), scratch(scratch), stream(stream) {}
+
+    template <typename T>
+    void add(const T& value) {
+        using U = std::decay_t<T>;
+        if constexpr (std::is_same_v<U, bool>) {
+            if (!plain()) {
+                return text(value);
+            }
+            uint8_t b = value ? 1 : 0;
+            put(Tag::BOOL, &b, sizeof(b));
+        } else if constexpr (std::is_same_v<U, char> || std::is_same_v<U, signed char> || std::is_same_v<U, unsigned char>) {
+            // int8_t and uint8_t included: streamed, they print as characters too
+            if (stream.width() != 0) {
+                return text(value);
+            }
+            char c = static_cast<char>(value);
+            put(Tag::CHAR, &c, sizeof(c));
+        } else if constexpr (std::is_integral_v<U>) {
+            if (!plain()) {
+                return text(value);
+            }
+            if constexpr (std::is_signed_v<U>) {
+                int64_t v = value;
+                put(Tag::I64, &v, sizeof(v));
+            } else {
+                uint64_t v = value;
+                put(Tag::U64, &v, sizeof(v));
+            }
+        } else if constexpr (std::is_floating_point_v<U>) {
+            const auto floatfield = stream.flags() & std::ios_base::floatfield;
+            if (!plain() || floatfield == (std::ios_base::fixed | std::ios_base::scientific) || stream.precision() > 255) {
+                return text(value);
+            }
+            double v = value;
+            put(Tag::F64, &v, sizeof(v));
+            payload.push_back(static_cast<char>(stream.precision()));
+            payload.push_back(static_cast<char>(floatfield == std::ios_base::fixed ? FloatFormat::FIXED :
+                                                floatfield == std::ios_base::scientific ? FloatFormat::SCIENTIFIC :
+                                                FloatFormat::DEFAULT));
+        } else if constexpr (std::is_convertible_v<const U&, std::string_view> && !std::is_pointer_v<U>) {
+            if (stream.width() != 0) {
+                return text(value);
+            }
+            putString(std::string_view(value));
+        } else if constexpr (std::is_array_v<T> && (std::is_same_v<U, const char*> || std::is_same_v<U, char*>)) {
+            if (stream.width() != 0) {
+                return text(value);
+            }
+            putString(std::string_view(value));
+        } else if constexpr (std::is_same_v<U, const char*> || std::is_same_v<U, char*>) {
+            if (stream.width() != 0 || value == nullptr) {
+                return text(value);
+            }
+            putString(std::string_view(value));
+        } else {
+            text(value);
+        }
+    }
+
+    // Formats through the stream and stores the result as a string; manipulators store nothing
+    template <typename... Args>
+    void text(const Args&... values) {
+        scratch.clear();
+        (stream << ... << values);
+        if (!scratch.empty()) {
+            putString(scratch);
+        }
+    }
+
+    void putString(std::string_view s) {
+        uint32_t length = static_cast<uint32_t>(s.size());
+        put(Tag::STR, &length, sizeof(length));
+        payload.append(s.data(), s.size());
+    }
+
+private:
+    std::string& payload;
+    std::string& scratch;
+    std::ostream& stream;
+
+    // Default integer/bool formatting: decimal, no width, no sign or base decorations
+    bool plain() const {
+        const auto flags = stream.flags();
+        const auto basefield = flags & std::ios_base::basefield;
+        return stream.width() == 0 && (basefield == std::ios_base::dec || basefield == 0) &&
+               !(flags & (std::ios_base::showpos | std::ios_base::showbase | std::ios_base::showpoint |
+                          std::ios_base::uppercase | std::ios_base::boolalpha));
+    }
+
+    void put(Tag tag, const void* data, size_t size) {
+        payload.push_back(static_cast<char>(tag));
+        payload.append(static_cast<const char*>(data), size);
+    }
+};
+
+} // namespace TraceArgs
@@ -0,0 +1,265 @@
+// Asynchronous backend of FastTraceLogger: per-thread SPSC rings and a drain thread.
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <ctime>
+#include <memory>
+#include <streambuf>
+#include <thread>
+#include <vector>
+#include "tracer.h"
+#include "trace_journal.h"
+#include "trace_ring.h"
+
+namespace {
+
+// streambuf appending to a string that keeps its capacity between traces: no allocation once warm
+class AppendBuffer : public std::streambuf {
+public:
+    explicit AppendBuffer(std::string& out) : out(out) {}
+
+protected:
+    int_type overflow(int_type c) override {
+        if (c != traits_type::eof()) {
+            out.push_back(static_cast<char>(c));
+        }
+        return c;
+    }
+    std::streamsize xsputn(const char* s, std::streamsize n) override {
+        out.append(s, static_cast<size_t>(n));
+        return n;
+    }
+
+private:
+    std::string& out;
+};
+
+struct AsyncState {
+    std::atomic<bool> enabled{false};
+    std::mutex ringsMutex;  // registration of threads, and the drain
+    std::vector<std::unique_ptr<TraceRing>> rings;
+    std::atomic<bool> draining{false};
+    std::thread drainThread;
+    std::string journalPath;  // guarded by ringsMutex; picked up by the drain
+};
+
+AsyncState& asyncState() {
+    static AsyncState state;
+    return state;
+}
+
+// What a producing thread keeps: its ring and the encoder its traces are written with
+struct ThreadTrace {
+    std::string payload;
+    std::string scratch;
+    AppendBuffer buffer{scratch};
+    std::ostream stream{&buffer};
+    std::ios_base::fmtflags defaultFlags = stream.flags();
+    TraceArgs::Encoder encoder{payload, scratch, stream};
+    TraceRing* ring = nullptr;
+
+    ~ThreadTrace() {
+        if (ring) {
+            ring->owned.store(false, std::memory_order_release);
+        }
+    }
+
+    TraceRing* getRing() {
+        if (!ring) {
+            auto& state = asyncState();
+            MUTEX_LOCK(state.ringsMutex);
+            // reuse the ring of a finished thread; what it left is still drained in order
+            for (auto& candidate : state.rings) {
+                bool expected = false;
+                if (candidate->owned.compare_exchange_strong(expected, true, std::memory_order_acquire)) {
+                    ring = candidate.get();
+                    break;
+                }
+            }
+            if (!ring) {
+                state.rings.push_back(std::make_unique<TraceRing>(Config::TRACE_RING_BYTES));
+                ring = state.rings.back().get();
+                ring->owned.store(true, std::memory_order_relaxed);
+            }
+        }
+        return ring;
+    }
+};
+
+ThreadTrace& threadTrace() {
+    thread_local ThreadTrace trace;
+    return trace;
+}
+
+// Where the drain thread puts what it takes off the rings
+struct Sink {
+    std::string batch;                // text mode
+    TraceJournal::Writer journal;     // binary mode, when open
+};
+
+constexpr size_t DRAIN_BATCH = 4096;
+
+// Writes up to DRAIN_BATCH records, oldest first across the threads; returns how many
+size_t drainOnce(Sink& sink, std::string& openJournal) {
+    auto& state = asyncState();
+    size_t count = 0;
+    {
+        MUTEX_LOCK(state.ringsMutex);
+        if (state.journalPath != openJournal) {
+            sink.journal.close();
+            if (!state.journalPath.empty() && !sink.journal.open(state.journalPath)) {
+                sink.batch += "[TRACES] can not open trace journal " + state.journalPath + ", writing text\n";
+            }
+            openJournal = state.journalPath;
+        }
+        const bool binary = sink.journal.isOpen();
+        for (; count < DRAIN_BATCH; count++) {
+            TraceRing* oldest = nullptr;
+            const TraceRecord* oldestRecord = nullptr;
+            for (auto& ring : state.rings) {
+                const TraceRecord* record = ring->front();
+                if (record && (!oldestRecord || record->timestampNs < oldestRecord->timestampNs)) {
+                    oldest = ring.get();
+                    oldestRecord = record;
+                }
+            }
+            if (!oldest) {
+                break;
+            }
+            if (binary) {
+                sink.journal.write(*oldestRecord);
+            } else {
+                TraceJournal::formatText(sink.batch, TraceJournal::fromRecord(*oldestRecord));
+            }
+            oldest->pop();
+        }
+        for (auto& ring : state.rings) {
+            uint64_t dropped = ring->dropped.exchange(0, std::memory_order_relaxed);
+            if (dropped > 0) {
+                if (binary) {
+                    sink.journal.writeDropped(dropped);
+                } else {
+                    sink.batch += "[TRACES] " + std::to_string(dropped) + " traces dropped: ring full\n";
+                }
+            }
+        }
+    }
+    if (sink.journal.isOpen()) {
+        sink.journal.flush();
+    }
+    if (!sink.batch.empty()) {
+        MUTEX_LOCK(FastTraceLogger::getMutex());
+        std::ostream& out = FastTraceLogger::getOutputStream();
+        out.write(sink.batch.data(), static_cast<std::streamsize>(sink.batch.size()));
+        out.flush();
+        sink.batch.clear();
+    }
+    return count;
+}
+
+void drainLoop() {
+    Sink sink;
+    std::string openJournal;
+    auto& state = asyncState();
+    while (state.draining.load(std::memory_order_acquire)) {
+        if (drainOnce(sink, openJournal) == 0) {
+            std::this_thread::sleep_for(std::chrono::microseconds(Config::TRACE_DRAIN_IDLE_US));
+        }
+    }
+    while (drainOnce(sink, openJournal) > 0) {
+    }
+}
+
+} // namespace
+
+std::atomic<bool>& FastTraceLogger::asyncEnabled() {
+    return asyncState().enabled;
+}
+
+void FastTraceLogger::startAsync() {
+    auto& state = asyncState();
+    if (state.draining.exchange(true)) {
+        return;
+    }
+    static bool atExitRegistered = false;
+    if (!atExitRegistered) {
+        // early returns and exit() still get their traces written
+        std::atexit(stopAsync);
+        atExitRegistered = true;
+    }
+    state.drainThread = std::thread(drainLoop);
+    state.enabled.store(true, std::memory_order_release);
+}
+
+void FastTraceLogger::stopAsync() {
+    auto& state = asyncState();
+    if (!state.draining.load()) {
+        return;
+    }
+    // new traces are written synchronously from here; the drain thread empties the rings and exits
+    state.enabled.store(false, std::memory_order_release);
+    state.draining.store(false, std::memory_order_release);
+    if (state.drainThread.joinable()) {
+        state.drainThread.join();
+    }
+}
+
+bool FastTraceLogger::setJournalFile(const std::string& filename) {
+    if (!filename.empty()) {
+        // fail here rather than on the drain thread
+        std::ofstream probe(filename, std::ios::binary | std::ios::app);
+        if (!probe.is_open()) {
+            return false;
+        }
+    }
+    auto& state = asyncState();
+    MUTEX_LOCK(state.ringsMutex);
+    state.journalPath = filename;
+    return true;
+}
+
+TraceArgs::Encoder& FastTraceLogger::asyncEncoder() {
+    ThreadTrace& trace = threadTrace();
+    trace.payload.clear();
+    trace.stream.clear();
+    trace.stream.flags(trace.defaultFlags);
+    // the synchronous path streams the arguments after its prefix, which leaves std::left set
+    trace.stream.setf(std::ios_base::left, std::ios_base::adjustfield);
+    trace.stream.precision(6);
+    trace.stream.fill(' ');
+    trace.stream.width(0);
+    return trace.encoder;
+}
+
+void FastTraceLogger::asyncPush(std::string_view level, TraceInstance type, ExchangeId exchangeId, std::string_view file, int line) {
+    ThreadTrace& trace = threadTrace();
+    TraceRing* ring = trace.getRing();
+    if (trace.payload.size() > static_cast<size_t>(Config::TRACE_MAX_TEXT)) {
+        // too long to keep typed: render it here and keep the beginning
+        std::string text;
+        TraceJournal::renderArgs(text, trace.payload);
+        text.resize(std::min(text.size(), static_cast<size_t>(Config::TRACE_MAX_TEXT)));
+        trace.payload.clear();
+        trace.encoder.putString(text);
+    }
+    const size_t payloadLength = trace.payload.size();
+    TraceRecord* record = ring->reserve(TraceRing::recordSize(payloadLength));
+    if (!record) {
+        ring->dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    record->size = static_cast<uint32_t>(TraceRing::recordSize(payloadLength));
+    record->line = static_cast<uint32_t>(line);
+    record->timestampNs = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count());
+    record->file = file.data();
+    record->fileLength = static_cast<uint16_t>(file.size());
+    record->payloadLength = static_cast<uint32_t>(payloadLength);
+    record->type = static_cast<uint8_t>(type);
+    record->exchangeId = static_cast<uint8_t>(exchangeId);
+    record->threadId = static_cast<uint16_t>(getThreadId());
+    std::memset(record->level, 0, sizeof(record->level));
+    std::memcpy(record->level, level.data(), std::min(level.size(), sizeof(record->level) - 1));
+    std::memcpy(reinterpret_cast<char*>(record + 1), trace.payload.data(), payloadLength);
+    ring->commit();
+}
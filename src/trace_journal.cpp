@@ -0,0 +1,396 @@
+#include "trace_journal.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <cstdio>
+#include <ctime>
+#include "tracer.h"
+
+namespace TraceJournal {
+
+namespace {
+
+template <typename T>
+bool take(std::string_view& data, T& value) {
+    if (data.size() < sizeof(T)) {
+        return false;
+    }
+    std::memcpy(&value, data.data(), sizeof(T));
+    data.remove_prefix(sizeof(T));
+    return true;
+}
+
+template <typename T>
+void append(std::string& out, const T& value) {
+    out.append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template <typename T>
+bool read(std::istream& in, T& value) {
+    return static_cast<bool>(in.read(reinterpret_cast<char*>(&value), sizeof(T)));
+}
+
+template <typename T>
+void appendNumber(std::string& out, T value) {
+    char buf[24];
+    auto res = std::to_chars(buf, buf + sizeof(buf), value);
+    out.append(buf, res.ptr);
+}
+
+// iostreams render doubles through the printf conversions, so this matches operator<<
+void appendDouble(std::string& out, const Arg& arg) {
+    const char* format = arg.format == TraceArgs::FloatFormat::FIXED ? "%.*f" :
+                         arg.format == TraceArgs::FloatFormat::SCIENTIFIC ? "%.*e" : "%.*g";
+    char buf[512];
+    int n = std::snprintf(buf, sizeof(buf), format, static_cast<int>(arg.precision), arg.f);
+    if (n > 0) {
+        out.append(buf, std::min(static_cast<size_t>(n), sizeof(buf) - 1));
+    }
+}
+
+void appendPadded(std::string& out, std::string_view s, size_t width, bool right) {
+    if (right && s.size() < width) {
+        out.append(width - s.size(), ' ');
+    }
+    out.append(s);
+    if (!right && s.size() < width) {
+        out.append(width - s.size(), ' ');
+    }
+}
+
+void appendJsonString(std::string& out, std::string_view s) {
+    out.push_back('"');
+    for (char c : s) {
+        switch (c) {
+            case '"': out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\t': out += "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    char buf[8];
+                    std::snprintf(buf, sizeof(buf), "\\u%04x", c);
+                    out += buf;
+                } else {
+                    out.push_back(c);
+                }
+        }
+    }
+    out.push_back('"');
+}
+
+void appendCsvField(std::string& out, std::string_view s) {
+    out.push_back('"');
+    for (char c : s) {
+        if (c == '"') {
+            out.push_back('"');
+        }
+        out.push_back(c);
+    }
+    out.push_back('"');
+}
+
+std::string_view trimLevel(std::string_view level) {
+    while (!level.empty() && (level.back() == ' ' || level.back() == '\0')) {
+        level.remove_suffix(1);
+    }
+    return level;
+}
+
+} // namespace
+
+bool nextArg(std::string_view& payload, Arg& arg) {
+    uint8_t tag;
+    if (!take(payload, tag)) {
+        return false;
+    }
+    arg.tag = static_cast<TraceArgs::Tag>(tag);
+    switch (arg.tag) {
+        case TraceArgs::Tag::I64:
+            return take(payload, arg.i);
+        case TraceArgs::Tag::U64:
+            return take(payload, arg.u);
+        case TraceArgs::Tag::F64: {
+            uint8_t format;
+            if (!take(payload, arg.f) || !take(payload, arg.precision) || !take(payload, format)) {
+                return false;
+            }
+            arg.format = static_cast<TraceArgs::FloatFormat>(format);
+            return true;
+        }
+        case TraceArgs::Tag::BOOL: {
+            uint8_t b;
+            if (!take(payload, b)) {
+                return false;
+            }
+            arg.b = b != 0;
+            return true;
+        }
+        case TraceArgs::Tag::CHAR:
+            return take(payload, arg.c);
+        case TraceArgs::Tag::STR: {
+            uint32_t length;
+            if (!take(payload, length) || payload.size() < length) {
+                return false;
+            }
+            arg.s = payload.substr(0, length);
+            payload.remove_prefix(length);
+            return true;
+        }
+    }
+    return false;
+}
+
+void renderArgs(std::string& out, std::string_view payload) {
+    Arg arg;
+    while (nextArg(payload, arg)) {
+        switch (arg.tag) {
+            case TraceArgs::Tag::I64: appendNumber(out, arg.i); break;
+            case TraceArgs::Tag::U64: appendNumber(out, arg.u); break;
+            case TraceArgs::Tag::F64: appendDouble(out, arg); break;
+            case TraceArgs::Tag::BOOL: out.push_back(arg.b ? '1' : '0'); break;
+            case TraceArgs::Tag::CHAR: out.push_back(arg.c); break;
+            case TraceArgs::Tag::STR: out.append(arg.s); break;
+        }
+    }
+}
+
+void formatText(std::string& out, const Line& line) {
+    thread_local time_t cachedSecond = -1;
+    thread_local char cachedTime[16];
+    const time_t seconds = static_cast<time_t>(line.timestampNs / 1000000000ULL);
+    if (seconds != cachedSecond) {
+        std::tm local;
+        localtime_r(&seconds, &local);
+        std::strftime(cachedTime, sizeof(cachedTime), "%H:%M:%S", &local);
+        cachedSecond = seconds;
+    }
+    char ms[8];
+    std::snprintf(ms, sizeof(ms), ".%03u", static_cast<unsigned>((line.timestampNs / 1000000ULL) % 1000));
+    out += cachedTime;
+    out += ms;
+    out += " ";
+    out.append(line.level);
+    out += " tid:";
+    appendNumber(out, line.threadId);
+    out += " ";
+    appendPadded(out, FastTraceLogger::getBaseName(line.file), 15, true);
+    out += ":";
+    char lineNumber[12];
+    auto res = std::to_chars(lineNumber, lineNumber + sizeof(lineNumber), line.line);
+    appendPadded(out, std::string_view(lineNumber, static_cast<size_t>(res.ptr - lineNumber)), 3, false);
+    out += " [";
+    out.append(FastTraceLogger::traceTypeToStr(static_cast<TraceInstance>(line.type)));
+    out += "] ";
+    if (static_cast<ExchangeId>(line.exchangeId) != ExchangeId::UNKNOWN) {
+        out += "[";
+        out.append(FastTraceLogger::exchangeIdToStr(static_cast<ExchangeId>(line.exchangeId)));
+        out += "] ";
+    }
+    renderArgs(out, line.payload);
+    out += "\n";
+}
+
+void formatCsvHeader(std::string& out) {
+    out += "timestamp_ns,thread,level,file,line,instance,exchange,message\n";
+}
+
+void formatCsv(std::string& out, const Line& line) {
+    appendNumber(out, line.timestampNs);
+    out += ",";
+    appendNumber(out, line.threadId);
+    out += ",";
+    out.append(trimLevel(line.level));
+    out += ",";
+    appendCsvField(out, FastTraceLogger::getBaseName(line.file));
+    out += ",";
+    appendNumber(out, line.line);
+    out += ",";
+    out.append(FastTraceLogger::traceTypeToStr(static_cast<TraceInstance>(line.type)));
+    out += ",";
+    out.append(FastTraceLogger::exchangeIdToStr(static_cast<ExchangeId>(line.exchangeId)));
+    out += ",";
+    std::string message;
+    renderArgs(message, line.payload);
+    appendCsvField(out, message);
+    out += "\n";
+}
+
+void formatJson(std::string& out, const Line& line) {
+    out += "{\"ts\":";
+    appendNumber(out, line.timestampNs);
+    out += ",\"tid\":";
+    appendNumber(out, line.threadId);
+    out += ",\"level\":";
+    appendJsonString(out, trimLevel(line.level));
+    out += ",\"file\":";
+    appendJsonString(out, FastTraceLogger::getBaseName(line.file));
+    out += ",\"line\":";
+    appendNumber(out, line.line);
+    out += ",\"instance\":";
+    appendJsonString(out, FastTraceLogger::traceTypeToStr(static_cast<TraceInstance>(line.type)));
+    out += ",\"exchange\":";
+    appendJsonString(out, FastTraceLogger::exchangeIdToStr(static_cast<ExchangeId>(line.exchangeId)));
+    out += ",\"args\":[";
+    std::string_view payload = line.payload;
+    Arg arg;
+    bool first = true;
+    while (nextArg(payload, arg)) {
+        if (!first) {
+            out += ",";
+        }
+        first = false;
+        switch (arg.tag) {
+            case TraceArgs::Tag::I64: appendNumber(out, arg.i); break;
+            case TraceArgs::Tag::U64: appendNumber(out, arg.u); break;
+            case TraceArgs::Tag::F64: {
+                char buf[32];
+                std::snprintf(buf, sizeof(buf), "%.17g", arg.f);
+                out += std::isfinite(arg.f) ? buf : "null";
+                break;
+            }
+            case TraceArgs::Tag::BOOL: out += arg.b ? "true" : "false"; break;
+            case TraceArgs::Tag::CHAR: appendJsonString(out, std::string_view(&arg.c, 1)); break;
+            case TraceArgs::Tag::STR: appendJsonString(out, arg.s); break;
+        }
+    }
+    out += "],\"message\":";
+    std::string message;
+    renderArgs(message, line.payload);
+    appendJsonString(out, message);
+    out += "}\n";
+}
+
+Line fromRecord(const TraceRecord& record) {
+    Line line;
+    line.timestampNs = record.timestampNs;
+    line.threadId = record.threadId;
+    line.level = std::string_view(record.level, strnlen(record.level, sizeof(record.level)));
+    line.file = std::string_view(record.file, record.fileLength);
+    line.line = record.line;
+    line.type = record.type;
+    line.exchangeId = record.exchangeId;
+    line.payload = std::string_view(record.payload(), record.payloadLength);
+    return line;
+}
+
+bool Writer::open(const std::string& path) {
+    close();
+    out.open(path, std::ios::binary | std::ios::trunc);
+    if (!out.is_open()) {
+        return false;
+    }
+    out.write(MAGIC, sizeof(MAGIC));
+    uint32_t reserved = 0;
+    out.write(reinterpret_cast<const char*>(&VERSION), sizeof(VERSION));
+    out.write(reinterpret_cast<const char*>(&reserved), sizeof(reserved));
+    return static_cast<bool>(out);
+}
+
+void Writer::close() {
+    if (out.is_open()) {
+        out.close();
+    }
+    callSites.clear();
+}
+
+void Writer::write(const TraceRecord& record) {
+    uint64_t levelBytes = 0;
+    std::memcpy(&levelBytes, record.level, sizeof(record.level));
+    auto key = std::make_tuple(record.file, record.line, record.type, levelBytes);
+    auto it = callSites.find(key);
+    block.clear();
+    if (it == callSites.end()) {
+        it = callSites.emplace(key, static_cast<uint32_t>(callSites.size())).first;
+        std::string_view file = FastTraceLogger::getBaseName(std::string_view(record.file, record.fileLength));
+        append(block, BlockKind::CALL_SITE);
+        append(block, it->second);
+        append(block, record.line);
+        append(block, record.type);
+        block.append(record.level, sizeof(record.level));
+        append(block, static_cast<uint16_t>(file.size()));
+        block.append(file);
+    }
+    append(block, BlockKind::TRACE);
+    append(block, it->second);
+    append(block, record.timestampNs);
+    append(block, record.threadId);
+    append(block, record.exchangeId);
+    append(block, record.payloadLength);
+    block.append(record.payload(), record.payloadLength);
+    out.write(block.data(), static_cast<std::streamsize>(block.size()));
+}
+
+void Writer::writeDropped(uint64_t count) {
+    block.clear();
+    append(block, BlockKind::DROPPED);
+    append(block, count);
+    out.write(block.data(), static_cast<std::streamsize>(block.size()));
+}
+
+bool Reader::open(const std::string& path) {
+    in.open(path, std::ios::binary);
+    char magic[sizeof(MAGIC)];
+    uint32_t version, reserved;
+    return in.read(magic, sizeof(magic)) && std::memcmp(magic, MAGIC, sizeof(MAGIC)) == 0 &&
+           read(in, version) && version == VERSION && read(in, reserved);
+}
+
+bool Reader::next(Line& line) {
+    BlockKind kind;
+    while (read(in, kind)) {
+        switch (kind) {
+            case BlockKind::CALL_SITE: {
+                uint32_t id;
+                CallSite site;
+                char level[sizeof(TraceRecord::level)];
+                uint16_t fileLength;
+                if (!read(in, id) || !read(in, site.line) || !read(in, site.type) ||
+                    !in.read(level, sizeof(level)) || !read(in, fileLength) || id != callSites.size()) {
+                    return false;
+                }
+                site.level.assign(level, strnlen(level, sizeof(level)));
+                site.file.resize(fileLength);
+                if (!in.read(&site.file[0], fileLength)) {
+                    return false;
+                }
+                callSites.push_back(std::move(site));
+                break;
+            }
+            case BlockKind::TRACE: {
+                uint32_t id, payloadLength;
+                if (!read(in, id) || !read(in, line.timestampNs) || !read(in, line.threadId) ||
+                    !read(in, line.exchangeId) || !read(in, payloadLength) || id >= callSites.size()) {
+                    return false;
+                }
+                payload.resize(payloadLength);
+                if (payloadLength > 0 && !in.read(&payload[0], payloadLength)) {
+                    return false;
+                }
+                const CallSite& site = callSites[id];
+                line.level = site.level;
+                line.file = site.file;
+                line.line = site.line;
+                line.type = site.type;
+                line.payload = payload;
+                return true;
+            }
+            case BlockKind::DROPPED: {
+                uint64_t count;
+                if (!read(in, count)) {
+                    return false;
+                }
+                droppedCount += count;
+                break;
+            }
+            default:
+                return false;
+        }
+    }
+    return false;
+}
+
+} // namespace TraceJournal
@@ -0,0 +1,115 @@
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <map>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <vector>
+#include "trace_args.h"
+#include "trace_ring.h"
+
+// Binary trace journal and the decoding side of async tracing.
+//
+// Instead of text, the drain thread can write the records as they are: the call site (file, line,
+// level, instance) is interned once per journal, then each trace costs its timestamp, thread,
+// exchange and typed argument payload. lla_tracedump renders a journal back to the usual text
+// lines, or to CSV/JSON for analysis.
+//
+// Layout (host byte order): "LLATRACE", uint32_t version, uint32_t reserved, then blocks that
+// start with a BlockKind byte:
+//   CALL_SITE uint32_t id, uint32_t line, uint8_t type, char level[6], uint16_t fileLength, file
+//   TRACE     uint32_t callSite, uint64_t timestampNs, uint16_t threadId, uint8_t exchangeId,
+//             uint32_t payloadLength, payload
+//   DROPPED   uint64_t count (traces lost to full rings)
+namespace TraceJournal {
+
+constexpr char MAGIC[8] = {'L', 'L', 'A', 'T', 'R', 'A', 'C', 'E'};
+constexpr uint32_t VERSION = 1;
+
+enum class BlockKind : uint8_t { CALL_SITE = 1, TRACE = 2, DROPPED = 3 };
+
+// One trace, decoded from a ring record or a journal
+struct Line {
+    uint64_t timestampNs = 0;
+    uint16_t threadId = 0;
+    std::string_view level;
+    std::string_view file;  // base name or path
+    uint32_t line = 0;
+    uint8_t type = 0;        // TraceInstance
+    uint8_t exchangeId = 0;  // ExchangeId
+    std::string_view payload;
+};
+
+// A decoded argument
+struct Arg {
+    TraceArgs::Tag tag;
+    int64_t i = 0;
+    uint64_t u = 0;
+    double f = 0.0;
+    uint8_t precision = 6;
+    TraceArgs::FloatFormat format = TraceArgs::FloatFormat::DEFAULT;
+    bool b = false;
+    char c = 0;
+    std::string_view s;
+};
+
+// Takes the next argument off the front of payload; false at the end or on a malformed payload
+bool nextArg(std::string_view& payload, Arg& arg);
+
+// Appends the arguments as the TRACE call would have streamed them
+void renderArgs(std::string& out, std::string_view payload);
+
+// Appends "hh:mm:ss.mmm LEVEL tid:N       file.cpp:123 [TYPE] [EXCHANGE] args\n", the layout of
+// FastTraceLogger::log. The time is local time.
+void formatText(std::string& out, const Line& line);
+// timestamp_ns,thread,level,file,line,instance,exchange,message
+void formatCsvHeader(std::string& out);
+void formatCsv(std::string& out, const Line& line);
+// One JSON object per line, with the arguments typed
+void formatJson(std::string& out, const Line& line);
+
+Line fromRecord(const TraceRecord& record);
+
+class Writer {
+public:
+    bool open(const std::string& path);
+    bool isOpen() const { return out.is_open(); }
+    void close();
+
+    void write(const TraceRecord& record);
+    void writeDropped(uint64_t count);
+    void flush() { out.flush(); }
+
+private:
+    std::ofstream out;
+    // file, line, type, level bytes
+    std::map<std::tuple<const char*, uint32_t, uint8_t, uint64_t>, uint32_t> callSites;
+    std::string block;
+};
+
+class Reader {
+public:
+    bool open(const std::string& path);
+
+    // Next trace; false at the end of the journal or on a malformed block.
+    // The views in line stay valid until the next call.
+    bool next(Line& line);
+    uint64_t dropped() const { return droppedCount; }
+
+private:
+    struct CallSite {
+        std::string file;
+        std::string level;
+        uint32_t line;
+        uint8_t type;
+    };
+
+    std::ifstream in;
+    std::vector<CallSite> callSites;
+    std::string payload;
+    uint64_t droppedCount = 0;
+};
+
+} // namespace TraceJournal
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+
+// One trace as it sits in a TraceRing: this header, then payloadLength bytes of typed arguments
+// (trace_args.h). Everything is raw; the drain thread renders it to text or writes it to a journal.
+struct TraceRecord {
+    static constexpr uint32_t PADDING = 0x80000000u;  // set in size: skip to the start of the ring
+
+    uint32_t size;          // whole record, header included, multiple of 8. Must stay first.
+    uint32_t line;
+    uint64_t timestampNs;   // system clock, ns since epoch
+    const char* file;       // __FILE__, static storage; with line, identifies the call site
+    uint32_t payloadLength;
+    uint16_t fileLength;
+    uint8_t type;           // TraceInstance
+    uint8_t exchangeId;     // ExchangeId
+    uint16_t threadId;
+    char level[6];          // "INFO ", "ERROR", ...
+
+    const char* payload() const { return reinterpret_cast<const char*>(this + 1); }
+};
+static_assert(sizeof(TraceRecord) % 8 == 0, "records are kept 8 byte aligned");
+
+// Single producer, single consumer ring of variable-size TraceRecords.
+//
+// The producer is the thread that owns the ring, the consumer is the drain thread; neither side
+// ever blocks or locks. A record always occupies one contiguous piece: if it does not fit before
+// the end of the buffer, the rest of the buffer is skipped with a padding marker.
+class TraceRing {
+public:
+    // capacity: bytes, power of two
+    explicit TraceRing(size_t capacity)
+        : buffer(new char[capacity]), capacity(capacity) {}
+
+    TraceRing(const TraceRing&) = delete;
+    TraceRing& operator=(const TraceRing&) = delete;
+
+    static constexpr size_t recordSize(size_t payloadLength) {
+        return (sizeof(TraceRecord) + payloadLength + 7) & ~size_t(7);
+    }
+
+    // Producer: contiguous room for a record of `size` bytes (see recordSize), nullptr if the ring
+    // is full. The record becomes visible to the consumer on commit().
+    TraceRecord* reserve(size_t size) {
+        if (size > capacity / 2) {
+            return nullptr;
+        }
+        const uint64_t h = head.load(std::memory_order_relaxed);
+        const size_t offset = h & (capacity - 1);
+        const size_t contiguous = capacity - offset;
+        const size_t needed = size <= contiguous ? size : contiguous + size;
+        if (h + needed - cachedTail > capacity) {
+            cachedTail = tail.load(std::memory_order_acquire);
+            if (h + needed - cachedTail > capacity) {
+                return nullptr;
+            }
+        }
+        char* at = buffer.get() + offset;
+        if (size > contiguous) {
+            // contiguous is a multiple of 8, so the size field always fits
+            uint32_t padding = static_cast<uint32_t>(contiguous) | TraceRecord::PADDING;
+            std::memcpy(at, &padding, sizeof(padding));
+            at = buffer.get();
+        }
+        pendingHead = h + needed;
+        return reinterpret_cast<TraceRecord*>(at);
+    }
+
+    void commit() {
+        head.store(pendingHead, std::memory_order_release);
+    }
+
+    // Consumer: oldest record, nullptr if empty. Stays valid until pop().
+    const TraceRecord* front() {
+        uint64_t t = tail.load(std::memory_order_relaxed);
+        while (t != head.load(std::memory_order_acquire)) {
+            const auto* record = reinterpret_cast<const TraceRecord*>(buffer.get() + (t & (capacity - 1)));
+            if (!(record->size & TraceRecord::PADDING)) {
+                return record;
+            }
+            t += record->size & ~TraceRecord::PADDING;
+            tail.store(t, std::memory_order_release);
+        }
+        return nullptr;
+    }
+
+    void pop() {
+        uint64_t t = tail.load(std::memory_order_relaxed);
+        const auto* record = reinterpret_cast<const TraceRecord*>(buffer.get() + (t & (capacity - 1)));
+        tail.store(t + record->size, std::memory_order_release);
+    }
+
+    // Records the producer could not push because the ring was full
+    std::atomic<uint64_t> dropped{0};
+    // Set while a live thread produces into the ring; rings of finished threads are handed on
+    std::atomic<bool> owned{false};
+
+private:
+    std::unique_ptr<char[]> buffer;
+    const size_t capacity;
+
+    alignas(64) std::atomic<uint64_t> head{0};  // bytes ever written
+    uint64_t pendingHead = 0;                   // producer only
+    uint64_t cachedTail = 0;                    // producer only: last tail seen
+    alignas(64) std::atomic<uint64_t> tail{0};  // bytes ever consumed
+};
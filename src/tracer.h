@@ -11,6 +11,7 @@
 #include <string>
 #include <sstream>
 #include <iomanip>
+#include <iterator>
 #include <pthread.h>
 
 #include "types.h"  // For ExchangeId
@@ -73,23 +74,107 @@ enum class CountableTrace {
 };
 
 
-// Base macro for logging with object
-#define TRACE_OBJ(_level, _obj, _type, _exchangeId, ...)                                            \
-    if (FastTraceLogger::globalLoggingEnabled().load(std::memory_order_relaxed) &&  \
-        FastTraceLogger::logLevels()[static_cast<int>(_type)].load(std::memory_order_relaxed) && \
-        FastTraceLogger::isLoggingEnabled(_exchangeId)) { \
-        FastTraceLogger::log(_level, _obj, _type, _exchangeId, __FILE__, __LINE__, __VA_ARGS__); \
+// Trace levels compiled in per TraceInstance. Below an instance's level its TRACE/DEBUG calls
+// generate no code at all (ERROR is always compiled); at or above it they are still gated by the
+// runtime toggles. Set from CMake (LLA_TRACE_LEVEL, LLA_TRACE_LEVELS), e.g. for latency builds:
+//   -DLLA_TRACE_LEVELS="ORDERBOOK=OFF,ORDERBOOK_MGR=OFF,A_IO=OFF"
+enum class TraceLevel { OFF, INFO, DEBUG };
+
+#ifndef LLA_TRACE_LEVEL
+#define LLA_TRACE_LEVEL "INFO"  // OFF, INFO or DEBUG for instances not in LLA_TRACE_LEVELS
+#endif
+#ifndef LLA_TRACE_LEVELS
+#define LLA_TRACE_LEVELS ""     // comma separated INSTANCE=LEVEL overrides
+#endif
+
+namespace TraceLevels {
+
+// Spelling of TraceInstance in LLA_TRACE_LEVELS
+constexpr std::string_view INSTANCE_NAMES[] = {
+    "TRACES", "TIMER", "BALANCE", "EVENT_LOOP", "EX_MGR", "STRAT", "ORDERBOOK", "ORDERBOOK_MGR",
+    "ORDER", "ORDER_MGR", "EVENTLOOP", "A_EXCHANGE", "A_IO", "A_KRAKEN", "A_BINANCE", "A_KUCOIN",
+    "A_OKX", "A_CRYPTO", "MAIN", "MUTEX",
+};
+static_assert(std::size(INSTANCE_NAMES) == static_cast<size_t>(TraceInstance::COUNT), "a TraceInstance has no name");
+
+constexpr bool parseLevel(std::string_view name, TraceLevel& level) {
+    if (name == "OFF") { level = TraceLevel::OFF; return true; }
+    if (name == "INFO") { level = TraceLevel::INFO; return true; }
+    if (name == "DEBUG") { level = TraceLevel::DEBUG; return true; }
+    return false;
+}
+
+// Calls f(instance index, level) for every override; false if one is malformed
+template <typename F>
+constexpr bool forEachOverride(std::string_view levels, F&& f) {
+    while (!levels.empty()) {
+        const size_t comma = levels.find(',');
+        const std::string_view entry = levels.substr(0, comma);
+        levels = comma == std::string_view::npos ? std::string_view() : levels.substr(comma + 1);
+        const size_t eq = entry.find('=');
+        TraceLevel level = TraceLevel::INFO;
+        if (eq == std::string_view::npos || !parseLevel(entry.substr(eq + 1), level)) {
+            return false;
+        }
+        size_t index = 0;
+        while (index < std::size(INSTANCE_NAMES) && INSTANCE_NAMES[index] != entry.substr(0, eq)) {
+            index++;
+        }
+        if (index == std::size(INSTANCE_NAMES)) {
+            return false;
+        }
+        f(index, level);
+    }
+    return true;
+}
+
+constexpr bool valid(std::string_view defaultLevel, std::string_view levels) {
+    TraceLevel level = TraceLevel::INFO;
+    return parseLevel(defaultLevel, level) && forEachOverride(levels, [](size_t, TraceLevel) {});
+}
+
+constexpr TraceLevel compiledLevel(TraceInstance type, std::string_view defaultLevel = LLA_TRACE_LEVEL,
+                                   std::string_view levels = LLA_TRACE_LEVELS) {
+    TraceLevel result = TraceLevel::INFO;
+    parseLevel(defaultLevel, result);
+    forEachOverride(levels, [&](size_t index, TraceLevel level) {
+        if (index == static_cast<size_t>(type)) {
+            result = level;
+        }
+    });
+    return result;
+}
+
+constexpr bool compiledIn(TraceInstance type, TraceLevel level) {
+    return compiledLevel(type) >= level;
+}
+
+static_assert(valid(LLA_TRACE_LEVEL, LLA_TRACE_LEVELS), "LLA_TRACE_LEVEL/LLA_TRACE_LEVELS: unknown instance or level");
+
+} // namespace TraceLevels
+
+// Base macro for logging with object, compiled in at _minLevel and above
+#define TRACE_AT(_minLevel, _level, _obj, _type, _exchangeId, ...)                                 \
+    if constexpr (TraceLevels::compiledIn(_type, _minLevel)) {                                   \
+        if (FastTraceLogger::globalLoggingEnabled().load(std::memory_order_relaxed) &&           \
+            FastTraceLogger::logLevels()[static_cast<int>(_type)].load(std::memory_order_relaxed) && \
+            FastTraceLogger::isLoggingEnabled(_exchangeId)) {                                    \
+            FastTraceLogger::log(_level, _obj, _type, _exchangeId, __FILE__, __LINE__, __VA_ARGS__); \
+        }                                                                                        \
     }
 
+#define TRACE_OBJ(_level, _obj, _type, _exchangeId, ...) TRACE_AT(TraceLevel::INFO, _level, _obj, _type, _exchangeId, __VA_ARGS__)
 #define TRACE_THIS(_type, _exchangeId, ...) TRACE_OBJ("INFO ", this, _type, _exchangeId, __VA_ARGS__)
 #define TRACE_BASE(_type, _exchangeId, ...) TRACE_OBJ("INFO ", nullptr, _type, _exchangeId, __VA_ARGS__)
 
 // For logging with countable trace
 #define TRACE_COUNT(_type, _id, _exchangeId, ...) \
-    if(FastTraceLogger::globalLoggingEnabled().load(std::memory_order_relaxed) && \
-        FastTraceLogger::logLevels()[static_cast<int>(_type)].load(std::memory_order_relaxed) && \
-        FastTraceLogger::isLoggingEnabled(_exchangeId)) { \
-        FastTraceLogger::countableLog("INFO ", this, _type, _id, _exchangeId, __FILE__, __LINE__, __VA_ARGS__); \
+    if constexpr (TraceLevels::compiledIn(_type, TraceLevel::INFO)) { \
+        if (FastTraceLogger::globalLoggingEnabled().load(std::memory_order_relaxed) && \
+            FastTraceLogger::logLevels()[static_cast<int>(_type)].load(std::memory_order_relaxed) && \
+            FastTraceLogger::isLoggingEnabled(_exchangeId)) { \
+            FastTraceLogger::countableLog("INFO ", this, _type, _id, _exchangeId, __FILE__, __LINE__, __VA_ARGS__); \
+        } \
     }
 
 // no checks
@@ -99,16 +184,10 @@ enum class CountableTrace {
 #define ERROR_COUNT(_type, _id, _exchangeId, ...) \
     FastTraceLogger::countableLog("ERROR", this, _type, _id, _exchangeId, __FILE__, __LINE__, __VA_ARGS__);
 
-// Debug versions (disabled by default)
-#if 0
-    #define DEBUG_THIS(_type, _exchangeId, ...) TRACE_OBJ("DEBUG", this, _type, _exchangeId, __VA_ARGS__)
-    #define DEBUG_BASE(_type, _exchangeId, ...) TRACE_OBJ("DEBUG", nullptr, _type, _exchangeId, __VA_ARGS__)
-    #define DEBUG_OBJ(_level, _obj, _type, _exchangeId, ...) TRACE_OBJ(_level, _obj, _type, _exchangeId, __VA_ARGS__)
-#else
-    #define DEBUG_THIS(_type, _exchangeId, ...) ((void)0)
-    #define DEBUG_BASE(_type, _exchangeId, ...) ((void)0)
-    #define DEBUG_OBJ(_level, _obj, _type, _exchangeId, ...) ((void)0)
-#endif
+// Debug versions, compiled in only for instances at LLA_TRACE_LEVEL DEBUG
+#define DEBUG_THIS(_type, _exchangeId, ...) TRACE_AT(TraceLevel::DEBUG, "DEBUG", this, _type, _exchangeId, __VA_ARGS__)
+#define DEBUG_BASE(_type, _exchangeId, ...) TRACE_AT(TraceLevel::DEBUG, "DEBUG", nullptr, _type, _exchangeId, __VA_ARGS__)
+#define DEBUG_OBJ(_level, _obj, _type, _exchangeId, ...) TRACE_AT(TraceLevel::DEBUG, _level, _obj, _type, _exchangeId, __VA_ARGS__)
 
 #define CONCATENATE_DETAIL(x, y) x##y
 #define UNIQUE_LOCK_NAME(_base, _line) CONCATENATE_DETAIL(_base, _line)
@@ -130,6 +209,9 @@ std::ostream& operator<<(std::ostream& os, const std::chrono::time_point<Clock,
     return os;
 }
 
+// After the operator<< above: the encoder streams whatever it cannot store raw
+#include "trace_args.h"
+
 // Base class for traceable objects
 class Traceable {
 public:
@@ -164,6 +246,17 @@ public:
     // Set the log file where logs will be written
     static void setLogFile(const std::string& filename);
 
+    // Asynchronous mode (trace_async.cpp): a trace costs encoding its arguments (trace_args.h) and a
+    // push into the calling thread's own lock-free ring. A background thread renders and writes
+    // in batches. Traces are dropped, and counted, if a thread outruns the drain.
+    static void startAsync();
+    // Drain what is left and go back to writing on the calling thread; also runs at exit
+    static void stopAsync();
+    static bool isAsync() { return asyncEnabled().load(std::memory_order_relaxed); }
+    // In async mode, write a binary journal (trace_journal.h, read with lla_tracedump) instead of
+    // text; an empty path goes back to text. False if the file can not be created.
+    static bool setJournalFile(const std::string& filename);
+
     // Convert TraceInstance to a string
     static std::string_view traceTypeToStr(TraceInstance type);
 
@@ -174,6 +267,16 @@ public:
     template <typename... Args>
     static void log(std::string level, const Traceable* instance, TraceInstance type, 
         ExchangeId exchangeId, std::string_view file, int line, Args&&... args) {
+        if (asyncEnabled().load(std::memory_order_relaxed)) {
+            // arguments are stored raw where possible, the drain thread does the formatting
+            TraceArgs::Encoder& encoder = asyncEncoder();
+            if (instance) {
+                encoder.text("[", *instance, "] ");
+            }
+            (encoder.add(args), ...);
+            asyncPush(level, type, exchangeId, file, line);
+            return;
+        }
         std::lock_guard<std::mutex> lock(getMutex());
 
         // Construct log message
@@ -305,6 +408,12 @@ public:
     }
 
 private:
+    static std::atomic<bool>& asyncEnabled();
+    // The calling thread's encoder, emptied and with default formatting
+    static TraceArgs::Encoder& asyncEncoder();
+    // Push what was written to asyncEncoder() as one record
+    static void asyncPush(std::string_view level, TraceInstance type, ExchangeId exchangeId, std::string_view file, int line);
+
     // Add exchange logging levels
     static std::array<std::atomic<bool>, static_cast<int>(ExchangeId::COUNT)>& exchangeLogLevels();  // UNKNOWN, BINANCE, KRAKEN
     
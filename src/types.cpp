@@ -1,10 +1,28 @@
 #include "types.h"
 
-#include <algorithm>
+#include <cstdint>
+
+namespace {
+
+constexpr size_t PAIR_COUNT = static_cast<size_t>(TradingPair::COUNT);
+constexpr size_t EXCHANGE_COUNT = static_cast<size_t>(ExchangeId::COUNT);
+constexpr size_t LISTED_EXCHANGES = EXCHANGE_COUNT - 1;  // all but UNKNOWN
+
+struct ExchangeSymbol {
+    ExchangeId exchange;
+    std::string_view symbol;
+};
+
+struct PairRow {
+    const char* displayName;
+    const char* baseSymbol;
+    const char* quoteSymbol;
+    int precision;
+    ExchangeSymbol symbols[LISTED_EXCHANGES];  // unused entries stay {UNKNOWN, ""}
+};
 
 // ---- TradingPairInfo Table ----
-const std::array<TradingPairInfo, static_cast<size_t>(TradingPair::COUNT)>
-TradingPairData::pairData = {{
+constexpr PairRow PAIR_ROWS[PAIR_COUNT] = {
     {"UNKNOWN", "UNKNOWN", "UNKNOWN", 8, {}},
     {"ADA/USDT", "ADA", "USDT", 6, {{ExchangeId::BINANCE, "ADAUSDT"}, {ExchangeId::KRAKEN, "ADA/USD"}, {ExchangeId::KUCOIN, "ADA-USDT"}, {ExchangeId::OKX, "ADA-USDT"}, {ExchangeId::CRYPTO, "ADAUSD"}}},
     {"ALGO/USDT", "ALGO", "USDT", 5, {{ExchangeId::BINANCE, "ALGOUSDT"}, {ExchangeId::KRAKEN, "ALGO/USD"}, {ExchangeId::KUCOIN, "ALGO-USDT"}, {ExchangeId::OKX, "ALGO-USDT"}, {ExchangeId::CRYPTO, "ALGOUSD"}}},
@@ -20,23 +38,121 @@ TradingPairData::pairData = {{
     {"SOL/USDT", "SOL", "USDT", 2, {{ExchangeId::BINANCE, "SOLUSDT"}, {ExchangeId::KRAKEN, "SOL/USD"}, {ExchangeId::KUCOIN, "SOL-USDT"}, {ExchangeId::OKX, "SOL-USDT"}, {ExchangeId::CRYPTO, "SOLUSD"}}},
     {"XRP/USDT", "XRP", "USDT", 5, {{ExchangeId::BINANCE, "XRPUSDT"}, {ExchangeId::KRAKEN, "XRP/USD"}, {ExchangeId::KUCOIN, "XRP-USDT"}, {ExchangeId::OKX, "XRP-USDT"}, {ExchangeId::CRYPTO, "XRPUSD"}}},
     {"XTZ/USDT", "XTZ", "USDT", 4, {{ExchangeId::BINANCE, "XTZUSDT"}, {ExchangeId::KRAKEN, "XTZ/USD"}, {ExchangeId::KUCOIN, "XTZ-USDT"}, {ExchangeId::OKX, "XTZ-USDT"}, {ExchangeId::CRYPTO, "XTZUSD"}}},
-}};
-
-// ---- Symbol Maps ----
-const std::array<std::unordered_map<std::string, TradingPair>,
-                 static_cast<size_t>(ExchangeId::COUNT)>
-TradingPairData::symbolMaps = []{
-    std::array<std::unordered_map<std::string, TradingPair>, static_cast<size_t>(ExchangeId::COUNT)> maps;
-
-    for (size_t pairIdx = 1; pairIdx < static_cast<size_t>(TradingPair::COUNT); ++pairIdx) {
-        const auto& info = TradingPairData::pairData[pairIdx];
-        for (const auto& [ex, symbol] : info.exchangeSymbols) {
-            std::string lower = symbol;
-            std::transform(lower.begin(), lower.end(), lower.begin(), ::tolower);
-            maps[static_cast<size_t>(ex)].emplace(lower, static_cast<TradingPair>(pairIdx));
+};
+
+// ---- Symbol Tables ----
+// One perfect hash table per exchange, built at compile time from PAIR_ROWS: the seed is searched
+// until every symbol of the exchange gets a slot of its own, so a lookup is one hash and one compare.
+constexpr size_t SYMBOL_SLOTS = 64;  // power of two, a few times the number of pairs
+constexpr uint32_t NO_SEED = UINT32_MAX;
+constexpr uint32_t MAX_SEED = 10000;
+
+struct SymbolSlot {
+    std::string_view symbol;
+    TradingPair pair;
+};
+
+struct SymbolTable {
+    uint32_t seed;
+    SymbolSlot slots[SYMBOL_SLOTS];
+};
+
+constexpr char toLowerAscii(char c) {
+    return (c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c;
+}
+
+// FNV-1a over the lowercased symbol with a final mix, so that the low bits used for the slot
+// depend on every character
+constexpr uint32_t symbolHash(std::string_view symbol, uint32_t seed) {
+    uint32_t hash = 2166136261u ^ (seed * 0x9E3779B9u);
+    for (char c : symbol) {
+        hash ^= static_cast<uint8_t>(toLowerAscii(c));
+        hash *= 16777619u;
+    }
+    hash ^= hash >> 16;
+    hash *= 0x85EBCA6Bu;
+    hash ^= hash >> 13;
+    return hash;
+}
+
+constexpr size_t symbolSlot(std::string_view symbol, uint32_t seed) {
+    return symbolHash(symbol, seed) & (SYMBOL_SLOTS - 1);
+}
+
+constexpr bool equalsIgnoreCase(std::string_view a, std::string_view b) {
+    if (a.size() != b.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < a.size(); i++) {
+        if (toLowerAscii(a[i]) != toLowerAscii(b[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+constexpr SymbolTable buildSymbolTable(ExchangeId exchange) {
+    for (uint32_t seed = 0; seed < MAX_SEED; seed++) {
+        SymbolTable table{seed, {}};
+        bool collision = false;
+        for (size_t pairIdx = 1; pairIdx < PAIR_COUNT && !collision; pairIdx++) {
+            for (const auto& entry : PAIR_ROWS[pairIdx].symbols) {
+                if (entry.exchange != exchange || entry.symbol.empty()) {
+                    continue;
+                }
+                SymbolSlot& slot = table.slots[symbolSlot(entry.symbol, seed)];
+                if (slot.pair != TradingPair::UNKNOWN) {
+                    collision = true;  // also the case for a symbol listed twice: no seed will do
+                    break;
+                }
+                slot = {entry.symbol, static_cast<TradingPair>(pairIdx)};
+            }
+        }
+        if (!collision) {
+            return table;
+        }
+    }
+    return SymbolTable{NO_SEED, {}};
+}
+
+constexpr std::array<SymbolTable, EXCHANGE_COUNT> buildSymbolTables() {
+    std::array<SymbolTable, EXCHANGE_COUNT> tables{};
+    for (size_t ex = 0; ex < EXCHANGE_COUNT; ex++) {
+        tables[ex] = buildSymbolTable(static_cast<ExchangeId>(ex));
+    }
+    return tables;
+}
+
+constexpr std::array<SymbolTable, EXCHANGE_COUNT> SYMBOL_TABLES = buildSymbolTables();
+
+constexpr bool allTablesBuilt() {
+    for (const auto& table : SYMBOL_TABLES) {
+        if (table.seed == NO_SEED) {
+            return false;
         }
     }
-    return maps;
+    return true;
+}
+static_assert(allTablesBuilt(), "duplicate exchange symbol in PAIR_ROWS, or SYMBOL_SLOTS too small");
+
+} // namespace
+
+const std::array<TradingPairInfo, PAIR_COUNT> TradingPairData::pairData = []{
+    std::array<TradingPairInfo, PAIR_COUNT> data;
+    for (size_t pairIdx = 0; pairIdx < PAIR_COUNT; pairIdx++) {
+        const PairRow& row = PAIR_ROWS[pairIdx];
+        TradingPairInfo& info = data[pairIdx];
+        info.displayName = row.displayName;
+        info.baseSymbol = row.baseSymbol;
+        info.quoteSymbol = row.quoteSymbol;
+        info.precision = row.precision;
+        for (const auto& entry : row.symbols) {
+            if (entry.exchange != ExchangeId::UNKNOWN) {
+                info.exchangeSymbols.emplace(entry.exchange, std::string(entry.symbol));
+            }
+        }
+    }
+    return data;
 }();
 
 // ---- API ----
@@ -61,16 +177,13 @@ int TradingPairData::getPrecision(TradingPair pair) {
     return info.precision;
 }
 
-TradingPair TradingPairData::fromSymbol(ExchangeId ex, const std::string& symbol) {
-    if (ex == ExchangeId::UNKNOWN || ex >= ExchangeId::COUNT) {
-        throw std::runtime_error("Invalid exchange " + std::to_string(static_cast<int>(ex)));
+TradingPair TradingPairData::fromSymbol(ExchangeId ex, std::string_view symbol) {
+    const size_t exchangeIdx = static_cast<size_t>(ex);
+    if (exchangeIdx >= EXCHANGE_COUNT) {
+        return TradingPair::UNKNOWN;
     }
-    std::string lower = symbol;
-    std::transform(lower.begin(), lower.end(), lower.begin(), ::tolower);
-    const auto& map = symbolMaps[static_cast<size_t>(ex)];
-    auto it = map.find(lower);
-    if (it == map.end()) {
-        throw std::runtime_error("Symbol not found for exchange " + std::to_string(static_cast<int>(ex)) + " and symbol " + symbol);
-    }
-    return it->second;
+    // the UNKNOWN exchange has an empty table, as does any slot no symbol hashed to
+    const SymbolTable& table = SYMBOL_TABLES[exchangeIdx];
+    const SymbolSlot& slot = table.slots[symbolSlot(symbol, table.seed)];
+    return equalsIgnoreCase(slot.symbol, symbol) ? slot.pair : TradingPair::UNKNOWN;
 }
@@ -6,6 +6,7 @@
 #include <array>
 #include <unordered_map>
 #include <string>
+#include <string_view>
 
 enum class ExchangeId {
     UNKNOWN = 0,
@@ -79,12 +80,13 @@ class TradingPairData {
 public:
     static const TradingPairInfo& get(TradingPair pair);
     static const std::string& getSymbol(ExchangeId ex, TradingPair pair);
-    static TradingPair fromSymbol(ExchangeId ex, const std::string& symbol);
+    // Exchange symbol to pair, case-insensitive; TradingPair::UNKNOWN if the exchange does not list it.
+    // Constant time and allocation-free (compile-time perfect hash per exchange), safe on the hot path.
+    static TradingPair fromSymbol(ExchangeId ex, std::string_view symbol);
     static int getPrecision(TradingPair pair);
 
 private:
     static const std::array<TradingPairInfo, static_cast<size_t>(TradingPair::COUNT)> pairData;
-    static const std::array<std::unordered_map<std::string, TradingPair>, static_cast<size_t>(ExchangeId::COUNT)> symbolMaps;
 };
 
 inline std::ostream& operator<<(std::ostream& os, const TradingPairInfo& info) {
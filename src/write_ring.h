@@ -0,0 +1,53 @@
+#pragma once
+
+#include <algorithm>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Outbound websocket messages of one feed, written in order.
+//
+// A fixed ring of slots, each reserved to slotBytes up front. A message is copied into the next free slot,
+// which keeps it alive until its write completes; one that fits costs no allocation, and a slot grown for
+// a longer message keeps its capacity. Pings and heartbeat replies go out without touching the heap.
+// Not thread safe: the feed's writes hold the exchange's websocket mutex.
+class WriteRing {
+public:
+    WriteRing(size_t slotCount, size_t slotBytes) : slots(std::max<size_t>(1, slotCount)) {
+        for (auto& slot : slots) {
+            slot.reserve(slotBytes);
+        }
+    }
+
+    // False if every slot holds a message not yet written
+    bool push(std::string_view message) {
+        if (count == slots.size()) {
+            return false;
+        }
+        slots[(head + count) % slots.size()].assign(message.data(), message.size());
+        count++;
+        return true;
+    }
+
+    // The oldest message, the one being written
+    const std::string& front() const { return slots[head]; }
+    void pop() {
+        if (count == 0) {
+            return;
+        }
+        head = (head + 1) % slots.size();
+        count--;
+    }
+    // Drops all but the oldest keep messages
+    void truncate(size_t keep) { count = std::min(count, keep); }
+
+    std::string_view at(size_t i) const { return slots[(head + i) % slots.size()]; }
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    size_t capacity() const { return slots.size(); }
+
+private:
+    std::vector<std::string> slots;
+    size_t head = 0;
+    size_t count = 0;
+};
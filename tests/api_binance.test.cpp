@@ -2,6 +2,8 @@
 #include <gmock/gmock.h>
 #include <memory>
 #include <chrono>
+#include <atomic>
+#include <thread>
 #include <nlohmann/json.hpp>
 
 #include "../src/api_exchange.h"
@@ -61,11 +63,15 @@ TEST_F(ApiBinanceTest, ConnectionHandling) {
 
 TEST_F(ApiBinanceTest, OrderBookSnapshot) {
     // Set up snapshot callback
-    bool callbackCalled = false;
+    std::atomic<bool> callbackCalled{false};
     api->setSnapshotCallback([&](bool success) { callbackCalled = success; });
     
-    // Get order book snapshot
+    // Get order book snapshot, it comes in asynchronously
     EXPECT_TRUE(api->getOrderBookSnapshot(TradingPair::BTC_USDT));
+    auto deadline = std::chrono::steady_clock::now() + 10s;
+    while (!callbackCalled && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(10ms);
+    }
     EXPECT_TRUE(callbackCalled);
 }
 
@@ -121,6 +127,7 @@ TEST_F(ApiBinanceTest, ProcessOrderBookSnapshot) {
     })");
 
     api->processOrderBookSnapshot(data, TradingPair::BTC_USDT);
+    EXPECT_EQ(api->getLastUpdateId(TradingPair::BTC_USDT), 160);
 
     // Verify the order book was updated correctly
     auto& orderBook = orderBookManager->getOrderBook(ExchangeId::BINANCE, TradingPair::BTC_USDT);
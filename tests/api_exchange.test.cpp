@@ -1,6 +1,7 @@
 #include <gtest/gtest.h>
 #include <gmock/gmock.h>
 #include <memory>
+#include <queue>
 #include <thread>
 #include <chrono>
 #include <nlohmann/json.hpp>
@@ -123,6 +124,60 @@ public:
         m_messageQueue.push(message);
     }
 
+    // Market data frames, taken as "ticker" channel messages
+    bool processMarketData(const JsonValue& data) override {
+        if (!data["channel"].equals("ticker")) {
+            return false;
+        }
+        int64_t seq;
+        if (data["seq"].getInt(seq) && !isFirstArrival(TradingPair::BTC_USDT, FeedArbiter::Stream::TOP, seq)) {
+            return true;
+        }
+        tickers.emplace_back(data["data"]["price"].str());
+        return true;
+    }
+    std::vector<std::string> tickers;
+
+    // Feeds without a websocket, fed by receive()
+    void useFeeds(size_t count) {
+        feeds.clear();
+        for (size_t i = 0; i < count; i++) {
+            feeds.push_back(std::make_shared<Feed>());
+            feeds.back()->index = i;
+            feeds.back()->up = true;
+        }
+        m_arbiter.setFeeds(count);
+        m_feeds = feeds;
+        m_connectionState = ConnectionState::CONNECTED;
+    }
+    // A frame as the websocket read of the feed leaves it in its buffer
+    void receive(const std::string& frame, size_t feed = 0) {
+        if (feeds.empty()) {
+            useFeeds(1);
+        }
+        auto buffer = feeds[feed]->buffer.prepare(frame.size());
+        memcpy(buffer.data(), frame.data(), frame.size());
+        feeds[feed]->buffer.commit(frame.size());
+        onRead(feeds[feed], {}, frame.size());
+    }
+    const beast::flat_buffer& readBuffer() const { return feeds[0]->buffer; }
+    std::vector<std::shared_ptr<Feed>> feeds;
+
+    // Reconnects are not timed: fail() leaves the feed in reconnectsDue, reconnect() brings it back
+    void fail(size_t feed) {
+        onRead(feeds[feed], net::error::connection_reset, 0);
+    }
+    void scheduleReconnect(const std::shared_ptr<Feed>& feed) override {
+        reconnectsDue.push_back(feed->index);
+    }
+    void reconnect(size_t feed) {
+        onFeedReconnected(feeds[feed]);
+    }
+    void subscribe(const std::string& key, const std::string& message) {
+        doSubscribe(key, message);
+    }
+    std::vector<size_t> reconnectsDue;
+
     // Expose protected members for testing
     std::map<TradingPair, SymbolState>& getSymbolStates() { return symbolStates; }
     TimersManager& getTimersMgr() { return timersManager; }
@@ -266,4 +321,124 @@ TEST_F(ApiExchangeTest, RateLimitHandling) {
     auto end = std::chrono::high_resolution_clock::now();
     auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - start);
     EXPECT_GT(duration.count(), 0);
-}
\ No newline at end of file
+}
+TEST_F(ApiExchangeTest, ReadFramesInPlace) {
+    const std::string frame = R"({"channel":"ticker","data":{"price":"10000.5"}})";
+    const std::string large = R"({"channel":"ticker","data":{"price":"10001.5","pad":")" + std::string(3000, 'x') + R"("}})";
+
+    api->receive(frame);
+    api->receive(large);
+    const size_t capacity = api->readBuffer().capacity();
+    for (int i = 0; i < 100; i++) {
+        api->receive(i % 2 ? frame : large);
+    }
+
+    ASSERT_EQ(api->tickers.size(), 102u);
+    EXPECT_EQ(api->tickers[0], "10000.5");
+    EXPECT_EQ(api->tickers[1], "10001.5");
+    // consumed after each frame, no regrowth once the largest frame fitted
+    EXPECT_EQ(api->readBuffer().size(), 0u);
+    EXPECT_EQ(api->readBuffer().capacity(), capacity);
+
+    auto stats = api->getReadStats();
+    EXPECT_EQ(stats.frames, 102u);
+    EXPECT_EQ(stats.bytes, 51 * frame.size() + 51 * large.size());
+    EXPECT_EQ(stats.maxFrameBytes, large.size());
+}
+
+TEST_F(ApiExchangeTest, RedundantFeedsApplyFirstCopy) {
+    api->useFeeds(2);
+    auto ticker = [](int seq, const char* price) {
+        return std::string(R"({"channel":"ticker","data":{"price":")") + price + R"("},"seq":)" + std::to_string(seq) + "}";
+    };
+
+    api->receive(ticker(1, "100.0"), 0);
+    api->receive(ticker(1, "100.0"), 1);
+    api->receive(ticker(2, "100.5"), 1);  // feed 1 is ahead now
+    api->receive(ticker(2, "100.5"), 0);
+    api->receive(ticker(3, "101.0"), 0);
+    api->receive(ticker(3, "101.0"), 1);
+
+    ASSERT_EQ(api->tickers.size(), 3u);
+    EXPECT_EQ(api->tickers[0], "100.0");
+    EXPECT_EQ(api->tickers[1], "100.5");
+    EXPECT_EQ(api->tickers[2], "101.0");
+
+    auto stats = api->getArbiterStats();
+    EXPECT_EQ(stats.applied, 3u);
+    EXPECT_EQ(stats.duplicates, 3u);
+    ASSERT_EQ(stats.wins.size(), 2u);
+    EXPECT_EQ(stats.wins[0], 2u);
+    EXPECT_EQ(stats.wins[1], 1u);
+}
+
+TEST_F(ApiExchangeTest, ReconnectsAndTimesTheOutage) {
+    api->useFeeds(2);
+    api->subscribe("ticker", R"({"op":"subscribe","args":["ticker"]})");
+    api->subscribe("ticker", R"({"op":"subscribe","args":["ticker","v2"]})");
+    api->subscribe("trades", R"({"op":"subscribe","args":["trades"]})");
+    api->getSymbolStates()[TradingPair::BTC_USDT].setHasSnapshot(true);
+    orderBookManager.updateOrderBookBestBidAsk(ExchangeId::BINANCE, TradingPair::BTC_USDT, 10000.0, 1.0, 10001.0, 1.0);
+
+    // a redundant feed dropping alone is no outage
+    api->fail(0);
+    EXPECT_EQ(api->getConnectionState(), ApiExchange::ConnectionState::CONNECTED);
+    EXPECT_EQ(api->reconnectsDue, (std::vector<size_t>{0}));
+    EXPECT_EQ(api->getFeedsUp(), 1u);
+    EXPECT_FALSE(orderBookManager.getOrderBook(ExchangeId::BINANCE, TradingPair::BTC_USDT).isProvisional());
+
+    // the last one does: the books are stale until data comes in again
+    api->fail(1);
+    EXPECT_EQ(api->getConnectionState(), ApiExchange::ConnectionState::RECONNECTING);
+    EXPECT_EQ(api->reconnectsDue, (std::vector<size_t>{0, 1}));
+    EXPECT_FALSE(api->getSymbolStates()[TradingPair::BTC_USDT].hasSnapshot());
+    EXPECT_TRUE(orderBookManager.getOrderBook(ExchangeId::BINANCE, TradingPair::BTC_USDT).isProvisional());
+    const uint32_t binanceBit = OrderBookManager::exchangeBit(ExchangeId::BINANCE);
+    TopOfBookMatrix::Quotes quotes;
+    orderBookManager.getTopOfBookMatrix().snapshot(TradingPair::BTC_USDT, quotes);
+    EXPECT_DOUBLE_EQ(quotes.bid[static_cast<size_t>(ExchangeId::BINANCE)], 0.0);
+    EXPECT_EQ(orderBookManager.getLiveMask(TradingPair::BTC_USDT) & binanceBit, 0u);
+    EXPECT_EQ(api->getOutageStats().outages, 1u);
+    std::this_thread::sleep_for(20ms);
+
+    // the subscriptions go out again on the feed that is back, the replaced one once
+    api->reconnect(1);
+    EXPECT_EQ(api->getConnectionState(), ApiExchange::ConnectionState::RESUBSCRIBED);
+    ASSERT_EQ(api->feeds[1]->writeRing.size(), 2u);
+    EXPECT_EQ(api->feeds[1]->writeRing.at(0), R"({"op":"subscribe","args":["ticker","v2"]})");
+    EXPECT_EQ(api->feeds[1]->writeRing.at(1), R"({"op":"subscribe","args":["trades"]})");
+    EXPECT_TRUE(api->feeds[0]->writeRing.empty());
+
+    // an acknowledgement is not fresh data
+    api->receive(R"({"event":"subscribed"})", 1);
+    EXPECT_EQ(api->getConnectionState(), ApiExchange::ConnectionState::RESUBSCRIBED);
+
+    orderBookManager.updateOrderBookBestBidAsk(ExchangeId::BINANCE, TradingPair::BTC_USDT, 10000.5, 1.0, 10001.0, 1.0);
+    api->receive(R"({"channel":"ticker","data":{"price":"10000.5"}})", 1);
+    EXPECT_EQ(api->getConnectionState(), ApiExchange::ConnectionState::CONNECTED);
+    EXPECT_FALSE(orderBookManager.getOrderBook(ExchangeId::BINANCE, TradingPair::BTC_USDT).isProvisional());
+    orderBookManager.getTopOfBookMatrix().snapshot(TradingPair::BTC_USDT, quotes);
+    EXPECT_DOUBLE_EQ(quotes.bid[static_cast<size_t>(ExchangeId::BINANCE)], 10000.5);
+    EXPECT_EQ(orderBookManager.getLiveMask(TradingPair::BTC_USDT) & binanceBit, binanceBit);
+
+    auto stats = api->getOutageStats();
+    EXPECT_EQ(stats.outages, 1u);
+    EXPECT_EQ(stats.reconnects, 1u);
+    EXPECT_GE(stats.lastDarkMs, 20u);
+    EXPECT_EQ(stats.maxDarkMs, stats.lastDarkMs);
+    EXPECT_EQ(stats.totalDarkMs, stats.lastDarkMs);
+}
+
+TEST_F(ApiExchangeTest, ReconnectBackoffIsJitteredAndCapped) {
+    for (int i = 0; i < 20; i++) {
+        int first = ApiExchange::reconnectDelayMs(0);
+        EXPECT_GE(first, Config::WS_RECONNECT_BASE_MS / 2);
+        EXPECT_LE(first, Config::WS_RECONNECT_BASE_MS);
+        int third = ApiExchange::reconnectDelayMs(2);
+        EXPECT_GE(third, Config::WS_RECONNECT_BASE_MS * 2);
+        EXPECT_LE(third, Config::WS_RECONNECT_BASE_MS * 4);
+        int late = ApiExchange::reconnectDelayMs(40);
+        EXPECT_GE(late, Config::WS_RECONNECT_MAX_MS / 2);
+        EXPECT_LE(late, Config::WS_RECONNECT_MAX_MS);
+    }
+}
@@ -2,9 +2,11 @@
 #include <gmock/gmock.h>
 #include "api_kraken.h"
 #include <memory>
+#include <set>
 #include <chrono>
 #include <nlohmann/json.hpp>
 #include "orderbook_mgr.h"
+#include "kraken_checksum.h"
 
 using namespace std::chrono_literals;
 using json = nlohmann::json;
@@ -13,11 +15,31 @@ using json = nlohmann::json;
 class TestApiKraken : public ApiKraken {
 public:
     TestApiKraken(bool testMode = true) : ApiKraken({TradingPair::BTC_USDT}, testMode) {}
+    TestApiKraken(const std::vector<TradingPair>& pairs) : ApiKraken(pairs, true) {}
 
     // Expose protected methods for testing
     using ApiKraken::processOrderBookUpdate;
     using ApiKraken::processMessage;
     using ApiKraken::processRateLimitHeaders;
+
+    // Feeds without a websocket and down: only what a reconnect replays is queued on them
+    void useFeeds(size_t count) {
+        for (size_t i = 0; i < count; i++) {
+            feeds.push_back(std::make_shared<Feed>());
+            feeds.back()->index = i;
+        }
+        m_feeds = feeds;
+        m_connected = true;
+    }
+    void reconnect(size_t feed) { onFeedReconnected(feeds[feed]); }
+    std::vector<std::string> written(size_t feed) const {
+        std::vector<std::string> messages;
+        for (size_t i = 0; i < feeds[feed]->writeRing.size(); i++) {
+            messages.emplace_back(feeds[feed]->writeRing.at(i));
+        }
+        return messages;
+    }
+    std::vector<std::shared_ptr<Feed>> feeds;
 };
 
 class ApiKrakenTest : public ::testing::Test {
@@ -173,3 +195,69 @@ TEST_F(ApiKrakenTest, OrderBookChecksumVerification) {
     // Test order book validation
     EXPECT_TRUE(api->isOrderBookValid(pair, expectedChecksum)) << "Order book validation failed";
 }
+
+TEST(KrakenChecksumTest, MatchesChecksumStringWithoutBuildingIt) {
+    // same book as OrderBookChecksumVerification
+    const double bidPrices[] = {45283.5, 45283.4, 45282.1, 45281.0, 45280.3, 45279.0, 45277.6, 45277.5, 45277.3, 45276.6};
+    const double bidQtys[] = {0.1, 1.54582015, 0.1, 0.1, 1.54592586, 0.0799, 0.03310103, 0.3, 1.54602737, 0.15445238};
+    const double askPrices[] = {45285.2, 45286.4, 45286.6, 45289.6, 45290.2, 45291.8, 45294.7, 45296.1, 45297.5, 45299.5};
+    const double askQtys[] = {0.001, 1.54571953, 1.54571109, 1.54560911, 0.1589066, 1.54553491, 0.04454749, 0.3538, 0.09945542, 0.18772827};
+    std::vector<FixedLevel> bids, asks;
+    for (int i = 0; i < 10; i++) {
+        bids.push_back({FixedPoint::toTicks(bidPrices[i]), FixedPoint::toLots(bidQtys[i])});
+        asks.push_back({FixedPoint::toTicks(askPrices[i]), FixedPoint::toLots(askQtys[i])});
+    }
+    const uint32_t expectedChecksum = 3310070434;
+    EXPECT_EQ(KrakenChecksum::of(asks, bids, TradingPair::BTC_USDT), expectedChecksum);
+
+    OrderBookManager manager;
+    manager.updateOrderBook(ExchangeId::KRAKEN, TradingPair::BTC_USDT, bids, asks, true);
+    const auto& book = manager.getOrderBook(ExchangeId::KRAKEN, TradingPair::BTC_USDT);
+    EXPECT_EQ(KrakenChecksum::of(book, TradingPair::BTC_USDT), expectedChecksum);
+
+    // one changed quantity changes the checksum
+    std::vector<FixedLevel> delta = {{FixedPoint::toTicks(45283.4), FixedPoint::toLots(1.5)}}, none;
+    manager.updateOrderBook(ExchangeId::KRAKEN, TradingPair::BTC_USDT, delta, none);
+    EXPECT_NE(KrakenChecksum::of(book, TradingPair::BTC_USDT), expectedChecksum);
+
+    // deeper books only count their top 10 levels, and long digit strings span several buffer flushes
+    TestApiKraken api;
+    for (int i = 0; i < 15; i++) {
+        bids.push_back({FixedPoint::toTicks(45270.0 - i), FixedPoint::toLots(123456789.12345678)});
+        asks.push_back({FixedPoint::toTicks(45300.0 + i), FixedPoint::toLots(123456789.12345678)});
+    }
+    for (auto& level : asks) {
+        level.quantity = FixedPoint::toLots(987654321.87654321);
+    }
+    std::string checksumString = api.buildChecksumString(TradingPair::BTC_USDT, asks) + api.buildChecksumString(TradingPair::BTC_USDT, bids);
+    EXPECT_EQ(KrakenChecksum::of(asks, bids, TradingPair::BTC_USDT), api.computeChecksum(checksumString));
+}
+
+TEST(KrakenSubscriptionTest, ResubscribeReplacesThePairsOwnSubscription) {
+    TestApiKraken api({TradingPair::BTC_USDT, TradingPair::ETH_USDT});
+    api.useFeeds(1);
+    EXPECT_TRUE(api.subscribeOrderBook());
+    // checksum mismatches resubscribe BTC twice
+    EXPECT_TRUE(api.resubscribeOrderBook({TradingPair::BTC_USDT}));
+    EXPECT_TRUE(api.resubscribeOrderBook({TradingPair::BTC_USDT}));
+
+    // the feed that comes back subscribes to each pair once
+    api.reconnect(0);
+    std::multiset<std::string> replayed;
+    for (const auto& message : api.written(0)) {
+        json request = json::parse(message);
+        EXPECT_EQ(request["method"], "subscribe");
+        for (const auto& symbol : request["params"]["symbol"]) {
+            replayed.insert(symbol.get<std::string>());
+        }
+    }
+    EXPECT_EQ(replayed, (std::multiset<std::string>{"BTC/USD", "ETH/USD"}));
+
+    // and to an unsubscribed pair not at all
+    api.feeds[0]->up = false;
+    EXPECT_TRUE(api.handleSubscribeUnsubscribe({TradingPair::ETH_USDT}, false));
+    api.reconnect(0);
+    auto again = api.written(0);
+    ASSERT_EQ(again.size(), replayed.size() + 1);
+    EXPECT_EQ(json::parse(again.back())["params"]["symbol"], json({"BTC/USD"}));
+}
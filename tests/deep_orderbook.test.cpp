@@ -0,0 +1,168 @@
+#include <gtest/gtest.h>
+#include "../src/deep_orderbook.h"
+#include "../src/orderbook_mgr.h"
+#include <map>
+#include <random>
+#include <functional>
+
+using namespace std;
+
+namespace {
+
+// Best `depth` levels of a reference side, best first
+vector<FixedLevel> referenceTop(const map<FixedPoint::Ticks, FixedPoint::Lots>& side, bool isBid, size_t depth) {
+    vector<FixedLevel> result;
+    if (isBid) {
+        for (auto it = side.rbegin(); it != side.rend() && result.size() < depth; ++it) {
+            result.emplace_back(it->first, it->second);
+        }
+    } else {
+        for (auto it = side.begin(); it != side.end() && result.size() < depth; ++it) {
+            result.emplace_back(it->first, it->second);
+        }
+    }
+    return result;
+}
+
+vector<FixedLevel> allLevels(const DeepLadder& ladder) {
+    vector<FixedLevel> result;
+    ladder.forEachLevel([&](const FixedLevel& level) {
+        result.push_back(level);
+        return true;
+    });
+    return result;
+}
+
+} // namespace
+
+TEST(DeepOrderBookTest, LadderTracksBestLevel) {
+    DeepLadder asks(false, 10, 4096);
+    EXPECT_TRUE(asks.empty());
+    EXPECT_TRUE(asks.apply({1000, 5}));
+    EXPECT_FALSE(asks.apply({1050, 1}));
+    EXPECT_TRUE(asks.apply({990, 2}));     // new best
+    EXPECT_TRUE(asks.apply({990, 3}));     // quantity at the best
+    EXPECT_FALSE(asks.apply({1001, 1}));   // off the 10-tick grid
+    EXPECT_EQ(asks.getOffGrid(), 1u);
+    EXPECT_EQ(asks.size(), 3u);
+    EXPECT_EQ(asks.best().price, 990);
+    EXPECT_EQ(asks.best().quantity, 3);
+
+    // deleting the best finds the next one through the bitmap
+    EXPECT_TRUE(asks.apply({990, 0}));
+    EXPECT_EQ(asks.best().price, 1000);
+    EXPECT_FALSE(asks.apply({1050, 0}));
+    EXPECT_TRUE(asks.apply({1000, 0}));
+    EXPECT_TRUE(asks.empty());
+    EXPECT_EQ(asks.best().price, 0);
+
+    // far apart levels: the scan crosses empty words and summary words
+    DeepLadder bids(true, 1, 1 << 16);
+    bids.apply({100000, 1});
+    bids.apply({60000, 2});
+    bids.apply({99999, 3});
+    EXPECT_EQ(bids.best().price, 100000);
+    bids.apply({100000, 0});
+    EXPECT_EQ(bids.best().price, 99999);
+    bids.apply({99999, 0});
+    EXPECT_EQ(bids.best().price, 60000);
+    auto levels = allLevels(bids);
+    ASSERT_EQ(levels.size(), 1u);
+    EXPECT_EQ(levels[0].quantity, 2);
+}
+
+TEST(DeepOrderBookTest, LadderRecentersWindow) {
+    DeepLadder bids(true, 1, 4096);
+    bids.apply({10000, 1});
+    bids.apply({9000, 1});
+    bids.apply({5000, 1});      // deeper than the window: ignored
+    EXPECT_EQ(bids.size(), 2u);
+    EXPECT_EQ(bids.getDropped(), 1u);
+
+    // price moves up beyond the headroom: the window follows and the deepest levels fall out
+    EXPECT_TRUE(bids.apply({13500, 1}));
+    EXPECT_EQ(bids.getRecenters(), 1u);
+    EXPECT_EQ(bids.best().price, 13500);
+    auto levels = allLevels(bids);
+    ASSERT_EQ(levels.size(), 2u);
+    EXPECT_EQ(levels[1].price, 10000);
+
+    // a jump further than the window clears the side
+    EXPECT_TRUE(bids.apply({50000, 1}));
+    EXPECT_EQ(bids.size(), 1u);
+    EXPECT_EQ(bids.best().price, 50000);
+}
+
+TEST(DeepOrderBookTest, MatchesReferenceBook) {
+    mt19937 rng(7);
+    const FixedPoint::Ticks tick = 100;
+    DeepLadder bids(true, tick, 1 << 14);
+    DeepLadder asks(false, tick, 1 << 14);
+    map<FixedPoint::Ticks, FixedPoint::Lots> refBids, refAsks;
+    uniform_int_distribution<int> offset(1, 1000);
+    uniform_int_distribution<int> quantity(0, 3);
+    const FixedPoint::Ticks mid = 5000000 * tick;
+
+    for (int i = 0; i < 200000; i++) {
+        bool isBid = i % 2 == 0;
+        FixedPoint::Ticks price = isBid ? mid - offset(rng) * tick : mid + offset(rng) * tick;
+        FixedPoint::Lots qty = quantity(rng);
+        auto& ref = isBid ? refBids : refAsks;
+        auto& ladder = isBid ? bids : asks;
+
+        FixedLevel before = ladder.best();
+        bool changed = ladder.apply({price, qty});
+        if (qty > 0) {
+            ref[price] = qty;
+        } else {
+            ref.erase(price);
+        }
+        auto top = referenceTop(ref, isBid, 1);
+        FixedLevel after = top.empty() ? FixedLevel() : top[0];
+        ASSERT_EQ(ladder.best().price, after.price) << "step " << i;
+        ASSERT_EQ(ladder.best().quantity, after.quantity) << "step " << i;
+        ASSERT_EQ(changed, before.price != after.price || before.quantity != after.quantity) << "step " << i;
+        ASSERT_EQ(ladder.size(), ref.size());
+    }
+
+    auto levels = allLevels(asks);
+    auto expected = referenceTop(refAsks, false, refAsks.size());
+    ASSERT_EQ(levels.size(), expected.size());
+    for (size_t i = 0; i < levels.size(); i++) {
+        EXPECT_EQ(levels[i].price, expected[i].price);
+        EXPECT_EQ(levels[i].quantity, expected[i].quantity);
+    }
+}
+
+TEST(DeepOrderBookTest, ManagerFeedsTopLevelsFromDeepBook) {
+    OrderBookManager manager;
+    EXPECT_EQ(manager.getDeepBook(ExchangeId::BINANCE, TradingPair::BTC_USDT), nullptr);
+    manager.enableDeepBook(ExchangeId::BINANCE, TradingPair::BTC_USDT);
+    const DeepOrderBook* deep = manager.getDeepBook(ExchangeId::BINANCE, TradingPair::BTC_USDT);
+    ASSERT_NE(deep, nullptr);
+
+    // a 500 level snapshot is kept in full, the OrderBook shows the best levels
+    std::vector<FixedLevel> bids, asks;
+    for (int i = 0; i < 500; i++) {
+        bids.push_back({FixedPoint::toTicks(50000.0 - i * 0.01), FixedPoint::toLots(1.0)});
+        asks.push_back({FixedPoint::toTicks(50000.01 + i * 0.01), FixedPoint::toLots(1.0)});
+    }
+    manager.updateOrderBook(ExchangeId::BINANCE, TradingPair::BTC_USDT, bids, asks, true);
+    EXPECT_EQ(deep->getBidCount(), 500u);
+    EXPECT_EQ(deep->getAskCount(), 500u);
+    auto& book = manager.getOrderBook(ExchangeId::BINANCE, TradingPair::BTC_USDT);
+    EXPECT_EQ(book.getBids().size(), static_cast<size_t>(Config::ORDERBOOK_MAX_DEPTH));
+    EXPECT_DOUBLE_EQ(book.getBestBid(), 50000.0);
+    EXPECT_DOUBLE_EQ(book.getBestAsk(), 50000.01);
+
+    // deleting the top levels pulls deeper ones into view
+    std::vector<FixedLevel> deletes, none;
+    for (int i = 0; i < 20; i++) {
+        deletes.push_back({FixedPoint::toTicks(50000.0 - i * 0.01), 0});
+    }
+    manager.updateOrderBook(ExchangeId::BINANCE, TradingPair::BTC_USDT, deletes, none);
+    EXPECT_DOUBLE_EQ(book.getBestBid(), 49999.8);
+    EXPECT_DOUBLE_EQ(book.getWorstBid(), 49999.71);
+    EXPECT_EQ(deep->getBidCount(), 480u);
+    EXPECT_TRUE(manager.isDirty(TradingPair::BTC_USDT));
+}
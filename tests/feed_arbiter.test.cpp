@@ -0,0 +1,84 @@
+#include <gtest/gtest.h>
+#include "../src/feed_arbiter.h"
+#include "../src/api_kraken.h"
+
+using Stream = FeedArbiter::Stream;
+
+TEST(FeedArbiterTest, SingleFeedAppliesEverything) {
+    FeedArbiter arbiter;
+    EXPECT_TRUE(arbiter.firstArrival(TradingPair::BTC_USDT, Stream::TOP, 5, 0, 0));
+    EXPECT_TRUE(arbiter.firstArrival(TradingPair::BTC_USDT, Stream::TOP, 5, 0, 0));
+    EXPECT_TRUE(arbiter.firstArrival(TradingPair::BTC_USDT, Stream::TOP, 4, 0, 0));
+}
+
+TEST(FeedArbiterTest, FirstCopyWinsAndLateOnesAreDropped) {
+    FeedArbiter arbiter;
+    arbiter.setFeeds(3);
+
+    EXPECT_TRUE(arbiter.firstArrival(TradingPair::BTC_USDT, Stream::BOOK, 10, 0, 2));
+    EXPECT_FALSE(arbiter.firstArrival(TradingPair::BTC_USDT, Stream::BOOK, 10, 0, 0));
+    EXPECT_TRUE(arbiter.firstArrival(TradingPair::BTC_USDT, Stream::BOOK, 11, 0, 0));
+    // a lagging feed still delivering older updates
+    EXPECT_FALSE(arbiter.firstArrival(TradingPair::BTC_USDT, Stream::BOOK, 10, 0, 1));
+    EXPECT_FALSE(arbiter.firstArrival(TradingPair::BTC_USDT, Stream::BOOK, 11, 0, 1));
+
+    // pairs and streams have sequences of their own
+    EXPECT_TRUE(arbiter.firstArrival(TradingPair::ETH_USDT, Stream::BOOK, 3, 0, 1));
+    EXPECT_TRUE(arbiter.firstArrival(TradingPair::BTC_USDT, Stream::TOP, 3, 0, 1));
+
+    const auto& stats = arbiter.getStats();
+    EXPECT_EQ(stats.applied, 4u);
+    EXPECT_EQ(stats.duplicates, 3u);
+    EXPECT_EQ(stats.wins, (std::vector<uint64_t>{1, 2, 1}));
+}
+
+TEST(FeedArbiterTest, TagsTellApartUpdatesWithTheSameSequence) {
+    FeedArbiter arbiter;
+    arbiter.setFeeds(2);
+
+    EXPECT_TRUE(arbiter.firstArrival(TradingPair::BTC_USDT, Stream::BOOK, 100, 0xAAAA, 0));
+    EXPECT_FALSE(arbiter.firstArrival(TradingPair::BTC_USDT, Stream::BOOK, 100, 0xAAAA, 1));
+    EXPECT_TRUE(arbiter.firstArrival(TradingPair::BTC_USDT, Stream::BOOK, 100, 0xBBBB, 1));
+    EXPECT_FALSE(arbiter.firstArrival(TradingPair::BTC_USDT, Stream::BOOK, 100, 0xBBBB, 0));
+}
+
+TEST(FeedArbiterTest, AllTagsOfASequenceAreRemembered) {
+    FeedArbiter arbiter;
+    arbiter.setFeeds(2);
+
+    // two updates A and B in the same microsecond: feed 0 has both before feed 1's copy of A
+    EXPECT_TRUE(arbiter.firstArrival(TradingPair::BTC_USDT, Stream::BOOK, 100, 0xAAAA, 0));
+    EXPECT_TRUE(arbiter.firstArrival(TradingPair::BTC_USDT, Stream::BOOK, 100, 0xBBBB, 0));
+    EXPECT_FALSE(arbiter.firstArrival(TradingPair::BTC_USDT, Stream::BOOK, 100, 0xAAAA, 1));
+    EXPECT_FALSE(arbiter.firstArrival(TradingPair::BTC_USDT, Stream::BOOK, 100, 0xBBBB, 1));
+
+    // a new sequence starts a new set
+    EXPECT_TRUE(arbiter.firstArrival(TradingPair::BTC_USDT, Stream::BOOK, 101, 0xAAAA, 1));
+    EXPECT_FALSE(arbiter.firstArrival(TradingPair::BTC_USDT, Stream::BOOK, 100, 0xCCCC, 0));
+    EXPECT_FALSE(arbiter.firstArrival(TradingPair::BTC_USDT, Stream::BOOK, 101, 0xAAAA, 0));
+
+    EXPECT_EQ(arbiter.getStats().applied, 3u);
+    EXPECT_EQ(arbiter.getStats().duplicates, 4u);
+}
+
+TEST(FeedArbiterTest, ResetForgetsThePair) {
+    FeedArbiter arbiter;
+    arbiter.setFeeds(2);
+
+    EXPECT_TRUE(arbiter.firstArrival(TradingPair::BTC_USDT, Stream::TOP, 1000, 0, 0));
+    EXPECT_TRUE(arbiter.firstArrival(TradingPair::ETH_USDT, Stream::TOP, 1000, 0, 0));
+    arbiter.reset(TradingPair::BTC_USDT);
+    // a restarted sequence
+    EXPECT_TRUE(arbiter.firstArrival(TradingPair::BTC_USDT, Stream::TOP, 1, 0, 1));
+    EXPECT_FALSE(arbiter.firstArrival(TradingPair::ETH_USDT, Stream::TOP, 1, 0, 1));
+}
+
+TEST(FeedArbiterTest, KrakenTimestampsOrderAsSequences) {
+    const uint64_t a = ApiKraken::timestampSequence("2025-05-06T09:17:26.208075Z");
+    EXPECT_EQ(a, 250506091726208075ULL);
+    EXPECT_LT(a, ApiKraken::timestampSequence("2025-05-06T09:17:26.208076Z"));
+    EXPECT_LT(ApiKraken::timestampSequence("2025-05-06T09:17:26.999999Z"), ApiKraken::timestampSequence("2025-05-06T09:17:27.000000Z"));
+    // fewer fraction digits are microseconds as well
+    EXPECT_EQ(ApiKraken::timestampSequence("2025-05-06T09:17:26.2Z"), 250506091726200000ULL);
+    EXPECT_EQ(ApiKraken::timestampSequence("2025-05-06T09:17:26Z"), 250506091726000000ULL);
+}
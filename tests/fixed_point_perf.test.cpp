@@ -0,0 +1,74 @@
+#include <gtest/gtest.h>
+#include "../src/fixed_point.h"
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Price/quantity fields as the adapters receive them
+struct DecimalPayload {
+    const char* exchange;
+    std::vector<std::string> fields;
+};
+
+static const std::vector<DecimalPayload> PAYLOADS = {
+    // bookTicker / depthUpdate
+    {"BINANCE", {"25.35190000", "31.21000000", "25.36520000", "40.66000000", "67232.91000000", "0.00007682"}},
+    // bbo-tbt
+    {"OKX", {"105252.6", "0.16271274", "105252.5", "1.1133491"}},
+    // level1
+    {"KUCOIN", {"9989", "8", "67232.9", "0.00007682"}},
+    // ticker
+    {"CRYPTO", {"105395.1", "0.1865", "105395.2", "0.2914"}},
+};
+
+template <typename Fn>
+static double nsPerField(const std::vector<std::string>& fields, int iterations, Fn&& fn) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++) {
+        for (const auto& field : fields) {
+            fn(field);
+        }
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    return static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()) /
+           (static_cast<double>(iterations) * static_cast<double>(fields.size()));
+}
+
+TEST(FixedPointPerfTest, ParseDecimalVsStod) {
+    const int ITERATIONS = 200000;
+    for (const auto& payload : PAYLOADS) {
+        volatile int64_t sinkFixed = 0;
+        volatile double sinkDouble = 0.0;
+
+        double fixed = nsPerField(payload.fields, ITERATIONS, [&](const std::string& field) {
+            int64_t value;
+            double asDouble;
+            FixedPoint::parseDecimal(std::string_view(field), 8, value, asDouble);
+            sinkFixed = value;
+            sinkDouble = asDouble;
+        });
+        // what the adapters did before: a std::string copy out of the JSON value and std::stod
+        double stod = nsPerField(payload.fields, ITERATIONS, [&](const std::string& field) {
+            std::string copy(field);
+            sinkDouble = std::stod(copy);
+        });
+        double strtod = nsPerField(payload.fields, ITERATIONS, [&](const std::string& field) {
+            sinkDouble = std::strtod(field.c_str(), nullptr);
+        });
+
+        std::cout << payload.exchange << ": parseDecimal " << fixed << " ns/field, std::stod " << stod
+                  << " ns/field, strtod " << strtod << " ns/field" << std::endl;
+        EXPECT_LT(fixed, stod) << payload.exchange;
+
+        // both representations agree with the reference conversion
+        for (const auto& field : payload.fields) {
+            int64_t value;
+            double asDouble;
+            ASSERT_TRUE(FixedPoint::parseDecimal(field, 8, value, asDouble));
+            EXPECT_EQ(asDouble, std::stod(field)) << field;
+            EXPECT_EQ(value, FixedPoint::toTicks(std::stod(field))) << field;
+        }
+    }
+}
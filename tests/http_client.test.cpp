@@ -0,0 +1,200 @@
+#include <gtest/gtest.h>
+#include "../src/http_client.h"
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/beast/core.hpp>
+#include <boost/beast/http.hpp>
+#include <condition_variable>
+#include <future>
+
+using namespace std;
+namespace http = boost::beast::http;
+using tcp = boost::asio::ip::tcp;
+
+namespace {
+
+// Keep-alive HTTP/1.1 server on a loopback port, answering "<method> <target> <body>"
+class EchoServer {
+public:
+    EchoServer() : acceptor(ioc, tcp::endpoint(boost::asio::ip::make_address("127.0.0.1"), 0)) {
+        port = acceptor.local_endpoint().port();
+        acceptThread = thread([this]() { acceptLoop(); });
+    }
+
+    ~EchoServer() {
+        stopping = true;
+        // wake up the blocking accept()
+        tcp::socket wake(ioc);
+        boost::system::error_code ec;
+        wake.connect(acceptor.local_endpoint(), ec);
+        acceptThread.join();
+        for (auto& connection : connections) {
+            connection.join();
+        }
+    }
+
+    string url(const string& target) const { return "http://127.0.0.1:" + to_string(port) + target; }
+    int accepted() const { return acceptedCount.load(); }
+
+private:
+    void acceptLoop() {
+        while (true) {
+            tcp::socket socket(ioc);
+            boost::system::error_code ec;
+            acceptor.accept(socket, ec);
+            if (stopping || ec) {
+                return;
+            }
+            acceptedCount++;
+            connections.emplace_back([this, s = std::move(socket)]() mutable { serve(std::move(s)); });
+        }
+    }
+
+    void serve(tcp::socket socket) {
+        boost::beast::flat_buffer buffer;
+        while (true) {
+            http::request<http::string_body> request;
+            boost::system::error_code ec;
+            http::read(socket, buffer, request, ec);
+            if (ec) {
+                return;  // client closed the connection
+            }
+            http::response<http::string_body> response(http::status::ok, request.version());
+            response.keep_alive(true);
+            response.body() = string(request.method_string()) + " " + string(request.target()) + " " + request.body();
+            response.set("x-echo-header", string(request["x-test"]));
+            response.prepare_payload();
+            http::write(socket, response, ec);
+            if (ec) {
+                return;
+            }
+        }
+    }
+
+    boost::asio::io_context ioc;
+    tcp::acceptor acceptor;
+    unsigned short port = 0;
+    atomic<bool> stopping{false};
+    atomic<int> acceptedCount{0};
+    thread acceptThread;
+    vector<thread> connections;  // only touched by the accept thread until it is joined
+};
+
+} // namespace
+
+TEST(HttpClientTest, ConcurrentRequestsShareKeptAliveConnections) {
+    EchoServer server;
+    HttpClient client(ExchangeId::BINANCE, 2);
+
+    const int count = 20;
+    mutex m;
+    condition_variable cv;
+    int done = 0;
+    int succeeded = 0;
+    for (int i = 0; i < count; i++) {
+        HttpRequest request;
+        request.url = server.url("/depth?id=" + to_string(i));
+        client.request(request, [&, i](HttpResponse& response) {
+            lock_guard<mutex> lock(m);
+            if (response.ok() && response.status == 200 && response.body == "GET /depth?id=" + to_string(i) + " ") {
+                succeeded++;
+            }
+            done++;
+            cv.notify_one();
+        });
+    }
+    {
+        unique_lock<mutex> lock(m);
+        ASSERT_TRUE(cv.wait_for(lock, chrono::seconds(10), [&]() { return done == count; }));
+    }
+    EXPECT_EQ(succeeded, count);
+
+    // requests queue for the two connections instead of opening new ones
+    EXPECT_GE(client.getConnectionsOpened(), 1u);
+    EXPECT_LE(client.getConnectionsOpened(), 2u);
+    EXPECT_EQ(server.accepted(), static_cast<int>(client.getConnectionsOpened()));
+
+    // and a later request reuses one of them
+    HttpRequest request;
+    request.url = server.url("/again");
+    EXPECT_EQ(client.perform(request).body, "GET /again ");
+    EXPECT_LE(client.getConnectionsOpened(), 2u);
+}
+
+TEST(HttpClientTest, PostAndDelete) {
+    EchoServer server;
+    HttpClient client(ExchangeId::KRAKEN, 1);
+
+    HttpRequest post;
+    post.method = "POST";
+    post.url = server.url("/AddOrder");
+    post.body = "pair=XBTUSD&type=buy";
+    post.headers.push_back("x-test: yes");
+    HttpResponse response = client.perform(post);
+    ASSERT_TRUE(response.ok()) << response.error;
+    EXPECT_EQ(response.status, 200);
+    EXPECT_EQ(response.body, "POST /AddOrder pair=XBTUSD&type=buy");
+    EXPECT_NE(response.headers.find("x-echo-header: yes"), string::npos);
+
+    HttpRequest remove;
+    remove.method = "DELETE";
+    remove.url = server.url("/order?orderId=42");
+    response = client.perform(remove);
+    ASSERT_TRUE(response.ok()) << response.error;
+    EXPECT_EQ(response.body, "DELETE /order?orderId=42 ");
+    EXPECT_EQ(client.getConnectionsOpened(), 1u);
+}
+
+TEST(HttpClientTest, ConnectionErrorIsReported) {
+    // a port that was just free: nobody listens there
+    unsigned short port;
+    {
+        boost::asio::io_context ioc;
+        tcp::acceptor acceptor(ioc, tcp::endpoint(boost::asio::ip::make_address("127.0.0.1"), 0));
+        port = acceptor.local_endpoint().port();
+    }
+    HttpClient client(ExchangeId::OKX, 1);
+    HttpRequest request;
+    request.url = "http://127.0.0.1:" + to_string(port) + "/";
+    HttpResponse response = client.perform(request);
+    EXPECT_FALSE(response.ok());
+    EXPECT_EQ(response.status, 0);
+    EXPECT_FALSE(response.error.empty());
+}
+
+TEST(HttpClientTest, DestructionCancelsPendingRequests) {
+    // accepts connections into its backlog and never answers
+    boost::asio::io_context ioc;
+    tcp::acceptor silent(ioc, tcp::endpoint(boost::asio::ip::make_address("127.0.0.1"), 0));
+    const string url = "http://127.0.0.1:" + to_string(silent.local_endpoint().port()) + "/";
+
+    auto client = make_unique<HttpClient>(ExchangeId::KUCOIN, 1);
+    mutex m;
+    vector<HttpResponse> responses;
+    for (int i = 0; i < 3; i++) {
+        HttpRequest request;
+        request.url = url;
+        client->request(request, [&](HttpResponse& response) {
+            lock_guard<mutex> lock(m);
+            responses.push_back(response);
+        });
+    }
+    // a synchronous request waiting when the client goes away
+    HttpRequest request;
+    request.url = url;
+    auto waiting = async(launch::async, [&]() { return client->perform(request); });
+    this_thread::sleep_for(chrono::milliseconds(100));
+    client.reset();
+
+    ASSERT_EQ(waiting.wait_for(chrono::seconds(5)), future_status::ready);
+    HttpResponse response = waiting.get();
+    EXPECT_FALSE(response.ok());
+    EXPECT_EQ(response.status, 0);
+    EXPECT_EQ(response.error, "cancelled");
+
+    ASSERT_EQ(responses.size(), 3u);
+    for (const auto& cancelled : responses) {
+        EXPECT_FALSE(cancelled.ok());
+        EXPECT_EQ(cancelled.status, 0);
+        EXPECT_EQ(cancelled.body, "cancelled");
+    }
+}
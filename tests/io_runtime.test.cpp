@@ -0,0 +1,152 @@
+#include <gtest/gtest.h>
+#include "../src/io_runtime.h"
+#include <boost/asio/post.hpp>
+#include <atomic>
+#include <future>
+#include <set>
+
+using namespace std;
+
+namespace {
+
+// Thread that runs a handler posted to the context
+thread::id runsOn(boost::asio::io_context& ioc) {
+    promise<thread::id> id;
+    boost::asio::post(ioc, [&id]() { id.set_value(this_thread::get_id()); });
+    return id.get_future().get();
+}
+
+void spin(boost::asio::io_context& ioc, chrono::milliseconds duration) {
+    promise<void> done;
+    boost::asio::post(ioc, [&done, duration]() {
+        auto end = chrono::steady_clock::now() + duration;
+        while (chrono::steady_clock::now() < end) {
+        }
+        done.set_value();
+    });
+    done.get_future().get();
+}
+
+} // namespace
+
+TEST(IoRuntimeTest, ThreadPerExchange) {
+    IoRuntime runtime;
+    IoConfig config;
+    config.exchangeCpus[static_cast<int>(ExchangeId::KRAKEN)] = 0;
+    ASSERT_TRUE(runtime.configure(config));
+
+    auto& kraken = runtime.acquire(ExchangeId::KRAKEN);
+    auto& okx = runtime.acquire(ExchangeId::OKX);
+    EXPECT_NE(&kraken, &okx);
+    EXPECT_NE(runsOn(kraken), runsOn(okx));
+    EXPECT_NE(runsOn(kraken), this_thread::get_id());
+    EXPECT_FALSE(runtime.configure(config));
+
+    spin(kraken, chrono::milliseconds(50));
+    runsOn(kraken); // the thread accounts for a handler after it returns
+    auto usage = runtime.sampleUtilization();
+    ASSERT_EQ(usage.size(), 2u);
+    for (const auto& thread : usage) {
+        if (thread.name == "KRAKEN") {
+#ifdef __linux__
+            EXPECT_EQ(thread.cpu, 0);
+#endif
+            EXPECT_GE(thread.handlers, 3u);
+            EXPECT_GT(thread.busy, 0.1);
+        } else {
+            EXPECT_EQ(thread.name, "OKX");
+            EXPECT_EQ(thread.cpu, -1);
+            EXPECT_LE(thread.handlers, 1u);
+            EXPECT_LT(thread.busy, 0.1);
+        }
+    }
+
+    // the context is reused after reconnecting
+    runtime.release(ExchangeId::KRAKEN);
+    auto& again = runtime.acquire(ExchangeId::KRAKEN);
+    EXPECT_EQ(&again, &kraken);
+    EXPECT_NE(runsOn(again), this_thread::get_id());
+    runtime.release(ExchangeId::KRAKEN);
+    runtime.release(ExchangeId::OKX);
+    EXPECT_TRUE(runtime.sampleUtilization().empty());
+    EXPECT_TRUE(runtime.configure(config));
+}
+
+TEST(IoRuntimeTest, SharedPool) {
+    IoRuntime runtime;
+    IoConfig config;
+    config.threading = IoThreading::SHARED_POOL;
+    config.poolThreads = 3;
+    ASSERT_TRUE(runtime.configure(config));
+
+    auto& kraken = runtime.acquire(ExchangeId::KRAKEN);
+    auto& okx = runtime.acquire(ExchangeId::OKX);
+    EXPECT_EQ(&kraken, &okx);
+
+    set<thread::id> threads;
+    for (int i = 0; i < 200 && threads.size() < 2; i++) {
+        // a busy thread leaves the next handler to another one
+        promise<void> started, release;
+        boost::asio::post(kraken, [&]() { started.set_value(); release.get_future().wait(); });
+        started.get_future().wait();
+        threads.insert(runsOn(okx));
+        release.set_value();
+        threads.insert(runsOn(kraken));
+    }
+    EXPECT_GE(threads.size(), 2u);
+
+    auto usage = runtime.sampleUtilization();
+    ASSERT_EQ(usage.size(), 3u);
+    EXPECT_EQ(usage[0].name, "pool-0");
+    EXPECT_EQ(usage[2].name, "pool-2");
+
+    // the pool keeps running while an exchange still uses it
+    runtime.release(ExchangeId::KRAKEN);
+    EXPECT_NE(runsOn(okx), this_thread::get_id());
+    runtime.release(ExchangeId::OKX);
+    EXPECT_TRUE(runtime.sampleUtilization().empty());
+}
+
+TEST(IoRuntimeTest, ReleaseFromItsOwnHandler) {
+    IoRuntime runtime;
+    ASSERT_TRUE(runtime.configure(IoConfig()));
+
+    auto& ioc = runtime.acquire(ExchangeId::OKX);
+    promise<void> released;
+    boost::asio::post(ioc, [&]() {
+        runtime.release(ExchangeId::OKX);
+        released.set_value();
+    });
+    released.get_future().wait();
+    EXPECT_TRUE(runtime.sampleUtilization().empty());
+
+    // a fresh context with threads of its own; nothing runs the old one any more
+    auto& again = runtime.acquire(ExchangeId::OKX);
+    EXPECT_NE(&again, &ioc);
+    EXPECT_NE(runsOn(again), this_thread::get_id());
+    EXPECT_EQ(runtime.sampleUtilization().size(), 1u);
+    atomic<bool> ranOnOld{false};
+    boost::asio::post(ioc, [&ranOnOld]() { ranOnOld = true; });
+    this_thread::sleep_for(chrono::milliseconds(20));
+    EXPECT_FALSE(ranOnOld.load());
+    runtime.release(ExchangeId::OKX);
+}
+
+TEST(IoRuntimeTest, BusyPollStaysOnTheCore) {
+    IoRuntime runtime;
+    IoConfig config;
+    config.busyPoll = true;
+    ASSERT_TRUE(runtime.configure(config));
+
+    auto& ioc = runtime.acquire(ExchangeId::KUCOIN);
+    runtime.sampleUtilization();
+    EXPECT_NE(runsOn(ioc), this_thread::get_id());
+    this_thread::sleep_for(chrono::milliseconds(100));
+    auto usage = runtime.sampleUtilization();
+    ASSERT_EQ(usage.size(), 1u);
+    EXPECT_LE(usage[0].handlers, 1u);
+    EXPECT_LT(usage[0].busy, 0.2);
+    // spinning, although on a single core the scheduler shares it with this thread
+    EXPECT_GT(usage[0].cpuShare, 0.2);
+    runtime.release(ExchangeId::KUCOIN);
+}
@@ -0,0 +1,125 @@
+#include <gtest/gtest.h>
+#include <nlohmann/json.hpp>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "../src/json_scanner.h"
+#include "../src/fixed_point.h"
+
+using namespace std;
+using json = nlohmann::json;
+
+namespace {
+
+const string OKX_BBO = R"({"arg":{"channel":"bbo-tbt","instId":"BTC-USDT"},"data":[{"asks":[["105252.6","0.16271274","0","5"]],"bids":[["105252.5","1.1133491","0","19"]],"ts":"1749044565306","seqId":55729075884}]})";
+const string BINANCE_DEPTH = R"({"e":"depthUpdate","E":123456789,"s":"BTCUSDT","U":157,"u":160,"b":[["10000.0","1.0"],["9999.0","0.00000000"]],"a":[["10001.0","0.5"],["10002.0","1.5"]]})";
+
+} // namespace
+
+TEST(JsonScannerTest, NavigatesExchangeFrames) {
+    JsonValue root = JsonValue::parse(OKX_BBO);
+    ASSERT_TRUE(root.isObject());
+    EXPECT_EQ(root.size(), 2u);
+    EXPECT_TRUE(root.find("arg/channel").equals("bbo-tbt"));
+    EXPECT_EQ(root.find("arg/instId").str(), "BTC-USDT");
+
+    JsonValue level1 = root.find("data/0");
+    ASSERT_TRUE(level1.isObject());
+    int64_t seqId = 0, ts = 0;
+    EXPECT_TRUE(level1["seqId"].getInt(seqId));
+    EXPECT_EQ(seqId, 55729075884);
+    EXPECT_TRUE(level1["ts"].getInt(ts));  // quoted
+    EXPECT_EQ(ts, 1749044565306);
+    EXPECT_EQ(level1["bids"].at(0).size(), 4u);
+    EXPECT_EQ(FixedPoint::parsePrice(root.find("data/0/asks/0/0").str()), FixedPoint::toTicks(105252.6));
+    EXPECT_EQ(root.find("data/0/bids/0/1").str(), "1.1133491");
+
+    // absent members and out of range indices are invalid, as are lookups on the wrong type
+    EXPECT_FALSE(root["missing"].valid());
+    EXPECT_FALSE(root.find("data/1").valid());
+    EXPECT_FALSE(root.find("arg/instId/0").valid());
+    EXPECT_FALSE(root.at(0).valid());
+
+    JsonValue depth = JsonValue::parse(BINANCE_DEPTH);
+    vector<pair<string_view, string_view>> bids;
+    EXPECT_TRUE(depth["b"].forEach([&](const JsonValue& level) {
+        bids.emplace_back(level.at(0).str(), level.at(1).str());
+        return true;
+    }));
+    ASSERT_EQ(bids.size(), 2u);
+    EXPECT_EQ(bids[1].first, "9999.0");
+    EXPECT_EQ(bids[1].second, "0.00000000");
+    int64_t updateId = 0;
+    EXPECT_TRUE(depth["u"].getInt(updateId));
+    EXPECT_EQ(updateId, 160);
+}
+
+TEST(JsonScannerTest, ScalarsAndEdgeCases) {
+    JsonValue root = JsonValue::parse(R"(  {"s":"a\"b}","n":-12,"f":1.5e-3,"t":true,"z":false,"x":null,"e":[],"o":{},"big":99999999999999999999})");
+    ASSERT_TRUE(root.isObject());
+    // escapes are kept raw and do not end the string
+    EXPECT_EQ(root["s"].str(), "a\\\"b}");
+    EXPECT_EQ(root["s"].raw(), "\"a\\\"b}\"");
+    int64_t n = 0;
+    EXPECT_TRUE(root["n"].getInt(n));
+    EXPECT_EQ(n, -12);
+    EXPECT_FALSE(root["f"].getInt(n));
+    EXPECT_EQ(root["f"].str(), "1.5e-3");
+    EXPECT_FALSE(root["big"].getInt(n));  // overflow
+    bool flag = false;
+    EXPECT_TRUE(root["t"].getBool(flag));
+    EXPECT_TRUE(flag);
+    EXPECT_TRUE(root["z"].getBool(flag));
+    EXPECT_FALSE(flag);
+    EXPECT_TRUE(root["x"].isNull());
+    EXPECT_TRUE(root["e"].isArray());
+    EXPECT_EQ(root["e"].size(), 0u);
+    EXPECT_TRUE(root["o"].isObject());
+    EXPECT_EQ(root["o"].size(), 0u);
+    EXPECT_EQ(root.size(), 9u);
+}
+
+TEST(JsonScannerTest, MalformedInputStaysInBounds) {
+    for (const string frame : {"", "   ", "{", "{\"a\":", "{\"a\":[1,2", "{\"a\":\"unterminated", "[1,2,", "nul"}) {
+        JsonValue root = JsonValue::parse(frame);
+        EXPECT_TRUE(root.raw().empty()) << frame;
+        root.find("a/0").raw();  // must not read past the end
+    }
+    // structure is only checked where the scan goes
+    EXPECT_FALSE(JsonValue::parse(R"({"a" 1})")["a"].valid());
+    // a truncated frame still yields the members before the cut
+    JsonValue truncated = JsonValue::parse(R"({"s":"BTCUSDT","b":[["1.0","2.0"],["3.0")");
+    EXPECT_EQ(truncated["s"].str(), "BTCUSDT");
+    EXPECT_FALSE(truncated["b"].forEach([](const JsonValue&) { return true; }));
+    EXPECT_FALSE(truncated["a"].valid());
+}
+
+TEST(JsonScannerTest, FasterThanDom) {
+    const int ITERATIONS = 100000;
+    int64_t checksum = 0;
+
+    auto start = chrono::steady_clock::now();
+    for (int i = 0; i < ITERATIONS; i++) {
+        JsonValue root = JsonValue::parse(OKX_BBO);
+        JsonValue level1 = root.find("data/0");
+        checksum += FixedPoint::parsePrice(level1["bids"].at(0).at(0).str());
+        checksum += FixedPoint::parsePrice(level1["asks"].at(0).at(0).str());
+    }
+    auto scanner = chrono::steady_clock::now() - start;
+
+    start = chrono::steady_clock::now();
+    for (int i = 0; i < ITERATIONS; i++) {
+        json root = json::parse(OKX_BBO);
+        const json& level1 = root["data"][0];
+        checksum -= FixedPoint::parsePrice(level1["bids"][0][0].get_ref<const string&>());
+        checksum -= FixedPoint::parsePrice(level1["asks"][0][0].get_ref<const string&>());
+    }
+    auto dom = chrono::steady_clock::now() - start;
+
+    EXPECT_EQ(checksum, 0);
+    auto ns = [&](chrono::steady_clock::duration d) { return chrono::duration_cast<chrono::nanoseconds>(d).count() / ITERATIONS; };
+    cout << "OKX bbo-tbt frame: scanner " << ns(scanner) << " ns, nlohmann DOM " << ns(dom) << " ns" << endl;
+    EXPECT_LT(scanner, dom);
+}
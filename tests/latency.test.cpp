@@ -0,0 +1,125 @@
+#include <gtest/gtest.h>
+#include <chrono>
+#include <thread>
+#include <boost/asio.hpp>
+#include "../src/latency.h"
+#include "../src/rx_timestamp_stream.h"
+
+namespace net = boost::asio;
+using tcp = net::ip::tcp;
+
+TEST(LatencyTest, HistogramBucketsBoundTheirValues) {
+    for (uint64_t ns : {0ULL, 3ULL, 4ULL, 7ULL, 1000ULL, 123456ULL, 999999999ULL}) {
+        const int bucket = LatencyHistogram::bucketOf(ns);
+        EXPECT_LT(bucket, LatencyHistogram::BUCKETS);
+        EXPECT_GE(LatencyHistogram::bucketUpperNs(bucket), ns);
+        // within a quarter of the value
+        EXPECT_LE(LatencyHistogram::bucketUpperNs(bucket), ns + ns / 4 + 1);
+    }
+    EXPECT_LT(LatencyHistogram::bucketOf(1000), LatencyHistogram::bucketOf(2000));
+}
+
+TEST(LatencyTest, HistogramPercentiles) {
+    LatencyHistogram histogram;
+    EXPECT_EQ(histogram.percentile(50), 0u);
+
+    for (uint64_t ns = 1; ns <= 100; ns++) {
+        histogram.record(ns * 1000);
+    }
+    EXPECT_EQ(histogram.count(), 100u);
+    EXPECT_EQ(histogram.max(), 100000u);
+    EXPECT_EQ(histogram.mean(), 50500u);
+    EXPECT_GE(histogram.percentile(50), 50000u);
+    EXPECT_LE(histogram.percentile(50), 62500u);
+    EXPECT_GE(histogram.percentile(99), 99000u);
+    EXPECT_LE(histogram.percentile(99), 100000u);
+
+    histogram.reset();
+    EXPECT_EQ(histogram.count(), 0u);
+    EXPECT_EQ(histogram.max(), 0u);
+}
+
+TEST(LatencyTest, FrameIsRecordedStageByStage) {
+    LatencyMonitor monitor;
+    const int64_t now = LatencyMonitor::nowNs();
+
+    monitor.beginFrame(ExchangeId::KRAKEN, now - 50000, now - 20000);
+    monitor.parsed();
+    monitor.bookUpdated();
+    // the frame's second book adds nothing
+    monitor.bookUpdated();
+    monitor.decided();
+    monitor.decided();
+    monitor.endFrame();
+
+    for (auto stage : {LatencyStage::WIRE, LatencyStage::PARSE, LatencyStage::BOOK,
+                       LatencyStage::DECISION, LatencyStage::TOTAL}) {
+        EXPECT_EQ(monitor.get(ExchangeId::KRAKEN, stage).count(), 1u) << toString(stage);
+    }
+    EXPECT_GE(monitor.get(ExchangeId::KRAKEN, LatencyStage::WIRE).max(), 30000u);
+    EXPECT_GE(monitor.get(ExchangeId::KRAKEN, LatencyStage::TOTAL).max(), 50000u);
+    EXPECT_EQ(monitor.get(ExchangeId::BINANCE, LatencyStage::TOTAL).count(), 0u);
+
+    // outside a frame and without a kernel timestamp
+    monitor.bookUpdated();
+    monitor.decided();
+    monitor.beginFrame(ExchangeId::KRAKEN, 0, LatencyMonitor::nowNs());
+    monitor.parsed();
+    monitor.bookUpdated();
+    monitor.decided();
+    monitor.endFrame();
+    EXPECT_EQ(monitor.get(ExchangeId::KRAKEN, LatencyStage::WIRE).count(), 1u);
+    EXPECT_EQ(monitor.get(ExchangeId::KRAKEN, LatencyStage::BOOK).count(), 2u);
+    EXPECT_EQ(monitor.get(ExchangeId::KRAKEN, LatencyStage::TOTAL).count(), 2u);
+
+    monitor.traceReport();
+    EXPECT_EQ(monitor.get(ExchangeId::KRAKEN, LatencyStage::BOOK).count(), 0u);
+}
+
+TEST(LatencyTest, ReadingTheFieldsIsParsing) {
+    LatencyMonitor monitor;
+    monitor.beginFrame(ExchangeId::OKX, 0, LatencyMonitor::nowNs());
+    // the adapter walking a lazily parsed frame before it reaches the OrderBookManager
+    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    monitor.parsed();
+    monitor.bookUpdated();
+    monitor.parsed();
+    monitor.endFrame();
+    EXPECT_GE(monitor.get(ExchangeId::OKX, LatencyStage::PARSE).max(), 2000000u);
+    EXPECT_LT(monitor.get(ExchangeId::OKX, LatencyStage::BOOK).max(), 2000000u);
+}
+
+TEST(LatencyTest, StreamReadsWithKernelTimestamps) {
+    net::io_context ioc;
+    tcp::acceptor acceptor(ioc, tcp::endpoint(net::ip::address_v4::loopback(), 0));
+    tcp::socket peer(ioc);
+
+    RxTimestampStream stream(ioc);
+    stream.next_layer().connect(acceptor.local_endpoint());
+    acceptor.accept(peer);
+#if defined(__linux__)
+    ASSERT_TRUE(stream.enableTimestamps());
+#endif
+
+    const int64_t before = LatencyMonitor::nowNs();
+    net::write(peer, net::buffer(std::string("tick")));
+
+    char data[16];
+    std::size_t received = 0;
+    boost::system::error_code error;
+    stream.async_read_some(net::buffer(data), [&](boost::system::error_code ec, std::size_t bytes) {
+        error = ec;
+        received = bytes;
+    });
+    ioc.run();
+
+    ASSERT_FALSE(error) << error.message();
+    EXPECT_EQ(std::string(data, received), "tick");
+    if (stream.hasTimestamps()) {
+        const int64_t rxNs = stream.takeRxNs();
+        EXPECT_GE(rxNs, before);
+        EXPECT_LE(rxNs, LatencyMonitor::nowNs());
+        // taken once
+        EXPECT_EQ(stream.takeRxNs(), 0);
+    }
+}
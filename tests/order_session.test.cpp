@@ -0,0 +1,180 @@
+#include <gtest/gtest.h>
+#include "../src/order_session.h"
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/ssl.hpp>
+#include <boost/beast/core.hpp>
+#include <boost/beast/http.hpp>
+#include <future>
+
+using namespace std;
+namespace http = boost::beast::http;
+namespace ssl = boost::asio::ssl;
+using tcp = boost::asio::ip::tcp;
+
+namespace {
+
+string testFile(const string& name) {
+    string dir = __FILE__;
+    return dir.substr(0, dir.find_last_of('/') + 1) + name;
+}
+
+// Stand-in for an exchange's REST host: TLS with tests/cert.pem, keep-alive HTTP/1.1 (no h2 in the ALPN,
+// so the session falls back from HTTP/2), answering "<method> <target> <body>"
+class TlsServer {
+public:
+    // delay: time to answer a request, keeps its connection busy
+    explicit TlsServer(chrono::milliseconds delay = chrono::milliseconds(0))
+        : delay(delay), tls(ssl::context::tls_server), acceptor(ioc, tcp::endpoint(boost::asio::ip::make_address("127.0.0.1"), 0)) {
+        tls.use_certificate_chain_file(testFile("cert.pem"));
+        tls.use_private_key_file(testFile("key.pem"), ssl::context::pem);
+        port = acceptor.local_endpoint().port();
+        acceptThread = thread([this]() { acceptLoop(); });
+    }
+
+    ~TlsServer() {
+        stopping = true;
+        tcp::socket wake(ioc);
+        boost::system::error_code ec;
+        wake.connect(acceptor.local_endpoint(), ec);
+        acceptThread.join();
+        for (auto& connection : connections) {
+            connection.join();
+        }
+    }
+
+    string url(const string& target) const { return "https://localhost:" + to_string(port) + target; }
+    int handshakes() const { return handshakeCount.load(); }
+    int requests() const { return requestCount.load(); }
+
+private:
+    void acceptLoop() {
+        while (true) {
+            tcp::socket socket(ioc);
+            boost::system::error_code ec;
+            acceptor.accept(socket, ec);
+            if (stopping || ec) {
+                return;
+            }
+            connections.emplace_back([this, s = std::move(socket)]() mutable { serve(std::move(s)); });
+        }
+    }
+
+    void serve(tcp::socket socket) {
+        ssl::stream<tcp::socket> stream(std::move(socket), tls);
+        boost::system::error_code ec;
+        stream.handshake(ssl::stream_base::server, ec);
+        if (ec) {
+            return;
+        }
+        handshakeCount++;
+
+        boost::beast::flat_buffer buffer;
+        while (true) {
+            http::request<http::string_body> request;
+            http::read(stream, buffer, request, ec);
+            if (ec) {
+                return;
+            }
+            requestCount++;
+            this_thread::sleep_for(delay);
+            http::response<http::string_body> response(http::status::ok, request.version());
+            response.keep_alive(true);
+            response.body() = string(request.method_string()) + " " + string(request.target()) + " " + request.body();
+            response.prepare_payload();
+            http::write(stream, response, ec);
+            if (ec) {
+                return;
+            }
+        }
+    }
+
+    chrono::milliseconds delay;
+    boost::asio::io_context ioc;
+    ssl::context tls;
+    tcp::acceptor acceptor;
+    unsigned short port = 0;
+    atomic<bool> stopping{false};
+    atomic<int> handshakeCount{0};
+    atomic<int> requestCount{0};
+    thread acceptThread;
+    vector<thread> connections;
+};
+
+HttpOptions standInOptions(int connections) {
+    HttpOptions options;
+    options.maxConnections = connections;
+    options.http2 = true;
+    // the stand-in certificate is self-signed and may have expired
+    options.verifyPeer = false;
+    return options;
+}
+
+bool waitFor(const function<bool()>& condition) {
+    auto deadline = chrono::steady_clock::now() + chrono::seconds(10);
+    while (!condition()) {
+        if (chrono::steady_clock::now() > deadline) {
+            return false;
+        }
+        this_thread::sleep_for(chrono::milliseconds(5));
+    }
+    return true;
+}
+
+HttpResponse send(OrderSession& session, HttpRequest request) {
+    promise<HttpResponse> response;
+    session.send(std::move(request), [&response](HttpResponse& r) { response.set_value(std::move(r)); });
+    return response.get_future().get();
+}
+
+} // namespace
+
+TEST(OrderSessionTest, ConnectionsAreWarmBeforeTheFirstOrder) {
+    TlsServer server;
+    OrderSession session(ExchangeId::BINANCE, server.url("/api/v3/ping"), standInOptions(1));
+    EXPECT_FALSE(session.isWarm());
+
+    session.start();
+    ASSERT_TRUE(waitFor([&]() { return session.isWarm(); }));
+    EXPECT_EQ(server.handshakes(), 1);
+    EXPECT_EQ(session.getConnectionsOpened(), 1u);
+
+    // orders pay no handshake: all of them go out on the connection the ping opened
+    for (int i = 0; i < 5; i++) {
+        HttpRequest order;
+        order.method = "POST";
+        order.url = server.url("/api/v3/order");
+        order.body = "symbol=BTCUSDT&side=BUY&id=" + to_string(i);
+        HttpResponse response = send(session, order);
+        ASSERT_TRUE(response.ok()) << response.error;
+        EXPECT_EQ(response.status, 200);
+        EXPECT_EQ(response.body, "POST /api/v3/order symbol=BTCUSDT&side=BUY&id=" + to_string(i));
+    }
+    EXPECT_EQ(server.handshakes(), 1);
+    EXPECT_EQ(session.getConnectionsOpened(), 1u);
+    session.stop();
+    EXPECT_FALSE(session.isWarm());
+}
+
+TEST(OrderSessionTest, PingsOpenEveryConnectionAndKeepThem) {
+    TlsServer server(chrono::milliseconds(50));
+    OrderSession session(ExchangeId::KRAKEN, server.url("/0/public/Time"), standInOptions(2));
+    session.start();
+    ASSERT_TRUE(waitFor([&]() { return session.getPings() == 2; }));
+    // HTTP/1.1 fallback: the two concurrent pings need a connection each
+    EXPECT_EQ(server.handshakes(), 2);
+
+    session.ping();
+    session.ping();
+    ASSERT_TRUE(waitFor([&]() { return session.getPings() == 6; }));
+    EXPECT_EQ(server.handshakes(), 2);
+    EXPECT_EQ(server.requests(), 6);
+    EXPECT_LE(session.getConnectionsOpened(), 2u);
+}
+
+TEST(OrderSessionTest, FailedPingLeavesTheSessionCold) {
+    OrderSession session(ExchangeId::OKX, "https://localhost:1/api/v5/public/time", standInOptions(1));
+    session.start();
+    this_thread::sleep_for(chrono::milliseconds(200));
+    EXPECT_FALSE(session.isWarm());
+    EXPECT_EQ(session.getPings(), 0u);
+}
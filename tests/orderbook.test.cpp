@@ -3,7 +3,9 @@
 #include "../src/tracer.h"
 #include <vector>
 #include <thread>
+#include <atomic>
 #include <chrono>
+#include <random>
 
 using namespace std;
 
@@ -263,6 +265,79 @@ TEST_F(OrderBookTest, OrderBookManagerMultiPair) {
     EXPECT_EQ(ethBook.getBestBid(), 3000.0);
 }
 
+// Test lock-free top-of-book reads
+TEST_F(OrderBookTest, TopOfBookSnapshot) {
+    OrderBookManager manager;
+    std::vector<PriceLevel> bids = testBids;
+    std::vector<PriceLevel> asks = testAsks;
+    manager.updateOrderBook(ExchangeId::BINANCE, TradingPair::BTC_USDT, bids, asks, true);
+
+    TopOfBook tob = manager.getTopOfBook(ExchangeId::BINANCE, TradingPair::BTC_USDT);
+    EXPECT_EQ(tob.bestBid, 50000.0);
+    EXPECT_EQ(tob.bestAsk, 50100.0);
+    EXPECT_EQ(tob.bestBidQuantity, 1.0);
+    EXPECT_EQ(tob.bestAskQuantity, 1.0);
+    EXPECT_EQ(tob.lastUpdate, manager.getOrderBook(ExchangeId::BINANCE, TradingPair::BTC_USDT).getLastUpdate());
+    EXPECT_EQ(tob.seq % 2, 0u);
+
+    manager.updateOrderBookBestBidAsk(ExchangeId::BINANCE, TradingPair::BTC_USDT, 50050.0, 0.5, 50060.0, 0.7);
+    TopOfBook next = manager.getTopOfBook(ExchangeId::BINANCE, TradingPair::BTC_USDT);
+    EXPECT_GT(next.seq, tob.seq);
+    EXPECT_EQ(next.bestBid, 50050.0);
+    EXPECT_EQ(next.bestAskQuantity, 0.7);
+
+    // books that never got data read as empty
+    TopOfBook empty = manager.getTopOfBook(ExchangeId::OKX, TradingPair::ETH_USDT);
+    EXPECT_EQ(empty.bestBid, 0.0);
+    EXPECT_EQ(empty.bestAsk, 0.0);
+}
+
+// A reader racing with the writer must never see a torn top of book
+TEST_F(OrderBookTest, TopOfBookConcurrentReads) {
+    FastTraceLogger::setLoggingEnabled(false);
+    OrderBook book(ExchangeId::OKX, TradingPair::BTC_USDT);
+    book.setBestBidAsk(100.0, 1.0, 101.0, 2.0);
+
+    std::atomic<bool> done{false};
+    std::thread writer([&]() {
+        for (int i = 1; i <= 20000; i++) {
+            book.setBestBidAsk(100.0 + i, 1.0 + i, 101.0 + i, 2.0 + i);
+        }
+        done = true;
+    });
+
+    int torn = 0;
+    uint64_t lastSeq = 0;
+    while (!done) {
+        TopOfBook tob = book.getTopOfBook();
+        if (tob.bestAsk != tob.bestBid + 1.0 || tob.bestBidQuantity != tob.bestBid - 99.0 ||
+            tob.bestAskQuantity != tob.bestBidQuantity + 1.0 || tob.seq < lastSeq) {
+            torn++;
+        }
+        lastSeq = tob.seq;
+    }
+    writer.join();
+
+    EXPECT_EQ(torn, 0);
+    EXPECT_EQ(book.getTopOfBook().bestBid, 20100.0);
+}
+
+// Books sit in fixed slots: references stay valid and lookups are bounds checked
+TEST_F(OrderBookTest, OrderBookManagerDenseStorage) {
+    OrderBookManager manager;
+    auto& book = manager.getOrderBook(ExchangeId::KUCOIN, TradingPair::XTZ_USDT);
+    EXPECT_EQ(book.getExchangeId(), ExchangeId::KUCOIN);
+    EXPECT_EQ(book.getTradingPair(), TradingPair::XTZ_USDT);
+    EXPECT_EQ(&book, &manager.getOrderBook(ExchangeId::KUCOIN, TradingPair::XTZ_USDT));
+
+    auto byPair = manager.getOrderBooks(TradingPair::ETH_USDT);
+    EXPECT_EQ(byPair.size(), static_cast<size_t>(ExchangeId::COUNT) - 1);
+    auto byExchange = manager.getOrderBooks(ExchangeId::OKX);
+    EXPECT_EQ(byExchange.size(), static_cast<size_t>(TradingPair::COUNT) - 1);
+
+    EXPECT_THROW(manager.getOrderBook(ExchangeId::COUNT, TradingPair::BTC_USDT), std::out_of_range);
+}
+
 // Helper function to create a test price level
 PriceLevel makePriceLevel(double price, double quantity) {
     return PriceLevel{price, quantity};
@@ -324,7 +399,318 @@ TEST_F(OrderBookTest, MergeWithZeroQuantitiesInOldList) {
     EXPECT_EQ(oldList[0].quantity, 1.0);
 }
 
+TEST_F(OrderBookTest, LadderKeepsBestLevelsAtCapacity) {
+    OrderBook book(ExchangeId::KRAKEN, TradingPair::BTC_USDT);
+    const size_t depth = OrderBook::MAX_DEPTH;
+
+    // fill the asks to capacity, then merge in better levels: the worst ones must fall off
+    std::vector<PriceLevel> bids, asks;
+    for (size_t i = 0; i < depth; i++) {
+        asks.push_back({50010.0 + i, 1.0});
+    }
+    book.update(TradingPair::BTC_USDT, bids, asks, false);
+    EXPECT_EQ(book.getAsks().size(), depth);
+
+    std::vector<PriceLevel> better = {{50000.0, 2.0}, {50001.0, 3.0}};
+    book.update(TradingPair::BTC_USDT, bids, better, false);
+    auto state = book.getState();
+    EXPECT_EQ(state.second.size(), depth);
+    EXPECT_EQ(state.second.front().price, 50000.0);
+    EXPECT_EQ(state.second.back().price, 50010.0 + depth - 3);
+    EXPECT_TRUE(OrderBook::isSorted(state.second, false));
+
+    // a complete update longer than the ladder is truncated to its best levels
+    std::vector<PriceLevel> longBids;
+    for (size_t i = 0; i < depth + 5; i++) {
+        longBids.push_back({49990.0 - i, 1.0});
+    }
+    book.update(TradingPair::BTC_USDT, longBids, asks, true);
+    EXPECT_EQ(book.getBids().size(), depth);
+    EXPECT_EQ(book.getBestBid(), 49990.0);
+    EXPECT_EQ(book.getWorstBid(), 49990.0 - (depth - 1));
+}
+
+// A message is merged as a whole before truncating: an insert then a delete keeps the ladder full
+TEST_F(OrderBookTest, LadderInsertThenDeleteStaysFull) {
+    OrderBook book(ExchangeId::KRAKEN, TradingPair::BTC_USDT);
+    const size_t depth = OrderBook::MAX_DEPTH;
+    std::vector<PriceLevel> bids, asks;
+    for (size_t i = 0; i < depth; i++) {
+        asks.push_back({50010.0 + i, 1.0});
+    }
+    book.update(TradingPair::BTC_USDT, bids, asks, false);
+
+    // the insert pushes the worst level past the capacity, the delete makes room for it again
+    std::vector<PriceLevel> message = {{50000.0, 2.0}, {50012.0, 0.0}};
+    book.update(TradingPair::BTC_USDT, bids, message, false);
+    auto state = book.getState();
+    ASSERT_EQ(state.second.size(), depth);
+    EXPECT_EQ(state.second.front().price, 50000.0);
+    EXPECT_EQ(state.second.back().price, 50010.0 + depth - 1);
+    EXPECT_TRUE(OrderBook::isSorted(state.second, false));
+    // the depth sums follow the merged side
+    EXPECT_EQ(book.getLadder(false).totalQuantity(), FixedPoint::toLots(2.0 + (depth - 1)));
+
+    // truncated to maxDepth once, after the merge
+    book.update(TradingPair::BTC_USDT, bids, message, false, 5);
+    EXPECT_EQ(book.getAsks().size(), 5u);
+}
+
+// Test decimal string parsing into fixed point
+TEST_F(OrderBookTest, FixedPointParsing) {
+    int64_t value = 0;
+    EXPECT_TRUE(FixedPoint::parseDecimal("50000.01", 8, value));
+    EXPECT_EQ(value, 5000001000000);
+    EXPECT_TRUE(FixedPoint::parseDecimal("-1.5", 8, value));
+    EXPECT_EQ(value, -150000000);
+    EXPECT_TRUE(FixedPoint::parseDecimal("5.325e-05", 8, value));
+    EXPECT_EQ(value, 5325);
+    EXPECT_TRUE(FixedPoint::parseDecimal("0.000000005", 8, value));  // rounded half up
+    EXPECT_EQ(value, 1);
+    // digits below half a unit round to 0, however far below the precision they start
+    for (const char* tiny : {"5.325e-15", "0.0000000006", "6e-10", "0.00000000049", "9e-400"}) {
+        EXPECT_TRUE(FixedPoint::parseDecimal(tiny, 8, value)) << tiny;
+        EXPECT_EQ(value, 0) << tiny;
+    }
+    EXPECT_TRUE(FixedPoint::parseDecimal("6e-9", 8, value));
+    EXPECT_EQ(value, 1);
+    EXPECT_TRUE(FixedPoint::parseDecimal("-4.99e-9", 8, value));
+    EXPECT_EQ(value, 0);
+    EXPECT_TRUE(FixedPoint::parseDecimal("123456789012345678e-24", 8, value));  // 1.23e-7
+    EXPECT_EQ(value, 12);
+    EXPECT_TRUE(FixedPoint::parseDecimal("93888.1", 1, value));
+    EXPECT_EQ(value, 938881);
+    EXPECT_FALSE(FixedPoint::parseDecimal("", 8, value));
+    EXPECT_FALSE(FixedPoint::parseDecimal("1.2.3", 8, value));
+    EXPECT_FALSE(FixedPoint::parseDecimal("abc", 8, value));
+    EXPECT_FALSE(FixedPoint::parseDecimal("123456789012", 8, value));  // overflows int64 at 1e-8
+    EXPECT_THROW(FixedPoint::parsePrice("1,5"), std::invalid_argument);
+
+    // ticks and doubles agree at the edges
+    EXPECT_EQ(FixedPoint::parsePrice("0.1"), FixedPoint::toTicks(0.1));
+    EXPECT_EQ(FixedPoint::fromTicks(FixedPoint::parsePrice("50000.01")), 50000.01);
+    EXPECT_EQ(FixedPoint::toPrecisionUnits(FixedPoint::parsePrice("45285.2"), TradingPair::BTC_USDT), 452852);
+}
+
+// The 8-digits-at-a-time path must agree with the digit loop on every plain decimal
+TEST_F(OrderBookTest, FixedPointFastPathMatchesDigitLoop) {
+    std::mt19937_64 rng(11);
+    for (int i = 0; i < 200000; i++) {
+        int intDigits = static_cast<int>(rng() % 11);       // 0..10
+        int fracDigits = static_cast<int>(rng() % 9);       // 0..8
+        if (intDigits + fracDigits == 0) {
+            continue;
+        }
+        int64_t intPart = static_cast<int64_t>(rng() % static_cast<uint64_t>(FixedPoint::pow10(intDigits)));
+        int64_t fracPart = static_cast<int64_t>(rng() % static_cast<uint64_t>(FixedPoint::pow10(fracDigits)));
+        bool negative = rng() % 4 == 0;
+
+        std::string s = negative ? "-" : "";
+        std::string digits = std::to_string(intPart);
+        if (intDigits > 0) {
+            s += std::string(static_cast<size_t>(intDigits) - digits.size(), '0') + digits;  // keep leading zeros
+        }
+        if (fracDigits > 0 || rng() % 8 == 0) {
+            std::string frac = fracDigits > 0 ? std::to_string(fracPart) : "";
+            s += "." + std::string(static_cast<size_t>(fracDigits) - frac.size(), '0') + frac;
+        }
+
+        int64_t expected = intPart * FixedPoint::PRICE_SCALE + fracPart * FixedPoint::pow10(8 - fracDigits);
+        int64_t value = 0;
+        double asDouble = 0.0;
+        ASSERT_TRUE(FixedPoint::parseDecimal(s, 8, value, asDouble)) << s;
+        ASSERT_EQ(value, negative ? -expected : expected) << s;
+        ASSERT_EQ(asDouble, FixedPoint::fromTicks(value)) << s;
+    }
+
+    // forms the fast path leaves to the digit loop
+    int64_t value = 0;
+    double asDouble = 0.0;
+    EXPECT_TRUE(FixedPoint::parseDecimal("12345678901.5", 8, value));  // 19 digits once scaled
+    EXPECT_EQ(value, 1234567890150000000);
+    EXPECT_TRUE(FixedPoint::parseDecimal("0.123456785", 8, value));  // rounded
+    EXPECT_EQ(value, 12345679);
+    EXPECT_TRUE(FixedPoint::parseDecimal("5.", 8, value, asDouble));
+    EXPECT_EQ(asDouble, 5.0);
+    EXPECT_TRUE(FixedPoint::parseDecimal("+.25", 8, value, asDouble));
+    EXPECT_EQ(asDouble, 0.25);
+    EXPECT_FALSE(FixedPoint::parseDecimal("-", 8, value));
+    EXPECT_FALSE(FixedPoint::parseDecimal(".", 8, value));
+    EXPECT_FALSE(FixedPoint::parseDecimal("12a4", 8, value));
+    EXPECT_FALSE(FixedPoint::parseDecimal("1 ", 8, value));
+}
+
+// Prices that are equal as decimals must compare equal in the book
+TEST_F(OrderBookTest, FixedPointChangeDetection) {
+    OrderBook book(ExchangeId::OKX, TradingPair::ETH_USDT);
+    FixedLevel bid(FixedPoint::parsePrice("3000.10"), FixedPoint::parseQty("1"));
+    FixedLevel ask(FixedPoint::parsePrice("3000.2"), FixedPoint::parseQty("2"));
+    EXPECT_EQ(book.setBestBidAsk(bid, ask), OrderBook::UpdateOutcome::BEST_PRICES_CHANGED);
+
+    // 0.1 + 0.2 style noise from the double API still lands on the same tick
+    EXPECT_EQ(book.setBestBidAsk(3000.0 + 0.1, 1.0, 3000.1 + 0.1, 2.0), OrderBook::UpdateOutcome::NO_CHANGES_TO_BEST_PRICES);
+    EXPECT_EQ(book.getTopOfBook().bidTicks, bid.price);
+    EXPECT_EQ(book.getTopOfBook().askLots, ask.quantity);
+    EXPECT_DOUBLE_EQ(book.getBestAsk(), 3000.2);
+}
+
+// Test single-level deltas applied in place on a ladder
+TEST_F(OrderBookTest, LadderApplyDelta) {
+    PriceLadder<4> asks;
+    EXPECT_TRUE(asks.apply({105, 1}, false));   // first level is the top
+    EXPECT_FALSE(asks.apply({107, 1}, false));  // appended behind the top
+    EXPECT_FALSE(asks.apply({106, 2}, false));  // inserted in the middle
+    EXPECT_TRUE(asks.apply({104, 3}, false));   // new best ask
+    ASSERT_EQ(asks.size(), 4u);
+    EXPECT_EQ(asks[0].price, 104);
+    EXPECT_EQ(asks[2].price, 106);
+    EXPECT_TRUE(OrderBook::isSorted(asks, false));
+
+    // full: a worse level is dropped, a better one pushes the worst out
+    EXPECT_FALSE(asks.apply({108, 1}, false));
+    EXPECT_EQ(asks.back().price, 107);
+    EXPECT_FALSE(asks.apply({105, 5}, false));  // quantity update only
+    EXPECT_EQ(asks[1].quantity, 5);
+    EXPECT_TRUE(asks.apply({103, 1}, false));
+    EXPECT_EQ(asks.size(), 4u);
+    EXPECT_EQ(asks.back().price, 106);
+
+    // deletes: unknown price is a no-op, known price closes the gap
+    EXPECT_FALSE(asks.apply({110, 0}, false));
+    EXPECT_TRUE(asks.apply({103, 0}, false));
+    EXPECT_EQ(asks.size(), 3u);
+    EXPECT_EQ(asks.front().price, 104);
+    EXPECT_FALSE(asks.apply({-1, 1}, false));  // invalid levels are ignored
+
+    PriceLadder<4> bids;
+    bids.apply({100, 1}, true);
+    bids.apply({98, 1}, true);
+    EXPECT_FALSE(bids.apply({99, 1}, true));
+    EXPECT_TRUE(bids.apply({101, 1}, true));
+    EXPECT_TRUE(OrderBook::isSorted(bids, true));
+    EXPECT_EQ(bids.front().price, 101);
+
+    // the book reports top changes from the same path
+    OrderBook book(ExchangeId::KRAKEN, TradingPair::BTC_USDT);
+    EXPECT_EQ(book.applyDelta(FixedLevel(FixedPoint::parsePrice("50000.1"), FixedPoint::parseQty("1")), true),
+              OrderBook::UpdateOutcome::BEST_PRICES_CHANGED);
+    EXPECT_EQ(book.applyDelta(FixedLevel(FixedPoint::parsePrice("49999.9"), FixedPoint::parseQty("1")), true),
+              OrderBook::UpdateOutcome::NO_CHANGES_TO_BEST_PRICES);
+    EXPECT_EQ(book.getTopOfBook().bestBid, 50000.1);
+}
+
+// Test book versions and the per-pair dirty set
+TEST_F(OrderBookTest, VersionsAndDirtySet) {
+    OrderBookManager manager;
+    EXPECT_FALSE(manager.isDirty(TradingPair::BTC_USDT));
+    uint64_t v0 = manager.getVersion(ExchangeId::OKX, TradingPair::BTC_USDT);
+
+    int calls = 0;
+    manager.setUpdateCallback(TradingPair::BTC_USDT, [&](ExchangeId, TradingPair pair) {
+        EXPECT_EQ(pair, TradingPair::BTC_USDT);
+        EXPECT_TRUE(manager.isDirty(pair));  // the bit is visible before the callback runs
+        calls++;
+    });
+
+    // a burst on one book and an update on another collapse into one drain
+    manager.updateOrderBookBestBidAsk(ExchangeId::OKX, TradingPair::BTC_USDT, 50000.0, 1.0, 50001.0, 1.0);
+    manager.updateOrderBookBestBidAsk(ExchangeId::OKX, TradingPair::BTC_USDT, 50000.5, 1.0, 50001.0, 1.0);
+    manager.updateOrderBookBestBidAsk(ExchangeId::KUCOIN, TradingPair::BTC_USDT, 50000.0, 1.0, 50002.0, 1.0);
+    manager.updateOrderBookBestBidAsk(ExchangeId::OKX, TradingPair::ETH_USDT, 3000.0, 1.0, 3001.0, 1.0);
+    EXPECT_EQ(calls, 3);
+    EXPECT_EQ(manager.getVersion(ExchangeId::OKX, TradingPair::BTC_USDT), v0 + 2);
+
+    uint32_t mask = manager.drainDirty(TradingPair::BTC_USDT);
+    EXPECT_EQ(mask, OrderBookManager::exchangeBit(ExchangeId::OKX) | OrderBookManager::exchangeBit(ExchangeId::KUCOIN));
+    EXPECT_EQ(manager.drainDirty(TradingPair::BTC_USDT), 0u);
+    EXPECT_EQ(manager.drainDirty(TradingPair::ETH_USDT), OrderBookManager::exchangeBit(ExchangeId::OKX));
+
+    // unchanged prices bump the version but do not mark the book dirty
+    manager.updateOrderBookBestBidAsk(ExchangeId::OKX, TradingPair::BTC_USDT, 50000.5, 2.0, 50001.0, 1.0);
+    EXPECT_FALSE(manager.isDirty(TradingPair::BTC_USDT));
+    EXPECT_EQ(manager.getVersion(ExchangeId::OKX, TradingPair::BTC_USDT), v0 + 3);
+    EXPECT_EQ(calls, 3);
+
+    manager.setUpdateCallback(TradingPair::BTC_USDT, nullptr);
+}
+
 int main(int argc, char **argv) {
     ::testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();
-} 
\ No newline at end of file
+} 
+// Test depth queries on the cached prefix sums
+TEST_F(OrderBookTest, DepthQueries) {
+    OrderBook book(ExchangeId::BINANCE, TradingPair::BTC_USDT);
+    std::vector<PriceLevel> bids = {{100.0, 1.0}, {99.0, 2.0}, {98.0, 3.0}};
+    std::vector<PriceLevel> asks = {{101.0, 1.0}, {102.0, 2.0}, {103.0, 3.0}};
+    book.update(TradingPair::BTC_USDT, bids, asks, true);
+
+    // VWAP across levels; not enough depth gives 0
+    EXPECT_DOUBLE_EQ(book.vwapToFill(1.0, false), 101.0);
+    EXPECT_DOUBLE_EQ(book.vwapToFill(2.0, false), (101.0 + 102.0) / 2);
+    EXPECT_DOUBLE_EQ(book.vwapToFill(4.0, true), (100.0 + 2 * 99.0 + 98.0) / 4);
+    EXPECT_EQ(book.vwapToFill(7.0, false), 0.0);
+    auto fill = book.fillEstimate(FixedPoint::toLots(7.0), false);
+    EXPECT_EQ(fill.quantity, FixedPoint::toLots(6.0));
+    EXPECT_EQ(fill.worstPrice, FixedPoint::toTicks(103.0));
+
+    EXPECT_EQ(book.quantityUpToPrice(FixedPoint::toTicks(102.0), false), FixedPoint::toLots(3.0));
+    EXPECT_EQ(book.quantityUpToPrice(FixedPoint::toTicks(100.5), false), 0);
+    EXPECT_EQ(book.quantityUpToPrice(FixedPoint::toTicks(98.5), true), FixedPoint::toLots(3.0));
+
+    // the sums follow in-place deltas and top-of-book overwrites
+    book.applyDelta(FixedLevel(FixedPoint::toTicks(102.0), 0), false);
+    book.applyDelta(FixedLevel(FixedPoint::toTicks(100.5), FixedPoint::toLots(0.5)), false);
+    EXPECT_EQ(book.quantityUpToPrice(FixedPoint::toTicks(103.0), false), FixedPoint::toLots(4.5));
+    EXPECT_DOUBLE_EQ(book.vwapToFill(1.5, false), (0.5 * 100.5 + 101.0) / 1.5);
+
+    OrderBook ticker(ExchangeId::OKX, TradingPair::BTC_USDT);
+    ticker.setBestBidAsk(100.0, 1.0, 101.0, 1.0);
+    ticker.setBestBidAsk(100.0, 4.0, 101.0, 1.0);
+    EXPECT_EQ(ticker.quantityUpToPrice(FixedPoint::toTicks(100.0), true), FixedPoint::toLots(4.0));
+
+    // cross-exchange sizing: buy on these asks, sell on bids that are 2% higher
+    OrderBook sell(ExchangeId::OKX, TradingPair::BTC_USDT);
+    std::vector<PriceLevel> sellBids = {{103.5, 2.0}, {102.5, 2.0}, {101.0, 5.0}};
+    std::vector<PriceLevel> sellAsks = {{104.0, 1.0}};
+    sell.update(TradingPair::BTC_USDT, sellBids, sellAsks, true);
+    auto askLadder = book.getLadder(false);   // 100.5@0.5 101@1 103@3
+    auto bidLadder = sell.getLadder(true);
+    // 1%: 100.5 and 101 sell into 103.5/102.5; 103 needs >= 104.03, so stop after 1.5
+    EXPECT_EQ(OrderBook::Ladder::maxSizeAboveMargin(askLadder, bidLadder, 1.0), FixedPoint::toLots(1.5));
+    // 2%: 101 needs >= 103.02, only the first 2.0 of bids qualify
+    EXPECT_EQ(OrderBook::Ladder::maxSizeAboveMargin(askLadder, bidLadder, 2.0), FixedPoint::toLots(1.5));
+    // 2.5%: 100.5 needs >= 103.0125, 101 needs >= 103.525 -> only the first ask level
+    EXPECT_EQ(OrderBook::Ladder::maxSizeAboveMargin(askLadder, bidLadder, 2.5), FixedPoint::toLots(0.5));
+    EXPECT_EQ(OrderBook::Ladder::maxSizeAboveMargin(askLadder, bidLadder, 5.0), 0);
+    // no margin: the 103 asks only sell into 103.5@2, so the size ends at the end of that bid level
+    EXPECT_EQ(OrderBook::Ladder::maxSizeAboveMargin(askLadder, bidLadder, 0.0), FixedPoint::toLots(2.0));
+}
+
+// The strategy sizes on lock-free copies of the sides, consistent with the top of book
+TEST_F(OrderBookTest, DepthSnapshotMatchesTheBook) {
+    OrderBook book(ExchangeId::BINANCE, TradingPair::BTC_USDT);
+    OrderBook::Ladder side;
+    TopOfBook top = book.getDepthSnapshot(true, side);
+    EXPECT_TRUE(side.empty());
+    EXPECT_EQ(top.bidTicks, 0);
+
+    std::vector<PriceLevel> bids = {{100.0, 1.0}, {99.0, 2.0}, {98.0, 3.0}};
+    std::vector<PriceLevel> asks = {{101.0, 1.0}, {102.0, 2.0}};
+    book.update(TradingPair::BTC_USDT, bids, asks, true);
+    book.applyDelta(FixedLevel(FixedPoint::toTicks(100.5), FixedPoint::toLots(0.5)), false);
+
+    for (bool isBid : {true, false}) {
+        top = book.getDepthSnapshot(isBid, side);
+        const auto ladder = book.getLadder(isBid);
+        ASSERT_EQ(side.size(), ladder.size());
+        for (size_t i = 0; i < side.size(); i++) {
+            EXPECT_EQ(side[i].price, ladder[i].price);
+            EXPECT_EQ(side.cumulativeQuantity(i), ladder.cumulativeQuantity(i));
+        }
+        EXPECT_EQ(top.seq, book.getTopOfBook().seq);
+    }
+    EXPECT_EQ(top.askTicks, side.front().price);
+    EXPECT_EQ(top.askTicks, FixedPoint::toTicks(100.5));
+    EXPECT_EQ(side.totalQuantity(), FixedPoint::toLots(3.5));
+}
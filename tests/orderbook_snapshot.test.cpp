@@ -0,0 +1,149 @@
+#include <gtest/gtest.h>
+#include "../src/orderbook_snapshot.h"
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <algorithm>
+
+using namespace std;
+
+namespace {
+
+const string SNAPSHOT_PATH = "orderbook_snapshot.test.bin";
+
+void fillBook(OrderBookManager& manager, ExchangeId exchangeId, TradingPair pair, double mid, int levels) {
+    vector<FixedLevel> bids, asks;
+    for (int i = 0; i < levels; i++) {
+        bids.push_back({FixedPoint::toTicks(mid - 1.0 - i), FixedPoint::toLots(0.5 + i)});
+        asks.push_back({FixedPoint::toTicks(mid + 1.0 + i), FixedPoint::toLots(0.25 + i)});
+    }
+    manager.updateOrderBook(exchangeId, pair, bids, asks, true);
+}
+
+bool sameLevels(const vector<FixedLevel>& a, const vector<FixedLevel>& b) {
+    return equal(a.begin(), a.end(), b.begin(), b.end(), [](const FixedLevel& x, const FixedLevel& y) {
+        return x.price == y.price && x.quantity == y.quantity;
+    });
+}
+
+class OrderBookSnapshotTest : public ::testing::Test {
+protected:
+    void TearDown() override {
+        remove(SNAPSHOT_PATH.c_str());
+    }
+};
+
+} // namespace
+
+TEST_F(OrderBookSnapshotTest, RoundTripRestoresBooksAsProvisional) {
+    OrderBookManager saved;
+    fillBook(saved, ExchangeId::BINANCE, TradingPair::BTC_USDT, 50000.0, Config::ORDERBOOK_MAX_DEPTH);
+    fillBook(saved, ExchangeId::KRAKEN, TradingPair::ETH_USDT, 3000.0, 3);
+    map<pair<ExchangeId, TradingPair>, int64_t> sequences = {
+        {{ExchangeId::BINANCE, TradingPair::BTC_USDT}, 123456789},
+        {{ExchangeId::KRAKEN, TradingPair::ETH_USDT}, 42},
+    };
+    ASSERT_TRUE(OrderBookSnapshot::save(SNAPSHOT_PATH, saved, [&](ExchangeId ex, TradingPair p) {
+        auto it = sequences.find({ex, p});
+        return it != sequences.end() ? it->second : 0;
+    }));
+
+    OrderBookManager restored;
+    map<pair<ExchangeId, TradingPair>, int64_t> restoredSequences;
+    size_t count = OrderBookSnapshot::load(SNAPSHOT_PATH, restored, 60000, [&](ExchangeId ex, TradingPair p, int64_t seq) {
+        restoredSequences[{ex, p}] = seq;
+    });
+    EXPECT_EQ(count, 2u);  // empty books are not saved
+    EXPECT_EQ(restoredSequences, sequences);
+
+    for (auto [ex, p] : {make_pair(ExchangeId::BINANCE, TradingPair::BTC_USDT), make_pair(ExchangeId::KRAKEN, TradingPair::ETH_USDT)}) {
+        const auto& original = saved.getOrderBook(ex, p);
+        const auto& book = restored.getOrderBook(ex, p);
+        EXPECT_TRUE(book.isProvisional());
+        EXPECT_FALSE(original.isProvisional());
+        EXPECT_TRUE(sameLevels(book.getBidLevels(), original.getBidLevels()));
+        EXPECT_TRUE(sameLevels(book.getAskLevels(), original.getAskLevels()));
+        EXPECT_EQ(book.getLastUpdate(), original.getLastUpdate());
+        EXPECT_EQ(book.getTopOfBook().bidTicks, original.getTopOfBook().bidTicks);
+    }
+    EXPECT_TRUE(restored.getOrderBook(ExchangeId::OKX, TradingPair::BTC_USDT).getBids().empty());
+
+    // the strategy view (top of book matrix, live mask, dirty set) waits for live data
+    TopOfBookMatrix::Quotes quotes;
+    restored.getTopOfBookMatrix().snapshot(TradingPair::BTC_USDT, quotes);
+    EXPECT_DOUBLE_EQ(quotes.bid[static_cast<size_t>(ExchangeId::BINANCE)], 0.0);
+    EXPECT_EQ(restored.getLiveMask(TradingPair::BTC_USDT), 0u);
+    EXPECT_FALSE(restored.isDirty(TradingPair::BTC_USDT));
+}
+
+TEST_F(OrderBookSnapshotTest, LiveUpdateClearsProvisional) {
+    OrderBookManager saved;
+    fillBook(saved, ExchangeId::OKX, TradingPair::BTC_USDT, 50000.0, 5);
+    ASSERT_TRUE(OrderBookSnapshot::save(SNAPSHOT_PATH, saved));
+
+    OrderBookManager restored;
+    ASSERT_EQ(OrderBookSnapshot::load(SNAPSHOT_PATH, restored), 1u);
+    auto& book = restored.getOrderBook(ExchangeId::OKX, TradingPair::BTC_USDT);
+    EXPECT_TRUE(book.isProvisional());
+
+    // an incremental update confirms the book
+    vector<FixedLevel> bid = {{FixedPoint::toTicks(49999.5), FixedPoint::toLots(1.0)}}, none;
+    restored.updateOrderBook(ExchangeId::OKX, TradingPair::BTC_USDT, bid, none);
+    EXPECT_FALSE(book.isProvisional());
+    EXPECT_DOUBLE_EQ(book.getBestBid(), 49999.5);
+    EXPECT_DOUBLE_EQ(book.getBestAsk(), 50001.0);
+
+    // and puts it in front of the strategy
+    TopOfBookMatrix::Quotes quotes;
+    restored.getTopOfBookMatrix().snapshot(TradingPair::BTC_USDT, quotes);
+    EXPECT_DOUBLE_EQ(quotes.bid[static_cast<size_t>(ExchangeId::OKX)], 49999.5);
+    EXPECT_EQ(restored.getLiveMask(TradingPair::BTC_USDT), OrderBookManager::exchangeBit(ExchangeId::OKX));
+}
+
+TEST_F(OrderBookSnapshotTest, RejectsMissingStaleAndCorruptFiles) {
+    OrderBookManager manager;
+    EXPECT_EQ(OrderBookSnapshot::load("no_such_snapshot.bin", manager), 0u);
+
+    OrderBookManager saved;
+    fillBook(saved, ExchangeId::BINANCE, TradingPair::BTC_USDT, 50000.0, 5);
+    ASSERT_TRUE(OrderBookSnapshot::save(SNAPSHOT_PATH, saved));
+
+    // read it back as raw bytes to tamper with it
+    string bytes;
+    {
+        ifstream in(SNAPSHOT_PATH, ios::binary);
+        bytes.assign(istreambuf_iterator<char>(in), istreambuf_iterator<char>());
+    }
+    ASSERT_EQ(bytes.size(), sizeof(OrderBookSnapshot::Header) + sizeof(OrderBookSnapshot::Record));
+    auto write = [&](const string& content) {
+        ofstream out(SNAPSHOT_PATH, ios::binary | ios::trunc);
+        out.write(content.data(), static_cast<streamsize>(content.size()));
+    };
+
+    // too old
+    string stale = bytes;
+    auto* header = reinterpret_cast<OrderBookSnapshot::Header*>(&stale[0]);
+    header->savedAtNs -= 3600LL * 1000000000LL;
+    write(stale);
+    EXPECT_EQ(OrderBookSnapshot::load(SNAPSHOT_PATH, manager, 60000), 0u);
+    EXPECT_EQ(OrderBookSnapshot::load(SNAPSHOT_PATH, manager), 1u);  // no age limit
+
+    // truncated
+    OrderBookManager fresh;
+    write(bytes.substr(0, bytes.size() - 8));
+    EXPECT_EQ(OrderBookSnapshot::load(SNAPSHOT_PATH, fresh), 0u);
+
+    // other depth
+    string otherDepth = bytes;
+    reinterpret_cast<OrderBookSnapshot::Header*>(&otherDepth[0])->depth += 1;
+    write(otherDepth);
+    EXPECT_EQ(OrderBookSnapshot::load(SNAPSHOT_PATH, fresh), 0u);
+
+    // unsorted levels: the record is skipped
+    string unsorted = bytes;
+    auto* record = reinterpret_cast<OrderBookSnapshot::Record*>(&unsorted[sizeof(OrderBookSnapshot::Header)]);
+    swap(record->bids[0], record->bids[1]);
+    write(unsorted);
+    EXPECT_EQ(OrderBookSnapshot::load(SNAPSHOT_PATH, fresh), 0u);
+    EXPECT_TRUE(fresh.getOrderBook(ExchangeId::BINANCE, TradingPair::BTC_USDT).getBids().empty());
+}
@@ -0,0 +1,26 @@
+#include <gtest/gtest.h>
+#include "../src/s_poplavki.h"
+#include "../src/orderbook_mgr.h"
+
+using namespace std;
+
+TEST(StrategyPoplavkiTest, OutlierQuoteDoesNotHideOtherSpreads) {
+    StrategyPoplavki strategy("BTC", "USDT", TradingPair::BTC_USDT,
+                              {ExchangeId::BINANCE, ExchangeId::OKX, ExchangeId::KRAKEN});
+
+    // KRAKEN prints a price far off the market: every spread selling there wins the matrix and fails
+    // the sanity check on the books
+    orderBookManager.updateOrderBookBestBidAsk(ExchangeId::KRAKEN, TradingPair::BTC_USDT, 200000.0, 1.0, 200010.0, 1.0);
+    // the real one: buy on BINANCE, sell on OKX, 0.016% (traced, not executed)
+    orderBookManager.updateOrderBookBestBidAsk(ExchangeId::BINANCE, TradingPair::BTC_USDT, 49990.0, 1.0, 50000.0, 0.5);
+    orderBookManager.updateOrderBookBestBidAsk(ExchangeId::OKX, TradingPair::BTC_USDT, 50008.0, 0.2, 50020.0, 1.0);
+    strategy.scanOpportunities();
+
+    EXPECT_EQ(strategy.bestOpportunity1.buyExchange, ExchangeId::BINANCE);
+    EXPECT_EQ(strategy.bestOpportunity1.sellExchange, ExchangeId::OKX);
+    EXPECT_DOUBLE_EQ(strategy.bestOpportunity1.amount, 0.2);
+    EXPECT_DOUBLE_EQ(strategy.bestOpportunity1.buyPrice, 50000.0);
+    EXPECT_DOUBLE_EQ(strategy.bestOpportunity1.sellPrice, 50008.0);
+    // nothing profitable the other way
+    EXPECT_EQ(strategy.bestOpportunity2.amount, 0.0);
+}
@@ -0,0 +1,184 @@
+#include <gtest/gtest.h>
+#include "../src/tob_matrix.h"
+#include "../src/orderbook_mgr.h"
+#include <random>
+#include <limits>
+
+using namespace std;
+
+namespace {
+
+uint32_t bit(ExchangeId exchangeId) { return OrderBookManager::exchangeBit(exchangeId); }
+
+TopOfBookMatrix::Quotes emptyQuotes() {
+    TopOfBookMatrix::Quotes q;
+    for (size_t j = 0; j < TopOfBookMatrix::LANES; j++) {
+        q.bid[j] = 0.0;
+        q.ask[j] = numeric_limits<double>::infinity();
+        q.bidQty[j] = 0.0;
+        q.askQty[j] = 0.0;
+    }
+    return q;
+}
+
+void setQuote(TopOfBookMatrix::Quotes& q, ExchangeId exchangeId, double bid, double ask) {
+    size_t lane = static_cast<size_t>(exchangeId);
+    q.bid[lane] = bid;
+    q.ask[lane] = ask;
+    q.bidQty[lane] = 1.0;
+    q.askQty[lane] = 1.0;
+}
+
+} // namespace
+
+class TopOfBookMatrixTest : public ::testing::Test {
+protected:
+    const uint32_t allExchanges = bit(ExchangeId::BINANCE) | bit(ExchangeId::KRAKEN) | bit(ExchangeId::KUCOIN) |
+                                  bit(ExchangeId::OKX) | bit(ExchangeId::CRYPTO);
+};
+
+TEST_F(TopOfBookMatrixTest, FindsBestDirectedSpread) {
+    auto q = emptyQuotes();
+    setQuote(q, ExchangeId::BINANCE, 100.0, 100.5);
+    setQuote(q, ExchangeId::KRAKEN, 101.0, 101.5);
+    setQuote(q, ExchangeId::KUCOIN, 99.0, 99.2);
+    setQuote(q, ExchangeId::OKX, 100.2, 100.4);
+
+    // buy cheapest ask (KUCOIN 99.2), sell highest bid (KRAKEN 101.0)
+    auto c = TopOfBookMatrix::findBestSpread(q, allExchanges);
+    EXPECT_EQ(c.buy, static_cast<int>(ExchangeId::KUCOIN));
+    EXPECT_EQ(c.sell, static_cast<int>(ExchangeId::KRAKEN));
+    EXPECT_DOUBLE_EQ(c.margin, 101.0 / 99.2 - 1.0);
+
+    // exchanges outside the active mask are ignored
+    c = TopOfBookMatrix::findBestSpread(q, allExchanges & ~bit(ExchangeId::KUCOIN));
+    EXPECT_EQ(c.buy, static_cast<int>(ExchangeId::OKX));
+    EXPECT_EQ(c.sell, static_cast<int>(ExchangeId::KRAKEN));
+
+    // no crossed market still reports the least negative spread
+    auto flat = emptyQuotes();
+    setQuote(flat, ExchangeId::BINANCE, 100.0, 100.5);
+    setQuote(flat, ExchangeId::OKX, 100.1, 100.6);
+    c = TopOfBookMatrix::findBestSpread(flat, allExchanges);
+    EXPECT_EQ(c.buy, static_cast<int>(ExchangeId::BINANCE));
+    EXPECT_EQ(c.sell, static_cast<int>(ExchangeId::OKX));
+    EXPECT_LT(c.margin, 0.0);
+}
+
+TEST_F(TopOfBookMatrixTest, SkipsEmptySidesAndSelfSpread) {
+    auto q = emptyQuotes();
+    EXPECT_EQ(TopOfBookMatrix::findBestSpread(q, allExchanges).buy, -1);
+
+    // a single exchange can not trade against itself, even with a crossed book
+    setQuote(q, ExchangeId::OKX, 101.0, 100.0);
+    EXPECT_EQ(TopOfBookMatrix::findBestSpread(q, allExchanges).buy, -1);
+
+    // an exchange with asks only can be bought on, never sold on
+    q.bid[static_cast<size_t>(ExchangeId::KRAKEN)] = 0.0;
+    q.ask[static_cast<size_t>(ExchangeId::KRAKEN)] = 99.0;
+    auto c = TopOfBookMatrix::findBestSpread(q, allExchanges);
+    EXPECT_EQ(c.buy, static_cast<int>(ExchangeId::KRAKEN));
+    EXPECT_EQ(c.sell, static_cast<int>(ExchangeId::OKX));
+}
+
+TEST_F(TopOfBookMatrixTest, DirtyMaskLimitsCombinations) {
+    auto q = emptyQuotes();
+    setQuote(q, ExchangeId::BINANCE, 100.0, 100.1);
+    setQuote(q, ExchangeId::KRAKEN, 102.0, 102.1);  // best spread is BINANCE -> KRAKEN
+    setQuote(q, ExchangeId::OKX, 101.0, 101.1);
+
+    // only OKX changed: combinations without OKX are skipped
+    auto c = TopOfBookMatrix::findBestSpread(q, allExchanges, bit(ExchangeId::OKX));
+    EXPECT_EQ(c.buy, static_cast<int>(ExchangeId::BINANCE));
+    EXPECT_EQ(c.sell, static_cast<int>(ExchangeId::OKX));
+
+    // OKX as the only buy side left
+    c = TopOfBookMatrix::findBestSpread(q, allExchanges & ~bit(ExchangeId::BINANCE), bit(ExchangeId::OKX));
+    EXPECT_EQ(c.buy, static_cast<int>(ExchangeId::OKX));
+    EXPECT_EQ(c.sell, static_cast<int>(ExchangeId::KRAKEN));
+
+    c = TopOfBookMatrix::findBestSpread(q, allExchanges, bit(ExchangeId::KRAKEN));
+    EXPECT_EQ(c.buy, static_cast<int>(ExchangeId::BINANCE));
+    EXPECT_EQ(c.sell, static_cast<int>(ExchangeId::KRAKEN));
+
+    EXPECT_EQ(TopOfBookMatrix::findBestSpread(q, allExchanges, 0).buy, -1);
+}
+
+TEST_F(TopOfBookMatrixTest, ExclusionsDropDirectedSpreads) {
+    auto q = emptyQuotes();
+    setQuote(q, ExchangeId::BINANCE, 100.0, 100.1);
+    setQuote(q, ExchangeId::KRAKEN, 102.0, 102.1);
+    setQuote(q, ExchangeId::OKX, 100.5, 100.6);
+
+    TopOfBookMatrix::Exclusions excluded{};
+    excluded[static_cast<size_t>(ExchangeId::BINANCE)] = bit(ExchangeId::KRAKEN);
+    auto c = TopOfBookMatrix::findBestSpread(q, allExchanges, ~0u, &excluded);
+    EXPECT_EQ(c.buy, static_cast<int>(ExchangeId::OKX));
+    EXPECT_EQ(c.sell, static_cast<int>(ExchangeId::KRAKEN));
+
+    // only that direction: BINANCE still buys for OKX
+    excluded[static_cast<size_t>(ExchangeId::OKX)] = bit(ExchangeId::KRAKEN);
+    c = TopOfBookMatrix::findBestSpread(q, allExchanges, ~0u, &excluded);
+    EXPECT_EQ(c.buy, static_cast<int>(ExchangeId::BINANCE));
+    EXPECT_EQ(c.sell, static_cast<int>(ExchangeId::OKX));
+}
+
+TEST_F(TopOfBookMatrixTest, KernelMatchesScalar) {
+    cout << "Kernel: " << TopOfBookMatrix::kernelName() << endl;
+    mt19937 rng(42);
+    uniform_real_distribution<double> price(99.0, 101.0);
+    uniform_int_distribution<uint32_t> mask(0, (1u << TopOfBookMatrix::LANES) - 1);
+    uniform_int_distribution<int> empty(0, 9);
+
+    for (int iteration = 0; iteration < 10000; iteration++) {
+        auto q = emptyQuotes();
+        for (size_t j = 0; j < TopOfBookMatrix::LANES; j++) {
+            double mid = price(rng);
+            q.bid[j] = empty(rng) == 0 ? 0.0 : mid - 0.05;
+            q.ask[j] = empty(rng) == 0 ? numeric_limits<double>::infinity() : mid + 0.05;
+        }
+        uint32_t active = mask(rng);
+        uint32_t dirty = iteration % 2 ? mask(rng) : ~0u;
+        TopOfBookMatrix::Exclusions excluded{};
+        if (iteration % 3 == 0) {
+            for (auto& sells : excluded) {
+                sells = mask(rng);
+            }
+        }
+
+        auto simd = TopOfBookMatrix::findBestSpread(q, active, dirty, &excluded);
+        auto scalar = TopOfBookMatrix::findBestSpreadScalar(q, active, dirty, &excluded);
+        ASSERT_EQ(simd.buy, scalar.buy) << "iteration " << iteration;
+        ASSERT_EQ(simd.sell, scalar.sell) << "iteration " << iteration;
+        ASSERT_EQ(simd.margin, scalar.margin) << "iteration " << iteration;
+    }
+}
+
+TEST_F(TopOfBookMatrixTest, ManagerPublishesTopOfBook) {
+    OrderBookManager manager;
+    manager.updateOrderBookBestBidAsk(ExchangeId::BINANCE, TradingPair::BTC_USDT, 50000.0, 1.0, 50001.0, 2.0);
+    manager.updateOrderBookBestBidAsk(ExchangeId::OKX, TradingPair::BTC_USDT, 50010.0, 0.5, 50011.0, 0.7);
+
+    TopOfBookMatrix::Quotes q;
+    manager.getTopOfBookMatrix().snapshot(TradingPair::BTC_USDT, q);
+    size_t binance = static_cast<size_t>(ExchangeId::BINANCE);
+    size_t okx = static_cast<size_t>(ExchangeId::OKX);
+    EXPECT_DOUBLE_EQ(q.bid[binance], 50000.0);
+    EXPECT_DOUBLE_EQ(q.ask[binance], 50001.0);
+    EXPECT_DOUBLE_EQ(q.askQty[binance], 2.0);
+    EXPECT_DOUBLE_EQ(q.bidQty[okx], 0.5);
+    EXPECT_EQ(q.ask[static_cast<size_t>(ExchangeId::KRAKEN)], numeric_limits<double>::infinity());
+
+    auto c = TopOfBookMatrix::findBestSpread(q, bit(ExchangeId::BINANCE) | bit(ExchangeId::OKX));
+    EXPECT_EQ(c.buy, static_cast<int>(ExchangeId::BINANCE));
+    EXPECT_EQ(c.sell, static_cast<int>(ExchangeId::OKX));
+
+    // quantity-only changes reach the matrix as well
+    manager.updateOrderBookBestBidAsk(ExchangeId::OKX, TradingPair::BTC_USDT, 50010.0, 3.0, 50011.0, 0.7);
+    manager.getTopOfBookMatrix().snapshot(TradingPair::BTC_USDT, q);
+    EXPECT_DOUBLE_EQ(q.bidQty[okx], 3.0);
+
+    // other pairs are untouched
+    manager.getTopOfBookMatrix().snapshot(TradingPair::ETH_USDT, q);
+    EXPECT_EQ(q.bid[binance], 0.0);
+}
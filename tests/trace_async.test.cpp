@@ -0,0 +1,171 @@
+#include <gtest/gtest.h>
+#include "../src/tracer.h"
+#include "../src/trace_ring.h"
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+#define TRACE(...) TRACE_BASE(TraceInstance::MAIN, ExchangeId::UNKNOWN, __VA_ARGS__)
+
+namespace {
+
+const string LOG_PATH = "trace_async.test.log";
+
+TraceRecord* pushText(TraceRing& ring, const string& text) {
+    TraceRecord* record = ring.reserve(TraceRing::recordSize(text.size()));
+    if (!record) {
+        return nullptr;
+    }
+    record->size = static_cast<uint32_t>(TraceRing::recordSize(text.size()));
+    record->payloadLength = static_cast<uint32_t>(text.size());
+    memcpy(reinterpret_cast<char*>(record + 1), text.data(), text.size());
+    ring.commit();
+    return record;
+}
+
+vector<string> readLines(const string& path) {
+    ifstream in(path);
+    vector<string> lines;
+    for (string line; getline(in, line);) {
+        lines.push_back(line);
+    }
+    return lines;
+}
+
+class TraceAsyncTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        remove(LOG_PATH.c_str());
+        FastTraceLogger::setLoggingEnabled(true);
+        FastTraceLogger::setLogFile(LOG_PATH);
+    }
+    void TearDown() override {
+        FastTraceLogger::stopAsync();
+        FastTraceLogger::getLogStream().close();
+        remove(LOG_PATH.c_str());
+    }
+};
+
+} // namespace
+
+TEST(TraceRingTest, WrapsAroundAndKeepsOrder) {
+    TraceRing ring(1024);
+    int pushed = 0, popped = 0;
+    // records of varying sizes so the padding at the end of the buffer is exercised
+    for (int round = 0; round < 200; round++) {
+        while (pushText(ring, string(static_cast<size_t>(pushed % 37), 'x') + to_string(pushed))) {
+            pushed++;
+        }
+        for (int i = 0; i < 3; i++) {
+            const TraceRecord* record = ring.front();
+            ASSERT_NE(record, nullptr);
+            string expected = string(static_cast<size_t>(popped % 37), 'x') + to_string(popped);
+            ASSERT_EQ(string(record->payload(), record->payloadLength), expected);
+            ring.pop();
+            popped++;
+        }
+    }
+    while (const TraceRecord* record = ring.front()) {
+        ASSERT_EQ(string(record->payload(), record->payloadLength), string(static_cast<size_t>(popped % 37), 'x') + to_string(popped));
+        ring.pop();
+        popped++;
+    }
+    EXPECT_EQ(popped, pushed);
+    EXPECT_GT(pushed, 600);
+    // a record bigger than half the ring never fits
+    EXPECT_EQ(ring.reserve(TraceRing::recordSize(600)), nullptr);
+}
+
+TEST_F(TraceAsyncTest, WritesEveryTraceFromEveryThreadInOrder) {
+    FastTraceLogger::startAsync();
+    ASSERT_TRUE(FastTraceLogger::isAsync());
+
+    const int THREADS = 4;
+    const int TRACES = 2000;
+    vector<thread> threads;
+    for (int t = 0; t < THREADS; t++) {
+        threads.emplace_back([t]() {
+            for (int i = 0; i < TRACES; i++) {
+                TRACE("thread ", t, " seq ", i, " value ", fixed, setprecision(2), 1.5);
+            }
+        });
+    }
+    for (auto& th : threads) {
+        th.join();
+    }
+    FastTraceLogger::stopAsync();
+    EXPECT_FALSE(FastTraceLogger::isAsync());
+    FastTraceLogger::getLogStream().flush();
+
+    map<int, int> nextSeq;
+    int count = 0;
+    for (const string& line : readLines(LOG_PATH)) {
+        size_t at = line.find("[MAIN] thread ");
+        if (at == string::npos) {
+            continue;
+        }
+        int t = -1, seq = -1;
+        ASSERT_EQ(sscanf(line.c_str() + at, "[MAIN] thread %d seq %d", &t, &seq), 2) << line;
+        EXPECT_EQ(seq, nextSeq[t]) << line;
+        nextSeq[t] = seq + 1;
+        // prefix rendered by the drain thread, manipulators of one trace do not leak into the next
+        EXPECT_NE(line.find("INFO  tid:"), string::npos) << line;
+        EXPECT_NE(line.find("trace_async.test.cpp:"), string::npos) << line;
+        EXPECT_EQ(line.substr(line.size() - 11), " value 1.50") << line;
+        count++;
+    }
+    EXPECT_EQ(count, THREADS * TRACES);
+}
+
+TEST_F(TraceAsyncTest, RendersLikeTheSynchronousPath) {
+    auto traceAll = [](const char* path) {
+        int8_t i8 = 'a';
+        uint8_t u8 = 'b';
+        signed char sc = 'c';
+        unsigned char uc = 'd';
+        TRACE(path, " ", i8, u8, sc, uc, 'e', " ", int16_t{-7}, " ", uint16_t{7}, " ", true, " ", setw(3), u8, "|",
+              hex, 255, " ", fixed, setprecision(3), 0.5);
+    };
+    traceAll("sync");
+    FastTraceLogger::startAsync();
+    traceAll("async");
+    FastTraceLogger::stopAsync();
+    FastTraceLogger::getLogStream().flush();
+
+    map<string, string> rendered;
+    for (const string& line : readLines(LOG_PATH)) {
+        for (const string path : {"sync", "async"}) {
+            size_t at = line.find("[MAIN] " + path + " ");
+            if (at != string::npos) {
+                rendered[path] = line.substr(at + 8 + path.size());
+            }
+        }
+    }
+    ASSERT_EQ(rendered.size(), 2u);
+    EXPECT_EQ(rendered["sync"], "abcde -7 7 1 b  |ff 0.500");
+    EXPECT_EQ(rendered["async"], rendered["sync"]);
+}
+
+TEST_F(TraceAsyncTest, CallerCostBelowSynchronousLogging) {
+    const int TRACES = 20000;
+    auto measure = [&]() {
+        auto start = chrono::steady_clock::now();
+        for (int i = 0; i < TRACES; i++) {
+            TRACE("order ", i, " price ", 50000.25 + i, " qty ", 0.125);
+        }
+        return chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start).count() / TRACES;
+    };
+    auto sync = measure();
+    FastTraceLogger::startAsync();
+    auto async = measure();
+    FastTraceLogger::stopAsync();
+
+    cout << "trace on the calling thread: sync " << sync << " ns, async " << async << " ns" << endl;
+    EXPECT_LT(async, sync);
+}
@@ -0,0 +1,97 @@
+#include <gtest/gtest.h>
+#include "../src/tracer.h"
+#include "../src/trace_journal.h"
+#include <cstdio>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+#define TRACE(...) TRACE_BASE(TraceInstance::ORDERBOOK, ExchangeId::KRAKEN, __VA_ARGS__)
+
+namespace {
+
+const string JOURNAL_PATH = "trace_journal.test.trace";
+
+struct Named : public Traceable {
+protected:
+    void trace(ostream& os) const override { os << "BTC/USDT 3/4"; }
+};
+
+// Encodes args the way async tracing does and renders them back
+template <typename... Args>
+string roundTrip(const Args&... args) {
+    string payload, scratch;
+    struct Append : streambuf {
+        string& out;
+        explicit Append(string& out) : out(out) {}
+        int_type overflow(int_type c) override { out.push_back(static_cast<char>(c)); return c; }
+    } buffer(scratch);
+    ostream stream(&buffer);
+    TraceArgs::Encoder encoder(payload, scratch, stream);
+    (encoder.add(args), ...);
+    string rendered;
+    TraceJournal::renderArgs(rendered, payload);
+    return rendered;
+}
+
+template <typename... Args>
+string streamed(const Args&... args) {
+    ostringstream oss;
+    (oss << ... << args);
+    return oss.str();
+}
+
+} // namespace
+
+TEST(TraceJournalTest, RenderedArgsMatchStreamedArgs) {
+    Named named;
+    const string s = "text";
+    const char* cstr = "c-string";
+    EXPECT_EQ(roundTrip("a ", 1, " ", -2L, " ", 3u, " ", 'x', " ", true, " ", s, " ", cstr, " ", string_view("view")),
+              streamed("a ", 1, " ", -2L, " ", 3u, " ", 'x', " ", true, " ", s, " ", cstr, " ", string_view("view")));
+    EXPECT_EQ(roundTrip(50000.25, " ", 0.1 + 0.2, " ", 1e-9, " ", 123456789.0), streamed(50000.25, " ", 0.1 + 0.2, " ", 1e-9, " ", 123456789.0));
+    EXPECT_EQ(roundTrip(fixed, setprecision(3), 1.23456, " ", scientific, 1.5, " ", 7),
+              streamed(fixed, setprecision(3), 1.23456, " ", scientific, 1.5, " ", 7));
+    // no raw form: formatted on the calling thread
+    EXPECT_EQ(roundTrip(ExchangeId::OKX, " ", TradingPair::ETH_USDT, " ", named, " ", hex, 255, dec, " ", setw(5), 42),
+              streamed(ExchangeId::OKX, " ", TradingPair::ETH_USDT, " ", named, " ", hex, 255, dec, " ", setw(5), 42));
+}
+
+TEST(TraceJournalTest, AsyncJournalDumpsToTextCsvAndJson) {
+    remove(JOURNAL_PATH.c_str());
+    FastTraceLogger::setLoggingEnabled(true);
+    ASSERT_TRUE(FastTraceLogger::setJournalFile(JOURNAL_PATH));
+    FastTraceLogger::startAsync();
+    for (int i = 0; i < 1000; i++) {
+        TRACE("update ", i, " bid ", 50000.5 + i, " \"quoted\"");
+    }
+    FastTraceLogger::stopAsync();
+    ASSERT_TRUE(FastTraceLogger::setJournalFile(""));
+
+    TraceJournal::Reader reader;
+    ASSERT_TRUE(reader.open(JOURNAL_PATH));
+    TraceJournal::Line line;
+    int count = 0;
+    while (reader.next(line)) {
+        string text, csv, json;
+        TraceJournal::formatText(text, line);
+        TraceJournal::formatCsv(csv, line);
+        TraceJournal::formatJson(json, line);
+
+        string message = streamed("update ", count, " bid ", 50000.5 + count, " \"quoted\"");
+        EXPECT_NE(text.find(" INFO  tid:"), string::npos) << text;
+        EXPECT_NE(text.find("trace_journal.test.cpp:"), string::npos) << text;
+        EXPECT_EQ(text.substr(text.find("[ORDERBOOK] [KRAKEN] ")), "[ORDERBOOK] [KRAKEN] " + message + "\n");
+        EXPECT_NE(csv.find(",INFO,\"trace_journal.test.cpp\","), string::npos) << csv;
+        EXPECT_NE(csv.find(",ORDERBOOK,KRAKEN,\"update " + to_string(count) + " bid "), string::npos) << csv;
+        EXPECT_NE(csv.find("\"\"quoted\"\"\""), string::npos) << csv;
+        EXPECT_NE(json.find("\"args\":[\"update \"," + to_string(count) + ",\" bid \","), string::npos) << json;
+        EXPECT_NE(json.find("\"message\":\"update " + to_string(count)), string::npos) << json;
+        count++;
+    }
+    EXPECT_EQ(count, 1000);
+    EXPECT_EQ(reader.dropped(), 0u);
+    remove(JOURNAL_PATH.c_str());
+}
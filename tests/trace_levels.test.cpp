@@ -0,0 +1,46 @@
+#include <gtest/gtest.h>
+#include "../src/tracer.h"
+
+using namespace std;
+
+#define TRACE(...) TRACE_BASE(TraceInstance::MAIN, ExchangeId::UNKNOWN, __VA_ARGS__)
+#define DEBUG(...) DEBUG_BASE(TraceInstance::MAIN, ExchangeId::UNKNOWN, __VA_ARGS__)
+
+namespace {
+
+constexpr string_view LATENCY = "ORDERBOOK=OFF,ORDERBOOK_MGR=OFF,A_IO=OFF,MAIN=DEBUG";
+
+static_assert(TraceLevels::compiledLevel(TraceInstance::ORDERBOOK, "INFO", LATENCY) == TraceLevel::OFF);
+static_assert(TraceLevels::compiledLevel(TraceInstance::A_IO, "INFO", LATENCY) == TraceLevel::OFF);
+static_assert(TraceLevels::compiledLevel(TraceInstance::MAIN, "INFO", LATENCY) == TraceLevel::DEBUG);
+static_assert(TraceLevels::compiledLevel(TraceInstance::STRAT, "INFO", LATENCY) == TraceLevel::INFO);
+static_assert(TraceLevels::compiledLevel(TraceInstance::STRAT, "OFF", LATENCY) == TraceLevel::OFF);
+static_assert(TraceLevels::compiledLevel(TraceInstance::MUTEX, "DEBUG", "") == TraceLevel::DEBUG);
+static_assert(TraceLevels::valid("INFO", LATENCY));
+static_assert(!TraceLevels::valid("INFO", "ORDERBOK=OFF"));
+static_assert(!TraceLevels::valid("INFO", "ORDERBOOK=QUIET"));
+static_assert(!TraceLevels::valid("INFO", "ORDERBOOK"));
+static_assert(!TraceLevels::valid("VERBOSE", ""));
+
+int evaluated = 0;
+
+int touch() {
+    return ++evaluated;
+}
+
+} // namespace
+
+TEST(TraceLevelsTest, CompiledOutTracesDoNotEvaluateArguments) {
+    FastTraceLogger::setLoggingEnabled(true);
+    evaluated = 0;
+    TRACE("evaluated ", touch());
+    DEBUG("evaluated ", touch());
+    const int expected = 1 + (TraceLevels::compiledIn(TraceInstance::MAIN, TraceLevel::DEBUG) ? 1 : 0);
+    EXPECT_EQ(evaluated, expected);
+
+    // runtime toggles still apply to what is compiled in
+    FastTraceLogger::setLoggingEnabled(false);
+    TRACE("evaluated ", touch());
+    EXPECT_EQ(evaluated, expected);
+    FastTraceLogger::setLoggingEnabled(true);
+}
@@ -0,0 +1,49 @@
+#include <gtest/gtest.h>
+#include "../src/types.h"
+#include <algorithm>
+#include <cctype>
+#include <string>
+
+using namespace std;
+
+namespace {
+
+const ExchangeId EXCHANGES[] = {ExchangeId::BINANCE, ExchangeId::KRAKEN, ExchangeId::KUCOIN, ExchangeId::OKX, ExchangeId::CRYPTO};
+
+string transformed(string s, int (*fn)(int)) {
+    transform(s.begin(), s.end(), s.begin(), [fn](char c) { return static_cast<char>(fn(static_cast<unsigned char>(c))); });
+    return s;
+}
+
+} // namespace
+
+TEST(TypesTest, FromSymbolResolvesEverySymbolOfEveryExchange) {
+    for (ExchangeId ex : EXCHANGES) {
+        for (int i = static_cast<int>(TradingPair::UNKNOWN) + 1; i < static_cast<int>(TradingPair::COUNT); i++) {
+            TradingPair pair = static_cast<TradingPair>(i);
+            const string& symbol = TradingPairData::getSymbol(ex, pair);
+            EXPECT_EQ(TradingPairData::fromSymbol(ex, symbol), pair) << ex << " " << symbol;
+            // exchanges are not consistent about case
+            EXPECT_EQ(TradingPairData::fromSymbol(ex, transformed(symbol, ::tolower)), pair) << ex << " " << symbol;
+            EXPECT_EQ(TradingPairData::fromSymbol(ex, transformed(symbol, ::toupper)), pair) << ex << " " << symbol;
+        }
+    }
+}
+
+TEST(TypesTest, FromSymbolReturnsUnknownInsteadOfThrowing) {
+    EXPECT_EQ(TradingPairData::fromSymbol(ExchangeId::BINANCE, "BTCUSDT"), TradingPair::BTC_USDT);
+    EXPECT_EQ(TradingPairData::fromSymbol(ExchangeId::BINANCE, "BTC-USDT"), TradingPair::UNKNOWN);  // OKX/KuCoin format
+    EXPECT_EQ(TradingPairData::fromSymbol(ExchangeId::OKX, "BTC-USDT"), TradingPair::BTC_USDT);
+    EXPECT_EQ(TradingPairData::fromSymbol(ExchangeId::KRAKEN, "BTC/USD"), TradingPair::BTC_USDT);
+    EXPECT_EQ(TradingPairData::fromSymbol(ExchangeId::KRAKEN, "BTC/USDT"), TradingPair::UNKNOWN);
+    EXPECT_EQ(TradingPairData::fromSymbol(ExchangeId::BINANCE, "BTCUSD"), TradingPair::UNKNOWN);  // prefix
+    EXPECT_EQ(TradingPairData::fromSymbol(ExchangeId::BINANCE, "BTCUSDTX"), TradingPair::UNKNOWN);
+    EXPECT_EQ(TradingPairData::fromSymbol(ExchangeId::BINANCE, "PEPEUSDT"), TradingPair::UNKNOWN);
+    EXPECT_EQ(TradingPairData::fromSymbol(ExchangeId::BINANCE, ""), TradingPair::UNKNOWN);
+    EXPECT_EQ(TradingPairData::fromSymbol(ExchangeId::UNKNOWN, "BTCUSDT"), TradingPair::UNKNOWN);
+    EXPECT_EQ(TradingPairData::fromSymbol(ExchangeId::COUNT, "BTCUSDT"), TradingPair::UNKNOWN);
+
+    // a view into a larger frame, not NUL terminated
+    const string frame = R"({"s":"ETHUSDT","b":"1.0"})";
+    EXPECT_EQ(TradingPairData::fromSymbol(ExchangeId::BINANCE, string_view(frame).substr(6, 7)), TradingPair::ETH_USDT);
+}
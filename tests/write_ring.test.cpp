@@ -0,0 +1,61 @@
+#include <gtest/gtest.h>
+#include "../src/write_ring.h"
+
+TEST(WriteRingTest, KeepsMessagesInOrder) {
+    WriteRing ring(3, 64);
+    EXPECT_TRUE(ring.empty());
+    EXPECT_TRUE(ring.push("a"));
+    EXPECT_TRUE(ring.push("b"));
+    EXPECT_TRUE(ring.push("c"));
+    // full until the front one is written
+    EXPECT_FALSE(ring.push("d"));
+    EXPECT_EQ(ring.size(), 3u);
+
+    EXPECT_EQ(ring.front(), "a");
+    ring.pop();
+    EXPECT_TRUE(ring.push("d"));
+    EXPECT_EQ(ring.at(0), "b");
+    EXPECT_EQ(ring.at(1), "c");
+    EXPECT_EQ(ring.at(2), "d");
+
+    ring.pop();
+    ring.pop();
+    ring.pop();
+    EXPECT_TRUE(ring.empty());
+    ring.pop();
+    EXPECT_TRUE(ring.empty());
+}
+
+TEST(WriteRingTest, SlotsAreReusedWithoutAllocating) {
+    WriteRing ring(2, 64);
+    ring.push("{\"id\": \"1\", \"type\": \"ping\"}");
+    const char* slot = ring.front().data();
+    ring.pop();
+    ring.push("{\"id\": \"2\", \"type\": \"ping\"}");
+    ring.pop();
+    // back in the first slot, in the storage reserved for it
+    ring.push("{\"id\": \"3\", \"type\": \"ping\"}");
+    EXPECT_EQ(ring.front().data(), slot);
+    EXPECT_EQ(ring.front(), "{\"id\": \"3\", \"type\": \"ping\"}");
+
+    // a longer message grows its slot once
+    const std::string large(1000, 'x');
+    ring.pop();
+    ring.push("short");
+    ring.push(large);
+    EXPECT_EQ(ring.at(1), large);
+}
+
+TEST(WriteRingTest, TruncateKeepsTheOldest) {
+    WriteRing ring(4, 16);
+    ring.push("in flight");
+    ring.push("stale 1");
+    ring.push("stale 2");
+    ring.truncate(1);
+    EXPECT_EQ(ring.size(), 1u);
+    EXPECT_EQ(ring.front(), "in flight");
+    ring.push("subscribe");
+    EXPECT_EQ(ring.at(1), "subscribe");
+    ring.truncate(0);
+    EXPECT_TRUE(ring.empty());
+}
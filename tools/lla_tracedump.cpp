@@ -0,0 +1,67 @@
+// Renders a binary trace journal (FastTraceLogger::setJournalFile) as text, CSV or JSON lines.
+//
+//   lla_tracedump [--text | --csv | --json] trading.trace
+#include <cstring>
+#include <iostream>
+#include <string>
+#include "trace_journal.h"
+
+namespace {
+
+enum class Format { TEXT, CSV, JSON };
+
+int usage() {
+    std::cerr << "usage: lla_tracedump [--text | --csv | --json] <journal>" << std::endl;
+    return 2;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Format format = Format::TEXT;
+    std::string path;
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--text") == 0) {
+            format = Format::TEXT;
+        } else if (std::strcmp(argv[i], "--csv") == 0) {
+            format = Format::CSV;
+        } else if (std::strcmp(argv[i], "--json") == 0) {
+            format = Format::JSON;
+        } else if (argv[i][0] == '-' || !path.empty()) {
+            return usage();
+        } else {
+            path = argv[i];
+        }
+    }
+    if (path.empty()) {
+        return usage();
+    }
+
+    TraceJournal::Reader reader;
+    if (!reader.open(path)) {
+        std::cerr << "lla_tracedump: " << path << " is not a trace journal" << std::endl;
+        return 1;
+    }
+
+    std::string out;
+    if (format == Format::CSV) {
+        TraceJournal::formatCsvHeader(out);
+    }
+    TraceJournal::Line line;
+    while (reader.next(line)) {
+        switch (format) {
+            case Format::TEXT: TraceJournal::formatText(out, line); break;
+            case Format::CSV: TraceJournal::formatCsv(out, line); break;
+            case Format::JSON: TraceJournal::formatJson(out, line); break;
+        }
+        if (out.size() > (1 << 16)) {
+            std::cout.write(out.data(), static_cast<std::streamsize>(out.size()));
+            out.clear();
+        }
+    }
+    std::cout.write(out.data(), static_cast<std::streamsize>(out.size()));
+    if (reader.dropped() > 0) {
+        std::cerr << "lla_tracedump: " << reader.dropped() << " traces were dropped when recording" << std::endl;
+    }
+    return 0;
+}